@@ -28,6 +28,7 @@
 #include "modify.h"
 #include "asciimap.h"
 #include "quest.h"
+#include "mccp.h"
 
 /* prototypes of local functions */
 /* do_diagnose utility functions */
@@ -2032,7 +2033,7 @@ ACMD(do_who)
 }
 
 #define USERS_FORMAT \
-"format: users [-l minlevel[-maxlevel]] [-n name] [-h host] [-c classlist] [-o] [-p]\r\n"
+"format: users [-l minlevel[-maxlevel]] [-n name] [-h host] [-c classlist] [-o] [-p] [-z]\r\n"
 
 ACMD(do_users)
 {
@@ -2042,7 +2043,8 @@ ACMD(do_users)
   struct char_data *tch;
   struct descriptor_data *d;
   int low = 0, high = LVL_IMPL, num_can_see = 0;
-  int showclass = 0, outlaws = 0, playing = 0, deadweight = 0;
+  int showclass = 0, outlaws = 0, playing = 0, deadweight = 0, compressed = 0;
+  unsigned long zin, zout;
   char buf[MAX_INPUT_LENGTH], arg[MAX_INPUT_LENGTH];
 
   host_search[0] = name_search[0] = '\0';
@@ -2068,6 +2070,10 @@ ACMD(do_users)
       case 'd':
     deadweight = 1;
     strcpy(buf, buf1);    /* strcpy: OK (sizeof: buf1 == buf) */
+    break;
+      case 'z':
+    compressed = 1;
+    strcpy(buf, buf1);    /* strcpy: OK (sizeof: buf1 == buf) */
     break;
       case 'l':
     playing = 1;
@@ -2108,6 +2114,8 @@ ACMD(do_users)
       continue;
     if (STATE(d) == CON_PLAYING && deadweight)
       continue;
+    if (compressed && !d->mccp)
+      continue;
     if (IS_PLAYING(d)) {
       if (d->original)
         tch = d->original;
@@ -2153,7 +2161,11 @@ ACMD(do_users)
     "UNDEFINED",
     state, idletime, timestr);
 
-    if (*d->host)
+    if (compressed) {
+      mccp_totals(d->mccp, &zin, &zout);
+      sprintf(line + strlen(line), "[%lu -> %lu bytes, %.2f:1]\r\n", zin, zout,
+        zout ? (double)zin / zout : 0.0);
+    } else if (*d->host)
       sprintf(line + strlen(line), "[%s]\r\n", d->host);
     else
       strcat(line, "[Hostname unknown]\r\n");
@@ -2794,10 +2806,12 @@ ACMD(do_toggle)
         else {
           send_to_char(ch, "Okay, you'll wimp out if you drop below %d hit points.", wimp_lev);
           GET_WIMP_LEV(ch) = wimp_lev;
+          msdp_changed(ch, MSDP_DIRTY_WIMPY);
         }
       } else {
         send_to_char(ch, "Okay, you'll now tough out fights to the bitter end.");
         GET_WIMP_LEV(ch) = 0;
+        msdp_changed(ch, MSDP_DIRTY_WIMPY);
       }
     } else
       send_to_char(ch, "Specify at how many hit points you want to wimp out at.  (0 to disable)\r\n");
@@ -193,6 +193,8 @@ ACMD(do_put)
                 GET_OBJ_VAL(obj, 0) = pile - howmany;
                 update_money_obj(obj);
                 GET_COINS(ch) = MAX(0, GET_COINS(ch) - howmany);
+                MARK_CHAR_CHANGED(ch);
+                msdp_changed(ch, MSDP_DIRTY_MONEY);
                 obj = split;
                 howmany = 1;
               } else {
@@ -319,6 +321,8 @@ static bool merge_money_pile(struct char_data *ch, struct obj_data *obj)
   GET_OBJ_VAL(target, 0) += coins;
   update_money_obj(target);
   GET_COINS(ch) = MIN(MAX_COINS, GET_COINS(ch) + coins);
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_MONEY);
   extract_obj(obj);
 
   return TRUE;
@@ -2173,8 +2177,10 @@ ACMD(do_forage)
   delay_seconds = rand_number(8, 12);
   WAIT_STATE(ch, delay_seconds * PASSES_PER_SEC);
 
-  if (!IS_NPC(ch))
+  if (!IS_NPC(ch)) {
     GET_STAMINA(ch) = MAX(0, GET_STAMINA(ch) - cost);
+    msdp_changed(ch, MSDP_DIRTY_VITALS);
+  }
 
   total = roll_skill_check(ch, SKILL_SURVIVAL, 0, NULL);
 
@@ -573,8 +573,10 @@ int do_simple_move(struct char_data *ch, int dir, int need_specials_check)
   /* Begin: the leave operation. */
   /*---------------------------------------------------------------------*/
   /* If applicable, subtract movement cost. */
-  if (GET_LEVEL(ch) < LVL_IMMORT && (mounted_move || !IS_NPC(ch)))
+  if (GET_LEVEL(ch) < LVL_IMMORT && (mounted_move || !IS_NPC(ch))) {
     GET_STAMINA(stamina_ch) -= need_movement;
+    msdp_changed(stamina_ch, MSDP_DIRTY_VITALS);
+  }
 
   /* Generate the leave message and display to others in the was_in room. */
   if (AFF_FLAGGED(ch, AFF_SNEAK)) {
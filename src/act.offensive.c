@@ -740,6 +740,7 @@ ACMD(do_bandage)
   if (heal < 1) heal = 1;
 
   GET_HIT(vict) = MIN(GET_MAX_HIT(vict), GET_HIT(vict) + heal);
+  msdp_changed(vict, MSDP_DIRTY_VITALS);
 
   act("You successfully bandage $N.", FALSE, ch, 0, vict, TO_CHAR);
   act("$n bandages $N, who looks a bit better now.", TRUE, ch, 0, vict, TO_NOTVICT);
@@ -198,12 +198,7 @@ ACMD(do_save)
       mudlog(NRM, LVL_IMMORT, FALSE,
              "RoomSave: manual save of room %d by %s.",
              world[rnum].number, GET_NAME(ch));
-      /* If you added a dirty-save API and want to clear the bit on manual save,
-         you can optionally call it here (guard with a macro if desired):
-         #ifdef ROOMSAVE_HAVE_DIRTY_API
-         RoomSave_clear_dirty(rnum);
-         #endif
-      */
+      /* RoomSave_now() also takes the room off the autosave dirty list. */
     } else {
       send_to_char(ch, "Room save failed; see logs.\r\n");
       mudlog(NRM, LVL_IMMORT, TRUE,
@@ -589,6 +584,8 @@ static bool sleight_merge_money_pile(struct char_data *ch, struct obj_data *obj)
   GET_OBJ_VAL(target, 0) += coins;
   update_money_obj(target);
   GET_COINS(ch) = MIN(MAX_COINS, GET_COINS(ch) + coins);
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_MONEY);
   extract_obj(obj);
 
   return TRUE;
@@ -757,6 +754,7 @@ ACMD(do_sneak)
     gain_skill(ch, "stealth", FALSE);
     WAIT_STATE(ch, PULSE_VIOLENCE / 2);
     GET_STAMINA(ch) -= 10;
+    msdp_changed(ch, MSDP_DIRTY_VITALS);
     return;
   }
 
@@ -776,6 +774,7 @@ ACMD(do_sneak)
 
   gain_skill(ch, "stealth", TRUE);
   GET_STAMINA(ch) -= 10;
+  msdp_changed(ch, MSDP_DIRTY_VITALS);
 }
 
 ACMD(do_hide)
@@ -812,6 +811,7 @@ ACMD(do_hide)
     gain_skill(ch, "stealth", FALSE);
     WAIT_STATE(ch, PULSE_VIOLENCE / 2);
     GET_STAMINA(ch) -= 10;
+    msdp_changed(ch, MSDP_DIRTY_VITALS);
     return;
   }
 
@@ -823,6 +823,7 @@ ACMD(do_hide)
   gain_skill(ch, "stealth", TRUE);
   WAIT_STATE(ch, PULSE_VIOLENCE / 2);
   GET_STAMINA(ch) -= 10;
+  msdp_changed(ch, MSDP_DIRTY_VITALS);
 }
 
 static void remember_scan_target(struct char_data *ch, struct char_data *tch)
@@ -1133,6 +1134,7 @@ ACMD(do_scan)
 
   WAIT_STATE(ch, PULSE_VIOLENCE / 2);
   GET_STAMINA(ch) -= 10;
+  msdp_changed(ch, MSDP_DIRTY_VITALS);
 }
 
 ACMD(do_listen)
@@ -1163,6 +1165,7 @@ ACMD(do_listen)
 
   WAIT_STATE(ch, PULSE_VIOLENCE / 2);
   GET_STAMINA(ch) -= 10;
+  msdp_changed(ch, MSDP_DIRTY_VITALS);
 }
 
 ACMD(do_palm)
@@ -1310,6 +1313,8 @@ ACMD(do_slip)
       GET_OBJ_VAL(obj, 0) = pile - howmany;
       update_money_obj(obj);
       GET_COINS(ch) = MAX(0, GET_COINS(ch) - howmany);
+      MARK_CHAR_CHANGED(ch);
+      msdp_changed(ch, MSDP_DIRTY_MONEY);
       obj = split;
     }
   }
@@ -1461,6 +1466,8 @@ ACMD(do_steal)
 
       if (coins > 0) {
         GET_COINS(vict) = MAX(0, GET_COINS(vict) - coins);
+        MARK_CHAR_CHANGED(vict);
+        msdp_changed(vict, MSDP_DIRTY_MONEY);
         add_coins_to_char(ch, coins);
         gain_skill(ch, "sleight of hand", TRUE);
         if (coins > 1)
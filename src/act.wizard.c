@@ -37,6 +37,11 @@
 #include "quest.h"
 #include "ban.h"
 #include "screen.h"
+#include "save_writer.h"
+#include "dormancy.h"
+#include "resolver.h"
+#include "mccp.h"
+#include "netio.h"
 
 /* local utility functions with file scope */
 static int perform_set(struct char_data *ch, struct char_data *vict, int mode, char *val_arg);
@@ -378,7 +383,7 @@ static void stat_format_script_globals(struct script_data *sc, char *buf, size_t
     return;
   }
 
-  for (struct trig_var_data *tv = sc->global_vars; tv; tv = tv->next) {
+  for (struct trig_var_data *tv = sc->global_vars->first; tv; tv = tv->next) {
     char value[MAX_INPUT_LENGTH];
 
     if (*(tv->value) == UID_CHAR)
@@ -2442,8 +2447,8 @@ ACMD(do_switch)
     ch->desc->character = victim;
     ch->desc->original = ch;
 
-    victim->desc = ch->desc;
-    ch->desc = NULL;
+    set_char_desc(victim, ch->desc);
+    set_char_desc(ch, NULL);
   }
 }
 
@@ -2452,6 +2457,7 @@ static void do_cheat(struct char_data *ch)
   switch (GET_IDNUM(ch)) {
     case    1: // IMP
       GET_LEVEL(ch) = LVL_IMPL;
+      msdp_changed(ch, MSDP_DIRTY_LEVEL);
       break;
     default:
       send_to_char(ch, "You do not have access to this command.\r\n");
@@ -2478,8 +2484,8 @@ void return_to_char(struct char_data * ch)
   ch->desc->original = NULL;
 
   /* And our body's pointer to descriptor now points to our descriptor. */
-  ch->desc->character->desc = ch->desc;
-  ch->desc = NULL;  
+  set_char_desc(ch->desc->character, ch->desc);
+  set_char_desc(ch, NULL);
 }
 
 ACMD(do_return)
@@ -2666,7 +2672,7 @@ ACMD(do_purge)
 	if (vict->desc) {
 	  STATE(vict->desc) = CON_CLOSE;
 	  vict->desc->character = NULL;
-	  vict->desc = NULL;
+	  set_char_desc(vict, NULL);
 	}
       }
       extract_char(vict);
@@ -2733,6 +2739,7 @@ ACMD(do_advance)
   if (newlevel < GET_LEVEL(victim)) {
     do_start(victim);
     GET_LEVEL(victim) = newlevel;
+    msdp_changed(victim, MSDP_DIRTY_LEVEL);
     send_to_char(victim, "You are momentarily enveloped by darkness!\r\nYou feel somewhat diminished.\r\n");
   } else {
     act("$n makes some strange gestures. A strange feeling comes upon you,\r\n"
@@ -2801,6 +2808,7 @@ ACMD(do_restore)
       GET_HIT(vict)  = GET_MAX_HIT(vict);
       GET_MANA(vict) = GET_MAX_MANA(vict);
       GET_STAMINA(vict) = GET_MAX_STAMINA(vict);
+      msdp_changed(vict, MSDP_DIRTY_VITALS);
 
       update_pos(vict);
       send_to_char(ch, "%s has been fully healed.\r\n", GET_NAME(vict));
@@ -2817,6 +2825,7 @@ ACMD(do_restore)
     GET_HIT(vict) = GET_MAX_HIT(vict);
     GET_MANA(vict) = GET_MAX_MANA(vict);
     GET_STAMINA(vict) = GET_MAX_STAMINA(vict);
+    msdp_changed(vict, MSDP_DIRTY_VITALS);
 
     if (!IS_NPC(vict) && GET_LEVEL(ch) >= LVL_GRGOD) {
       if (GET_LEVEL(vict) >= LVL_IMMORT)
@@ -3640,7 +3649,7 @@ static size_t print_zone_to_buf(char *bufptr, size_t left, zone_rnum zone, int l
     tmp = snprintf(bufptr, left,
 	"%3d %-30.30s%s By: %-10.10s%s Age: %3d; Reset: %3d (%s); Range: %5d-%5d\r\n",
 	zone_table[zone].number, zone_table[zone].name, KNRM, zone_table[zone].builders, KNRM,
-	zone_table[zone].age, zone_table[zone].lifespan,
+	zone_age(zone), zone_table[zone].lifespan,
         zone_table[zone].reset_mode ? ((zone_table[zone].reset_mode == 1) ? "Reset when no players are in zone" : "Normal reset") : "Never reset",
 	zone_table[zone].bot, zone_table[zone].top);
         j = k = l = m = n = o = 0;
@@ -3705,6 +3714,11 @@ ACMD(do_show)
 	arg[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH];
   int r, g, b;
   char colour[16];
+  int dormant;
+  long dormancy_saved;
+  struct resolver_stats rs;
+  unsigned long zin, zout, din, dout, nin, nout;
+  int compressed, threaded;
 
   struct show_struct {
     const char *cmd;
@@ -3846,6 +3860,28 @@ ACMD(do_show)
     }
     for (obj = object_list; obj; obj = obj->next)
       k++;
+    /* What the skipped mob turns would have cost at the going rate, spread
+     * over the ticks since boot. */
+    for (dormant = 0, zrn = 0; zrn <= top_of_zone_table; zrn++)
+      if (ZONE_DORMANT(zrn))
+        dormant++;
+    dormancy_saved = mob_ai_turns ?
+      (long)((double)mob_ai_dormant * mob_ai_usec / mob_ai_turns /
+             MAX(1, (time(0) - boot_time) / SECS_PER_MUD_HOUR)) : 0;
+    resolver_get_stats(&rs);
+    zin = mccp_bytes_in;
+    zout = mccp_bytes_out;
+    for (compressed = 0, d = descriptor_list; d; d = d->next)
+      if (d->mccp) {
+        mccp_totals(d->mccp, &din, &dout);
+        zin += din;
+        zout += dout;
+        compressed++;
+      }
+    for (threaded = 0, d = descriptor_list; d; d = d->next)
+      if (d->netio)
+        threaded++;
+    netio_totals(&nin, &nout);
     send_to_char(ch,
 	"Current stats:\r\n"
 	"  %5d players in game  %5d connected\r\n"
@@ -3854,9 +3890,15 @@ ACMD(do_show)
 	"  %5d objects          %5d prototypes\r\n"
 	"  %5d rooms            %5d zones\r\n"
   "  %5d triggers         %5d shops\r\n"
-  "  %5d large bufs       %5d autoquests\r\n"
-	"  %5d buf switches     %5d overflows\r\n"
-	"  %5d lists\r\n",
+  "  %5d output blocks    %5d autoquests\r\n"
+	"  %5d overflows        %5d lists\r\n"
+	"  %5.2f bytes copied per byte of output sent\r\n"
+	"  %5ld autosaved files  %5ld skipped (unchanged)\r\n"
+	"  %5ld mob AI slices    %5ld usec average, %ld worst\r\n"
+	"  %5d dormant zones    %5ld mob turns skipped, ~%ld usec saved a tick\r\n"
+	"  %5ld site lookups    %5ld cached, %ld shared, %ld nameless, %ld msec worst\r\n"
+	"  %5d compressed       %5.2f:1 compression, %lu bytes saved\r\n"
+	"  %5d on net thread    %5lu KB read, %lu KB sent\r\n",
 	i, con,
 	top_of_p_table + 1,
 	j, top_of_mobt + 1,
@@ -3864,7 +3906,15 @@ ACMD(do_show)
 	top_of_world + 1, top_of_zone_table + 1,
 	top_of_trigt + 1, top_shop + 1,
 	buf_largecount, total_quests,
-	buf_switches, buf_overflows, global_lists->iSize
+	buf_overflows, global_lists->iSize,
+	output_bytes_sent ? (double)output_bytes_copied / output_bytes_sent : 0.0,
+	autosave_files_written, autosave_files_skipped,
+	mob_ai_slices, mob_ai_slices ? mob_ai_usec / mob_ai_slices : 0,
+	mob_ai_worst_usec,
+	dormant, mob_ai_dormant, dormancy_saved,
+	rs.lookups, rs.hits, rs.shared, rs.failures, rs.worst_ms,
+	compressed, zout ? (double)zin / zout : 0.0, zin > zout ? zin - zout : 0,
+	threaded, nin / 1024, nout / 1024
 	);
     break;
 
@@ -4107,6 +4157,10 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
   } else if (set_fields[mode].type == NUMBER) {
     value = atoi(val_arg);
   }
+
+  /* Most fields are something MSDP reports; let it look at them all. */
+  msdp_changed(vict, MSDP_DIRTY_ALL);
+
   switch (mode) {
     case 0: /* ac */
       vict->points.armor = RANGE(-100, 100);
@@ -4203,6 +4257,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
         for (i = 0; i < NUM_WEARS; i++)
           remove_other_coins_from_list(GET_EQ(vict, i), NULL);
         GET_COINS(vict) = 0;
+        MARK_CHAR_CHANGED(vict);
         send_to_char(ch, "Ok.\r\n");
         return (1);
       }
@@ -4224,6 +4279,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
         remove_other_coins_from_list(GET_EQ(vict, i), coin_obj);
 
       GET_COINS(vict) = value;
+      MARK_CHAR_CHANGED(vict);
       send_to_char(ch, "Ok.\r\n");
       return (1);
     }
@@ -5463,6 +5519,9 @@ ACMD(do_copyover)
 
    sprintf (buf, "\n\r *** COPYOVER by %s - please remain seated!\n\r", GET_NAME(ch));
 
+   /* The sockets are written to directly from here on, and handed over. */
+   stop_network_thread();
+
    /* write boot_time as first line in file */
    fprintf(fp, "%ld\n", (long)boot_time);
 
@@ -5479,7 +5538,7 @@ ACMD(do_copyover)
 
   /* drop those logging on */
    if (!d->character || d->connected > CON_PLAYING) {
-     write_to_descriptor (d->descriptor, "\n\rSorry, we are rebooting. Come back in a few minutes.\n\r");
+     write_direct(d, "\n\rSorry, we are rebooting. Come back in a few minutes.\n\r");
      close_socket (d); /* throw'em out */
    } else {
       fprintf (fp, "%d %ld %s %s %s\n", d->descriptor, GET_PREF(och), GET_NAME(och), d->host, CopyoverGet(d));
@@ -5494,6 +5553,9 @@ ACMD(do_copyover)
   fprintf (fp, "-1\n");
   fclose (fp);
 
+  /* Queued saves use paths relative to lib/, so finish them before the chdir. */
+  save_writer_flush();
+
   /* exec - descriptors are inherited */
   sprintf (buf, "%d", port);
   sprintf (buf2, "-C%d", mother_desc);
@@ -5905,7 +5967,7 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
 {
   struct char_data *temp_ch=NULL;
   int plr_i = 0, i, k;
-  char old_name[MAX_NAME_LENGTH], old_pfile[50], new_pfile[50], buf[MAX_STRING_LENGTH];
+  char old_name[MAX_NAME_LENGTH], old_pfile[50], new_pfile[50];
 
   if (!ch)
   {
@@ -5977,8 +6039,17 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
   free(GET_PC_NAME(vict));
   GET_PC_NAME(vict) = strdup(CAP(new_name));    // Change the name in the victims char struct
 
-  /* Rename the player's pfile */
-  sprintf(buf, "mv %s %s", old_pfile, new_pfile);
+  /* Rename the player's files, once the save writer is done with them, so a
+   * queued save can't land under the old name after the move */
+  for (k = 0; k < MAX_FILES; k++) {
+    if (!get_filename(old_pfile, sizeof(old_pfile), k, old_name) ||
+        !get_filename(new_pfile, sizeof(new_pfile), k, new_name))
+      continue;
+    save_writer_wait(old_pfile);
+    save_writer_wait(new_pfile);
+    if (rename(old_pfile, new_pfile) < 0 && errno != ENOENT)
+      log("SYSERR: Couldn't rename %s to %s: %s", old_pfile, new_pfile, strerror(errno));
+  }
 
   /* Save the changed player index - the pfile is saved by perform_set */
   save_player_index();
@@ -0,0 +1,129 @@
+/**
+* @file boot_parse.c
+* Parsing of the TOML world files at boot, optionally on several threads.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "toml.h"
+#include "boot_parse.h"
+
+/** Work on one file; safe to run on any thread. */
+static void parse_one(struct boot_file *f)
+{
+  FILE *fp;
+  toml_array_t *arr;
+
+  f->tab = NULL;
+  f->count = 0;
+  f->open_errno = 0;
+  *f->errbuf = '\0';
+
+  if (!(fp = fopen(f->path, "r"))) {
+    f->open_errno = errno ? errno : ENOENT;
+    return;
+  }
+
+  f->tab = toml_parse_file(fp, f->errbuf, sizeof(f->errbuf));
+  fclose(fp);
+
+  if (f->tab && (arr = toml_array_in(f->tab, f->key)) != NULL)
+    f->count = toml_array_nelem(arr);
+}
+
+/** Work out how many parser threads to use.
+ * @param configured The boot_threads setting: 0 means one per online CPU,
+ * 1 parses on the main thread only.
+ * @retval int The number of threads, at least 1. */
+int boot_parse_threads(int configured)
+{
+#ifdef HAVE_PTHREAD_H
+  int n = configured;
+
+  if (n <= 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+    n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    n = 1;
+#endif
+  }
+  return (MAX(1, MIN(n, BOOT_PARSE_MAX_THREADS)));
+#else
+  return (1);
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+struct parse_pool {
+  struct boot_file *files;
+  int num_files;
+  int next;              /* next file nobody has taken yet */
+  pthread_mutex_t lock;
+};
+
+static void *parse_worker(void *arg)
+{
+  struct parse_pool *pool = arg;
+  int i;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    i = pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (i >= pool->num_files)
+      return (NULL);
+    parse_one(&pool->files[i]);
+  }
+}
+#endif
+
+/** Parse a list of world files.  Each file's results are stored in its own
+ * entry, so the order they finish in does not matter.
+ * @param files The files; tab, count, open_errno and errbuf are filled in.
+ * @param num_files Number of entries in files.
+ * @param threads From boot_parse_threads(); the calling thread is one of
+ * them. */
+void boot_parse_files(struct boot_file *files, int num_files, int threads)
+{
+  int i;
+#ifdef HAVE_PTHREAD_H
+  pthread_t tid[BOOT_PARSE_MAX_THREADS];
+  struct parse_pool pool;
+  int started = 0;
+
+  threads = MIN(threads, num_files);
+  if (threads > 1) {
+    pool.files = files;
+    pool.num_files = num_files;
+    pool.next = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    for (i = 0; i < threads - 1; i++)
+      if (pthread_create(&tid[started], NULL, parse_worker, &pool) == 0)
+        started++;
+
+    parse_worker(&pool);
+
+    for (i = 0; i < started; i++)
+      pthread_join(tid[i], NULL);
+    pthread_mutex_destroy(&pool.lock);
+    return;
+  }
+#endif
+
+  for (i = 0; i < num_files; i++)
+    parse_one(&files[i]);
+}
@@ -0,0 +1,33 @@
+/**
+* @file boot_parse.h
+* Parsing of the TOML world files at boot, optionally on several threads.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* Only the parsing is done in parallel.  index_boot() still creates the
+* rooms, mobs, objects etc. on the main thread, walking the parsed files in
+* index order, so rnums come out exactly as in a serial boot.  Nothing here
+* may call log() or touch game data, since it runs off the main thread.
+*/
+#ifndef _BOOT_PARSE_H_
+#define _BOOT_PARSE_H_
+
+/** Upper bound on parser threads, whatever is configured. */
+#define BOOT_PARSE_MAX_THREADS 32
+
+/** One world file to parse. */
+struct boot_file {
+  const char *path;           /**< File to parse; owned by the caller. */
+  const char *key;            /**< Record array to count ("room", "mob"...). */
+  struct toml_table_t *tab;   /**< Parsed file, or NULL if it failed. */
+  int count;                  /**< Entries in the key array. */
+  int open_errno;             /**< errno from fopen(), 0 if it opened. */
+  char errbuf[200];           /**< Parser error when tab is NULL. */
+};
+
+int  boot_parse_threads(int configured);
+void boot_parse_files(struct boot_file *files, int num_files, int threads);
+
+#endif /* _BOOT_PARSE_H_ */
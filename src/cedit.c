@@ -17,6 +17,7 @@
 #include "oasis.h"
 #include "improved-edit.h"
 #include "modify.h"
+#include "boot_parse.h"
 
 /* local scope functions, not used externally */
 static void cedit_disp_menu(struct descriptor_data *d);
@@ -126,6 +127,11 @@ static void cedit_setup(struct descriptor_data *d)
   OLC_CONFIG(d)->operation.protocol_negotiation = CONFIG_PROTOCOL_NEGOTIATION;
   OLC_CONFIG(d)->operation.special_in_comm    = CONFIG_SPECIAL_IN_COMM;
   OLC_CONFIG(d)->operation.debug_mode    = CONFIG_DEBUG_MODE;
+  OLC_CONFIG(d)->operation.boot_threads  = CONFIG_BOOT_THREADS;
+  OLC_CONFIG(d)->operation.mob_ai_shards = CONFIG_MOB_AI_SHARDS;
+  OLC_CONFIG(d)->operation.dormancy_delay = CONFIG_DORMANCY_DELAY;
+  OLC_CONFIG(d)->operation.dormancy_radius = CONFIG_DORMANCY_RADIUS;
+  OLC_CONFIG(d)->operation.network_thread = CONFIG_NETWORK_THREAD;
   
   /* Autowiz */
   OLC_CONFIG(d)->autowiz.use_autowiz          = CONFIG_USE_AUTOWIZ;
@@ -223,6 +229,11 @@ static void cedit_save_internally(struct descriptor_data *d)
   CONFIG_PROTOCOL_NEGOTIATION = OLC_CONFIG(d)->operation.protocol_negotiation;
   CONFIG_SPECIAL_IN_COMM      = OLC_CONFIG(d)->operation.special_in_comm;
   CONFIG_DEBUG_MODE           = OLC_CONFIG(d)->operation.debug_mode;
+  CONFIG_BOOT_THREADS         = OLC_CONFIG(d)->operation.boot_threads;
+  CONFIG_MOB_AI_SHARDS        = OLC_CONFIG(d)->operation.mob_ai_shards;
+  CONFIG_DORMANCY_DELAY       = OLC_CONFIG(d)->operation.dormancy_delay;
+  CONFIG_DORMANCY_RADIUS      = OLC_CONFIG(d)->operation.dormancy_radius;
+  CONFIG_NETWORK_THREAD       = OLC_CONFIG(d)->operation.network_thread;
     
   /* Autowiz */
   CONFIG_USE_AUTOWIZ          = OLC_CONFIG(d)->autowiz.use_autowiz;
@@ -540,6 +551,26 @@ int save_config( IDXTYPE nowhere )
               "debug_mode = %d\n\n",
               CONFIG_DEBUG_MODE);
 
+  fprintf(fl, "* Threads used to parse the world files at boot, 0 for one per CPU.\n"
+              "boot_threads = %d\n\n",
+              CONFIG_BOOT_THREADS);
+
+  fprintf(fl, "* Pulses the mob AI is spread over, 1 to %d.\n"
+              "mob_ai_shards = %d\n\n",
+              PULSE_MOBILE, CONFIG_MOB_AI_SHARDS);
+
+  fprintf(fl, "* Minutes with no player near before a zone goes dormant, 0 for never.\n"
+              "dormancy_delay = %d\n\n",
+              CONFIG_DORMANCY_DELAY);
+
+  fprintf(fl, "* How many zones away from a player count as near.\n"
+              "dormancy_radius = %d\n\n",
+              CONFIG_DORMANCY_RADIUS);
+
+  fprintf(fl, "* If yes, do socket reads and writes on a network thread.\n"
+              "network_thread = %d\n\n",
+              CONFIG_NETWORK_THREAD);
+
   fclose(fl);
 
   if (in_save_list(NOWHERE, SL_CFG))
@@ -715,6 +746,11 @@ static void cedit_disp_operation_options(struct descriptor_data *d)
   	"%sR%s) Enable Protocol Negotiation : %s%s\r\n"
   	"%sS%s) Enable Special Char in Comm : %s%s\r\n"
   	"%sT%s) Current Debug Mode : %s%s\r\n"
+  	"%sU%s) Boot Parser Threads (0 = per CPU) : %s%d\r\n"
+  	"%sV%s) Mob AI Shards : %s%d\r\n"
+  	"%sW%s) Zone Dormancy Delay (minutes, 0 = never) : %s%d\r\n"
+  	"%sX%s) Zone Dormancy Radius (zones) : %s%d\r\n"
+  	"%sY%s) Network I/O Thread : %s%s\r\n"
     "%sQ%s) Exit To The Main Menu\r\n"
     "Enter your choice : ",
     grn, nrm, cyn, OLC_CONFIG(d)->operation.DFLT_PORT,
@@ -736,6 +772,11 @@ static void cedit_disp_operation_options(struct descriptor_data *d)
     grn, nrm, cyn, OLC_CONFIG(d)->operation.protocol_negotiation ? "Yes" : "No",
     grn, nrm, cyn, OLC_CONFIG(d)->operation.special_in_comm ? "Yes" : "No",
     grn, nrm, cyn, OLC_CONFIG(d)->operation.debug_mode == 0 ? "OFF" : (OLC_CONFIG(d)->operation.debug_mode == 1 ? "BRIEF" : (OLC_CONFIG(d)->operation.debug_mode == 2 ? "NORMAL" : "COMPLETE")),
+    grn, nrm, cyn, OLC_CONFIG(d)->operation.boot_threads,
+    grn, nrm, cyn, OLC_CONFIG(d)->operation.mob_ai_shards,
+    grn, nrm, cyn, OLC_CONFIG(d)->operation.dormancy_delay,
+    grn, nrm, cyn, OLC_CONFIG(d)->operation.dormancy_radius,
+    grn, nrm, cyn, OLC_CONFIG(d)->operation.network_thread ? "Yes" : "No",
     grn, nrm
     );
 
@@ -1190,6 +1231,35 @@ void cedit_parse(struct descriptor_data *d, char *arg)
            OLC_MODE(d) = CEDIT_DEBUG_MODE;
            return;
 
+         case 'u':
+         case 'U':
+           write_to_output(d, "Enter the number of boot parser threads (0: one per CPU, 1: serial) : ");
+           OLC_MODE(d) = CEDIT_BOOT_THREADS;
+           return;
+
+         case 'v':
+         case 'V':
+           write_to_output(d, "Enter the number of mob AI shards (1 to %d) : ", PULSE_MOBILE);
+           OLC_MODE(d) = CEDIT_MOB_AI_SHARDS;
+           return;
+
+         case 'w':
+         case 'W':
+           write_to_output(d, "Enter the minutes before an unvisited zone goes dormant (0: never) : ");
+           OLC_MODE(d) = CEDIT_DORMANCY_DELAY;
+           return;
+
+         case 'x':
+         case 'X':
+           write_to_output(d, "Enter how many zones away a player keeps a zone awake : ");
+           OLC_MODE(d) = CEDIT_DORMANCY_RADIUS;
+           return;
+
+         case 'y':
+         case 'Y':
+           TOGGLE_VAR(OLC_CONFIG(d)->operation.network_thread);
+           break;
+
          case 'q':
          case 'Q':
            cedit_disp_menu(d);
@@ -1528,6 +1598,26 @@ void cedit_parse(struct descriptor_data *d, char *arg)
       cedit_disp_operation_options(d);
       break;
 
+    case CEDIT_BOOT_THREADS:
+      OLC_CONFIG(d)->operation.boot_threads = LIMIT(atoi(arg), 0, BOOT_PARSE_MAX_THREADS);
+      cedit_disp_operation_options(d);
+      break;
+
+    case CEDIT_MOB_AI_SHARDS:
+      OLC_CONFIG(d)->operation.mob_ai_shards = LIMIT(atoi(arg), 1, PULSE_MOBILE);
+      cedit_disp_operation_options(d);
+      break;
+
+    case CEDIT_DORMANCY_DELAY:
+      OLC_CONFIG(d)->operation.dormancy_delay = MAX(0, atoi(arg));
+      cedit_disp_operation_options(d);
+      break;
+
+    case CEDIT_DORMANCY_RADIUS:
+      OLC_CONFIG(d)->operation.dormancy_radius = MAX(0, atoi(arg));
+      cedit_disp_operation_options(d);
+      break;
+
     case CEDIT_MIN_WIZLIST_LEV:
       if (atoi(arg) > LVL_IMPL) {
         write_to_output(d,
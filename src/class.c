@@ -17,6 +17,7 @@
 #include "sysdep.h"
 #include "structs.h"
 #include "utils.h"
+#include "comm.h"
 #include "db.h"
 #include "spells.h"
 #include "interpreter.h"
@@ -615,6 +616,8 @@ void do_start(struct char_data *ch)
 
   if (CONFIG_SITEOK_ALL)
     SET_BIT_AR(PLR_FLAGS(ch), PLR_SITEOK);
+
+  msdp_changed(ch, MSDP_DIRTY_ALL);
 }
 
 /* This function controls the change to maxstamina, maxmana, and maxhp for each
@@ -706,6 +709,7 @@ void advance_level(struct char_data *ch)
     SET_BIT_AR(PRF_FLAGS(ch), PRF_HOLYLIGHT);
   }
 
+  msdp_changed(ch, MSDP_DIRTY_LEVEL | MSDP_DIRTY_VITALS);
   snoop_check(ch);
   save_char(ch);
 }
@@ -83,23 +83,52 @@
 #include "quest.h"
 #include "ibt.h" /* for free_ibt_lists */
 #include "mud_event.h"
+#include "poller.h"
+#include "save_writer.h"
+#include "resolver.h"
+#include "mccp.h"
+#include "netio.h"
+#include "input_scan.h"
+#include "dormancy.h"
 
 #ifndef INVALID_SOCKET
 #define INVALID_SOCKET (-1)
 #endif
 
+/* True if d has compressed output the socket hasn't taken yet. */
+#define COMPRESSED_PENDING(d) ((d)->mccp && mccp_pending((d)->mccp, NULL) > 0)
+/* How long end_compression() waits for the end of a stream to be sent:
+ * up to MCCP_DRAIN_TRIES waits of MCCP_DRAIN_WAIT microseconds. */
+#define MCCP_DRAIN_TRIES 25
+#define MCCP_DRAIN_WAIT  10000
+
+#if defined(CIRCLE_WINDOWS) || !defined(HAVE_SYS_UIO_H)
+/* Output is sent in pieces; without writev() they go one at a time. */
+struct iovec {
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
 extern time_t motdmod;
 extern time_t newsmod;
 
 /* locally defined globals, used externally */
 struct descriptor_data *descriptor_list = NULL;   /* master desc list */
-int buf_largecount = 0;   /* # of large buffers which exist */
+int buf_largecount = 0;   /* # of output blocks which exist */
 int buf_overflows = 0;    /* # of overflows of output */
-int buf_switches = 0;     /* # of switches from small to large buf */
+long output_bytes_copied = 0; /* bytes copied into output blocks */
+long output_bytes_sent = 0;   /* bytes of queued output sent */
+unsigned long mccp_bytes_in = 0;  /* text compressed by streams since ended */
+unsigned long mccp_bytes_out = 0; /* and what it came to */
 int circle_shutdown = 0;  /* clean shutdown */
 int circle_reboot = 0;    /* reboot the game after a shutdown */
 int no_specials = 0;      /* Suppress ass. of special routines */
 int scheck = 0;           /* for syntax checking mode */
+int no_world_image = 0;   /* rebuild the world image from the TOML files */
+#ifdef DG_CORPUS
+static const char *dg_corpus_file = NULL; /* run the DG regression corpus */
+#endif
 FILE *logfile = NULL;     /* Where to send the log messages. */
 unsigned long pulse = 0;  /* number of pulses since game start */
 ush_int port;
@@ -108,7 +137,7 @@ int next_tick = SECS_PER_MUD_HOUR;  /* Tick countdown */
 
 
 /* static local global variable declarations (current file scope only) */
-static struct txt_block *bufpool = 0;  /* pool of large output buffers */
+static struct out_block *out_pool = NULL;  /* pool of spare output blocks */
 static int max_players = 0;   /* max descriptors available */
 static int tics_passed = 0;     /* for extern checkpointing */
 static struct timeval null_time; /* zero-valued time structure */
@@ -135,12 +164,22 @@ static void init_game(ush_int port);
 static void signal_setup(void);
 static socket_t init_socket(ush_int port);
 static int new_descriptor(socket_t s);
+static void host_resolved(long key, struct in_addr addr, const char *name);
 static int get_max_players(void);
 static int process_output(struct descriptor_data *t);
 static int process_input(struct descriptor_data *t);
 static void timediff(struct timeval *diff, struct timeval *a, struct timeval *b);
 static void timeadd(struct timeval *sum, struct timeval *a, struct timeval *b);
 static void flush_queues(struct descriptor_data *d);
+static void output_append(struct descriptor_data *t, const char *txt, int len);
+static void release_output(struct descriptor_data *t);
+static int write_iov_to_descriptor(struct descriptor_data *t, struct iovec *iov, int iovcnt);
+static ssize_t descriptor_read(struct descriptor_data *t, char *read_point, size_t space_left);
+static int watch_socket(socket_t desc, struct descriptor_data *d);
+static int write_compressed(struct descriptor_data *t, struct iovec *iov, int iovcnt);
+static int send_compressed(struct descriptor_data *t);
+static void free_compression(struct descriptor_data *d);
+static void begin_compression(struct descriptor_data *t);
 static void nonblock(socket_t s);
 static int perform_subst(struct descriptor_data *t, char *orig, char *subst);
 static void record_usage(void);
@@ -159,6 +198,7 @@ static sigfunc *my_signal(int signo, sigfunc *func);
 #endif
 
 static void msdp_update(void); /* KaVir plugin*/
+static int msdp_players = 0;   /* descriptors msdp_update() sends MSDP for */
 
 /* externally defined functions, used locally */
 #ifdef __CXREF__
@@ -270,6 +310,16 @@ int main(int argc, char **argv)
 	exit(1);
       }
       break;
+    case 'j':
+      if (*(argv[pos] + 2))
+	CONFIG_BOOT_THREADS = atoi(argv[pos] + 2);
+      else if (++pos < argc)
+	CONFIG_BOOT_THREADS = atoi(argv[pos]);
+      else {
+	puts("SYSERR: Thread count expected after option -j.");
+	exit(1);
+      }
+      break;
     case 'm':
       mini_mud = 1;
       no_rent_check = 1;
@@ -291,19 +341,46 @@ int main(int argc, char **argv)
       no_specials = 1;
       puts("Suppressing assignment of special routines.");
       break;
+#ifdef DG_CORPUS
+    case 't':
+      if (*(argv[pos] + 2))
+	dg_corpus_file = argv[pos] + 2;
+      else if (++pos < argc)
+	dg_corpus_file = argv[pos];
+      else {
+	puts("SYSERR: Trigger file expected after option -t.");
+	exit(1);
+      }
+      scheck = 1;
+      break;
+#endif
+    case 'w':
+      no_world_image = 1;
+      puts("Ignoring the world image; world files will be parsed.");
+      break;
     case 'h':
       /* From: Anil Mahajan. Do NOT use -C, this is the copyover mode and
        * without the proper copyover.dat file, the game will go nuts! */
-      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-d pathname] [port #]\n"
+      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-w] [-d pathname] [-j threads]"
+#ifdef DG_CORPUS
+              " [-t file]"
+#endif
+              " [port #]\n"
               "  -c             Enable syntax check mode.\n"
               "  -d <directory> Specify library directory (defaults to 'lib').\n"
               "  -h             Print this command line argument help.\n"
+              "  -j <threads>   Parse world files on <threads> threads (0: one per CPU).\n"
               "  -m             Start in mini-MUD mode.\n"
 	      "  -f<file>       Use <file> for configuration.\n"
 	      "  -o <file>      Write log to <file> instead of stderr.\n"
               "  -q             Quick boot (doesn't scan save files for object limits)\n"
               "  -r             Restrict MUD -- no new players allowed.\n"
               "  -s             Suppress special procedure assignments.\n"
+#ifdef DG_CORPUS
+              "  -t <file>      Check the trigger engines agree on the world's triggers\n"
+              "                 and those in <file>, then exit (implies -c).\n"
+#endif
+              "  -w             Ignore the world image and rebuild it from the world files.\n"
               " Note:		These arguments are 'CaSe SeNsItIvE!!!'\n",
 		 argv[0]
       );
@@ -339,6 +416,12 @@ int main(int argc, char **argv)
   }
   log("Using %s as data directory.", dir);
 
+#ifdef DG_CORPUS
+  if (dg_corpus_file) {
+    boot_world();
+    exit(dg_corpus_run(dg_corpus_file) == 0 ? 0 : 1);
+  } else
+#endif
   if (scheck)
     boot_world();
   else {
@@ -444,6 +527,12 @@ void copyover_recover()
     d->next = descriptor_list;
     descriptor_list = d;
 
+    if (watch_socket(desc, d) < 0) {
+      write_to_descriptor (desc, "\n\rSorry, the game is full right now... please try again later!\n\r");
+      close_socket (d);
+      continue;
+    }
+
     d->connected = CON_CLOSE;
 
     CopyoverSet(d,guiopt);
@@ -470,10 +559,10 @@ void copyover_recover()
 
     /* Player file not found?! */
     if (!fOld) {
-      write_to_descriptor (desc, "\n\rSomehow, your character was lost in the copyover. Sorry.\n\r");
+      write_direct(d, "\n\rSomehow, your character was lost in the copyover. Sorry.\n\r");
       close_socket (d);
     } else {
-      write_to_descriptor (desc, "\n\rCopyover recovery complete.\n\r");
+      write_direct(d, "\n\rCopyover recovery complete.\n\r");
       GET_PREF(d->character) = pref;
     
       enter_player_game(d);
@@ -508,11 +597,29 @@ static void init_game(ush_int local_port)
      mother_desc = init_socket (local_port);
   }
 
+  poller_open(POLLER_DEFAULT);
+  log("Using %s() for socket polling.", poller_name());
+  if (poller_add_listener(mother_desc) < 0) {
+    perror("SYSERR: Fatal error polling mother connection");
+    exit(1);
+  }
+
+  if (CONFIG_NETWORK_THREAD) {
+    if (netio_start())
+      log("Doing socket reads and writes on the network thread.");
+    else
+      log("SYSERR: Couldn't start the network thread; doing socket I/O in the game loop.");
+  }
+
   event_init();
 
   /* set up hash table for find_char() */
   init_lookup_table();
 
+  save_writer_init();
+  if (!resolver_init(RESOLVER_THREADS, RESOLVER_TTL))
+    log("SYSERR: Couldn't start the resolver threads; looking up sites synchronously.");
+
   boot_db();
 
 #if defined(CIRCLE_UNIX) || defined(CIRCLE_MACINTOSH)
@@ -535,8 +642,10 @@ static void init_game(ush_int local_port)
   log("Closing all sockets.");
   while (descriptor_list)
     close_socket(descriptor_list);
+  stop_network_thread();
 
   CLOSE_SOCKET(mother_desc);
+  poller_close();
 
   if (circle_reboot != 2)
     save_all();
@@ -544,6 +653,9 @@ static void init_game(ush_int local_port)
   log("Saving current MUD time.");
   save_mud_time(&time_info);
 
+  save_writer_shutdown();
+  resolver_shutdown();
+
   if (circle_reboot) {
     log("Rebooting.");
     exit(52);			/* what's so great about HHGTTG, anyhow? */
@@ -733,19 +845,23 @@ static int get_max_players(void)
  * such as mobile_activity(). */
 void game_loop(socket_t local_mother_desc)
 {
-  fd_set input_set, output_set, exc_set, null_set;
+  struct poll_event *events;
   struct timeval last_time, opt_time, process_time, temp_time;
   struct timeval before_sleep, now, timeout;
   char comm[MAX_INPUT_LENGTH];
   struct descriptor_data *d, *next_d;
-  int missed_pulses, maxdesc, aliased;
+  int missed_pulses, aliased, num_events, max_events, i;
+  bool mother_ready;
 
   /* initialize various time values */
   null_time.tv_sec = 0;
   null_time.tv_usec = 0;
   opt_time.tv_usec = OPT_USEC;
   opt_time.tv_sec = 0;
-  FD_ZERO(&null_set);
+
+  /* one slot per player plus the mother socket */
+  max_events = max_players + 1;
+  CREATE(events, struct poll_event, max_events);
 
   gettimeofday(&last_time, (struct timezone *) 0);
 
@@ -755,9 +871,7 @@ void game_loop(socket_t local_mother_desc)
     /* Sleep if we don't have any connections */
     if (descriptor_list == NULL) {
       log("No connections.  Going to sleep.");
-      FD_ZERO(&input_set);
-      FD_SET(local_mother_desc, &input_set);
-      if (select(local_mother_desc + 1, &input_set, (fd_set *) 0, (fd_set *) 0, NULL) < 0) {
+      if (poller_wait(events, max_events, NULL) < 0) {
 	if (errno == EINTR)
 	  log("Waking up to process signal.");
 	else
@@ -766,23 +880,6 @@ void game_loop(socket_t local_mother_desc)
 	log("New connection.  Waking up.");
       gettimeofday(&last_time, (struct timezone *) 0);
     }
-    /* Set up the input, output, and exception sets for select(). */
-    FD_ZERO(&input_set);
-    FD_ZERO(&output_set);
-    FD_ZERO(&exc_set);
-    FD_SET(local_mother_desc, &input_set);
-
-    maxdesc = local_mother_desc;
-    for (d = descriptor_list; d; d = d->next) {
-#ifndef CIRCLE_WINDOWS
-      if (d->descriptor > maxdesc)
-	maxdesc = d->descriptor;
-#endif
-      FD_SET(d->descriptor, &input_set);
-      FD_SET(d->descriptor, &output_set);
-      FD_SET(d->descriptor, &exc_set);
-    }
-
     /* At this point, we have completed all input, output and heartbeat
      * activity from the previous iteration, so we have to put ourselves
      * to sleep until the next 0.1 second tick.  The first step is to
@@ -817,34 +914,50 @@ void game_loop(socket_t local_mother_desc)
       timediff(&timeout, &last_time, &now);
     } while (timeout.tv_usec || timeout.tv_sec);
 
-    /* Poll (without blocking) for new input, output, and exceptions */
-    if (select(maxdesc + 1, &input_set, &output_set, &exc_set, &null_time) < 0) {
+    /* Poll (without blocking) for new input, output, and exceptions. Only
+     * sockets whose state changed are reported, so readiness is kept in
+     * d->poll_ready until a read or write would block. */
+    if ((num_events = poller_wait(events, max_events, &null_time)) < 0) {
       perror("SYSERR: Select poll");
+      free(events);
       return;
     }
+    mother_ready = FALSE;
+    for (i = 0; i < num_events; i++) {
+      if (events[i].data == NULL)
+        mother_ready = TRUE;
+      else
+        ((struct descriptor_data *) events[i].data)->poll_ready |= events[i].ready;
+    }
+
+    /* The network thread's sockets are as ready as their rings. */
+    if (netio_running())
+      for (d = descriptor_list; d; d = d->next)
+        if (d->netio)
+          d->poll_ready = netio_ready(d->netio);
+
     /* If there are new connections waiting, accept them. */
-    if (FD_ISSET(local_mother_desc, &input_set))
+    if (mother_ready)
       new_descriptor(local_mother_desc);
 
     /* Kick out the freaky folks in the exception set and marked for close */
     for (d = descriptor_list; d; d = next_d) {
       next_d = d->next;
-      if (FD_ISSET(d->descriptor, &exc_set)) {
-        FD_CLR(d->descriptor, &input_set);
-	      FD_CLR(d->descriptor, &output_set);
+      if (d->poll_ready & POLL_EXCEPT)
 	      close_socket(d);
-      }
     }
 
     /* Process descriptors with input pending */
     for (d = descriptor_list; d; d = next_d) {
       next_d = d->next;
-      if (FD_ISSET(d->descriptor, &input_set))
+      if (d->poll_ready & POLL_READ)
        {
         if ( d->pProtocol != NULL )      /* KaVir's plugin */
           d->pProtocol->WriteOOB = 0;    /* KaVir's plugin */
-	      if (process_input(d) < 0)
+	      if ((i = process_input(d)) < 0)
 	        close_socket(d);
+	      else if (i == 0)		/* drained, wait for the next edge */
+	        d->poll_ready &= ~POLL_READ;
        }
     }
 
@@ -898,19 +1011,22 @@ void game_loop(socket_t local_mother_desc)
     /* Send queued output out to the operating system (ultimately to user). */
     for (d = descriptor_list; d; d = next_d) {
       next_d = d->next;
-      if (*(d->output) && FD_ISSET(d->descriptor, &output_set)) {
+      if ((d->output || COMPRESSED_PENDING(d)) && (d->poll_ready & POLL_WRITE)) {
 	/* Output for this player is ready */
 	if (process_output(d) < 0)
 	  close_socket(d);
-	else
+	else {
 	  d->has_prompt = 1;
+	  if (d->output || COMPRESSED_PENDING(d))	/* kernel buffer full, wait for the next edge */
+	    d->poll_ready &= ~POLL_WRITE;
+	}
       }
     }
 
     /* Print prompts for other descriptors who had no other output */
     for (d = descriptor_list; d; d = d->next) {
       if (!d->has_prompt) {
-	      write_to_descriptor(d->descriptor, make_prompt(d));
+	      write_direct(d, make_prompt(d));
 	      d->has_prompt = TRUE;
       }
     }
@@ -922,6 +1038,9 @@ void game_loop(socket_t local_mother_desc)
 	close_socket(d);
     }
 
+    /* Have the network thread send this pulse's output. */
+    netio_kick();
+
     /* Now, we execute as many pulses as necessary--just one if we haven't
      * missed any pulses, or make up for lost time if we missed a few
      * pulses by sleeping for too long. */
@@ -963,6 +1082,8 @@ void game_loop(socket_t local_mother_desc)
     tics_passed++;
 #endif
   }
+
+  free(events);
 }
 
 void heartbeat(int heart_pulse)
@@ -970,23 +1091,28 @@ void heartbeat(int heart_pulse)
   static int mins_since_crashsave = 0;
 
   event_process();
+  resolver_poll(host_resolved);
+
+#ifdef CHECK_ZONE_OCCUPANCY
+  check_zone_occupancy();
+#endif
 
   if (!(heart_pulse % PULSE_DG_SCRIPT))
     script_trigger_check();
 
   if (!(heart_pulse % PASSES_PER_SEC)) {    /* EVERY second */
     msdp_update();
+    save_writer_poll();
     next_tick--;
   }
 
-  if (!(heart_pulse % PULSE_ZONE))
-    zone_update();
+  dormancy_update(heart_pulse);
+  zone_update();
 
   if (!(heart_pulse % PULSE_IDLEPWD))		/* 15 seconds */
     check_idle_passwords();
 
-  if (!(heart_pulse % PULSE_MOBILE))
-    mobile_activity();
+  mobile_activity(heart_pulse);
 
   if (!(heart_pulse % PULSE_VIOLENCE))
     perform_violence();
@@ -1249,10 +1375,6 @@ static int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 /* Empty the queues before closing connection */
 static void flush_queues(struct descriptor_data *d)
 {
-  if (d->large_outbuf) {
-    d->large_outbuf->next = bufpool;
-    bufpool = d->large_outbuf;
-  }
   while (d->input.head) {
     struct txt_block *tmp = d->input.head;
     d->input.head = d->input.head->next;
@@ -1274,84 +1396,103 @@ size_t write_to_output(struct descriptor_data *t, const char *txt, ...)
   return left;
 }
 
+/* Appends len bytes to the descriptor's output chain, starting a new block
+ * from the pool when the last one is full. */
+static void output_append(struct descriptor_data *t, const char *txt, int len)
+{
+  struct out_block *blk;
+  int n;
+
+  while (len > 0) {
+    if (!(blk = t->output_tail) || blk->end == OUT_BLOCK_SIZE) {
+      if (out_pool) {
+        blk = out_pool;
+        out_pool = out_pool->next;
+      } else {
+        CREATE(blk, struct out_block, 1);
+        buf_largecount++;
+      }
+      blk->next = NULL;
+      blk->start = blk->end = 0;
+      if (t->output_tail)
+        t->output_tail->next = blk;
+      else
+        t->output = blk;
+      t->output_tail = blk;
+    }
+
+    n = MIN(len, OUT_BLOCK_SIZE - blk->end);
+    memcpy(blk->text + blk->end, txt, n);
+    blk->end += n;
+    txt += n;
+    len -= n;
+    t->output_len += n;
+    output_bytes_copied += n;
+  }
+}
+
+/* Hands the descriptor's output blocks back to the pool, sent or not. */
+static void release_output(struct descriptor_data *t)
+{
+  if (t->output) {
+    t->output_tail->next = out_pool;
+    out_pool = t->output;
+  }
+  t->output = t->output_tail = NULL;
+  t->output_len = 0;
+  t->output_overflow = FALSE;
+}
+
 /* Add a new string to a player's output queue. */
 size_t vwrite_to_output(struct descriptor_data *t, const char *format, va_list args)
 {
   const char *text_overflow = "\r\nOVERFLOW\r\n";
   static char txt[MAX_STRING_LENGTH];
-  size_t wantsize;
-  int size;
+  const char *out;
+  int size, wantsize;
+  bool truncated;
 
   /* if we're in the overflow state already, ignore this new output */
-  if (t->bufspace == 0)
+  if (t->output_overflow)
     return (0);
 
-  wantsize = size = vsnprintf(txt, sizeof(txt), format, args);
-
-  strcpy(txt, ProtocolOutput( t, txt, (int*)&wantsize )); /* <--- Add this line */
-  size = wantsize;                    /* <--- Add this line */
-  if ( t->pProtocol->WriteOOB > 0 )   /* <--- Add this line */
-    --t->pProtocol->WriteOOB;         /* <--- Add this line */
-
-  /* If exceeding the size of the buffer, truncate it for the overflow message */
-  if (size < 0 || wantsize >= sizeof(txt)) {
-    size = sizeof(txt) - 1;
-    strcpy(txt + size - strlen(text_overflow), text_overflow);	/* strcpy: OK */
-  }
-
-  /* If the text is too big to fit into even a large buffer, truncate
-   * the new text to make it fit.  (This will switch to the overflow
-   * state automatically because t->bufspace will end up 0.) */
-  if (size + t->bufptr + 1 > LARGE_BUFSIZE) {
-    size = LARGE_BUFSIZE - t->bufptr - 1;
-    txt[size] = '\0';
+  size = vsnprintf(txt, sizeof(txt), format, args);
+  truncated = (size < 0 || size >= (int)sizeof(txt));
+  if (size < 0)
+    *txt = '\0';
+  wantsize = MIN(MAX(size, 0), (int)sizeof(txt) - 1);
+
+  out = ProtocolOutput(t, txt, &wantsize);
+  size = wantsize;
+  if ( t->pProtocol->WriteOOB > 0 )
+    --t->pProtocol->WriteOOB;
+
+  /* If the text is too big to fit in what is left of the queue, truncate
+   * it to fit and go into the overflow state. */
+  if (size + t->output_len + 1 > LARGE_BUFSIZE) {
+    size = LARGE_BUFSIZE - t->output_len - 1;
+    t->output_overflow = TRUE;
     buf_overflows++;
   }
 
-  /* If we have enough space, just write to buffer and that's it! If the
-   * text just barely fits, then it's switched to a large buffer instead. */
-  if (t->bufspace > size) {
-    strcpy(t->output + t->bufptr, txt);	/* strcpy: OK (size checked above) */
-    t->bufspace -= size;
-    t->bufptr += size;
-    return (t->bufspace);
-  }
-
-  buf_switches++;
-
-  /* if the pool has a buffer in it, grab it */
-  if (bufpool != NULL) {
-    t->large_outbuf = bufpool;
-    bufpool = bufpool->next;
-  } else {			/* else create a new one */
-    CREATE(t->large_outbuf, struct txt_block, 1);
-    CREATE(t->large_outbuf->text, char, LARGE_BUFSIZE);
-    buf_largecount++;
-  }
-
-  strcpy(t->large_outbuf->text, t->output);	/* strcpy: OK (size checked previously) */
-  t->output = t->large_outbuf->text;	/* make big buffer primary */
-  strcat(t->output, txt);	/* strcat: OK (size checked) */
-
-  /* set the pointer for the next write */
-  t->bufptr = strlen(t->output);
+  output_append(t, out, size);
 
-  /* calculate how much space is left in the buffer */
-  t->bufspace = LARGE_BUFSIZE - 1 - t->bufptr;
+  /* Text that was too long to format is cut short with a warning. */
+  if (truncated && !t->output_overflow &&
+      t->output_len + strlen(text_overflow) + 1 <= LARGE_BUFSIZE)
+    output_append(t, text_overflow, strlen(text_overflow));
 
-  return (t->bufspace);
+  return (t->output_overflow ? 0 : LARGE_BUFSIZE - 1 - t->output_len);
 }
 
 static void free_bufpool(void)
 {
-  struct txt_block *tmp;
+  struct out_block *tmp;
 
-  while (bufpool) {
-    tmp = bufpool->next;
-    if (bufpool->text)
-      free(bufpool->text);
-    free(bufpool);
-    bufpool = tmp;
+  while (out_pool) {
+    tmp = out_pool->next;
+    free(out_pool);
+    out_pool = tmp;
   }
 }
 
@@ -1444,11 +1585,10 @@ static void init_descriptor (struct descriptor_data *newd, int desc)
 
   newd->descriptor = desc;
   newd->idle_tics = 0;
-  newd->output = newd->small_outbuf;
-  newd->bufspace = SMALL_BUFSIZE - 1;
+  newd->output = newd->output_tail = NULL;
+  newd->output_len = 0;
+  newd->output_overflow = FALSE;
   newd->login_time = time(0);
-  *newd->output = '\0';
-  newd->bufptr = 0;
   newd->has_prompt = 1;  /* prompt is part of greetings */
   STATE(newd) = CONFIG_PROTOCOL_NEGOTIATION ? CON_GET_PROTOCOL : CON_GET_CONNECT;
   CREATE(newd->history, char *, HISTORY_SIZE);
@@ -1461,6 +1601,29 @@ static void init_descriptor (struct descriptor_data *newd, int desc)
   
 }
 
+/* Have the network thread look after d's socket if it is running, else
+ * the poller.  Returns -1 if neither can. */
+static int watch_socket(socket_t desc, struct descriptor_data *d)
+{
+  if (netio_running())
+    return ((d->netio = netio_attach(desc)) ? 0 : -1);
+  return (poller_add(desc, d));
+}
+
+/* Take every socket back from the network thread, once it has sent what it
+ * was given, so they can be written to directly and handed over at a
+ * copyover. */
+void stop_network_thread(void)
+{
+  struct descriptor_data *d;
+
+  if (!netio_running())
+    return;
+  netio_stop();
+  for (d = descriptor_list; d; d = d->next)
+    d->netio = NULL;
+}
+
 static int new_descriptor(socket_t s)
 {
   socket_t desc;
@@ -1469,7 +1632,8 @@ static int new_descriptor(socket_t s)
   socklen_t i;
   struct descriptor_data *newd;
   struct sockaddr_in peer;
-  struct hostent *from;
+  char name[HOST_LENGTH + 1];
+  int known = RESOLVE_NO_NAME;
   
   /* accept the new connection */
   i = sizeof(peer);
@@ -1498,22 +1662,14 @@ static int new_descriptor(socket_t s)
   /* create a new descriptor */
   CREATE(newd, struct descriptor_data, 1);
 
-  /* find the sitename */
-  if (CONFIG_NS_IS_SLOW ||
-      !(from = gethostbyaddr((char *) &peer.sin_addr,
-		             sizeof(peer.sin_addr), AF_INET))) {
-
-    /* resolution failed */
-    if (!CONFIG_NS_IS_SLOW)
-      perror("SYSERR: gethostbyaddr");
-
-    /* find the numeric site address */
-    strncpy(newd->host, (char *)inet_ntoa(peer.sin_addr), HOST_LENGTH);	/* strncpy: OK (n->host:HOST_LENGTH+1) */
-    *(newd->host + HOST_LENGTH) = '\0';
-  } else {
-    strncpy(newd->host, from->h_name, HOST_LENGTH);	/* strncpy: OK (n->host:HOST_LENGTH+1) */
-    *(newd->host + HOST_LENGTH) = '\0';
-  }
+  /* find the sitename: the name if the resolver already knows it, else the
+   * numeric address until host_resolved() gets the name */
+  if (!CONFIG_NS_IS_SLOW)
+    known = resolver_cached(peer.sin_addr, name, sizeof(name));
+  if (known == RESOLVE_FOUND)
+    strlcpy(newd->host, name, sizeof(newd->host));
+  else
+    strlcpy(newd->host, inet_ntoa(peer.sin_addr), sizeof(newd->host));
 
   /* determine if the site is banned */
   if (isbanned(newd->host) == BAN_ALL) {
@@ -1523,9 +1679,20 @@ static int new_descriptor(socket_t s)
     return (0);
   }
 
+  /* make sure the poller or the network thread can watch it */
+  if (watch_socket(desc, newd) < 0) {
+    write_to_descriptor(desc, "Sorry, the game is full right now... please try again later!\r\n");
+    CLOSE_SOCKET(desc);
+    free(newd);
+    return (0);
+  }
+
   /* initialize descriptor data */
   init_descriptor(newd, desc);
 
+  if (known == RESOLVE_MISS)
+    resolver_request(peer.sin_addr, newd->desc_num);
+
   /* prepend to list */
   newd->next = descriptor_list;
   descriptor_list = newd;
@@ -1543,88 +1710,154 @@ static int new_descriptor(socket_t s)
   return (0);
 }
 
-/* Send all of the output that we've accumulated for a player out to the
- * player's descriptor. 32 byte GARBAGE_SPACE in MAX_SOCK_BUF used for:
- *	 2 bytes: prepended \r\n
- *	14 bytes: overflow message
- *	 2 bytes: extra \r\n for non-comapct
- *      14 bytes: unused */
-static int process_output(struct descriptor_data *t)
+/* The resolver found the name of a site, or found that it has none.  key is
+ * the desc_num of the connection that asked, which may have closed since, or
+ * even have been reused: it only counts while the host is still the numeric
+ * address.  The ban check done on the address is done again on the name. */
+static void host_resolved(long key, struct in_addr addr, const char *name)
 {
-  char i[MAX_SOCK_BUF], *osb = i + 2;
-  int result;
+  struct descriptor_data *d;
+  const char *numeric = inet_ntoa(addr);
 
-  /* we may need this \r\n for later -- see below */
-  strcpy(i, "\r\n");	/* strcpy: OK (for 'MAX_SOCK_BUF >= 3') */
+  if (!name)
+    return;
 
-  /* now, append the 'real' output */
-  strcpy(osb, t->output);	/* strcpy: OK (t->output:LARGE_BUFSIZE < osb:MAX_SOCK_BUF-2) */
+  for (d = descriptor_list; d; d = d->next)
+    if (d->desc_num == key && !strcmp(d->host, numeric))
+      break;
+  if (!d)
+    return;
 
-  /* if we're in the overflow state, notify the user */
-  if (t->bufspace == 0)
-    strcat(osb, "**OVERFLOW**\r\n");	/* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space) */
+  strlcpy(d->host, name, sizeof(d->host));
+  if (isbanned(d->host) == BAN_ALL) {
+    mudlog(CMP, LVL_GOD, TRUE, "Connection from [%s] (%s) denied once resolved", d->host, numeric);
+    STATE(d) = CON_CLOSE;
+  }
+}
 
-  /* add the extra CRLF if the person isn't in compact mode */
-  if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) && !PRF_FLAGGED(t->character, PRF_COMPACT))
-    if ( !t->pProtocol->WriteOOB ) 
-      strcat(osb, "\r\n");	/* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space) */
+/* Pieces one process_output() call can send: the output blocks, of which
+ * there can be two more than LARGE_BUFSIZE fills as the first and last may
+ * be partly used, plus the leading CRLF, the overflow notice, the trailing
+ * CRLF and the prompt. */
+#define OUTPUT_IOVECS (LARGE_BUFSIZE / OUT_BLOCK_SIZE + 2 + 4)
 
-  if (!t->pProtocol->WriteOOB) /* add a prompt */
-    strcat(i, make_prompt(t));	/* strcpy: OK (i:MAX_SOCK_BUF reserves space) */
+/* Send all of the output that we've accumulated for a player out to the
+ * player's descriptor.  The blocks go out as they are, with the CRLF that
+ * breaks a prompt, the overflow notice, the extra CRLF for non-compact mode
+ * and the new prompt as pieces of their own around them, in one writev().
+ * Sent blocks go back to the pool; a partly sent one just moves its start.
+ * Whatever of the pieces after the output didn't fit is queued as output. */
+static int process_output(struct descriptor_data *t)
+{
+  struct iovec iov[OUTPUT_IOVECS], sending[OUTPUT_IOVECS];
+  struct out_block *blk;
+  char *prompt;
+  int iovcnt = 0, prefix = 0, first_extra, i, result, left, n;
+  bool all_blocks = TRUE;
+
+  /* Compressed output the socket wouldn't take last time goes first. */
+  if (COMPRESSED_PENDING(t)) {
+    if ((result = send_compressed(t)) < 0)
+      return (-1);
+    if (COMPRESSED_PENDING(t) || !t->output)
+      return (result);
+  }
 
-  /* now, send the output.  If this is an 'interruption', use the prepended
-   * CRLF, otherwise send the straight output sans CRLF. */
+  /* If this is an 'interruption', break the prompt line with a CRLF first. */
   if (t->has_prompt && !t->pProtocol->WriteOOB) {
     t->has_prompt = FALSE;
-    result = write_to_descriptor(t->descriptor, i);
-    if (result >= 2)
-      result -= 2;
-  } else
-    result = write_to_descriptor(t->descriptor, osb);
+    iov[iovcnt].iov_base = (char *)"\r\n";
+    iov[iovcnt++].iov_len = 2;
+    prefix = 2;
+  }
+
+  for (blk = t->output; blk; blk = blk->next) {
+    if (iovcnt == OUTPUT_IOVECS - 3) {
+      all_blocks = FALSE;
+      break;
+    }
+    iov[iovcnt].iov_base = blk->text + blk->start;
+    iov[iovcnt++].iov_len = blk->end - blk->start;
+  }
+  first_extra = iovcnt;
+
+  /* The notices and prompt only go after the last of the output. */
+  if (all_blocks) {
+    /* if we're in the overflow state, notify the user */
+    if (t->output_overflow) {
+      iov[iovcnt].iov_base = (char *)"**OVERFLOW**\r\n";
+      iov[iovcnt++].iov_len = 14;
+    }
+
+    /* add the extra CRLF if the person isn't in compact mode */
+    if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) &&
+        !PRF_FLAGGED(t->character, PRF_COMPACT) && !t->pProtocol->WriteOOB) {
+      iov[iovcnt].iov_base = (char *)"\r\n";
+      iov[iovcnt++].iov_len = 2;
+    }
 
-  if (result < 0) {	/* Oops, fatal error. Bye! */
-//    close_socket(t); // close_socket is called after return of negative result
+    if (!t->pProtocol->WriteOOB) {	/* add a prompt */
+      prompt = make_prompt(t);
+      iov[iovcnt].iov_base = prompt;
+      iov[iovcnt++].iov_len = strlen(prompt);
+    }
+  }
+
+  memcpy(sending, iov, iovcnt * sizeof(struct iovec));
+  if (t->mccp && mccp_started(t->mccp))
+    result = write_compressed(t, sending, iovcnt);
+  else
+    result = write_iov_to_descriptor(t, sending, iovcnt);
+
+  if (result < 0)	/* Oops, fatal error. Bye! */
     return (-1);
-  } else if (result == 0)	/* Socket buffer full. Try later. */
+  else if (result == 0)	/* Socket buffer full. Try later. */
     return (0);
 
+  left = MAX(0, result - prefix);
+
   /* Handle snooping: prepend "% " and send to snooper. */
-  if (t->snoop_by)
-    write_to_output(t->snoop_by, "%% %*s%%%%", result, t->output);
-
-  /* The common case: all saved output was handed off to the kernel buffer. */
-  if (result >= t->bufptr) {
-    /* If we were using a large buffer, put the large buffer on the buffer pool
-     * and switch back to the small one. */
-    if (t->large_outbuf) {
-      t->large_outbuf->next = bufpool;
-      bufpool = t->large_outbuf;
-      t->large_outbuf = NULL;
-      t->output = t->small_outbuf;
-    }
-    /* reset total bufspace back to that of a small buffer */
-    t->bufspace = SMALL_BUFSIZE - 1;
-    t->bufptr = 0;
-    *(t->output) = '\0';
-
-    /* If the overflow message or prompt were partially written, try to save
-     * them. There will be enough space for them if this is true.  'result'
-     * is effectively unsigned here anyway. */
-    if ((unsigned int)result < strlen(osb)) {
-      size_t savetextlen = strlen(osb + result);
-
-      strcat(t->output, osb + result);
-      t->bufptr   -= savetextlen;
-      t->bufspace += savetextlen;
+  if (t->snoop_by) {
+    write_to_output(t->snoop_by, "%% ");
+    for (blk = t->output, n = left; blk && n > 0; blk = blk->next) {
+      write_to_output(t->snoop_by, "%.*s", MIN(n, blk->end - blk->start), blk->text + blk->start);
+      n -= blk->end - blk->start;
     }
+    write_to_output(t->snoop_by, "%%%%");
+  }
 
-  } else {
-    /* Not all data in buffer sent.  result < output buffersize. */
-    strcpy(t->output, t->output + result);	/* strcpy: OK (overlap) */
-    t->bufptr   -= result;
-    t->bufspace += result;
+  /* Use up the blocks that went out, and any part of the next. */
+  while (left > 0 && (blk = t->output)) {
+    n = MIN(left, blk->end - blk->start);
+    blk->start += n;
+    left -= n;
+    t->output_len -= n;
+    output_bytes_sent += n;
+    if (blk->start < blk->end)
+      break;
+    t->output = blk->next;
+    blk->next = out_pool;
+    out_pool = blk;
+  }
+
+  /* The common case: all saved output was handed off to the kernel buffer.
+   * If the overflow message or prompt were partially written, save the rest
+   * of them as the new output. */
+  if (!t->output) {
+    t->output_tail = NULL;
+    t->output_overflow = FALSE;
+    for (i = first_extra; i < iovcnt; i++) {
+      n = MIN(left, (int)iov[i].iov_len);
+      left -= n;
+      if (n < (int)iov[i].iov_len)
+        output_append(t, (char *)iov[i].iov_base + n, iov[i].iov_len - n);
+    }
   }
 
+  /* A compressed stream the client asked for starts once the text queued
+   * ahead of it has gone out as it was. */
+  begin_compression(t);
+
   return (result);
 }
 
@@ -1744,6 +1977,227 @@ int write_to_descriptor(socket_t desc, const char *txt)
   return (write_total);
 }
 
+/* perform_socket_writev: as perform_socket_write, for text in several
+ * pieces.  Platforms without writev() get the pieces one at a time. */
+static ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int iovcnt)
+{
+#if defined(CIRCLE_WINDOWS) || !defined(HAVE_SYS_UIO_H)
+  ssize_t result, total = 0;
+  int i;
+
+  for (i = 0; i < iovcnt; i++) {
+    result = perform_socket_write(desc, iov[i].iov_base, iov[i].iov_len);
+    if (result < 0)
+      return (total ? total : -1);
+    total += result;
+    if ((size_t)result < iov[i].iov_len)
+      break;
+  }
+  return (total);
+#else
+  ssize_t result;
+
+  result = writev(desc, iov, iovcnt);
+
+  if (result > 0)
+    return (result);
+
+  if (result == 0) {
+    log("SYSERR: Huh??  writev() returned 0???  Please report this!");
+    return (-1);
+  }
+
+#ifdef EAGAIN		/* POSIX */
+  if (errno == EAGAIN)
+    return (0);
+#endif
+
+#ifdef EWOULDBLOCK	/* BSD */
+  if (errno == EWOULDBLOCK)
+    return (0);
+#endif
+
+  return (-1);
+#endif
+}
+
+/* write_iov_to_descriptor: as write_to_descriptor, for text in pieces, to
+ * t's socket or, if the network thread has it, t's output ring.  The iovecs
+ * are used up as they are written.  Returns the bytes written, or -1 if the
+ * player should be cut off. */
+static int write_iov_to_descriptor(struct descriptor_data *t, struct iovec *iov, int iovcnt)
+{
+  ssize_t bytes_written;
+  size_t write_total = 0;
+
+  for (;;) {
+    /* Empty pieces, such as the prompt before login, have nothing to send. */
+    for (; iovcnt > 0 && !iov->iov_len; iov++, iovcnt--)
+      ;
+    if (!iovcnt)
+      break;
+
+    if (t->netio)
+      bytes_written = netio_writev(t->netio, iov, iovcnt);
+    else
+      bytes_written = perform_socket_writev(t->descriptor, iov, iovcnt);
+
+    if (bytes_written < 0) {
+      /* Fatal error.  Disconnect the player. */
+      perror("SYSERR: Write to socket");
+      return (-1);
+    } else if (bytes_written == 0) {
+      /* Temporary failure -- socket buffer full. */
+      return (write_total);
+    }
+
+    write_total += bytes_written;
+    for (; iovcnt > 0 && (size_t)bytes_written >= iov->iov_len; iov++, iovcnt--)
+      bytes_written -= iov->iov_len;
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + bytes_written;
+      iov->iov_len -= bytes_written;
+    }
+  }
+
+  return (write_total);
+}
+
+/* Hand compressed output to the socket until it is all gone or the socket
+ * is full; what's left is sent by the next process_output().  Returns the
+ * bytes written, or -1 if the player should be cut off. */
+static int send_compressed(struct descriptor_data *t)
+{
+  struct iovec iov;
+  const char *data;
+  size_t len;
+  ssize_t bytes_written;
+  int write_total = 0;
+
+  while ((len = mccp_pending(t->mccp, &data)) > 0) {
+    if (t->netio) {
+      iov.iov_base = (char *)data;
+      iov.iov_len = len;
+      bytes_written = netio_writev(t->netio, &iov, 1);
+    } else
+      bytes_written = perform_socket_write(t->descriptor, data, len);
+
+    if (bytes_written < 0) {
+      perror("SYSERR: Write to socket");
+      return (-1);
+    } else if (bytes_written == 0)
+      break;
+    mccp_consume(t->mccp, bytes_written);
+    write_total += bytes_written;
+  }
+  return (write_total);
+}
+
+/* write_iov_to_descriptor for a client with MCCP on.  All of the text is
+ * compressed, with a flush at the end so the client can show it at once,
+ * so all of it counts as sent even if the compressed bytes don't all fit
+ * in the socket yet.  Returns the bytes of text taken, or -1. */
+static int write_compressed(struct descriptor_data *t, struct iovec *iov, int iovcnt)
+{
+  int i, total = 0;
+
+  for (i = 0; i < iovcnt; i++) {
+    if (!mccp_compress(t->mccp, iov[i].iov_base, iov[i].iov_len))
+      return (-1);
+    total += iov[i].iov_len;
+  }
+  if (!mccp_flush(t->mccp) || send_compressed(t) < 0)
+    return (-1);
+  return (total);
+}
+
+/* Write txt to d at once, outside the output queue: compressed if d has
+ * MCCP on, else as write_to_descriptor() does. */
+int write_direct(struct descriptor_data *d, const char *txt)
+{
+  struct iovec iov;
+
+  begin_compression(d);
+  iov.iov_base = (char *)txt;
+  iov.iov_len = strlen(txt);
+  if (!d->mccp || !mccp_started(d->mccp))
+    return (write_iov_to_descriptor(d, &iov, 1));
+  return (write_compressed(d, &iov, 1));
+}
+
+/* Start the compressed stream if the client has asked for one and no text
+ * meant to go out before it is still queued. */
+static void begin_compression(struct descriptor_data *t)
+{
+  if (t->mccp && !mccp_started(t->mccp) && !t->output && !mccp_begin(t->mccp)) {
+    log("SYSERR: Couldn't start MCCP for %s.", t->host);
+    mccp_free(t->mccp);
+    t->mccp = NULL;
+  }
+}
+
+/* The client said DO COMPRESS2: compress what it is sent from here on. */
+void start_compression(struct descriptor_data *d)
+{
+  if (!d->mccp)
+    d->mccp = mccp_create();
+  begin_compression(d);
+}
+
+/* Send all of d's compressed output, waiting a little for the socket (or
+ * the network thread) to make room whenever it is full.  Returns FALSE if
+ * it couldn't all be sent. */
+static bool drain_compressed(struct descriptor_data *d)
+{
+  struct timeval wait;
+  int tries;
+
+  for (tries = 0; tries < MCCP_DRAIN_TRIES; tries++) {
+    if (send_compressed(d) < 0)
+      return (FALSE);
+    if (!COMPRESSED_PENDING(d))
+      return (TRUE);
+    netio_kick();
+    wait.tv_sec = 0;
+    wait.tv_usec = MCCP_DRAIN_WAIT;
+    circle_sleep(&wait);
+  }
+  return (FALSE);
+}
+
+static void free_compression(struct descriptor_data *d)
+{
+  unsigned long in, out;
+
+  if (!d->mccp)
+    return;
+  mccp_totals(d->mccp, &in, &out);
+  mccp_bytes_in += in;
+  mccp_bytes_out += out;
+  mccp_free(d->mccp);
+  d->mccp = NULL;
+}
+
+/* Stop compressing what d is sent, because it said DONT COMPRESS2, or is
+ * going away, or is about to be handed over at a copyover.  The end of the
+ * stream must reach the client before any plain text does, so if the socket
+ * won't take it all the stream is left in place, where it refuses any more
+ * text, and the client is cut off. */
+void end_compression(struct descriptor_data *d)
+{
+  if (!d->mccp)
+    return;
+
+  if (mccp_started(d->mccp)) {
+    mccp_finish(d->mccp);	/* FALSE if an earlier try already ended it */
+    if (!drain_compressed(d)) {
+      STATE(d) = CON_CLOSE;
+      return;
+    }
+  }
+  free_compression(d);
+}
+
 /* Same information about perform_socket_write applies here. I like
  * standards, there are so many of them. -gg 6/30/98 */
 static ssize_t perform_socket_read(socket_t desc, char *read_point, size_t space_left)
@@ -1807,6 +2261,20 @@ static ssize_t perform_socket_read(socket_t desc, char *read_point, size_t space
   return (-1);
 }
 
+/* perform_socket_read for t, from its input ring if the network thread has
+ * its socket. */
+static ssize_t descriptor_read(struct descriptor_data *t, char *read_point, size_t space_left)
+{
+  ssize_t ret;
+
+  if (!t->netio)
+    return (perform_socket_read(t->descriptor, read_point, space_left));
+
+  if ((ret = netio_read(t->netio, read_point, space_left)) < 0)
+    log("WARNING: EOF on socket read (connection broken by peer)");
+  return (ret);
+}
+
 /* ASSUMPTION: There will be no newlines in the raw input buffer when this
  * function is called.  We must maintain that before returning.
  *
@@ -1822,12 +2290,12 @@ static int process_input(struct descriptor_data *t)
   int buf_length, failed_subst;
   ssize_t bytes_read;
   size_t space_left;
-  char *ptr, *read_point, *write_point, *nl_pos = NULL;
+  char *ptr, *read_point, *end, *nl_pos = NULL;
   char tmp[MAX_INPUT_LENGTH];
   static char read_buf[MAX_PROTOCOL_BUFFER] = { '\0' }; /* KaVir's plugin */
   
   /* first, find the point where we left off reading data */
-  buf_length = strlen(t->inbuf);
+  buf_length = t->inbuf_len;
   read_point = t->inbuf + buf_length;
   space_left = MAX_RAW_INPUT_LENGTH - buf_length - 1;
 
@@ -1839,13 +2307,19 @@ static int process_input(struct descriptor_data *t)
 
     /* Read # of "bytes_read" from socket, and if we have something, mark the sizeof data
      * in the read_buf array as NULL */
-    if ((bytes_read = perform_socket_read(t->descriptor, read_buf, space_left)) > 0)
+    if ((bytes_read = descriptor_read(t, read_buf, space_left)) > 0)
       read_buf[bytes_read] = '\0';
 
     /* Since we have recieved atleast 1 byte of data from the socket, lets run it through
      * ProtocolInput() and rip out anything that is Out Of Band */ 
-    if ( bytes_read > 0 )
-      bytes_read = ProtocolInput( t, read_buf, bytes_read, t->inbuf );
+    if ( bytes_read > 0 ) {
+      bytes_read = ProtocolInput( t, read_buf, bytes_read, read_point );
+
+      /* Nothing but telnet negotiation; keep reading until the socket would
+       * block, since an edge-triggered poller won't report it again. */
+      if ( bytes_read == 0 )
+        continue;
+    }
 
     if (bytes_read < 0)	/* Error, disconnect them. */
       return (-1);
@@ -1856,12 +2330,12 @@ static int process_input(struct descriptor_data *t)
     *(read_point + bytes_read) = '\0';	/* terminate the string */
 
     /* search for a newline in the data we just read */
-    for (ptr = read_point; *ptr && !nl_pos; ptr++)
-      if (ISNEWL(*ptr))
-	      nl_pos = ptr;
+    if ((ptr = read_point + scan_newline(read_point, bytes_read)) < read_point + bytes_read)
+      nl_pos = ptr;
 
     read_point += bytes_read;
     space_left -= bytes_read;
+    t->inbuf_len += bytes_read;
 
 /* on some systems such as AIX, POSIX-standard nonblocking I/O is broken,
  * causing the MUD to hang when it encounters input not terminated by a
@@ -1884,37 +2358,17 @@ static int process_input(struct descriptor_data *t)
    * can copy the formatted data to a new array for further processing. */
 
   read_point = t->inbuf;
+  end = t->inbuf + t->inbuf_len;
 
   while (nl_pos != NULL) {
-    write_point = tmp;
     space_left = MAX_INPUT_LENGTH - 1;
-
-    /* The '> 1' reserves room for a '$ => $$' expansion. */
-    for (ptr = read_point; (space_left > 1) && (ptr < nl_pos); ptr++) {
-      if (*ptr == '\b' || *ptr == 127) { /* handle backspacing or delete key */
-	if (write_point > tmp) {
-	  if (*(--write_point) == '$') {
-	    write_point--;
-	    space_left += 2;
-	  } else
-	    space_left++;
-	}
-      } else if (isascii(*ptr) && isprint(*ptr)) {
-	if ((*(write_point++) = *ptr) == '$') {		/* copy one character */
-	  *(write_point++) = '$';	/* if it's a $, double it */
-	  space_left -= 2;
-	} else
-	  space_left--;
-      }
-    }
-
-    *write_point = '\0';
+    ptr = (char *)input_copy_line(read_point, nl_pos, tmp, &space_left);
 
     if ((space_left <= 0) && (ptr < nl_pos)) {
       char buffer[MAX_INPUT_LENGTH + 64];
 
       snprintf(buffer, sizeof(buffer), "Line too long.  Truncated to:\r\n%s\r\n", tmp);
-      if (write_to_descriptor(t->descriptor, buffer) < 0)
+      if (write_direct(t, buffer) < 0)
 	return (-1);
     }
     if (t->snoop_by)
@@ -1967,17 +2421,14 @@ static int process_input(struct descriptor_data *t)
       nl_pos++;
 
     /* see if there's another newline in the input buffer */
-    read_point = ptr = nl_pos;
-    for (nl_pos = NULL; *ptr && !nl_pos; ptr++)
-      if (ISNEWL(*ptr))
-	nl_pos = ptr;
+    read_point = nl_pos;
+    if ((nl_pos = read_point + scan_newline(read_point, end - read_point)) == end)
+      nl_pos = NULL;
   }
 
   /* now move the rest of the buffer up to the beginning for the next pass */
-  write_point = t->inbuf;
-  while (*read_point)
-    *(write_point++) = *(read_point++);
-  *write_point = '\0';
+  t->inbuf_len = end - read_point;
+  memmove(t->inbuf, read_point, t->inbuf_len + 1);
 
   return (1);
 }
@@ -2035,8 +2486,18 @@ void close_socket(struct descriptor_data *d)
   struct descriptor_data *temp;
 
   REMOVE_FROM_LIST(d, descriptor_list, next);
-  CLOSE_SOCKET(d->descriptor);
+  if (d->msdp_char)
+    msdp_players--;
+  end_compression(d);
+  free_compression(d);	/* if the end of the stream didn't all go */
+  if (d->netio)		/* the network thread closes it */
+    netio_detach(d->netio);
+  else {
+    poller_remove(d->descriptor);
+    CLOSE_SOCKET(d->descriptor);
+  }
   flush_queues(d);
+  release_output(d);
 
   /* Forget snooping */
   if (d->snooping)
@@ -2049,7 +2510,7 @@ void close_socket(struct descriptor_data *d)
 
   if (d->character) {
     /* If we're switched, this resets the mobile taken. */
-    d->character->desc = NULL;
+    set_char_desc(d->character, NULL);
 
     /* Plug memory leak, from Eric Green. */
     if (!IS_NPC(d->character) && PLR_FLAGGED(d->character, PLR_MAILING) && d->str) {
@@ -2080,7 +2541,7 @@ void close_socket(struct descriptor_data *d)
 
   /* JE 2/22/95 -- part of my unending quest to make switch stable */
   if (d->original && d->original->desc)
-    d->original->desc = NULL;
+    set_char_desc(d->original, NULL);
 
   /* Clear the command history. */
   if (d->history) {
@@ -2765,63 +3226,108 @@ static void circle_sleep(struct timeval *timeout)
 #endif /* CIRCLE_WINDOWS */
 
 /* KaVir's plugin*/
+/** Note that something MSDP reports about ch has changed, so the next
+ * msdp_update() sends it.  Cheap enough to call wherever it changes.
+ * @param ch The character whose stats changed.
+ * @param what The MSDP_DIRTY_xxx bits for what changed. */
+void msdp_changed(struct char_data *ch, int what)
+{
+  if (ch && ch->desc)
+    ch->desc->msdp_dirty |= what;
+}
+
+/* Once a second, refresh the MSDP variables of whatever msdp_changed() said
+ * has changed and send the ones that differ.  A player who has just come
+ * into the game (or out of OLC, or back from a switch) has everything sent;
+ * a fight is refreshed every time, for the opponent's health. */
 static void msdp_update( void )
 {
   struct descriptor_data *d;
-  int PlayerCount = 0;
+  static int players_sent = -1;
   char buf[MAX_STRING_LENGTH];
   extern const char *pc_class_types[];
 
   for (d = descriptor_list; d; d = d->next)
   {
     struct char_data *ch = d->character;
-    if ( ch && !IS_NPC(ch) && d->connected == CON_PLAYING )
+
+    if ( !ch || IS_NPC(ch) || d->connected != CON_PLAYING )
+      ch = NULL;
+
+    if ( ch != d->msdp_char )
     {
-      struct char_data *pOpponent = FIGHTING(ch);
-      ++PlayerCount;
-
-      MSDPSetString( d, eMSDP_CHARACTER_NAME, GET_NAME(ch) );
-      MSDPSetNumber( d, eMSDP_ALIGNMENT, GET_ALIGNMENT(ch) );
-      MSDPSetNumber( d, eMSDP_EXPERIENCE, GET_EXP(ch) );
-
-      MSDPSetNumber( d, eMSDP_HEALTH, GET_HIT(ch) );
-      MSDPSetNumber( d, eMSDP_HEALTH_MAX, GET_MAX_HIT(ch) );
-      MSDPSetNumber( d, eMSDP_LEVEL, GET_LEVEL(ch) );
-
-      sprinttype( ch->player.chclass, pc_class_types, buf, sizeof(buf) );
-      MSDPSetString( d, eMSDP_CLASS, buf );
-
-      MSDPSetNumber( d, eMSDP_MANA, GET_MANA(ch) );
-      MSDPSetNumber( d, eMSDP_MANA_MAX, GET_MAX_MANA(ch) );
-      MSDPSetNumber( d, eMSDP_WIMPY, GET_WIMP_LEV(ch) );
-      MSDPSetNumber( d, eMSDP_MONEY, GET_COINS(ch) );
-      MSDPSetNumber( d, eMSDP_MOVEMENT, GET_STAMINA(ch) );
-      MSDPSetNumber( d, eMSDP_MOVEMENT_MAX, GET_MAX_STAMINA(ch) );
-      MSDPSetNumber( d, eMSDP_AC, compute_armor_class(ch) );
-
-      /* This would be better moved elsewhere */
-      if ( pOpponent != NULL )
+      msdp_players += (ch != NULL) - (d->msdp_char != NULL);
+      d->msdp_char = ch;
+      d->msdp_dirty = MSDP_DIRTY_ALL;
+    }
+
+    if ( ch == NULL )
+      continue;
+    if ( FIGHTING(ch) )
+      d->msdp_dirty |= MSDP_DIRTY_COMBAT;
+
+    if ( d->msdp_dirty )
+    {
+      if ( d->msdp_dirty == MSDP_DIRTY_ALL )
+        MSDPSetString( d, eMSDP_CHARACTER_NAME, GET_NAME(ch) );
+
+      if ( d->msdp_dirty & MSDP_DIRTY_ALIGN )
+        MSDPSetNumber( d, eMSDP_ALIGNMENT, GET_ALIGNMENT(ch) );
+
+      if ( d->msdp_dirty & MSDP_DIRTY_LEVEL )
+      {
+        MSDPSetNumber( d, eMSDP_EXPERIENCE, GET_EXP(ch) );
+        MSDPSetNumber( d, eMSDP_LEVEL, GET_LEVEL(ch) );
+        sprinttype( ch->player.chclass, pc_class_types, buf, sizeof(buf) );
+        MSDPSetString( d, eMSDP_CLASS, buf );
+      }
+
+      if ( d->msdp_dirty & MSDP_DIRTY_VITALS )
       {
-          int hit_points = (GET_HIT(pOpponent) * 100) / GET_MAX_HIT(pOpponent);
-          MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH, hit_points );
-          MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH_MAX, 100 );
-          MSDPSetNumber( d, eMSDP_OPPONENT_LEVEL, GET_LEVEL(pOpponent) );
-          MSDPSetString( d, eMSDP_OPPONENT_NAME, PERS(pOpponent, ch) );
+        MSDPSetNumber( d, eMSDP_HEALTH, GET_HIT(ch) );
+        MSDPSetNumber( d, eMSDP_HEALTH_MAX, GET_MAX_HIT(ch) );
+        MSDPSetNumber( d, eMSDP_MANA, GET_MANA(ch) );
+        MSDPSetNumber( d, eMSDP_MANA_MAX, GET_MAX_MANA(ch) );
+        MSDPSetNumber( d, eMSDP_MOVEMENT, GET_STAMINA(ch) );
+        MSDPSetNumber( d, eMSDP_MOVEMENT_MAX, GET_MAX_STAMINA(ch) );
       }
-      else /* Clear the values */
+
+      if ( d->msdp_dirty & MSDP_DIRTY_WIMPY )
+        MSDPSetNumber( d, eMSDP_WIMPY, GET_WIMP_LEV(ch) );
+      if ( d->msdp_dirty & MSDP_DIRTY_MONEY )
+        MSDPSetNumber( d, eMSDP_MONEY, GET_COINS(ch) );
+      if ( d->msdp_dirty & MSDP_DIRTY_ARMOR )
+        MSDPSetNumber( d, eMSDP_AC, compute_armor_class(ch) );
+
+      if ( d->msdp_dirty & MSDP_DIRTY_COMBAT )
       {
-          MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH, 0 );
-          MSDPSetNumber( d, eMSDP_OPPONENT_LEVEL, 0 ); 
-          MSDPSetString( d, eMSDP_OPPONENT_NAME, "" ); 
+        struct char_data *pOpponent = FIGHTING(ch);
+
+        if ( pOpponent != NULL )
+        {
+            int hit_points = (GET_HIT(pOpponent) * 100) / GET_MAX_HIT(pOpponent);
+            MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH, hit_points );
+            MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH_MAX, 100 );
+            MSDPSetNumber( d, eMSDP_OPPONENT_LEVEL, GET_LEVEL(pOpponent) );
+            MSDPSetString( d, eMSDP_OPPONENT_NAME, PERS(pOpponent, ch) );
+        }
+        else /* Clear the values */
+        {
+            MSDPSetNumber( d, eMSDP_OPPONENT_HEALTH, 0 );
+            MSDPSetNumber( d, eMSDP_OPPONENT_LEVEL, 0 ); 
+            MSDPSetString( d, eMSDP_OPPONENT_NAME, "" ); 
+        }
       }
 
-      MSDPUpdate( d );
+      d->msdp_dirty = 0;
     }
 
-    /* Ideally this should be called once at startup, and again whenever
-     * someone leaves or joins the mud.  But this works, and it keeps the
-     * snippet simple.  Optimise as you see fit.
-     */
-    MSSPSetPlayers( PlayerCount );
+    /* Also sends whatever the client has just asked to have reported. */
+    MSDPUpdate( d );
   }
+
+  /* The player count only changes as descriptors come and go above, or
+   * close_socket() drops one. */
+  if ( msdp_players != players_sent )
+    MSSPSetPlayers( players_sent = msdp_players );
 }
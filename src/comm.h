@@ -51,6 +51,22 @@ void	write_to_q(const char *txt, struct txt_q *queue, int aliased);
 int	write_to_descriptor(socket_t desc, const char *txt);
 size_t	write_to_output(struct descriptor_data *d, const char *txt, ...) __attribute__ ((format (printf, 2, 3)));
 size_t	vwrite_to_output(struct descriptor_data *d, const char *format, va_list args);
+int	write_direct(struct descriptor_data *d, const char *txt);
+void	start_compression(struct descriptor_data *d);
+void	end_compression(struct descriptor_data *d);
+void	stop_network_thread(void);
+void	msdp_changed(struct char_data *ch, int what);
+
+/* What msdp_changed() says has changed, so msdp_update() knows which MSDP
+ * variables to look at again. */
+#define MSDP_DIRTY_VITALS  (1 << 0)  /**< hit, mana, stamina and maxima */
+#define MSDP_DIRTY_MONEY   (1 << 1)  /**< coins */
+#define MSDP_DIRTY_COMBAT  (1 << 2)  /**< who they are fighting */
+#define MSDP_DIRTY_LEVEL   (1 << 3)  /**< level, experience and class */
+#define MSDP_DIRTY_ALIGN   (1 << 4)  /**< alignment */
+#define MSDP_DIRTY_ARMOR   (1 << 5)  /**< armor class */
+#define MSDP_DIRTY_WIMPY   (1 << 6)  /**< wimpy level */
+#define MSDP_DIRTY_ALL     ((1 << 7) - 1)
 
 typedef RETSIGTYPE sigfunc(int);
 
@@ -63,11 +79,15 @@ void copyover_recover(void);
 extern struct descriptor_data *descriptor_list;
 extern int buf_largecount;
 extern int buf_overflows;
-extern int buf_switches;
+extern long output_bytes_copied;
+extern long output_bytes_sent;
+extern unsigned long mccp_bytes_in;
+extern unsigned long mccp_bytes_out;
 extern int circle_shutdown;
 extern int circle_reboot;
 extern int no_specials;
 extern int scheck;
+extern int no_world_image;
 extern FILE *logfile;
 extern unsigned long pulse;
 extern ush_int port;
@@ -292,3 +292,28 @@ int special_in_comm = YES;
 
 /* Current Debug Mode */
 int debug_mode = OFF;
+
+/* How many threads parse the world files at boot.  0 uses one per CPU, 1
+ * parses them one after another on the main thread.  The world comes out
+ * the same either way; only boot time changes.  -j on the command line
+ * overrides this. */
+int boot_threads = 0;
+
+/* How many slices each PULSE_MOBILE's mob AI is cut into.  The mobs are
+ * shared out between the slices, which run on different pulses, so the work
+ * doesn't all land on one.  1 runs every mob on the same pulse; the most is
+ * PULSE_MOBILE, one slice a pulse. */
+int mob_ai_shards = 10;
+
+/* Zone dormancy, see dormancy.h.  A zone no player has been within
+ * dormancy_radius zones of for dormancy_delay minutes goes to sleep: its
+ * mobs stop wandering and its resets wait until someone comes back.  Set
+ * dormancy_delay to 0 to keep every zone awake. */
+int dormancy_delay = 5;
+int dormancy_radius = 1;
+
+/* Move socket reads and writes onto a thread of their own, see netio.h.
+ * The game thread then only copies bytes to and from memory each pulse.
+ * Needs pthreads and epoll(); without them the game does its own socket
+ * I/O whatever this says.  Takes effect at the next boot or copyover. */
+int network_thread = NO;
@@ -64,6 +64,11 @@ extern int display_closed_doors;
 extern int protocol_negotiation;
 extern int special_in_comm;
 extern int debug_mode;
+extern int boot_threads;
+extern int mob_ai_shards;
+extern int dormancy_delay;
+extern int dormancy_radius;
+extern int network_thread;
 /* Automap and map options */
 extern int map_option;
 extern int default_map_size;
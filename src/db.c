@@ -41,6 +41,10 @@
 #include "msgedit.h"
 #include "screen.h"
 #include "toml.h"
+#include "vnum_index.h"
+#include "boot_parse.h"
+#include "world_image.h"
+#include "dormancy.h"
 #include <sys/stat.h>
 
 /*  declarations of most of the 'global' variables */
@@ -62,6 +66,13 @@ obj_rnum top_of_objt = 0;	/* top of object index table	 */
 struct zone_data *zone_table; /* zone table      */
 zone_rnum top_of_zone_table = 0;/* top element of zone tab   */
 
+/* World file parser threads for this boot, see boot_parse.h */
+static int parse_threads = 1;
+
+/* vnum -> rnum lookup tables, see vnum_index.h */
+static struct vnum_index room_vnums, mob_vnums, obj_vnums, zone_vnums;
+struct vnum_index trig_vnums, quest_vnums;
+
 /* begin previously located in players.c */
 struct player_index_element *player_table = NULL; /* index to plr file   */
 int top_of_p_table = 0;   /* ref to top of table     */
@@ -122,17 +133,28 @@ time_t motdmod; /* Time motd file was last modified. */
 struct time_info_data time_info;  /* the infomation about the time    */
 struct weather_data weather_info;	/* the infomation about the weather */
 struct player_special_data dummy_mob;	/* dummy spec area for mobs	*/
-struct reset_q_type reset_q;	    /* queue of zones to be reset	 */
 
 /* declaration of local (file scope) variables */
 static int converting = FALSE;
 
+/* Zones wait for their resets in a min-heap ordered by the pulse each is
+ * next due.  An entry is only good while its due pulse matches the zone's
+ * reset_due; rescheduling a zone just pushes a new entry, and the old one is
+ * thrown away when it reaches the top. */
+struct zone_reset_event {
+  long due;             /* the pulse the zone is due */
+  zone_rnum zone;
+};
+static struct zone_reset_event *reset_heap = NULL;
+static int reset_heap_size = 0, reset_heap_max = 0;
+long zone_pulse = 0;            /* pulses zone_update() has seen */
+
 /* Local (file scope) utility functions */
 static int check_bitvector_names(bitvector_t bits, size_t namecount, const char *whatami, const char *whatbits);
 static int check_object_spell_number(struct obj_data *obj, int val);
 static int check_object_level(struct obj_data *obj, int val);
 static int check_object(struct obj_data *);
-static void load_zones(FILE *fl, char *zonename);
+static void load_zones(toml_table_t *tab, char *zonename);
 static int file_to_string(const char *name, char *buf);
 static int file_to_string_alloc(const char *name, char **buf);
 static int count_alias_records(FILE *fl);
@@ -143,7 +165,6 @@ static void parse_enhanced_mob(FILE *mob_f, int i, int nr);
 static void parse_room_toml(toml_table_t *room_tab);
 static void parse_mobile_toml(toml_table_t *mob_tab);
 static void parse_object_toml(toml_table_t *obj_tab);
-static void parse_trigger_toml(toml_table_t *trig_tab);
 static void parse_quest_toml(toml_table_t *quest_tab);
 static void get_one_line(FILE *fl, char *buf);
 static void check_start_rooms(void);
@@ -449,45 +470,280 @@ ACMD(do_reboot)
   send_to_char(ch, "%s", CONFIG_OK);
 }
 
+/* Milliseconds since *start. */
+static double boot_elapsed_ms(const struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return ((now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_usec - start->tv_usec) / 1000.0);
+}
+
+/* Log how long the boot phase begun at *start took, and start the next. */
+static void boot_phase_done(struct timeval *start)
+{
+  log("   done in %.1f ms.", boot_elapsed_ms(start));
+  gettimeofday(start, NULL);
+}
+
+/* FNV-1a over the loaded world, see world_digest(). */
+#define DIGEST_INIT 0xcbf29ce484222325ULL
+
+static unsigned long long digest_bytes(unsigned long long h, const void *data, size_t len)
+{
+  const unsigned char *p = data;
+
+  while (len--)
+    h = (h ^ *p++) * 0x100000001b3ULL;
+  return (h);
+}
+
+static unsigned long long digest_int(unsigned long long h, long n)
+{
+  return (digest_bytes(h, &n, sizeof(n)));
+}
+
+static unsigned long long digest_str(unsigned long long h, const char *str)
+{
+  /* Tell NULL apart from "" and keep "ab","c" apart from "a","bc". */
+  if (!str)
+    return (digest_int(h, -1));
+  return (digest_bytes(h, str, strlen(str) + 1));
+}
+
+static unsigned long long digest_extra(unsigned long long h, const struct extra_descr_data *ex)
+{
+  for (; ex; ex = ex->next) {
+    h = digest_str(h, ex->keyword);
+    h = digest_str(h, ex->description);
+  }
+  return (digest_int(h, -2));
+}
+
+static unsigned long long digest_protos(unsigned long long h, const struct trig_proto_list *tp)
+{
+  for (; tp; tp = tp->next)
+    h = digest_int(h, tp->vnum);
+  return (digest_int(h, -2));
+}
+
+/** A hash of what boot_world() loaded, in rnum order.  Two boots of the
+ * same files must produce the same digest whatever parse_threads was, so
+ * comparing it between a -j1 and a -jN boot checks that parallel parsing
+ * changed nothing, and comparing a -w boot with one from the world image
+ * checks the image. */
+static unsigned long long world_digest(void)
+{
+  unsigned long long h = DIGEST_INIT;
+  struct cmdlist_element *cl;
+  struct forage_entry *fe;
+  struct mob_loadout *lo;
+  struct skin_yield_entry *sy;
+  int i, j;
+
+  for (i = 0; i <= top_of_zone_table; i++) {
+    h = digest_int(h, zone_table[i].number);
+    h = digest_str(h, zone_table[i].name);
+    h = digest_int(h, zone_table[i].bot);
+    h = digest_int(h, zone_table[i].top);
+    h = digest_int(h, zone_table[i].lifespan);
+    h = digest_int(h, zone_table[i].reset_mode);
+    for (j = 0; zone_table[i].cmd[j].command != 'S'; j++) {
+      h = digest_int(h, zone_table[i].cmd[j].command);
+      h = digest_int(h, zone_table[i].cmd[j].if_flag);
+      h = digest_int(h, zone_table[i].cmd[j].arg1);
+      h = digest_int(h, zone_table[i].cmd[j].arg2);
+      h = digest_int(h, zone_table[i].cmd[j].arg3);
+      h = digest_str(h, zone_table[i].cmd[j].sarg1);
+      h = digest_str(h, zone_table[i].cmd[j].sarg2);
+    }
+  }
+
+  for (i = 0; i < top_of_trigt; i++) {
+    struct trig_data *t = trig_index[i]->proto;
+
+    h = digest_int(h, trig_index[i]->vnum);
+    h = digest_str(h, t->name);
+    h = digest_int(h, t->attach_type);
+    h = digest_int(h, t->trigger_type);
+    h = digest_int(h, t->narg);
+    h = digest_str(h, t->arglist);
+    for (cl = t->cmdlist; cl; cl = cl->next)
+      h = digest_str(h, cl->cmd);
+  }
+
+  for (i = 0; i <= top_of_world; i++) {
+    struct room_data *r = &world[i];
+
+    h = digest_int(h, r->number);
+    h = digest_int(h, r->zone);
+    h = digest_int(h, r->sector_type);
+    h = digest_bytes(h, r->room_flags, sizeof(r->room_flags));
+    h = digest_str(h, r->name);
+    h = digest_str(h, r->description);
+    h = digest_extra(h, r->ex_description);
+    h = digest_protos(h, r->proto_script);
+    for (fe = r->forage; fe; fe = fe->next) {
+      h = digest_int(h, fe->obj_vnum);
+      h = digest_int(h, fe->dc);
+    }
+    for (j = 0; j < NUM_OF_DIRS; j++) {
+      if (!r->dir_option[j])
+        continue;
+      h = digest_int(h, j);
+      h = digest_int(h, r->dir_option[j]->to_room);
+      h = digest_int(h, r->dir_option[j]->exit_info);
+      h = digest_int(h, r->dir_option[j]->key);
+      h = digest_str(h, r->dir_option[j]->keyword);
+      h = digest_str(h, r->dir_option[j]->general_description);
+    }
+  }
+
+  for (i = 0; i <= top_of_mobt; i++) {
+    struct char_data *m = &mob_proto[i];
+
+    h = digest_int(h, mob_index[i].vnum);
+    h = digest_str(h, m->player.name);
+    h = digest_str(h, m->player.keywords);
+    h = digest_str(h, m->player.short_descr);
+    h = digest_str(h, m->player.long_descr);
+    h = digest_str(h, m->player.description);
+    h = digest_str(h, m->player.background);
+    h = digest_extra(h, m->mob_specials.ex_description);
+    for (lo = m->proto_loadout; lo; lo = lo->next) {
+      h = digest_int(h, lo->vnum);
+      h = digest_int(h, lo->wear_pos);
+      h = digest_int(h, lo->quantity);
+    }
+    for (sy = mob_index[i].skin_yields; sy; sy = sy->next) {
+      h = digest_int(h, sy->obj_vnum);
+      h = digest_int(h, sy->dc);
+    }
+    h = digest_bytes(h, &m->real_abils, sizeof(m->real_abils));
+    h = digest_int(h, GET_LEVEL(m));
+    h = digest_int(h, GET_MAX_HIT(m));
+    h = digest_int(h, GET_EXP(m));
+    h = digest_int(h, GET_COINS(m));
+    h = digest_bytes(h, MOB_FLAGS(m), sizeof(MOB_FLAGS(m)));
+    h = digest_protos(h, m->proto_script);
+  }
+
+  for (i = 0; i <= top_of_objt; i++) {
+    struct obj_data *o = &obj_proto[i];
+
+    h = digest_int(h, obj_index[i].vnum);
+    h = digest_str(h, o->name);
+    h = digest_str(h, o->description);
+    h = digest_str(h, o->short_description);
+    h = digest_str(h, o->main_description);
+    h = digest_extra(h, o->ex_description);
+    h = digest_int(h, o->obj_flags.type_flag);
+    h = digest_bytes(h, o->obj_flags.value, sizeof(o->obj_flags.value));
+    h = digest_bytes(h, o->obj_flags.wear_flags, sizeof(o->obj_flags.wear_flags));
+    h = digest_bytes(h, o->obj_flags.extra_flags, sizeof(o->obj_flags.extra_flags));
+    h = digest_int(h, o->obj_flags.weight);
+    h = digest_int(h, o->obj_flags.cost);
+    h = digest_protos(h, o->proto_script);
+  }
+
+  for (i = 0; i <= top_shop; i++) {
+    h = digest_int(h, SHOP_NUM(i));
+    h = digest_int(h, SHOP_KEEPER(i));
+    for (j = 0; SHOP_PRODUCT(i, j) != NOTHING; j++)
+      h = digest_int(h, SHOP_PRODUCT(i, j));
+  }
+
+  for (i = 0; i < total_quests; i++) {
+    h = digest_int(h, QST_NUM(i));
+    h = digest_str(h, QST_NAME(i));
+    h = digest_int(h, QST_MASTER(i));
+    h = digest_int(h, QST_TARGET(i));
+  }
+
+  return (h);
+}
+
 void boot_world(void)
 {
-  log("Loading zone table.");
-  index_boot(DB_BOOT_ZON);
+  struct timeval t_world, t_phase;
 
-  log("Loading triggers and generating index.");
-  index_boot(DB_BOOT_TRG);
+  gettimeofday(&t_world, NULL);
+  t_phase = t_world;
 
-  log("Loading rooms.");
-  index_boot(DB_BOOT_WLD);
+  parse_threads = boot_parse_threads(CONFIG_BOOT_THREADS);
 
-  log("Renumbering rooms.");
-  renum_world();
+  /* The image holds zones, triggers, rooms, mobs and objs as they stand
+   * after renumbering; it is only trusted if no world file has changed. */
+  if (world_image_load()) {
+    boot_phase_done(&t_phase);
 
-  log("Checking start rooms.");
-  check_start_rooms();
+    log("Checking start rooms.");
+    check_start_rooms();
+    boot_phase_done(&t_phase);
+  } else {
+    log("Parsing world files on %d thread%s.", parse_threads, parse_threads == 1 ? "" : "s");
 
-  log("Loading mobs and generating index.");
-  index_boot(DB_BOOT_MOB);
+    log("Loading zone table.");
+    index_boot(DB_BOOT_ZON);
+    boot_phase_done(&t_phase);
 
-  log("Loading objs and generating index.");
-  index_boot(DB_BOOT_OBJ);
+    log("Loading triggers and generating index.");
+    index_boot(DB_BOOT_TRG);
+    boot_phase_done(&t_phase);
 
-  log("Renumbering zone table.");
-  renum_zone_table();
+    log("Loading rooms.");
+    index_boot(DB_BOOT_WLD);
+    boot_phase_done(&t_phase);
 
-  if(converting) {
-    log("Saving 128bit world files to disk.");
-    save_all();
+    log("Renumbering rooms.");
+    renum_world();
+    boot_phase_done(&t_phase);
+
+    log("Checking start rooms.");
+    check_start_rooms();
+    boot_phase_done(&t_phase);
+
+    log("Loading mobs and generating index.");
+    index_boot(DB_BOOT_MOB);
+    boot_phase_done(&t_phase);
+
+    log("Loading objs and generating index.");
+    index_boot(DB_BOOT_OBJ);
+    boot_phase_done(&t_phase);
+
+    log("Renumbering zone table.");
+    renum_zone_table();
+    boot_phase_done(&t_phase);
+
+    if(converting) {
+      log("Saving 128bit world files to disk.");
+      save_all();
+      boot_phase_done(&t_phase);
+    } else {
+      log("Writing world image.");
+      world_image_save();
+      boot_phase_done(&t_phase);
+    }
   }
 
   if (!no_specials) {
     log("Loading shops.");
     index_boot(DB_BOOT_SHP);
+    boot_phase_done(&t_phase);
   }
 
   log("Loading quests.");
   index_boot(DB_BOOT_QST);
+  boot_phase_done(&t_phase);
 
+  log("Compiling triggers.");
+  dg_compile_all();
+  boot_phase_done(&t_phase);
+
+  vnum_index_report();
+
+  log("World loaded in %.1f ms, digest %016llx.", boot_elapsed_ms(&t_world),
+      world_digest());
 }
 
 static void free_extra_descriptions(struct extra_descr_data *edesc)
@@ -644,31 +900,18 @@ void destroy_db(void)
 #undef THIS_CMD
 
   /* zone table reset queue */
-  if (reset_q.head) {
-    struct reset_q_element *ftemp=reset_q.head, *temp;
-    while (ftemp) {
-      temp = ftemp->next;
-      free(ftemp);
-      ftemp = temp;
-    }
-  }
+  if (reset_heap)
+    free(reset_heap);
+  reset_heap = NULL;
+  reset_heap_size = reset_heap_max = 0;
+  free_zone_links();
 
   /* Triggers */
   for (cnt=0; cnt < top_of_trigt; cnt++) {
     if (trig_index[cnt]->proto) {
       /* make sure to nuke the command list (memory leak) */
       /* free_trigger() doesn't free the command list */
-      if (trig_index[cnt]->proto->cmdlist) {
-        struct cmdlist_element *i, *j;
-        i = trig_index[cnt]->proto->cmdlist;
-        while (i) {
-          j = i->next;
-          if (i->cmd)
-            free(i->cmd);
-          free(i);
-          i = j;
-        }
-      }
+      free_cmdlist(trig_index[cnt]->proto->cmdlist);
       free_trigger(trig_index[cnt]->proto);
     }
     free(trig_index[cnt]);
@@ -678,6 +921,13 @@ void destroy_db(void)
   /* Events */
   event_free_all();
 
+  /* vnum lookup tables */
+  vnum_index_clear(&room_vnums);
+  vnum_index_clear(&mob_vnums);
+  vnum_index_clear(&obj_vnums);
+  vnum_index_clear(&zone_vnums);
+  vnum_index_clear(&trig_vnums);
+  vnum_index_clear(&quest_vnums);
 }
 
 /* body of the booting system */
@@ -818,8 +1068,6 @@ void boot_db(void)
     reset_zone(i);
   }
 
-  reset_q.head = reset_q.tail = NULL;
-
   if (!boot_time)
     boot_time = time(0);
 
@@ -972,7 +1220,7 @@ static const char *toml_mode_key(int mode)
   }
 }
 
-static char **toml_load_index_files(const char *index_path, int *count)
+char **toml_load_index_files(const char *index_path, int *count)
 {
   FILE *fp;
   toml_table_t *tab;
@@ -1025,40 +1273,6 @@ static char **toml_load_index_files(const char *index_path, int *count)
   return list;
 }
 
-static int toml_count_records(const char *path, int mode)
-{
-  FILE *fp;
-  toml_table_t *tab;
-  toml_array_t *arr;
-  char errbuf[200];
-  const char *key;
-  int count = 0;
-
-  key = toml_mode_key(mode);
-  if (!key)
-    return 0;
-
-  fp = fopen(path, "r");
-  if (!fp) {
-    log("SYSERR: File '%s' listed in '%s': %s", path, key, strerror(errno));
-    return 0;
-  }
-
-  tab = toml_parse_file(fp, errbuf, sizeof(errbuf));
-  fclose(fp);
-  if (!tab) {
-    log("SYSERR: parsing file '%s': %s", path, errbuf);
-    return 0;
-  }
-
-  arr = toml_array_in(tab, key);
-  if (arr)
-    count = toml_array_nelem(arr);
-
-  toml_free(tab);
-  return count;
-}
-
 static int toml_get_int_default(toml_table_t *tab, const char *key, int def)
 {
   toml_datum_t v = toml_int_in(tab, key);
@@ -1177,7 +1391,12 @@ void index_boot(int mode)
   int line_number, rec_count = 0, size[2];
   char buf2[PATH_MAX], buf1[PATH_MAX - 100];   // - 100 to make room for prefix
   char **index_files = NULL;
+  struct boot_file *parsed = NULL;
   int index_count = 0;
+  struct timeval t_start;
+  double t_parse = 0;
+
+  gettimeofday(&t_start, NULL);
 
   switch (mode) {
   case DB_BOOT_WLD:
@@ -1255,16 +1474,46 @@ void index_boot(int mode)
     snprintf(buf2, sizeof(buf2), "%s%s", prefix, index_filename);
     index_files = toml_load_index_files(buf2, &index_count);
 
+    /* Parse every file once, on boot_threads threads; the parsed tables
+     * size the arrays below and are then handed to the loaders in index
+     * order. */
+    if (index_count > 0)
+      CREATE(parsed, struct boot_file, index_count);
     for (line_number = 0; line_number < index_count; line_number++) {
       snprintf(buf2, sizeof(buf2), "%s%s", prefix, index_files[line_number]);
-      rec_count += toml_count_records(buf2, mode);
+      free(index_files[line_number]);
+      index_files[line_number] = strdup(buf2);
+      parsed[line_number].path = index_files[line_number];
+      parsed[line_number].key = toml_mode_key(mode);
+    }
+    boot_parse_files(parsed, index_count, parse_threads);
+
+    for (line_number = 0; line_number < index_count; line_number++) {
+      struct boot_file *f = &parsed[line_number];
+
+      if (f->open_errno)
+        log("SYSERR: File '%s' listed in '%s': %s", f->path, f->key, strerror(f->open_errno));
+      else if (!f->tab)
+        log("SYSERR: parsing file '%s': %s", f->path, f->errbuf);
+      rec_count += f->count;
     }
+    t_parse = boot_elapsed_ms(&t_start);
   }
 
   /* Exit if 0 records, unless this is shops */
   if (!rec_count) {
-    if (mode == DB_BOOT_SHP || mode == DB_BOOT_QST)
+    if (mode == DB_BOOT_SHP || mode == DB_BOOT_QST) {
+      for (line_number = 0; line_number < index_count; line_number++) {
+        if (parsed[line_number].tab)
+          toml_free(parsed[line_number].tab);
+        free(index_files[line_number]);
+      }
+      if (parsed)
+        free(parsed);
+      if (index_files)
+        free(index_files);
       return;
+    }
     log("SYSERR: boot error - 0 records counted in %s/%s.", prefix,
 	index_filename);
     exit(1);
@@ -1342,64 +1591,124 @@ void index_boot(int mode)
     fclose(db_index);
   } else {
     for (line_number = 0; line_number < index_count; line_number++) {
-      snprintf(buf2, sizeof(buf2), "%s%s", prefix, index_files[line_number]);
+      toml_table_t *tab = parsed[line_number].tab;
+
+      if (!tab) {
+        log("SYSERR: %s: could not be read, see above.", index_files[line_number]);
+        exit(1);
+      }
       switch (mode) {
       case DB_BOOT_WLD:
       case DB_BOOT_OBJ:
       case DB_BOOT_MOB:
       case DB_BOOT_TRG:
       case DB_BOOT_QST:
-        discrete_load(NULL, mode, buf2);
+        discrete_load(tab, mode, index_files[line_number]);
         break;
       case DB_BOOT_ZON:
-        load_zones(NULL, buf2);
+        load_zones(tab, index_files[line_number]);
         break;
       case DB_BOOT_SHP:
-        boot_the_shops(NULL, buf2, rec_count);
+        boot_the_shops(tab, index_files[line_number], rec_count);
         break;
       }
+      /* Free as we go so only one mode's worth of parsed files is live. */
+      toml_free(tab);
+      parsed[line_number].tab = NULL;
     }
     for (line_number = 0; line_number < index_count; line_number++)
       free(index_files[line_number]);
     free(index_files);
+    free(parsed);
+
+    log("   %d files parsed in %.1f ms (%d thread%s), loaded in %.1f ms.", index_count,
+        t_parse, MIN(parse_threads, index_count), MIN(parse_threads, index_count) == 1 ? "" : "s",
+        boot_elapsed_ms(&t_start) - t_parse);
   }
 
   /* Sort the help index. */
   if (mode == DB_BOOT_HLP) {
     qsort(help_table, top_of_helpt, sizeof(struct help_index_element), hsort);
   }
+
+  vnum_index_rebuild(mode);
 }
 
-void discrete_load(FILE *fl, int mode, char *filename)
+static IDXTYPE room_vnum_at(IDXTYPE rnum)  { return world[rnum].number; }
+static IDXTYPE mob_vnum_at(IDXTYPE rnum)   { return mob_index[rnum].vnum; }
+static IDXTYPE obj_vnum_at(IDXTYPE rnum)   { return obj_index[rnum].vnum; }
+static IDXTYPE zone_vnum_at(IDXTYPE rnum)  { return zone_table[rnum].number; }
+static IDXTYPE trig_vnum_at(IDXTYPE rnum)  { return trig_index[rnum]->vnum; }
+static IDXTYPE quest_vnum_at(IDXTYPE rnum) { return QST_NUM(rnum); }
+
+/** Rebuild the vnum lookup table for one of the world tables.  Must be
+ * called whenever rnums in that table change: after booting it, and after
+ * an OLC function inserts or removes an entry.
+ * @param mode The DB_BOOT_xxx constant of the table that changed. */
+void vnum_index_rebuild(int mode)
+{
+  switch (mode) {
+  case DB_BOOT_WLD:
+    vnum_index_build(&room_vnums, top_of_world + 1, room_vnum_at);
+    break;
+  case DB_BOOT_MOB:
+    vnum_index_build(&mob_vnums, top_of_mobt + 1, mob_vnum_at);
+    break;
+  case DB_BOOT_OBJ:
+    vnum_index_build(&obj_vnums, top_of_objt + 1, obj_vnum_at);
+    break;
+  case DB_BOOT_ZON:
+    vnum_index_build(&zone_vnums, top_of_zone_table + 1, zone_vnum_at);
+    break;
+  case DB_BOOT_TRG:
+    vnum_index_build(&trig_vnums, top_of_trigt, trig_vnum_at);
+    break;
+  case DB_BOOT_QST:
+    vnum_index_build(&quest_vnums, total_quests, quest_vnum_at);
+    break;
+  }
+}
+
+/** Log what the vnum lookup tables cost, once the world is loaded. */
+void vnum_index_report(void)
+{
+  const struct { const char *name; struct vnum_index *idx; } tab[] = {
+    { "rooms",    &room_vnums  },
+    { "mobs",     &mob_vnums   },
+    { "objs",     &obj_vnums   },
+    { "zones",    &zone_vnums  },
+    { "triggers", &trig_vnums  },
+    { "quests",   &quest_vnums },
+  };
+  size_t i, total = 0;
+
+  log("Vnum lookup tables:");
+  for (i = 0; i < sizeof(tab) / sizeof(tab[0]); i++) {
+    log("   %-8s %6d vnums, %5d of %6d pages, %lu bytes.%s", tab[i].name,
+        tab[i].idx->entries, tab[i].idx->used_pages, tab[i].idx->num_pages,
+        (unsigned long) vnum_index_bytes(tab[i].idx),
+        tab[i].idx->complete ? "" : " (some vnums too large, searched)");
+    total += vnum_index_bytes(tab[i].idx);
+  }
+  log("   %lu bytes total.", (unsigned long) total);
+}
+
+/** Load the records of one parsed world file.
+ * @param tab The parsed file; still owned by the caller.
+ * @param mode DB_BOOT_xxx of the records to load.
+ * @param filename Only used in error messages. */
+void discrete_load(toml_table_t *tab, int mode, char *filename)
 {
-  FILE *fp;
-  toml_table_t *tab;
   toml_array_t *arr;
-  char errbuf[200];
   const char *key;
   int i, count;
 
-  (void)fl;
-
   key = toml_mode_key(mode);
   if (!key)
     return;
 
-  if (!(fp = fopen(filename, "r"))) {
-    log("SYSERR: %s: %s", filename, strerror(errno));
-    exit(1);
-  }
-
-  tab = toml_parse_file(fp, errbuf, sizeof(errbuf));
-  fclose(fp);
-  if (!tab) {
-    log("SYSERR: parsing file '%s': %s", filename, errbuf);
-    exit(1);
-  }
-
   arr = toml_array_in(tab, key);
   if (!arr) {
-    toml_free(tab);
     log("SYSERR: TOML file '%s' missing '%s' array.", filename, key);
     exit(1);
   }
@@ -1427,8 +1736,6 @@ void discrete_load(FILE *fl, int mode, char *filename)
       break;
     }
   }
-
-  toml_free(tab);
 }
 
 static char fread_letter(FILE *fp)
@@ -2105,7 +2412,7 @@ static void parse_object_toml(toml_table_t *obj_tab)
   i++;
 }
 
-static void parse_trigger_toml(toml_table_t *trig_tab)
+void parse_trigger_toml(toml_table_t *trig_tab)
 {
   int vnum;
   toml_array_t *arr;
@@ -3282,33 +3589,14 @@ char *parse_object(FILE *obj_f, int nr)
 
 #define Z	zone_table[zone]
 /* load the zone table and command tables */
-static void load_zones(FILE *fl, char *zonename)
+static void load_zones(toml_table_t *tab, char *zonename)
 {
   static zone_rnum zone = 0;
-  FILE *fp;
-  toml_table_t *tab;
   toml_array_t *zones;
-  char errbuf[200];
   int i, zcount;
 
-  (void)fl;
-
-  fp = fopen(zonename, "r");
-  if (!fp) {
-    log("SYSERR: %s: %s", zonename, strerror(errno));
-    exit(1);
-  }
-
-  tab = toml_parse_file(fp, errbuf, sizeof(errbuf));
-  fclose(fp);
-  if (!tab) {
-    log("SYSERR: parsing file '%s': %s", zonename, errbuf);
-    exit(1);
-  }
-
   zones = toml_array_in(tab, "zone");
   if (!zones) {
-    toml_free(tab);
     log("SYSERR: TOML file '%s' missing 'zone' array.", zonename);
     exit(1);
   }
@@ -3384,8 +3672,6 @@ static void load_zones(FILE *fl, char *zonename)
     top_of_zone_table = zone;
     zone++;
   }
-
-  toml_free(tab);
 }
 #undef Z
 
@@ -3798,78 +4084,146 @@ struct obj_data *read_object(obj_vnum nr, int type) /* and obj_rnum */
   return (obj);
 }
 
-#define ZO_DEAD  999
-/* update zone ages, queue for reset if necessary, and dequeue when possible */
-void zone_update(void)
+#define PULSES_PER_MIN (60 * PASSES_PER_SEC)
+
+static bool reset_event_before(struct zone_reset_event *a, struct zone_reset_event *b)
 {
-  int i;
-  struct reset_q_element *update_u, *temp;
-  static int timer = 0;
+  return (a->due < b->due || (a->due == b->due && a->zone < b->zone));
+}
 
-  /* jelson 10/22/92 */
-  if (((++timer * PULSE_ZONE) / PASSES_PER_SEC) >= 60) {
-    /* one minute has passed NOT accurate unless PULSE_ZONE is a multiple of
-     * PASSES_PER_SEC or a factor of 60 */
+static void push_zone_reset(zone_rnum zone, long due)
+{
+  struct zone_reset_event ev;
+  int i, parent;
 
-    timer = 0;
+  if (reset_heap_size == reset_heap_max) {
+    reset_heap_max = MAX(32, reset_heap_max * 2);
+    RECREATE(reset_heap, struct zone_reset_event, reset_heap_max);
+  }
 
-    /* since one minute has passed, increment zone ages */
-    for (i = 0; i <= top_of_zone_table; i++) {
-      if (zone_table[i].age < zone_table[i].lifespan &&
-	  zone_table[i].reset_mode)
-	(zone_table[i].age)++;
+  ev.due = due;
+  ev.zone = zone;
+  for (i = reset_heap_size++; i > 0; i = parent) {
+    parent = (i - 1) / 2;
+    if (!reset_event_before(&ev, &reset_heap[parent]))
+      break;
+    reset_heap[i] = reset_heap[parent];
+  }
+  reset_heap[i] = ev;
+}
 
-      if (zone_table[i].age >= zone_table[i].lifespan &&
-	  zone_table[i].age < ZO_DEAD && zone_table[i].reset_mode) {
-	/* enqueue zone */
+static void pop_zone_reset(void)
+{
+  struct zone_reset_event last;
+  int i = 0, child;
 
-	CREATE(update_u, struct reset_q_element, 1);
+  if (--reset_heap_size == 0)
+    return;
+
+  last = reset_heap[reset_heap_size];
+  while ((child = 2 * i + 1) < reset_heap_size) {
+    if (child + 1 < reset_heap_size &&
+        reset_event_before(&reset_heap[child + 1], &reset_heap[child]))
+      child++;
+    if (!reset_event_before(&reset_heap[child], &last))
+      break;
+    reset_heap[i] = reset_heap[child];
+    i = child;
+  }
+  reset_heap[i] = last;
+}
 
-	update_u->zone_to_reset = i;
-	update_u->next = 0;
+/** Queues a zone to be reset at pulse due, in place of when it was due. */
+void schedule_zone_reset_at(zone_rnum zone, long due)
+{
+  zone_table[zone].reset_due = due;
+  if (zone_table[zone].reset_mode)
+    push_zone_reset(zone, due);
+}
 
-	if (!reset_q.head)
-	  reset_q.head = reset_q.tail = update_u;
-	else {
-	  reset_q.tail->next = update_u;
-	  reset_q.tail = update_u;
-	}
+/** Queues a zone's next reset, lifespan minutes after its last.  Called by
+ * reset_zone(), and when a zone's lifespan or reset mode changes. */
+void schedule_zone_reset(zone_rnum zone)
+{
+  schedule_zone_reset_at(zone, zone_table[zone].last_reset +
+                         MAX(1, zone_table[zone].lifespan) * PULSES_PER_MIN);
+}
 
-	zone_table[i].age = ZO_DEAD;
-      }
+/** Requeues every zone.  Called when zone_table is renumbered. */
+void reschedule_zone_resets(void)
+{
+  zone_rnum zone;
+
+  reset_heap_size = 0;
+  for (zone = 0; zone <= top_of_zone_table; zone++)
+    schedule_zone_reset(zone);
+}
+
+/** Minutes since a zone was last reset, up to its lifespan. */
+int zone_age(zone_rnum zone)
+{
+  if (!zone_table[zone].reset_mode)
+    return (0);
+  return (MIN(zone_table[zone].lifespan,
+              (zone_pulse - zone_table[zone].last_reset) / PULSES_PER_MIN));
+}
+
+/* What a reset of the zone counts against ZONE_RESET_BUDGET: its commands,
+ * plus one for the reset itself. */
+static int zone_reset_cost(zone_rnum zone)
+{
+  int cmd_no;
+
+  for (cmd_no = 0; ZCMD.command != 'S'; cmd_no++);
+  return (cmd_no + 1);
+}
+
+/** Resets the zones that are due.  Called every pulse.  Each pulse resets
+ * zones until ZONE_RESET_BUDGET zone commands have been run, so a crowd of
+ * zones falling due together is spread over the following pulses.  A zone
+ * is started whenever some budget is left, so the last one reset in a pulse
+ * may run past it, and a zone bigger than the whole budget still gets reset,
+ * though possibly after smaller zones in the same pulse.  A zone that only
+ * resets when empty and has someone in it is looked at again PULSE_ZONE
+ * later, and a dormant zone is left until it wakes. */
+void zone_update(void)
+{
+  struct descriptor_data *pt;
+  zone_rnum zone;
+  int budget = ZONE_RESET_BUDGET;
+
+  zone_pulse++;
+
+  while (reset_heap_size > 0 && reset_heap[0].due <= zone_pulse && budget > 0) {
+    zone = reset_heap[0].zone;
+    if (reset_heap[0].due != zone_table[zone].reset_due ||
+        !zone_table[zone].reset_mode) {
+      pop_zone_reset();
+      continue;
     }
-  }	/* end - one minute has passed */
-
-  /* Dequeue zones (if possible) and reset. This code is executed every 10
-   * seconds (i.e. PULSE_ZONE). */
-  for (update_u = reset_q.head; update_u; update_u = update_u->next)
-    if (zone_table[update_u->zone_to_reset].reset_mode == 2 ||
-	is_empty(update_u->zone_to_reset)) {
-      reset_zone(update_u->zone_to_reset);
-      mudlog(CMP, LVL_IMPL+1, FALSE, "Auto zone reset: %s (Zone %d)",
-          zone_table[update_u->zone_to_reset].name, zone_table[update_u->zone_to_reset].number);
-      struct descriptor_data *pt;
-      for (pt = descriptor_list; pt; pt = pt->next)
-        if (IS_PLAYING(pt) && pt->character && PRF_FLAGGED(pt->character, PRF_ZONERESETS))
-          send_to_char(pt->character, "%s[Auto zone reset: %s (Zone %d)]%s", 
-            CCGRN(pt->character, C_NRM), zone_table[update_u->zone_to_reset].name, 
-            zone_table[update_u->zone_to_reset].number, CCNRM(pt->character, C_NRM));
-      /* dequeue */
-      if (update_u == reset_q.head)
-	reset_q.head = reset_q.head->next;
-      else {
-	for (temp = reset_q.head; temp->next != update_u;
-	     temp = temp->next);
-
-	if (!update_u->next)
-	  reset_q.tail = temp;
-
-	temp->next = update_u->next;
-      }
+    pop_zone_reset();
 
-      free(update_u);
-      break;
+    /* A dormant zone gets its reset when it wakes up. */
+    if (ZONE_DORMANT(zone)) {
+      zone_table[zone].reset_missed = TRUE;
+      continue;
     }
+
+    if (zone_table[zone].reset_mode != 2 && !is_empty(zone)) {
+      schedule_zone_reset_at(zone, zone_pulse + PULSE_ZONE);
+      continue;
+    }
+
+    budget -= zone_reset_cost(zone);
+    reset_zone(zone);
+    mudlog(CMP, LVL_IMPL+1, FALSE, "Auto zone reset: %s (Zone %d)",
+        zone_table[zone].name, zone_table[zone].number);
+    for (pt = descriptor_list; pt; pt = pt->next)
+      if (IS_PLAYING(pt) && pt->character && PRF_FLAGGED(pt->character, PRF_ZONERESETS))
+        send_to_char(pt->character, "%s[Auto zone reset: %s (Zone %d)]%s",
+          CCGRN(pt->character, C_NRM), zone_table[zone].name,
+          zone_table[zone].number, CCNRM(pt->character, C_NRM));
+  }
 }
 
 static void log_zone_error(zone_rnum zone, int cmd_no, const char *message)
@@ -4052,11 +4406,13 @@ void reset_zone(zone_rnum zone)
         if (!SCRIPT(tmob))
           CREATE(SCRIPT(tmob), struct script_data, 1);
         add_trigger(SCRIPT(tmob), read_trigger(ZCMD.arg2), -1);
+        triggers_attached(tmob, MOB_TRIGGER);
         last_cmd = 1;
       } else if (ZCMD.arg1==OBJ_TRIGGER && tobj) {
         if (!SCRIPT(tobj))
           CREATE(SCRIPT(tobj), struct script_data, 1);
         add_trigger(SCRIPT(tobj), read_trigger(ZCMD.arg2), -1);
+        triggers_attached(tobj, OBJ_TRIGGER);
         last_cmd = 1;
       } else if (ZCMD.arg1==WLD_TRIGGER) {
         if (ZCMD.arg3 == NOWHERE || ZCMD.arg3>top_of_world) {
@@ -4065,6 +4421,7 @@ void reset_zone(zone_rnum zone)
         if (!world[ZCMD.arg3].script)
           CREATE(world[ZCMD.arg3].script, struct script_data, 1);
         add_trigger(world[ZCMD.arg3].script, read_trigger(ZCMD.arg2), -1);
+        triggers_attached(&world[ZCMD.arg3], WLD_TRIGGER);
         last_cmd = 1;
       }
 
@@ -4106,7 +4463,8 @@ void reset_zone(zone_rnum zone)
     }
   }
 
-  zone_table[zone].age = 0;
+  zone_table[zone].last_reset = zone_pulse;
+  schedule_zone_reset(zone);
 
   /* handle reset_wtrigger's */
   rvnum = zone_table[zone].bot;
@@ -4118,7 +4476,8 @@ void reset_zone(zone_rnum zone)
 }
 
 /* for use in reset_zone; return TRUE if zone 'nr' is free of PC's  */
-int is_empty(zone_rnum zone_nr)
+/* Whether anyone connected and playing is in the zone. */
+static int zone_has_player(zone_rnum zone_nr)
 {
   struct descriptor_data *i;
 
@@ -4134,12 +4493,73 @@ int is_empty(zone_rnum zone_nr)
     if ((!IS_NPC(i->character)) && (GET_LEVEL(i->character) >= LVL_IMMORT) && (PRF_FLAGGED(i->character, PRF_NOHASSLE)))
       continue;
 
-    return (0);
+    return (1);
   }
 
-  return (1);
+  return (0);
 }
 
+/* The number of characters in a zone with a link, kept by char_to_room(),
+ * char_from_room() and set_char_desc().  Anyone who counts for is_empty()
+ * is one of these. */
+#define ZONE_LINKED(z) ((z)->num_players - (z)->num_linkless + (z)->num_switched)
+
+/** Whether no one is playing in a zone.  Connected players in OLC or the
+ * like, and immortals with nohassle on, don't count.
+ * @param zone_nr The zone.
+ * @retval int 1 if the zone is empty, else 0. */
+int is_empty(zone_rnum zone_nr)
+{
+  /* Nearly every zone has no one linked in it at all. */
+  if (!ZONE_LINKED(&zone_table[zone_nr]))
+    return (1);
+
+  return (!zone_has_player(zone_nr));
+}
+
+#ifdef CHECK_ZONE_OCCUPANCY
+/** Recounts every zone's occupants and checks them against the counts kept
+ * as characters move.  Called every pulse when built with
+ * -DCHECK_ZONE_OCCUPANCY. */
+void check_zone_occupancy(void)
+{
+  struct char_data *ch;
+  zone_rnum z;
+  room_rnum r;
+  int players, linkless, switched;
+
+  for (z = 0; z <= top_of_zone_table; z++) {
+    players = linkless = switched = 0;
+
+    for (r = 0; r <= top_of_world; r++) {
+      if (world[r].zone != z)
+        continue;
+      for (ch = world[r].people; ch; ch = ch->next_in_room)
+        if (!IS_NPC(ch)) {
+          players++;
+          if (!ch->desc)
+            linkless++;
+        } else if (ch->desc)
+          switched++;
+    }
+
+    if (players != zone_table[z].num_players ||
+        linkless != zone_table[z].num_linkless ||
+        switched != zone_table[z].num_switched) {
+      log("SYSERR: Zone %d occupancy is %d/%d/%d, counted %d/%d/%d.",
+          zone_table[z].number, zone_table[z].num_players,
+          zone_table[z].num_linkless, zone_table[z].num_switched,
+          players, linkless, switched);
+      assert(FALSE);
+    }
+    if (!ZONE_LINKED(&zone_table[z]) && zone_has_player(z)) {
+      log("SYSERR: Zone %d has a player but no one linked.", zone_table[z].number);
+      assert(FALSE);
+    }
+  }
+}
+#endif
+
 /* Functions of a general utility nature. */
 /* read and allocate space for a '~'-terminated string from a given file */
 char *fread_string(FILE *fl, const char *error)
@@ -4516,6 +4936,8 @@ void free_char(struct char_data *ch)
   int i;
   struct alias_data *a;
 
+  unschedule_char(ch);
+
   if (!IS_NPC(ch) && ch->player_specials && ch->player_specials != &dummy_mob)
     clear_scan_results(ch);
 
@@ -4625,6 +5047,7 @@ void free_obj(struct obj_data *obj)
   /* free any assigned scripts */
   if (SCRIPT(obj))
     extract_script(obj, OBJ_TRIGGER);
+  unschedule_obj(obj);
 
   /* find_obj helper (0 is not-yet-added to the table) */
   if (obj->script_id != 0) {
@@ -4895,6 +5318,9 @@ room_rnum real_room(room_vnum vnum)
 {
   room_rnum bot, top, mid;
 
+  if (vnum_index_lookup(&room_vnums, vnum, &mid))
+    return (mid);
+
   bot = 0;
   top = top_of_world;
 
@@ -4920,6 +5346,9 @@ mob_rnum real_mobile(mob_vnum vnum)
 {
   mob_rnum bot, top, mid;
 
+  if (vnum_index_lookup(&mob_vnums, vnum, &mid))
+    return (mid);
+
   bot = 0;
   top = top_of_mobt;
 
@@ -4946,6 +5375,9 @@ obj_rnum real_object(obj_vnum vnum)
 {
   obj_rnum bot, top, mid;
 
+  if (vnum_index_lookup(&obj_vnums, vnum, &mid))
+    return (mid);
+
   bot = 0;
   top = top_of_objt;
 
@@ -4972,6 +5404,9 @@ zone_rnum real_zone(zone_vnum vnum)
 {
   zone_rnum bot, top, mid;
 
+  if (vnum_index_lookup(&zone_vnums, vnum, &mid))
+    return (mid);
+
   bot = 0;
   top = top_of_zone_table;
 
@@ -5161,6 +5596,11 @@ static void load_default_config( void )
   CONFIG_MINIMAP_SIZE           = default_minimap_size;
   CONFIG_SCRIPT_PLAYERS         = script_players;
   CONFIG_DEBUG_MODE             = debug_mode;
+  CONFIG_BOOT_THREADS           = boot_threads;
+  CONFIG_MOB_AI_SHARDS          = mob_ai_shards;
+  CONFIG_DORMANCY_DELAY         = dormancy_delay;
+  CONFIG_DORMANCY_RADIUS        = dormancy_radius;
+  CONFIG_NETWORK_THREAD         = network_thread;
 
   /* Crashsave options. */
   CONFIG_AUTO_SAVE		        = auto_save;
@@ -5239,6 +5679,11 @@ void load_config( void )
           CONFIG_OLC_SAVE = num;
         break;
 
+      case 'b':
+        if (!str_cmp(tag, "boot_threads"))
+          CONFIG_BOOT_THREADS = num;
+        break;
+
       case 'c':
         if (!str_cmp(tag, "crash_file_timeout"))
           CONFIG_CRASH_TIMEOUT = num;
@@ -5251,6 +5696,10 @@ void load_config( void )
           CONFIG_DISP_CLOSED_DOORS = num;
         else if (!str_cmp(tag, "diagonal_dirs"))
           CONFIG_DIAGONAL_DIRS = num;
+        else if (!str_cmp(tag, "dormancy_delay"))
+          CONFIG_DORMANCY_DELAY = num;
+        else if (!str_cmp(tag, "dormancy_radius"))
+          CONFIG_DORMANCY_RADIUS = num;
         else if (!str_cmp(tag, "dts_are_dumps"))
           CONFIG_DTS_ARE_DUMPS = num;
         else if (!str_cmp(tag, "donation_room_1"))
@@ -5344,6 +5793,8 @@ void load_config( void )
           CONFIG_MAX_NPC_CORPSE_TIME = num;
         else if (!str_cmp(tag, "max_pc_corpse_time"))
           CONFIG_MAX_PC_CORPSE_TIME = num;
+        else if (!str_cmp(tag, "mob_ai_shards"))
+          CONFIG_MOB_AI_SHARDS = num;
         else if (!str_cmp(tag, "max_playing"))
           CONFIG_MAX_PLAYING = num;
         else if (!str_cmp(tag, "menu")) {
@@ -5368,6 +5819,8 @@ void load_config( void )
           CONFIG_NS_IS_SLOW = num;
         else if (!str_cmp(tag, "no_mort_to_immort"))
           CONFIG_NO_MORT_TO_IMMORT = num;
+        else if (!str_cmp(tag, "network_thread"))
+          CONFIG_NETWORK_THREAD = num;
         else if (!str_cmp(tag, "noperson")) {
           char tmp[READ_SIZE];
           if (CONFIG_NOPERSON)
@@ -87,6 +87,7 @@
 #define TRG_PREFIX  LIB_WORLD"trg"SLASH	/* trigger files	*/
 #define HLP_PREFIX  LIB_TEXT"help"SLASH /* Help files           */
 #define QST_PREFIX  LIB_WORLD"qst"SLASH /* quest files          */
+#define WORLD_IMAGE_FILE LIB_WORLD"world.img" /* compiled world, see world_image.c */
 
 #define CREDITS_FILE	LIB_TEXT"credits" /* for the 'credits' command	*/
 #define NEWS_FILE	LIB_TEXT"news"	/* for the 'news' command	*/
@@ -173,13 +174,16 @@ struct reset_com {
     *  'V': Assign a variable */
 };
 
+/* zone commands zone_update() may run in one pulse; see db.c */
+#define ZONE_RESET_BUDGET 500
+
 /* zone definition structure. for the 'zone-table'   */
 struct zone_data {
    char	*name;		    /* name of this zone                  */
    char *builders;          /* namelist of builders allowed to    */
                             /* modify this zone.		  */
    int	lifespan;           /* how long between resets (minutes)  */
-   int	age;                /* current age of this zone (minutes) */
+   int	age;                /* zedit's 'commands changed' flag     */
    room_vnum bot;           /* starting room number for this zone */
    room_vnum top;           /* upper limit for rooms in this zone */
 
@@ -191,24 +195,23 @@ struct zone_data {
    zone_vnum number;	    /* virtual number of this zone	  */
    struct reset_com *cmd;   /* command table for reset	          */
 
+   int num_players;         /* players in the zone, linked or not  */
+   int num_linkless;        /* of those, players without a link    */
+   int num_switched;        /* mobs in the zone someone switched into */
+
+   long last_reset;         /* pulse of the last reset             */
+   long reset_due;          /* pulse the next reset is queued for  */
+
+   bool dormant;            /* asleep, see dormancy.h              */
+   bool reset_missed;       /* a reset came due while asleep       */
+   time_t last_near;        /* last time a player was near         */
+
    /* Reset mode:
     *   0: Don't reset, and don't update age.
     *   1: Reset if no PC's are located in zone.
     *   2: Just reset. */
 };
 
-/* for queueing zones for update   */
-struct reset_q_element {
-   zone_rnum zone_to_reset;            /* ref to zone_data */
-   struct reset_q_element *next;
-};
-
-/* structure for the update queue     */
-struct reset_q_type {
-   struct reset_q_element *head;
-   struct reset_q_element *tail;
-};
-
 /* Added level, flags, and last, primarily for pfile autocleaning.  You can also
  * use them to keep online statistics, and add race, class, etc if you like. */
 struct player_index_element {
@@ -244,6 +247,11 @@ void  destroy_db(void);
 char *fread_action(FILE *fl, int nr);
 int   create_entry(char *name);
 void  zone_update(void);
+void  schedule_zone_reset(zone_rnum zone);
+void  schedule_zone_reset_at(zone_rnum zone, long due);
+void  reschedule_zone_resets(void);
+int   zone_age(zone_rnum zone);
+extern long zone_pulse;
 char  *fread_string(FILE *fl, const char *error);
 char  *fread_clean_string(FILE *fl, const char *error);
 int   fread_number(FILE *fp);
@@ -269,9 +277,13 @@ zone_rnum real_zone(zone_vnum vnum);
 room_rnum real_room(room_vnum vnum);
 mob_rnum real_mobile(mob_vnum vnum);
 obj_rnum real_object(obj_vnum vnum);
+void vnum_index_rebuild(int mode);
+void vnum_index_report(void);
 
 /* Public Procedures from objsave.c */
 void  Crash_save_all(void);
+extern long autosave_files_written;
+extern long autosave_files_skipped;
 void  Crash_idlesave(struct char_data *ch);
 void  Crash_crashsave(struct char_data *ch);
 int Crash_load(struct char_data *ch);
@@ -313,11 +325,17 @@ int    vnum_trig(char *, struct char_data *);
 
 void setup_dir(FILE *fl, int room, int dir);
 void index_boot(int mode);
-void discrete_load(FILE *fl, int mode, char *filename);
+struct toml_table_t;
+void discrete_load(struct toml_table_t *tab, int mode, char *filename);
+void parse_trigger_toml(struct toml_table_t *trig_tab);
+char **toml_load_index_files(const char *index_path, int *count);
 void parse_room(FILE *fl, int virtual_nr);
 void parse_mobile(FILE *mob_f, int nr);
 char *parse_object(FILE *obj_f, int nr);
 int is_empty(zone_rnum zone_nr);
+#ifdef CHECK_ZONE_OCCUPANCY
+void check_zone_occupancy(void);
+#endif
 void reset_zone(zone_rnum zone);
 void reboot_wizlists(void);
 ACMD(do_reboot);
@@ -364,7 +382,6 @@ extern struct config_data config_info;
 extern struct time_info_data time_info;
 extern struct weather_data weather_info;
 extern struct player_special_data dummy_mob;
-extern struct reset_q_type reset_q;
 
 extern struct room_data *world;
 extern room_rnum top_of_world;
@@ -390,6 +407,8 @@ extern struct shop_data *shop_index;
 extern int top_shop;
 
 extern struct index_data **trig_index;
+extern struct vnum_index trig_vnums;
+extern struct vnum_index quest_vnums;
 extern struct trig_data *trigger_list;
 extern int top_of_trigt;
 extern long max_mob_id;
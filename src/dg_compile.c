@@ -0,0 +1,269 @@
+/**
+* @file dg_compile.c
+* Compiles trigger command lists for the script driver.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* script_driver() used to classify every line of a trigger from its text
+* each time it ran, and rescan the command list with find_end(),
+* find_else_end(), find_case() and find_done() to match up blocks.  Here all
+* of that is done once, when the triggers are loaded or saved in trigedit,
+* and the result hung off each cmdlist_element.  What cannot be known until
+* run time - the if and case conditions, and the command when a variable
+* supplies it - is left for the driver.  The scans below mirror the ones in
+* dg_scripts.c line for line, including where they stop on malformed
+* scripts and the errors they log, so that a trigger behaves exactly as it
+* did before; src/tests/dg_corpus.toml checks this.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "dg_scripts.h"
+#include "utils.h"
+#include "db.h"
+
+/** Classifies a trigger line the way script_driver() always has.
+ * @param line The line.
+ * @param text Set to the line with leading spaces skipped.
+ * @retval int The DG_OP_* for the line. */
+int dg_line_op(char *line, char **text)
+{
+  char *p;
+
+  for (p = line; *p && isspace(*p); p++);
+  *text = p;
+
+  if (*p == '*')
+    return (DG_OP_COMMENT);
+  if (!strn_cmp(p, "if ", 3))
+    return (DG_OP_IF);
+  if (!strn_cmp("elseif ", p, 7) || !strn_cmp("else", p, 4))
+    return (DG_OP_ELSE);
+  if (!strn_cmp("while ", p, 6))
+    return (DG_OP_WHILE);
+  if (!strn_cmp("switch ", p, 7))
+    return (DG_OP_SWITCH);
+  if (!strn_cmp("end", p, 3))
+    return (DG_OP_END);
+  if (!strn_cmp("done", p, 4))
+    return (DG_OP_DONE);
+  if (!strn_cmp("break", p, 5))
+    return (DG_OP_BREAK);
+  if (!strn_cmp("case", p, 4))
+    return (DG_OP_CASE);
+  return (DG_OP_CMD);
+}
+
+/** Works out which script command a line runs, testing in the same order
+ * script_driver() always has.  No prefix is longer than 10 characters.
+ * @param cmd The line after var_subst().
+ * @retval int The DG_CMD_* for the line. */
+int dg_command_id(const char *cmd)
+{
+  if (!strn_cmp(cmd, "eval ", 5))      return (DG_CMD_EVAL);
+  if (!strn_cmp(cmd, "nop ", 4))       return (DG_CMD_NOP);
+  if (!strn_cmp(cmd, "extract ", 8))   return (DG_CMD_EXTRACT);
+  if (!strn_cmp(cmd, "dg_letter ", 10)) return (DG_CMD_LETTER);
+  if (!strn_cmp(cmd, "makeuid ", 8))   return (DG_CMD_MAKEUID);
+  if (!strn_cmp(cmd, "halt", 4))       return (DG_CMD_HALT);
+  if (!strn_cmp(cmd, "dg_cast ", 8))   return (DG_CMD_CAST);
+  if (!strn_cmp(cmd, "dg_affect ", 10)) return (DG_CMD_AFFECT);
+  if (!strn_cmp(cmd, "global ", 7))    return (DG_CMD_GLOBAL);
+  if (!strn_cmp(cmd, "context ", 8))   return (DG_CMD_CONTEXT);
+  if (!strn_cmp(cmd, "remote ", 7))    return (DG_CMD_REMOTE);
+  if (!strn_cmp(cmd, "rdelete ", 8))   return (DG_CMD_RDELETE);
+  if (!strn_cmp(cmd, "return ", 7))    return (DG_CMD_RETURN);
+  if (!strn_cmp(cmd, "set ", 4))       return (DG_CMD_SET);
+  if (!strn_cmp(cmd, "unset ", 6))     return (DG_CMD_UNSET);
+  if (!strn_cmp(cmd, "wait ", 5))      return (DG_CMD_WAIT);
+  if (!strn_cmp(cmd, "attach ", 7))    return (DG_CMD_ATTACH);
+  if (!strn_cmp(cmd, "detach ", 7))    return (DG_CMD_DETACH);
+  return (DG_CMD_OTHER);
+}
+
+/* Hands over the errors collected so far, leaving errors empty. */
+static char *take_errors(char *errors)
+{
+  char *saved;
+
+  if (!*errors)
+    return (NULL);
+  saved = strdup(errors);
+  *errors = '\0';
+  return (saved);
+}
+
+static void add_step(struct dg_line *code, int kind,
+                     struct cmdlist_element *line, char *arg, char *errors)
+{
+  struct dg_step *step;
+
+  RECREATE(code->steps, struct dg_step, code->num_steps + 1);
+  step = &code->steps[code->num_steps++];
+  step->kind = kind;
+  step->line = line;
+  step->arg = arg;
+  step->errors = take_errors(errors);
+}
+
+/* find_else_end(), recording where it would stop instead of evaluating. */
+static void compile_else_end(trig_data *trig, struct cmdlist_element *cl,
+                             struct dg_line *code, char *errors)
+{
+  struct cmdlist_element *c;
+  char *p;
+
+  if (!cl->next) {
+    add_step(code, DG_STEP_STOP, cl, NULL, errors);
+    return;
+  }
+
+  for (c = cl->next; c->next; c = c->next) {
+    for (p = c->cmd; *p && isspace(*p); p++);
+
+    if (!strn_cmp("if ", p, 3))
+      c = find_end(trig, c, errors);
+
+    else if (!strn_cmp("elseif ", p, 7))
+      add_step(code, DG_STEP_ELSEIF, c, p + 7, errors);
+
+    else if (!strn_cmp("else", p, 4)) {
+      add_step(code, DG_STEP_ELSE, c, NULL, errors);
+      return;
+    }
+
+    else if (!strn_cmp("end", p, 3)) {
+      add_step(code, DG_STEP_STOP, c, NULL, errors);
+      return;
+    }
+
+    if (!c->next) {
+      strcat(errors, "4");
+      add_step(code, DG_STEP_STOP, c, NULL, errors);
+      return;
+    }
+  }
+
+  for (p = c->cmd; *p && isspace(*p); p++);
+  if (strn_cmp("end", p, 3))
+    strcat(errors, "5");
+  add_step(code, DG_STEP_STOP, c, NULL, errors);
+}
+
+/* find_case(), recording the case values instead of comparing them. */
+static void compile_case(struct cmdlist_element *cl, struct dg_line *code,
+                         char *errors)
+{
+  struct cmdlist_element *c, *last = cl;
+  char *p;
+
+  if (!cl->next) {
+    add_step(code, DG_STEP_STOP, cl, NULL, errors);
+    return;
+  }
+
+  for (c = cl->next; c && c->next; c = c->next) {
+    for (p = c->cmd; *p && isspace(*p); p++);
+
+    if (!strn_cmp("while ", p, 6) || !strn_cmp("switch", p, 6))
+      c = find_done(c);
+    else if (!strn_cmp("case ", p, 5))
+      add_step(code, DG_STEP_CASE, c, p + 5, errors);
+    else if (!strn_cmp("default", p, 7) || !strn_cmp("done", p, 3)) {
+      add_step(code, DG_STEP_STOP, c, NULL, errors);
+      return;
+    }
+    last = c;
+  }
+  /* A while or switch without a done as the last block ran find_case() off
+   * the end of the list; stop on the last line instead. */
+  add_step(code, DG_STEP_STOP, c ? c : last, NULL, errors);
+}
+
+/** Compiles a trigger's command list, if that has not been done already.
+ * The compiled lines are shared by every trigger using the list.
+ * @param trig The trigger (usually the prototype) holding the list. */
+void dg_compile_cmdlist(trig_data *trig)
+{
+  struct cmdlist_element *cl;
+  struct dg_line *code;
+  char *errors, *pct;
+  int lines = 0;
+
+  if (!trig->cmdlist || trig->cmdlist->code)
+    return;
+
+  /* Each line can add at most one error to a scan. */
+  for (cl = trig->cmdlist; cl; cl = cl->next)
+    lines++;
+  CREATE(errors, char, lines + 2);
+
+  for (cl = trig->cmdlist; cl; cl = cl->next) {
+    CREATE(code, struct dg_line, 1);
+    code->op = dg_line_op(cl->cmd, &code->text);
+
+    switch (code->op) {
+      case DG_OP_IF:
+        compile_else_end(trig, cl, code, errors);
+        break;
+      case DG_OP_ELSE:
+        code->end = find_end(trig, cl, errors);
+        code->end_errors = take_errors(errors);
+        break;
+      case DG_OP_WHILE:
+      case DG_OP_BREAK:
+        code->done = find_done(cl);
+        break;
+      case DG_OP_SWITCH:
+        compile_case(cl, code, errors);
+        break;
+      case DG_OP_CMD:
+        /* var_subst() copies everything before the first % unchanged, so
+         * the command is fixed if no variable starts in its first 10
+         * characters. */
+        pct = strchr(code->text, '%');
+        code->literal = (pct == NULL);
+        code->cmd = (!pct || pct - code->text >= 10) ? dg_command_id(code->text) : DG_CMD_UNKNOWN;
+        break;
+    }
+    cl->code = code;
+  }
+  free(errors);
+}
+
+/** Compiles every trigger prototype.  Called once the triggers are loaded. */
+void dg_compile_all(void)
+{
+  int i;
+
+  for (i = 0; i < top_of_trigt; i++)
+    if (trig_index[i]->proto)
+      dg_compile_cmdlist(trig_index[i]->proto);
+}
+
+/** Frees a command list and its compiled form. */
+void free_cmdlist(struct cmdlist_element *cl)
+{
+  struct cmdlist_element *next;
+  int i;
+
+  for (; cl; cl = next) {
+    next = cl->next;
+    if (cl->code) {
+      for (i = 0; i < cl->code->num_steps; i++)
+        if (cl->code->steps[i].errors)
+          free(cl->code->steps[i].errors);
+      if (cl->code->steps)
+        free(cl->code->steps);
+      if (cl->code->end_errors)
+        free(cl->code->end_errors);
+      free(cl->code);
+    }
+    if (cl->cmd)
+      free(cl->cmd);
+    free(cl);
+  }
+}
@@ -202,6 +202,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
         if (!(room->script))
           CREATE(room->script, struct script_data, 1);
         add_trigger(SCRIPT(room), read_trigger(rnum), -1);
+        triggers_attached(room, WLD_TRIGGER);
       } else {
         mudlog(BRF, LVL_BUILDER, TRUE,
                "SYSERR: non-existant trigger #%d assigned to room #%d",
@@ -275,6 +276,7 @@ void assign_triggers(void *i, int type)
         }
         trg_proto = trg_proto->next;
       }
+      triggers_attached(mob, MOB_TRIGGER);
       break;
     case OBJ_TRIGGER:
       obj = (obj_data *)i;
@@ -291,6 +293,7 @@ void assign_triggers(void *i, int type)
         }
         trg_proto = trg_proto->next;
       }
+      triggers_attached(obj, OBJ_TRIGGER);
       break;
     case WLD_TRIGGER:
       room = (struct room_data *)i;
@@ -308,6 +311,7 @@ void assign_triggers(void *i, int type)
         }
         trg_proto = trg_proto->next;
       }
+      triggers_attached(room, WLD_TRIGGER);
       break;
     default:
       mudlog(BRF, LVL_BUILDER, TRUE,
@@ -0,0 +1,342 @@
+/**
+* @file dg_eval.c
+* Evaluates the expressions in DG script if, while, switch and eval lines.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* These functions used to live in dg_scripts.c and passed every value
+* around as text: each operator parsed its operands with is_num() and
+* atoi() and printed its answer with sprintf(), only for the next operator
+* up to parse it again.  Every operator's answer is a number, so it is now
+* kept as one, and text is only made from it when a string operator or the
+* caller needs it.  The answers, as text, are exactly what they were; the
+* old evaluator is kept in tests/bench_dg_eval.c to check this.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "dg_scripts.h"
+#include "utils.h"
+#include "interpreter.h"
+
+/* The operators, in order of priority.  op_at() must agree. */
+enum {
+  OP_OR, OP_AND, OP_EQ, OP_NE, OP_LE, OP_GE, OP_LT, OP_GT, OP_CONTAINS,
+  OP_SUB, OP_ADD, OP_DIV, OP_MUL, OP_NOT, NUM_EVAL_OPS
+};
+
+static const char *eval_ops[NUM_EVAL_OPS] = {
+  "||", "&&", "==", "!=", "<=", ">=", "<", ">", "/=", "-", "+", "/", "*", "!"
+};
+
+/* A value met while evaluating: the number an operator came up with, or the
+ * text of a variable substitution, which is only read as a number if an
+ * operator needs it to be. */
+struct eval_value {
+  bool is_int;
+  int num;
+  char *text;                   /* NULL until needed, for a number */
+  char buf[MAX_INPUT_LENGTH];
+};
+
+static void eval_value(char *line, struct eval_value *v, void *go,
+          struct script_data *sc, trig_data *trig, int type);
+
+/* Returns 1 if string is all digits, else 0. Bugfixed - would have returned
+ * true on num="------". */
+static int is_num(char *arg)
+{
+   if (*arg == '\0')
+      return FALSE;
+
+   if (*arg == '+' || *arg == '-')
+      arg++;
+
+   for (; *arg != '\0'; arg++)
+   {
+      if (!isdigit(*arg))
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+static void set_text(struct eval_value *v, char *text)
+{
+  v->is_int = FALSE;
+  v->text = text;
+}
+
+static char *value_text(struct eval_value *v)
+{
+  if (!v->text) {
+    snprintf(v->buf, sizeof(v->buf), "%d", v->num);
+    v->text = v->buf;
+  }
+  return (v->text);
+}
+
+static bool value_is_num(struct eval_value *v)
+{
+  return (v->is_int || is_num(v->text));
+}
+
+static int value_num(struct eval_value *v)
+{
+  return (v->is_int ? v->num : atoi(v->text));
+}
+
+/* What || and && take as true: anything but "", or text starting with 0. */
+static bool value_true(struct eval_value *v)
+{
+  if (v->is_int)
+    return (v->num != 0);
+  return (*v->text && *v->text != '0');
+}
+
+/* strip off extra spaces at begin and end */
+static void strip_value(struct eval_value *v)
+{
+  char *p;
+
+  if (v->is_int)
+    return;
+
+  while (*v->text && isspace(*v->text))
+    v->text++;
+
+  for (p = v->text; *p; p++);
+  while (p > v->text && isspace(*(p - 1)))
+    *--p = '\0';
+}
+
+/* evaluates 'lhs op rhs' */
+static int eval_op(int op, struct eval_value *lhs, struct eval_value *rhs)
+{
+  bool nums;
+  int n;
+
+  strip_value(lhs);
+  strip_value(rhs);
+
+  /* find the op, and figure out the value */
+  switch (op) {
+    case OP_OR:
+      return (value_true(lhs) || value_true(rhs));
+
+    case OP_AND:
+      return (value_true(lhs) && value_true(rhs));
+
+    case OP_CONTAINS:
+      return (str_str(value_text(lhs), value_text(rhs)) ? 1 : 0);
+
+    case OP_MUL:
+      return (value_num(lhs) * value_num(rhs));
+
+    case OP_DIV:
+      return ((n = value_num(rhs)) ? (value_num(lhs) / n) : 0);
+
+    case OP_ADD:
+      return (value_num(lhs) + value_num(rhs));
+
+    case OP_SUB:
+      return (value_num(lhs) - value_num(rhs));
+
+    case OP_NOT:
+      if (value_is_num(rhs))
+        return (!value_num(rhs));
+      return (!*rhs->text);
+  }
+
+  /* The comparisons are numeric if both sides are numbers, else they
+   * compare the text. */
+  nums = value_is_num(lhs) && value_is_num(rhs);
+
+  switch (op) {
+    case OP_EQ:
+      return (nums ? value_num(lhs) == value_num(rhs) : !str_cmp(value_text(lhs), value_text(rhs)));
+    case OP_NE:
+      return (nums ? value_num(lhs) != value_num(rhs) : str_cmp(value_text(lhs), value_text(rhs)));
+    case OP_LE:
+      return (nums ? value_num(lhs) <= value_num(rhs) : str_cmp(value_text(lhs), value_text(rhs)) <= 0);
+    case OP_GE:
+      /* <= on text is how it has always been. */
+      return (nums ? value_num(lhs) >= value_num(rhs) : str_cmp(value_text(lhs), value_text(rhs)) <= 0);
+    case OP_LT:
+      return (nums ? value_num(lhs) < value_num(rhs) : str_cmp(value_text(lhs), value_text(rhs)) < 0);
+    case OP_GT:
+      return (nums ? value_num(lhs) > value_num(rhs) : str_cmp(value_text(lhs), value_text(rhs)) > 0);
+  }
+  return (0);
+}
+
+/* p points to the first quote, returns the matching end quote, or the last
+ * non-null char in p.*/
+char *matching_quote(char *p)
+{
+  for (p++; *p && (*p != '"'); p++) {
+    if (*p == '\\')
+      p++;
+  }
+
+  if (!*p)
+    p--;
+
+  return p;
+}
+
+/* p points to the first paren.  returns a pointer to the matching closing
+ * paren, or the last non-null char in p. */
+static char *matching_paren(char *p)
+{
+  int i;
+
+  for (p++, i = 1; *p && i; p++) {
+    if (*p == '(')
+      i++;
+    else if (*p == ')')
+      i--;
+    else if (*p == '"')
+      p = matching_quote(p);
+  }
+
+  return --p;
+}
+
+/* The highest priority operator p starts with, or -1. */
+static int op_at(const char *p)
+{
+  switch (*p) {
+    case '|': return (p[1] == '|' ? OP_OR : -1);
+    case '&': return (p[1] == '&' ? OP_AND : -1);
+    case '=': return (p[1] == '=' ? OP_EQ : -1);
+    case '!': return (p[1] == '=' ? OP_NE : OP_NOT);
+    case '<': return (p[1] == '=' ? OP_LE : OP_LT);
+    case '>': return (p[1] == '=' ? OP_GE : OP_GT);
+    case '/': return (p[1] == '=' ? OP_CONTAINS : OP_DIV);
+    case '-': return (OP_SUB);
+    case '+': return (OP_ADD);
+    case '*': return (OP_MUL);
+  }
+  return (-1);
+}
+
+/* Evaluates expr if it is in the form lhs op rhs, and puts the answer in v.
+ * Returns 1 if expr is evaluated, else 0. */
+static int eval_lhs_op_rhs(char *expr, struct eval_value *v, void *go,
+          struct script_data *sc, trig_data *trig, int type)
+{
+  char *p, *split = NULL;
+  char line[MAX_INPUT_LENGTH];
+  struct eval_value lhs, rhs;
+  int op, best = NUM_EVAL_OPS;
+
+  p = strcpy(line, expr);
+
+  /* Walk the places in line where an op could occur - skipping over
+   * parentheses, quotes and words - and split at the first of the highest
+   * priority op found. */
+  while (*p) {
+    if ((op = op_at(p)) >= 0 && op < best) {
+      best = op;
+      split = p;
+    }
+    if (*p == '(')
+      p = matching_paren(p) + 1;
+    else if (*p == '"')
+      p = matching_quote(p) + 1;
+    else if (isalnum(*p))
+      for (p++; *p && (isalnum(*p) || isspace(*p)); p++);
+    else
+      p++;
+  }
+
+  if (!split)
+    return 0;
+
+  *split = '\0';
+  p = split + strlen(eval_ops[best]);
+
+  eval_value(line, &lhs, go, sc, trig, type);
+  eval_value(p, &rhs, go, sc, trig, type);
+  v->num = eval_op(best, &lhs, &rhs);
+  v->is_int = TRUE;
+  v->text = NULL;
+
+  return 1;
+}
+
+/* evaluates line, and puts the answer in v */
+static void eval_value(char *line, struct eval_value *v, void *go,
+          struct script_data *sc, trig_data *trig, int type)
+{
+  char expr[MAX_INPUT_LENGTH], *p;
+
+  while (*line && isspace(*line))
+    line++;
+
+  if (eval_lhs_op_rhs(line, v, go, sc, trig, type));
+
+  else if (*line == '(') {
+    strcpy(expr, line);
+    p = matching_paren(expr);
+    *p = '\0';
+    eval_value(expr + 1, v, go, sc, trig, type);
+  }
+
+  else {
+    var_subst(go, sc, trig, type, line, v->buf);
+    set_text(v, v->buf);
+  }
+}
+
+/** Evaluates an expression.
+ * @param line The expression.
+ * @param result Set to the answer, as text; MAX_INPUT_LENGTH long. */
+void eval_expr(char *line, char *result, void *go, struct script_data *sc,
+               trig_data *trig, int type)
+{
+  struct eval_value v;
+
+  eval_value(line, &v, go, sc, trig, type);
+  if (v.is_int)
+    sprintf(result, "%d", v.num);
+  else
+    strcpy(result, v.text);
+}
+
+/* returns 1 if cond is true, else 0 */
+int process_if(char *cond, void *go, struct script_data *sc,
+               trig_data *trig, int type)
+{
+  struct eval_value v;
+  char *p;
+
+  eval_value(cond, &v, go, sc, trig, type);
+
+  if (v.is_int)
+    return (v.num != 0);
+
+  p = v.text;
+  skip_spaces(&p);
+
+  if (!*p || *p == '0')
+    return 0;
+  else
+    return 1;
+}
+
+/** Tests a switch value against a case, as '==' would.  Both may have
+ * trailing spaces stripped.
+ * @retval int 1 if they match, else 0. */
+int eval_case(char *value, char *arg)
+{
+  struct eval_value lhs, rhs;
+
+  set_text(&lhs, value);
+  set_text(&rhs, arg);
+  return (eval_op(OP_EQ, &lhs, &rhs) != 0);
+}
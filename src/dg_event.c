@@ -173,14 +173,147 @@ int event_is_queued(struct event *event)
 /***************************************************************************
  * Begin generic (abstract) priority queue functions
  **************************************************************************/
+/** Number of q_elements carved out of each pool allocation. */
+#define Q_POOL_SIZE 1024
+
+/** A block of q_elements, so that enqueueing doesn't cost a calloc. */
+struct q_pool {
+  struct q_pool *next;
+  struct q_element elements[Q_POOL_SIZE];
+};
+
+static void q_list_init(struct q_element *head)
+{
+  head->next = head->prev = head;
+}
+
+static void q_push_front(struct q_element *head, struct q_element *qe)
+{
+  qe->prev = head;
+  qe->next = head->next;
+  head->next->prev = qe;
+  head->next = qe;
+}
+
+static void q_push_back(struct q_element *head, struct q_element *qe)
+{
+  qe->next = head;
+  qe->prev = head->prev;
+  head->prev->next = qe;
+  head->prev = qe;
+}
+
+static void q_unlink(struct q_element *qe)
+{
+  qe->prev->next = qe->next;
+  qe->next->prev = qe->prev;
+  qe->next = qe->prev = NULL;
+}
+
+static struct q_element *q_alloc(struct dg_queue *q)
+{
+  struct q_element *qe;
+  struct q_pool *pool;
+  int i;
+
+  if (!q->free_elements) {
+    CREATE(pool, struct q_pool, 1);
+    pool->next = q->pools;
+    q->pools = pool;
+    for (i = Q_POOL_SIZE - 1; i >= 0; i--) {
+      pool->elements[i].next = q->free_elements;
+      q->free_elements = &pool->elements[i];
+    }
+  }
+
+  qe = q->free_elements;
+  q->free_elements = qe->next;
+  return qe;
+}
+
+/** Find the list an element with this key belongs on, relative to the
+ * wheel position q->now. */
+static struct q_element *q_slot(struct dg_queue *q, long key)
+{
+  long delta = key - q->now;
+  int lvl, shift;
+
+  if (delta <= 0)
+    return &q->due;
+  if (delta < Q_WHEEL_SIZE)
+    return &q->wheel[key & Q_WHEEL_MASK];
+
+  for (lvl = 0; lvl < Q_NUM_LEVELS; lvl++) {
+    shift = Q_WHEEL_BITS + lvl * Q_LEVEL_BITS;
+    if (delta < (1L << (shift + Q_LEVEL_BITS)))
+      return &q->level[lvl][(key >> shift) & Q_LEVEL_MASK];
+  }
+  return &q->overflow;
+}
+
+/** Move everything on one list down to where it now belongs. Elements on a
+ * coarser list are always older than those already placed below, so they
+ * go to the back; this keeps the firing order of the old sorted lists. */
+static void q_cascade(struct dg_queue *q, struct q_element *head)
+{
+  struct q_element *qe = head->next, *next_qe;
+
+  q_list_init(head);
+  for (; qe != head; qe = next_qe) {
+    next_qe = qe->next;
+    q_push_back(q_slot(q, qe->key), qe);
+  }
+}
+
+/** Turn the wheel up to 'when', stopping early if something expires. */
+static void q_advance(struct dg_queue *q, long when)
+{
+  struct q_element *slot;
+  int lvl, idx;
+
+  /* Nothing queued: just jump. */
+  if (q->count == 0 && q->now < when)
+    q->now = when;
+
+  while (q->due.next == &q->due && q->now < when) {
+    q->now++;
+
+    /* This pulse's slot first: anything cascading down to it now is older. */
+    slot = &q->wheel[q->now & Q_WHEEL_MASK];
+    if (slot->next != slot)
+      q_cascade(q, slot);
+
+    if (!(q->now & Q_WHEEL_MASK)) {
+      for (lvl = 0; lvl < Q_NUM_LEVELS; lvl++) {
+        idx = (q->now >> (Q_WHEEL_BITS + lvl * Q_LEVEL_BITS)) & Q_LEVEL_MASK;
+        q_cascade(q, &q->level[lvl][idx]);
+        if (idx)
+          break;
+      }
+      if (lvl == Q_NUM_LEVELS)
+        q_cascade(q, &q->overflow);
+    }
+  }
+}
+
 /** Create a new, empty, priority queue and return it.
  * @retval dg_queue * Pointer to the newly created queue structure. */
 struct dg_queue *queue_init(void)
 {
   struct dg_queue *q;
+  int i, j;
 
   CREATE(q, struct dg_queue, 1);
 
+  for (i = 0; i < Q_WHEEL_SIZE; i++)
+    q_list_init(&q->wheel[i]);
+  for (i = 0; i < Q_NUM_LEVELS; i++)
+    for (j = 0; j < Q_LEVEL_SIZE; j++)
+      q_list_init(&q->level[i][j]);
+  q_list_init(&q->overflow);
+  q_list_init(&q->due);
+  q->now = pulse;
+
   return q;
 }
 
@@ -196,77 +329,39 @@ struct dg_queue *queue_init(void)
  * the data. */
 struct q_element *queue_enq(struct dg_queue *q, void *data, long key)
 {
-  struct q_element *qe, *i;
-  int bucket;
+  struct q_element *qe;
 
-  CREATE(qe, struct q_element, 1);
+  qe = q_alloc(q);
   qe->data = data;
   qe->key = key;
 
-  bucket = key % NUM_EVENT_QUEUES;   /* which queue does this go in */
-
-  if (!q->head[bucket]) { /* queue is empty */
-    q->head[bucket] = qe;
-    q->tail[bucket] = qe;
-  }
-
-  else {
-    for (i = q->tail[bucket]; i; i = i->prev) {
-
-      if (i->key < key) { /* found insertion point */
-	if (i == q->tail[bucket])
-	  q->tail[bucket] = qe;
-	else {
-	  qe->next = i->next;
-	  i->next->prev = qe;
-	}
-
-	qe->prev = i;
-	i->next = qe;
-	break;
-      }
-    }
-
-    if (i == NULL) { /* insertion point is front of list */
-      qe->next = q->head[bucket];
-      q->head[bucket] = qe;
-      qe->next->prev = qe;
-    }
-  }
+  /* Equal keys fire newest first, as they always have. */
+  q_push_front(q_slot(q, key), qe);
+  q->count++;
 
   return qe;
 }
 
 /** Remove queue element qe from the priority queue q.
  * @pre qe->data has been dealt with in some way.
- * @post qe has been freed. 
+ * @post qe has been returned to the pool. 
  * @param q Pointer to the queue containing qe.
  * @param qe Pointer to the q_element to remove from q.
  */
 void queue_deq(struct dg_queue *q, struct q_element *qe)
 {
-  int i;
-
   assert(qe);
 
-  i = qe->key % NUM_EVENT_QUEUES;
-
-  if (qe->prev == NULL)
-    q->head[i] = qe->next;
-  else
-    qe->prev->next = qe->next;
-
-  if (qe->next == NULL)
-    q->tail[i] = qe->prev;
-  else
-    qe->next->prev = qe->prev;
-
-  free(qe);
+  q_unlink(qe);
+  qe->data = NULL;
+  qe->next = q->free_elements;
+  q->free_elements = qe;
+  q->count--;
 }
 
 /** Removes and returns the data of the first element of the priority queue q. 
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse.
+ * @pre pulse must be defined. The wheel is turned up to the current pulse
+ * before looking for expired elements.
  * @post the q->head is dequeued. 
  * @param q The queue to return the head of.
  * @retval void * NULL if there is not a currently available head, pointer
@@ -274,32 +369,29 @@ void queue_deq(struct dg_queue *q, struct q_element *qe)
 void *queue_head(struct dg_queue *q)
 {
   void *dg_data;
-  int i;
 
-  i = pulse % NUM_EVENT_QUEUES;
+  q_advance(q, pulse);
 
-  if (!q->head[i])
+  if (q->due.next == &q->due)
     return NULL;
 
-  dg_data = q->head[i]->data;
-  queue_deq(q, q->head[i]);
+  dg_data = q->due.next->data;
+  queue_deq(q, q->due.next);
   return dg_data;
 }
 
 /** Returns the key of the head element of the priority queue.
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse. 
+ * @pre pulse must be defined. The wheel is turned up to the current pulse
+ * before looking for expired elements.
  * @param q Queue to check for.
  * @retval long Return the key element of the head q_element. If no head
  * q_element is available, return LONG_MAX. */
 long queue_key(struct dg_queue *q)
 {
-  int i;
-
-  i = pulse % NUM_EVENT_QUEUES;
+  q_advance(q, pulse);
 
-  if (q->head[i])
-    return q->head[i]->key;
+  if (q->due.next != &q->due)
+    return q->due.next->key;
   else
     return LONG_MAX;
 }
@@ -312,6 +404,22 @@ long queue_elmt_key(struct q_element *qe)
   return qe->key;
 }
 
+/* Free every event on one list of the queue. */
+static void q_free_list(struct q_element *head)
+{
+  struct q_element *qe;
+  struct event *event;
+
+  for (qe = head->next; qe != head; qe = qe->next) {
+    if ((event = (struct event *) qe->data) != NULL) {
+      if (event->event_obj)
+        cleanup_event_obj(event);
+
+      free(event);
+    }
+  }
+}
+
 /** Free q and all contents.
  * @pre Function requires definition of struct event.
  * @post All items associeated qith q, including non-abstract data, are freed.
@@ -319,26 +427,21 @@ long queue_elmt_key(struct q_element *qe)
  */
 void queue_free(struct dg_queue *q)
 {
-  int i;
-  struct q_element *qe, *next_qe;
-  struct event *event;
-
-  for (i = 0; i < NUM_EVENT_QUEUES; i++)
-  {
-    for (qe = q->head[i]; qe; qe = next_qe) 
-    {
-      next_qe = qe->next;
-      if ((event = (struct event *) qe->data) != NULL) 
-      {
-        if (event->event_obj)
-          cleanup_event_obj(event);
-
-        free(event);
-      }
-      free(qe);
-    }
+  struct q_pool *pool, *next_pool;
+  int i, j;
+
+  q_free_list(&q->due);
+  for (i = 0; i < Q_WHEEL_SIZE; i++)
+    q_free_list(&q->wheel[i]);
+  for (i = 0; i < Q_NUM_LEVELS; i++)
+    for (j = 0; j < Q_LEVEL_SIZE; j++)
+      q_free_list(&q->level[i][j]);
+  q_free_list(&q->overflow);
+
+  for (pool = q->pools; pool; pool = next_pool) {
+    next_pool = pool->next;
+    free(pool);
   }
 
   free(q);
 }
-
@@ -42,21 +42,40 @@ struct event {
 /**************************************************************************
  * Begin priority queue structures and defines.
  **************************************************************************/
-/** Number of buckets available in each queue. Reduces enqueue cost. */
-#define NUM_EVENT_QUEUES    10
+/* The queue is a hierarchical timing wheel. Level 0 has one slot per pulse
+ * for the next Q_WHEEL_SIZE pulses; each upper level covers Q_LEVEL_SIZE
+ * times the span of the one below it and is cascaded down as the wheel
+ * turns. Anything further out waits on an overflow list. Enqueue, dequeue
+ * and expiry are all O(1). */
+#define Q_WHEEL_BITS  8                       /**< log2 of level 0 slots */
+#define Q_WHEEL_SIZE  (1 << Q_WHEEL_BITS)     /**< 256 pulses */
+#define Q_WHEEL_MASK  (Q_WHEEL_SIZE - 1)
+#define Q_LEVEL_BITS  6                       /**< log2 of upper level slots */
+#define Q_LEVEL_SIZE  (1 << Q_LEVEL_BITS)
+#define Q_LEVEL_MASK  (Q_LEVEL_SIZE - 1)
+#define Q_NUM_LEVELS  3   /**< Upper levels; together about 77 days of pulses. */
 
-/** The priority queue. */
-struct dg_queue {
-  struct q_element *head[NUM_EVENT_QUEUES]; /**< Front of each queue bucket. */
-  struct q_element *tail[NUM_EVENT_QUEUES]; /**< Rear of each queue bucket. */
-};
-
-/** Queued elements. */
+/** Queued elements. Each wheel slot is a circular list headed by a sentinel
+ * q_element, so an element can unlink itself without knowing its slot. */
 struct q_element {
   void *data;  /**< The event to be handled. */
   long key;    /**< When the event should be handled. */
   struct q_element *prev, *next; /**< Points to other q_elements in line. */
 };
+
+struct q_pool;
+
+/** The priority queue. */
+struct dg_queue {
+  struct q_element wheel[Q_WHEEL_SIZE];                /**< Level 0, one pulse per slot. */
+  struct q_element level[Q_NUM_LEVELS][Q_LEVEL_SIZE];  /**< Coarser levels. */
+  struct q_element overflow; /**< Beyond the top level. */
+  struct q_element due;      /**< Expired, waiting for queue_head(). */
+  long now;                  /**< Pulse the wheel has been turned to. */
+  long count;                /**< Number of queued elements. */
+  struct q_element *free_elements; /**< Recycled elements. */
+  struct q_pool *pools;      /**< Blocks the elements are carved from. */
+};
 /**************************************************************************
  * End priority queue structures and defines.
  **************************************************************************/
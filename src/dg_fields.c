@@ -0,0 +1,256 @@
+/**
+* @file dg_fields.c
+* Perfect hash tables for the variable and field names of DG scripts.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* find_replacement() used to find out which field a script wanted by
+* comparing the name against each field it knows in turn.  Each table here
+* is instead hashed, on first use, with a table size and seed picked so
+* that no two names land in the same slot; a lookup is then one hash and
+* one str_cmp() however many fields there are.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "dg_fields.h"
+
+struct dg_field {
+  const char *name;
+  int id;
+};
+
+static const struct dg_field var_fields[] = {
+  { "self", DG_VAR_SELF },
+  { "global", DG_VAR_GLOBAL },
+  { "door", DG_VAR_DOOR },
+  { "force", DG_VAR_FORCE },
+  { "load", DG_VAR_LOAD },
+  { "purge", DG_VAR_PURGE },
+  { "teleport", DG_VAR_TELEPORT },
+  { "damage", DG_VAR_DAMAGE },
+  { "send", DG_VAR_SEND },
+  { "echo", DG_VAR_ECHO },
+  { "echoaround", DG_VAR_ECHOAROUND },
+  { "zoneecho", DG_VAR_ZONEECHO },
+  { "asound", DG_VAR_ASOUND },
+  { "at", DG_VAR_AT },
+  { "transform", DG_VAR_TRANSFORM },
+  { "recho", DG_VAR_RECHO },
+  { "move", DG_VAR_MOVE },
+  { "log", DG_VAR_LOG },
+  { "people", DG_VAR_PEOPLE },
+  { "time", DG_VAR_TIME },
+  { "findmob", DG_VAR_FINDMOB },
+  { "findobj", DG_VAR_FINDOBJ },
+  { "random", DG_VAR_RANDOM },
+  { NULL, DG_FIELD_NONE }
+};
+
+static const struct dg_field text_fields[] = {
+  { "strlen", DG_TEXT_STRLEN },
+  { "toupper", DG_TEXT_TOUPPER },
+  { "trim", DG_TEXT_TRIM },
+  { "contains", DG_TEXT_CONTAINS },
+  { "car", DG_TEXT_CAR },
+  { "cdr", DG_TEXT_CDR },
+  { "charat", DG_TEXT_CHARAT },
+  { "mudcommand", DG_TEXT_MUDCOMMAND },
+  { NULL, DG_FIELD_NONE }
+};
+
+static const struct dg_field char_fields[] = {
+  { "global", DG_CHAR_GLOBAL },
+  { "affect", DG_CHAR_AFFECT },
+  { "alias", DG_CHAR_ALIAS },
+  { "align", DG_CHAR_ALIGN },
+  { "armor", DG_CHAR_ARMOR },
+  { "canbeseen", DG_CHAR_CANBESEEN },
+  { "cha", DG_CHAR_CHA },
+  { "class", DG_CHAR_CLASS },
+  { "con", DG_CHAR_CON },
+  { "dex", DG_CHAR_DEX },
+  { "drunk", DG_CHAR_DRUNK },
+  { "eq", DG_CHAR_EQ },
+  { "exp", DG_CHAR_EXP },
+  { "fighting", DG_CHAR_FIGHTING },
+  { "follower", DG_CHAR_FOLLOWER },
+  { "coins", DG_CHAR_COINS },
+  { "has_item", DG_CHAR_HAS_ITEM },
+  { "hasattached", DG_CHAR_HASATTACHED },
+  { "heshe", DG_CHAR_HESHE },
+  { "himher", DG_CHAR_HIMHER },
+  { "hisher", DG_CHAR_HISHER },
+  { "hitp", DG_CHAR_HITP },
+  { "hunger", DG_CHAR_HUNGER },
+  { "id", DG_CHAR_ID },
+  { "is_pc", DG_CHAR_IS_PC },
+  { "int", DG_CHAR_INT },
+  { "inventory", DG_CHAR_INVENTORY },
+  { "level", DG_CHAR_LEVEL },
+  { "mana", DG_CHAR_MANA },
+  { "master", DG_CHAR_MASTER },
+  { "maxhitp", DG_CHAR_MAXHITP },
+  { "maxmana", DG_CHAR_MAXMANA },
+  { "maxmove", DG_CHAR_MAXMOVE },
+  { "maxstamina", DG_CHAR_MAXSTAMINA },
+  { "move", DG_CHAR_MOVE },
+  { "stamina", DG_CHAR_STAMINA },
+  { "name", DG_CHAR_NAME },
+  { "next_in_room", DG_CHAR_NEXT_IN_ROOM },
+  { "npcflag", DG_CHAR_NPCFLAG },
+  { "pos", DG_CHAR_POS },
+  { "pref", DG_CHAR_PREF },
+  { "questpoints", DG_CHAR_QUESTPOINTS },
+  { "qp", DG_CHAR_QP },
+  { "qpnts", DG_CHAR_QPNTS },
+  { "quest", DG_CHAR_QUEST },
+  { "questdone", DG_CHAR_QUESTDONE },
+  { "room", DG_CHAR_ROOM },
+  { "save_str", DG_CHAR_SAVE_STR },
+  { "save_dex", DG_CHAR_SAVE_DEX },
+  { "save_con", DG_CHAR_SAVE_CON },
+  { "save_int", DG_CHAR_SAVE_INT },
+  { "save_wis", DG_CHAR_SAVE_WIS },
+  { "save_cha", DG_CHAR_SAVE_CHA },
+  { "sex", DG_CHAR_SEX },
+  { "skill", DG_CHAR_SKILL },
+  { "str", DG_CHAR_STR },
+  { "thirst", DG_CHAR_THIRST },
+  { "varexists", DG_CHAR_VAREXISTS },
+  { "vnum", DG_CHAR_VNUM },
+  { "weight", DG_CHAR_WEIGHT },
+  { "wis", DG_CHAR_WIS },
+  { "wait", DG_CHAR_WAIT },
+  { NULL, DG_FIELD_NONE }
+};
+
+static const struct dg_field obj_fields[] = {
+  { "affects", DG_OBJ_AFFECTS },
+  { "cost", DG_OBJ_COST },
+  { "carried_by", DG_OBJ_CARRIED_BY },
+  { "contents", DG_OBJ_CONTENTS },
+  { "count", DG_OBJ_COUNT },
+  { "extra", DG_OBJ_EXTRA },
+  { "has_in", DG_OBJ_HAS_IN },
+  { "hasattached", DG_OBJ_HASATTACHED },
+  { "id", DG_OBJ_ID },
+  { "is_inroom", DG_OBJ_IS_INROOM },
+  { "is_pc", DG_OBJ_IS_PC },
+  { "name", DG_OBJ_NAME },
+  { "next_in_list", DG_OBJ_NEXT_IN_LIST },
+  { "oset", DG_OBJ_OSET },
+  { "room", DG_OBJ_ROOM },
+  { "shortdesc", DG_OBJ_SHORTDESC },
+  { "type", DG_OBJ_TYPE },
+  { "timer", DG_OBJ_TIMER },
+  { "vnum", DG_OBJ_VNUM },
+  { "val0", DG_OBJ_VAL0 },
+  { "val1", DG_OBJ_VAL1 },
+  { "val2", DG_OBJ_VAL2 },
+  { "val3", DG_OBJ_VAL3 },
+  { "wearflag", DG_OBJ_WEARFLAG },
+  { "weight", DG_OBJ_WEIGHT },
+  { "worn_by", DG_OBJ_WORN_BY },
+  { NULL, DG_FIELD_NONE }
+};
+
+static const struct dg_field room_fields[] = {
+  { "name", DG_ROOM_NAME },
+  { "sector", DG_ROOM_SECTOR },
+  { "vnum", DG_ROOM_VNUM },
+  { "contents", DG_ROOM_CONTENTS },
+  { "people", DG_ROOM_PEOPLE },
+  { "id", DG_ROOM_ID },
+  { "weather", DG_ROOM_WEATHER },
+  { "hasattached", DG_ROOM_HASATTACHED },
+  { "zonenumber", DG_ROOM_ZONENUMBER },
+  { "zonename", DG_ROOM_ZONENAME },
+  { "roomflag", DG_ROOM_ROOMFLAG },
+  { "north", DG_ROOM_NORTH },
+  { "east", DG_ROOM_EAST },
+  { "south", DG_ROOM_SOUTH },
+  { "west", DG_ROOM_WEST },
+  { "up", DG_ROOM_UP },
+  { "down", DG_ROOM_DOWN },
+  { NULL, DG_FIELD_NONE }
+};
+
+static const struct dg_field *field_tables[NUM_DG_FIELDS] = {
+  var_fields, text_fields, char_fields, obj_fields, room_fields
+};
+
+/** A table once hashed: slots[hash & mask] is the only name to check. */
+struct dg_field_hash {
+  const struct dg_field **slots;
+  unsigned long seed;
+  unsigned long mask;
+};
+
+static struct dg_field_hash field_hashes[NUM_DG_FIELDS];
+
+/* FNV-1a on the lowercased name, as str_cmp() ignores case. */
+static unsigned long hash_name(unsigned long seed, const char *name)
+{
+  unsigned long h = 2166136261UL ^ seed;
+
+  for (; *name; name++) {
+    h ^= (unsigned char)LOWER(*name);
+    h = (h * 16777619UL) & 0xffffffffUL;
+  }
+  return (h);
+}
+
+/* Finds a size and seed that give every name in the table its own slot. */
+static void build_hash(int table)
+{
+  struct dg_field_hash *fh = &field_hashes[table];
+  const struct dg_field *f, *fields = field_tables[table];
+  unsigned long size, seed, slot;
+  int num = 0;
+
+  for (f = fields; f->name; f++)
+    num++;
+
+  for (size = 8; size < (unsigned long)num * 2; size <<= 1);
+  for (;; size <<= 1) {
+    CREATE(fh->slots, const struct dg_field *, size);
+    for (seed = 0; seed < 256; seed++) {
+      for (f = fields; f->name; f++) {
+        slot = hash_name(seed, f->name) & (size - 1);
+        if (fh->slots[slot])
+          break;
+        fh->slots[slot] = f;
+      }
+      if (!f->name) {
+        fh->seed = seed;
+        fh->mask = size - 1;
+        return;
+      }
+      memset(fh->slots, 0, size * sizeof(*fh->slots));
+    }
+    free(fh->slots);
+  }
+}
+
+/** Looks up a variable or field name.
+ * @param table One of the DG_FIELDS_* tables.
+ * @param name The name as written in the script; case does not matter.
+ * @retval int Its DG_* number, or DG_FIELD_NONE if the table lacks it. */
+int dg_field_id(int table, const char *name)
+{
+  struct dg_field_hash *fh = &field_hashes[table];
+  const struct dg_field *f;
+
+  if (!fh->slots)
+    build_hash(table);
+
+  f = fh->slots[hash_name(fh->seed, name) & fh->mask];
+  if (f && !str_cmp(f->name, name))
+    return (f->id);
+  return (DG_FIELD_NONE);
+}
@@ -0,0 +1,174 @@
+/**
+* @file dg_fields.h
+* Numbers for the variable and field names find_replacement() knows.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* To add a field, give it a number here and its name in the matching table
+* in dg_fields.c.
+*/
+#ifndef _DG_FIELDS_H_
+#define _DG_FIELDS_H_
+
+/** Returned by dg_field_id() for a name that is not in the table. */
+#define DG_FIELD_NONE 0
+
+/* Tables for dg_field_id() */
+#define DG_FIELDS_VAR   0
+#define DG_FIELDS_TEXT  1
+#define DG_FIELDS_CHAR  2
+#define DG_FIELDS_OBJ   3
+#define DG_FIELDS_ROOM  4
+#define NUM_DG_FIELDS   5
+
+/* variable names (%self%, %echo%, %random.N%, ...) */
+#define DG_VAR_SELF           1
+#define DG_VAR_GLOBAL         2
+#define DG_VAR_DOOR           3
+#define DG_VAR_FORCE          4
+#define DG_VAR_LOAD           5
+#define DG_VAR_PURGE          6
+#define DG_VAR_TELEPORT       7
+#define DG_VAR_DAMAGE         8
+#define DG_VAR_SEND           9
+#define DG_VAR_ECHO           10
+#define DG_VAR_ECHOAROUND     11
+#define DG_VAR_ZONEECHO       12
+#define DG_VAR_ASOUND         13
+#define DG_VAR_AT             14
+#define DG_VAR_TRANSFORM      15
+#define DG_VAR_RECHO          16
+#define DG_VAR_MOVE           17
+#define DG_VAR_LOG            18
+#define DG_VAR_PEOPLE         19
+#define DG_VAR_TIME           20
+#define DG_VAR_FINDMOB        21
+#define DG_VAR_FINDOBJ        22
+#define DG_VAR_RANDOM         23
+
+/* fields of any variable (%var.strlen%, ...) */
+#define DG_TEXT_STRLEN         1
+#define DG_TEXT_TOUPPER        2
+#define DG_TEXT_TRIM           3
+#define DG_TEXT_CONTAINS       4
+#define DG_TEXT_CAR            5
+#define DG_TEXT_CDR            6
+#define DG_TEXT_CHARAT         7
+#define DG_TEXT_MUDCOMMAND     8
+
+/* character fields */
+#define DG_CHAR_GLOBAL         1
+#define DG_CHAR_AFFECT         2
+#define DG_CHAR_ALIAS          3
+#define DG_CHAR_ALIGN          4
+#define DG_CHAR_ARMOR          5
+#define DG_CHAR_CANBESEEN      6
+#define DG_CHAR_CHA            7
+#define DG_CHAR_CLASS          8
+#define DG_CHAR_CON            9
+#define DG_CHAR_DEX            10
+#define DG_CHAR_DRUNK          11
+#define DG_CHAR_EQ             12
+#define DG_CHAR_EXP            13
+#define DG_CHAR_FIGHTING       14
+#define DG_CHAR_FOLLOWER       15
+#define DG_CHAR_COINS          16
+#define DG_CHAR_HAS_ITEM       17
+#define DG_CHAR_HASATTACHED    18
+#define DG_CHAR_HESHE          19
+#define DG_CHAR_HIMHER         20
+#define DG_CHAR_HISHER         21
+#define DG_CHAR_HITP           22
+#define DG_CHAR_HUNGER         23
+#define DG_CHAR_ID             24
+#define DG_CHAR_IS_PC          25
+#define DG_CHAR_INT            26
+#define DG_CHAR_INVENTORY      27
+#define DG_CHAR_LEVEL          28
+#define DG_CHAR_MANA           29
+#define DG_CHAR_MASTER         30
+#define DG_CHAR_MAXHITP        31
+#define DG_CHAR_MAXMANA        32
+#define DG_CHAR_MAXMOVE        33
+#define DG_CHAR_MAXSTAMINA     34
+#define DG_CHAR_MOVE           35
+#define DG_CHAR_STAMINA        36
+#define DG_CHAR_NAME           37
+#define DG_CHAR_NEXT_IN_ROOM   38
+#define DG_CHAR_NPCFLAG        39
+#define DG_CHAR_POS            40
+#define DG_CHAR_PREF           41
+#define DG_CHAR_QUESTPOINTS    42
+#define DG_CHAR_QP             43
+#define DG_CHAR_QPNTS          44
+#define DG_CHAR_QUEST          45
+#define DG_CHAR_QUESTDONE      46
+#define DG_CHAR_ROOM           47
+#define DG_CHAR_SAVE_STR       48
+#define DG_CHAR_SAVE_DEX       49
+#define DG_CHAR_SAVE_CON       50
+#define DG_CHAR_SAVE_INT       51
+#define DG_CHAR_SAVE_WIS       52
+#define DG_CHAR_SAVE_CHA       53
+#define DG_CHAR_SEX            54
+#define DG_CHAR_SKILL          55
+#define DG_CHAR_STR            56
+#define DG_CHAR_THIRST         57
+#define DG_CHAR_VAREXISTS      58
+#define DG_CHAR_VNUM           59
+#define DG_CHAR_WEIGHT         60
+#define DG_CHAR_WIS            61
+#define DG_CHAR_WAIT           62
+
+/* object fields */
+#define DG_OBJ_AFFECTS        1
+#define DG_OBJ_COST           2
+#define DG_OBJ_CARRIED_BY     3
+#define DG_OBJ_CONTENTS       4
+#define DG_OBJ_COUNT          5
+#define DG_OBJ_EXTRA          6
+#define DG_OBJ_HAS_IN         7
+#define DG_OBJ_HASATTACHED    8
+#define DG_OBJ_ID             9
+#define DG_OBJ_IS_INROOM      10
+#define DG_OBJ_IS_PC          11
+#define DG_OBJ_NAME           12
+#define DG_OBJ_NEXT_IN_LIST   13
+#define DG_OBJ_OSET           14
+#define DG_OBJ_ROOM           15
+#define DG_OBJ_SHORTDESC      16
+#define DG_OBJ_TYPE           17
+#define DG_OBJ_TIMER          18
+#define DG_OBJ_VNUM           19
+#define DG_OBJ_VAL0           20
+#define DG_OBJ_VAL1           21
+#define DG_OBJ_VAL2           22
+#define DG_OBJ_VAL3           23
+#define DG_OBJ_WEARFLAG       24
+#define DG_OBJ_WEIGHT         25
+#define DG_OBJ_WORN_BY        26
+
+/* room fields */
+#define DG_ROOM_NAME           1
+#define DG_ROOM_SECTOR         2
+#define DG_ROOM_VNUM           3
+#define DG_ROOM_CONTENTS       4
+#define DG_ROOM_PEOPLE         5
+#define DG_ROOM_ID             6
+#define DG_ROOM_WEATHER        7
+#define DG_ROOM_HASATTACHED    8
+#define DG_ROOM_ZONENUMBER     9
+#define DG_ROOM_ZONENAME       10
+#define DG_ROOM_ROOMFLAG       11
+#define DG_ROOM_NORTH          12
+#define DG_ROOM_EAST           13
+#define DG_ROOM_SOUTH          14
+#define DG_ROOM_WEST           15
+#define DG_ROOM_UP             16
+#define DG_ROOM_DOWN           17
+
+int dg_field_id(int table, const char *name);
+
+#endif /* _DG_FIELDS_H_ */
@@ -29,44 +29,39 @@ void free_var_el(struct trig_var_data *var)
 {
   if (var->name)
     free(var->name);
-  if (var->value)
+  if (var->value && var->value != var->value_buf)
     free(var->value);
   free(var);
 }
 
 /* release memory allocated for a variable list */
-void free_varlist(struct trig_var_data *vd)
+void free_varlist(struct trig_var_table *vars)
 {
     struct trig_var_data *i, *j;
 
-    for (i = vd; i;) {
+    if (!vars)
+      return;
+
+    for (i = vars->first; i;) {
 	j = i;
 	i = i->next;
 	free_var_el(j);
     }
+    if (vars->slots)
+      free(vars->slots);
+    free(vars);
 }
 
 /* Remove var name from var_list. Returns 1 if found, else 0. */
-int remove_var(struct trig_var_data **var_list, char *name)
+int remove_var(struct trig_var_table **var_list, char *name)
 {
-  struct trig_var_data *i, *j;
-
-  for (j = NULL, i = *var_list; i && str_cmp(name, i->name);
-       j = i, i = i->next);
-
-  if (i) {
-    if (j) {
-      j->next = i->next;
-      free_var_el(i);
-    } else {
-      *var_list = i->next;
-      free_var_el(i);
-    }
+  struct trig_var_data *i;
 
-    return 1;
-  }
+  if ((i = find_var(*var_list, name)) == NULL)
+    return 0;
 
-  return 0;
+  delete_var(var_list, i);
+  return 1;
 }
 
 /* Return memory used by a trigger. The command list is free'd when changed and
@@ -108,6 +103,8 @@ void extract_trigger(struct trig_data *trig)
   free_trigger(trig);
 }
 
+static room_rnum trig_types_room(void *thing, int type);
+
 /* remove all triggers from a mob/obj/room */
 void extract_script(void *thing, int type)
 {
@@ -116,6 +113,11 @@ void extract_script(void *thing, int type)
   char_data *mob;
   obj_data *obj;
   room_data *room;
+  room_rnum in_room;
+
+  /* Whatever this had, it has no more. */
+  if ((in_room = trig_types_room(thing, type)) != NOWHERE)
+    world[in_room].trig_types_stale = TRUE;
 
   switch (type) {
     case MOB_TRIGGER:
@@ -289,3 +291,311 @@ void update_wait_events(struct room_data *to, struct room_data *from)
     ((struct wait_event_data *)GET_TRIG_WAIT(trig)->event_obj)->go = to;
   }
 }
+
+/* Room trigger type masks.  Each room keeps the SCRIPT_TYPES of the people in
+ * it or'd together, and the same for the objects on the floor and those its
+ * people carry or wear, so the triggers that look through a whole room can
+ * pass over a room where nothing could fire in one test.  The masks may say
+ * more than is there - a trigger detached, say - but never less: they are
+ * or'd into as things arrive or have triggers attached, and rebuilt the next
+ * time they are wanted after something scripted has left. */
+
+/* SCRIPT_TYPES of what ch carries and wears, or'd together. */
+static long carried_trig_types(struct char_data *ch)
+{
+  struct obj_data *obj;
+  long types = 0;
+  int i;
+
+  for (obj = ch->carrying; obj; obj = obj->next_content)
+    if (SCRIPT(obj))
+      types |= SCRIPT_TYPES(SCRIPT(obj));
+
+  for (i = 0; i < NUM_WEARS; i++)
+    if (GET_EQ(ch, i) && SCRIPT(GET_EQ(ch, i)))
+      types |= SCRIPT_TYPES(SCRIPT(GET_EQ(ch, i)));
+
+  return (types);
+}
+
+static void rebuild_room_trig_types(struct room_data *room)
+{
+  struct char_data *ch;
+  struct obj_data *obj;
+
+  room->mob_trig_types = room->obj_trig_types = 0;
+
+  for (ch = room->people; ch; ch = ch->next_in_room) {
+    if (SCRIPT(ch))
+      room->mob_trig_types |= SCRIPT_TYPES(SCRIPT(ch));
+    room->obj_trig_types |= carried_trig_types(ch);
+  }
+
+  for (obj = room->contents; obj; obj = obj->next_content)
+    if (SCRIPT(obj))
+      room->obj_trig_types |= SCRIPT_TYPES(SCRIPT(obj));
+
+  room->trig_types_stale = FALSE;
+}
+
+/** The MTRIG_ types of the people in a room.  If none of the types a
+ * trigger function wants is set, no one in the room has such a trigger. */
+long room_mob_trig_types(struct room_data *room)
+{
+  if (room->trig_types_stale)
+    rebuild_room_trig_types(room);
+  return (room->mob_trig_types);
+}
+
+/** The OTRIG_ types of the objects in a room, including those carried or
+ * worn by the people there. */
+long room_obj_trig_types(struct room_data *room)
+{
+  if (room->trig_types_stale)
+    rebuild_room_trig_types(room);
+  return (room->obj_trig_types);
+}
+
+/** Called by char_to_room(). */
+void room_trig_types_enter_char(room_rnum room, struct char_data *ch)
+{
+  if (SCRIPT(ch))
+    world[room].mob_trig_types |= SCRIPT_TYPES(SCRIPT(ch));
+  world[room].obj_trig_types |= carried_trig_types(ch);
+}
+
+/** Called by char_from_room(). */
+void room_trig_types_leave_char(room_rnum room, struct char_data *ch)
+{
+  if ((SCRIPT(ch) && SCRIPT_TYPES(SCRIPT(ch))) || carried_trig_types(ch))
+    world[room].trig_types_stale = TRUE;
+}
+
+/** Called when obj arrives in room, or with a person there. */
+void room_trig_types_enter_obj(room_rnum room, struct obj_data *obj)
+{
+  if (SCRIPT(obj))
+    world[room].obj_trig_types |= SCRIPT_TYPES(SCRIPT(obj));
+}
+
+/** Called when obj leaves room, or a person there. */
+void room_trig_types_leave_obj(room_rnum room, struct obj_data *obj)
+{
+  if (SCRIPT(obj) && SCRIPT_TYPES(SCRIPT(obj)))
+    world[room].trig_types_stale = TRUE;
+}
+
+/* The room whose masks count a mob or object, or NOWHERE. */
+static room_rnum trig_types_room(void *thing, int type)
+{
+  struct obj_data *obj;
+
+  if (type == MOB_TRIGGER)
+    return (IN_ROOM((struct char_data *)thing));
+  if (type != OBJ_TRIGGER)
+    return (NOWHERE);
+
+  obj = (struct obj_data *)thing;
+  if (obj->carried_by)
+    return (IN_ROOM(obj->carried_by));
+  if (obj->worn_by)
+    return (IN_ROOM(obj->worn_by));
+  return (IN_ROOM(obj));
+}
+
+/* The random and time trigger registries.  script_trigger_check() and
+ * check_time_triggers() used to look through every character, object and
+ * room for the few with random or time triggers; now they go through these
+ * lists instead.  Things join when such a trigger is attached, and mobs and
+ * objects leave when freed.  Something whose triggers have been detached is
+ * dropped when the list next reaches it.  Mobs and objects join at the
+ * front, as they do character_list and object_list, and rooms are kept in
+ * vnum order, so the triggers run in the order they always have. */
+static struct char_data *scheduled_chars = NULL, *char_cursor = NULL;
+static struct obj_data *scheduled_objs = NULL, *obj_cursor = NULL;
+static room_vnum *scheduled_rooms = NULL;
+static int num_scheduled_rooms = 0, max_scheduled_rooms = 0;
+
+static void schedule_char(struct char_data *ch)
+{
+  if (ch->scheduled)
+    return;
+  ch->scheduled = TRUE;
+  ch->prev_scheduled = NULL;
+  if ((ch->next_scheduled = scheduled_chars) != NULL)
+    scheduled_chars->prev_scheduled = ch;
+  scheduled_chars = ch;
+}
+
+/** Takes a character off the trigger registry.  Called by free_char(). */
+void unschedule_char(struct char_data *ch)
+{
+  if (!ch->scheduled)
+    return;
+  if (char_cursor == ch)
+    char_cursor = ch->next_scheduled;
+  if (ch->prev_scheduled)
+    ch->prev_scheduled->next_scheduled = ch->next_scheduled;
+  else
+    scheduled_chars = ch->next_scheduled;
+  if (ch->next_scheduled)
+    ch->next_scheduled->prev_scheduled = ch->prev_scheduled;
+  ch->next_scheduled = ch->prev_scheduled = NULL;
+  ch->scheduled = FALSE;
+}
+
+static void schedule_obj(struct obj_data *obj)
+{
+  if (obj->scheduled)
+    return;
+  obj->scheduled = TRUE;
+  obj->prev_scheduled = NULL;
+  if ((obj->next_scheduled = scheduled_objs) != NULL)
+    scheduled_objs->prev_scheduled = obj;
+  scheduled_objs = obj;
+}
+
+/** Takes an object off the trigger registry.  Called by free_obj(). */
+void unschedule_obj(struct obj_data *obj)
+{
+  if (!obj->scheduled)
+    return;
+  if (obj_cursor == obj)
+    obj_cursor = obj->next_scheduled;
+  if (obj->prev_scheduled)
+    obj->prev_scheduled->next_scheduled = obj->next_scheduled;
+  else
+    scheduled_objs = obj->next_scheduled;
+  if (obj->next_scheduled)
+    obj->next_scheduled->prev_scheduled = obj->prev_scheduled;
+  obj->next_scheduled = obj->prev_scheduled = NULL;
+  obj->scheduled = FALSE;
+}
+
+static void schedule_room(room_vnum vnum)
+{
+  int bot = 0, top = num_scheduled_rooms - 1, mid;
+
+  while (bot <= top) {
+    mid = (bot + top) / 2;
+    if (scheduled_rooms[mid] == vnum)
+      return;
+    if (scheduled_rooms[mid] < vnum)
+      bot = mid + 1;
+    else
+      top = mid - 1;
+  }
+
+  if (num_scheduled_rooms == max_scheduled_rooms) {
+    max_scheduled_rooms = MAX(16, max_scheduled_rooms * 2);
+    RECREATE(scheduled_rooms, room_vnum, max_scheduled_rooms);
+  }
+  memmove(scheduled_rooms + bot + 1, scheduled_rooms + bot,
+          (num_scheduled_rooms - bot) * sizeof(room_vnum));
+  scheduled_rooms[bot] = vnum;
+  num_scheduled_rooms++;
+}
+
+/** The next character on the trigger registry that may have one of types,
+ * starting from the first if first is set, or NULL when there are no more.
+ * Characters on the list that no longer have any scheduled type are taken
+ * off. */
+struct char_data *next_scheduled_char(bool first, long types)
+{
+  struct char_data *ch;
+
+  if (first)
+    char_cursor = scheduled_chars;
+
+  while ((ch = char_cursor) != NULL) {
+    char_cursor = ch->next_scheduled;
+    if (!SCRIPT(ch) || !(SCRIPT_TYPES(SCRIPT(ch)) & TRIG_SCHEDULED))
+      unschedule_char(ch);
+    else if (SCRIPT_TYPES(SCRIPT(ch)) & types)
+      return (ch);
+  }
+  return (NULL);
+}
+
+/** As next_scheduled_char(), for objects. */
+struct obj_data *next_scheduled_obj(bool first, long types)
+{
+  struct obj_data *obj;
+
+  if (first)
+    obj_cursor = scheduled_objs;
+
+  while ((obj = obj_cursor) != NULL) {
+    obj_cursor = obj->next_scheduled;
+    if (!SCRIPT(obj) || !(SCRIPT_TYPES(SCRIPT(obj)) & TRIG_SCHEDULED))
+      unschedule_obj(obj);
+    else if (SCRIPT_TYPES(SCRIPT(obj)) & types)
+      return (obj);
+  }
+  return (NULL);
+}
+
+/** As next_scheduled_char(), for rooms. */
+struct room_data *next_scheduled_room(bool first, long types)
+{
+  static room_vnum last;
+  room_rnum rnum;
+  int i = 0, top = num_scheduled_rooms, mid;
+
+  /* Find where last was even if triggers have come or gone since. */
+  if (!first)
+    while (i < top) {
+      mid = (i + top) / 2;
+      if (scheduled_rooms[mid] <= last)
+        i = mid + 1;
+      else
+        top = mid;
+    }
+
+  while (i < num_scheduled_rooms) {
+    rnum = real_room(scheduled_rooms[i]);
+    if (rnum == NOWHERE || !SCRIPT(&world[rnum]) ||
+        !(SCRIPT_TYPES(SCRIPT(&world[rnum])) & TRIG_SCHEDULED)) {
+      memmove(scheduled_rooms + i, scheduled_rooms + i + 1,
+              (num_scheduled_rooms - i - 1) * sizeof(room_vnum));
+      num_scheduled_rooms--;
+    } else if (SCRIPT_TYPES(SCRIPT(&world[rnum])) & types) {
+      last = scheduled_rooms[i];
+      return (&world[rnum]);
+    } else
+      i++;
+  }
+  return (NULL);
+}
+
+/** Called after triggers are attached to a mob, object or room. */
+void triggers_attached(void *thing, int type)
+{
+  struct script_data *sc = NULL;
+  room_rnum room;
+
+  switch (type) {
+    case MOB_TRIGGER: sc = SCRIPT((struct char_data *)thing); break;
+    case OBJ_TRIGGER: sc = SCRIPT((struct obj_data *)thing); break;
+    case WLD_TRIGGER: sc = SCRIPT((struct room_data *)thing); break;
+  }
+  if (!sc)
+    return;
+
+  if (SCRIPT_TYPES(sc) & TRIG_SCHEDULED) {
+    if (type == MOB_TRIGGER)
+      schedule_char((struct char_data *)thing);
+    else if (type == OBJ_TRIGGER)
+      schedule_obj((struct obj_data *)thing);
+    else
+      schedule_room(((struct room_data *)thing)->number);
+  }
+
+  if ((room = trig_types_room(thing, type)) == NOWHERE)
+    return;
+
+  if (type == MOB_TRIGGER)
+    room_trig_types_enter_char(room, (struct char_data *)thing);
+  else
+    room_trig_types_enter_obj(room, (struct obj_data *)thing);
+}
@@ -296,6 +296,7 @@ void script_damage(struct char_data *vict, int dam)
 
   GET_HIT(vict) -= dam;
   GET_HIT(vict) = MIN(GET_HIT(vict), GET_MAX_HIT(vict));
+  msdp_changed(vict, MSDP_DIRTY_VITALS);
 
   update_pos(vict);
   send_char_pos(vict, dam);
@@ -936,6 +936,8 @@ ACMD(do_mtransform)
     /* put the mob in the same room as ch so extract will work */
     char_to_room(m, IN_ROOM(ch));
 
+    /* m is thrown away, so it must not be left on the trigger registry. */
+    unschedule_char(m);
     memcpy(&tmpmob, m, sizeof(*m));
 
     /* Thanks to Russell Ryan for this fix. RRfon we need to copy the
@@ -964,6 +966,9 @@ ACMD(do_mtransform)
     tmpmob.followers = ch->followers;
     tmpmob.master = ch->master;
     tmpmob.group = ch->group;
+    tmpmob.next_scheduled = ch->next_scheduled;
+    tmpmob.prev_scheduled = ch->prev_scheduled;
+    tmpmob.scheduled = ch->scheduled;
 
     GET_WAS_IN(&tmpmob) = GET_WAS_IN(ch);
     if (keep_hp) {
@@ -985,6 +990,7 @@ ACMD(do_mtransform)
     }
 
     ch->nr = this_rnum;
+    triggers_attached(ch, MOB_TRIGGER);
     extract_char(m);
   }
 }
@@ -322,7 +322,9 @@ static OCMD(do_otransform)
       unequip_char(obj->worn_by, pos);
     }
 
-    /* move new obj info over to old object and delete new obj */
+    /* move new obj info over to old object and delete new obj; o is thrown
+     * away, so it must not be left on the trigger registry */
+    unschedule_obj(o);
     memcpy(&tmpobj, o, sizeof(*o));
     tmpobj.in_room = IN_ROOM(obj);
     tmpobj.carried_by = obj->carried_by;
@@ -335,7 +337,11 @@ static OCMD(do_otransform)
     tmpobj.script = obj->script;
     tmpobj.next_content = obj->next_content;
     tmpobj.next = obj->next;
+    tmpobj.next_scheduled = obj->next_scheduled;
+    tmpobj.prev_scheduled = obj->prev_scheduled;
+    tmpobj.scheduled = obj->scheduled;
     memcpy(obj, &tmpobj, sizeof(*obj));
+    triggers_attached(obj, OBJ_TRIGGER);
 
     if (wearer) {
       equip_char(wearer, obj, pos);
@@ -635,7 +635,7 @@ void trigedit_save(struct descriptor_data *d)
   trig_data *proto;
   trig_data *trig = OLC_TRIG(d);
   trig_data *live_trig;
-  struct cmdlist_element *cmd, *next_cmd;
+  struct cmdlist_element *cmd;
   struct index_data **new_index;
   struct descriptor_data *dsc;
   FILE *trig_file;
@@ -646,12 +646,7 @@ void trigedit_save(struct descriptor_data *d)
 
   if ((rnum = real_trigger(OLC_NUM(d))) != NOTHING) {
     proto = trig_index[rnum]->proto;
-    for (cmd = proto->cmdlist; cmd; cmd = next_cmd) {
-      next_cmd = cmd->next;
-      if (cmd->cmd)
-        free(cmd->cmd);
-      free(cmd);
-    }
+    free_cmdlist(proto->cmdlist);
 
 
     free(proto->arglist);
@@ -676,6 +671,7 @@ void trigedit_save(struct descriptor_data *d)
       }
     } else
       trig->cmdlist->cmd = strdup("* No Script");
+    dg_compile_cmdlist(trig);
 
     /* make the prorotype look like what we have */
     trig_data_copy(proto, trig);
@@ -742,6 +738,7 @@ void trigedit_save(struct descriptor_data *d)
       }
     } else
       trig->cmdlist->cmd = strdup("* No Script");
+    dg_compile_cmdlist(trig);
 
     for (i = 0; i < top_of_trigt; i++) {
       if (!found) {
@@ -789,6 +786,7 @@ void trigedit_save(struct descriptor_data *d)
 
     trig_index = new_index;
     top_of_trigt++;
+    vnum_index_rebuild(DB_BOOT_TRG);
 
     /* HERE IT HAS TO GO THROUGH AND FIX ALL SCRIPTS/TRIGS OF HIGHER RNUM */
     for (live_trig = trigger_list; live_trig; live_trig = live_trig->next_in_world)
@@ -31,26 +31,23 @@
 #include "modify.h"
 #include "toml.h"
 #include "toml_utils.h"
+#include "vnum_index.h"
+#include "dormancy.h"
 
 #define PULSES_PER_MUD_HOUR     (SECS_PER_MUD_HOUR*PASSES_PER_SEC)
 
+#ifdef DG_CORPUS
+/** Run triggers from their text instead of the compiled form.  Only the
+ * regression corpus turns this on, to compare the two. */
+bool dg_text_engine = FALSE;
+#endif
+
 /* Local functions not used elsewhere */
 static obj_data *find_obj(long n);
 static room_data *find_room(long n);
 static void do_stat_trigger(struct char_data *ch, trig_data *trig);
 static void script_stat(char_data *ch, struct script_data *sc);
 static int remove_trigger(struct script_data *sc, char *name);
-static int is_num(char *arg);
-static void eval_op(char *op, char *lhs, char *rhs, char *result, void *go,
-          struct script_data *sc, trig_data *trig);
-static char *matching_paren(char *p);
-static void eval_expr(char *line, char *result, void *go, struct script_data *sc,
-          trig_data *trig, int type);
-static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
-          trig_data *trig, int type);
-static int process_if(char *cond, void *go, struct script_data *sc,
-          trig_data *trig, int type);
-static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl);
 static struct cmdlist_element *find_else_end(trig_data *trig,
           struct cmdlist_element *cl, void *go, struct script_data *sc, int type);
 static void process_wait(void *go, trig_data *trig, int type, char *cmd,
@@ -72,7 +69,11 @@ static void extract_value(struct script_data *sc, trig_data *trig, char *cmd);
 static void dg_letter_value(struct script_data *sc, trig_data *trig, char *cmd);
 static struct cmdlist_element * find_case(struct trig_data *trig, struct cmdlist_element *cl,
           void *go, struct script_data *sc, int type, char *cond);
-static struct cmdlist_element *find_done(struct cmdlist_element *cl);
+static struct cmdlist_element *run_else_steps(trig_data *trig,
+          struct dg_line *code, void *go, struct script_data *sc, int type);
+static struct cmdlist_element *run_case_steps(trig_data *trig,
+          struct dg_line *code, void *go, struct script_data *sc, int type,
+          char *cond);
 static struct char_data *find_char_by_uid_in_lookup_table(long uid);
 static struct obj_data *find_obj_by_uid_in_lookup_table(long uid);
 static EVENTFUNC(trig_wait_event);
@@ -630,82 +631,51 @@ void script_trigger_check(void)
 {
   char_data *ch;
   obj_data *obj;
-  struct room_data *room=NULL;
-  room_rnum nr;
-  struct script_data *sc;
-
-  for (ch = character_list; ch; ch = ch->next) {
-    if (SCRIPT(ch)) {
-      sc = SCRIPT(ch);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-          (!is_empty(world[IN_ROOM(ch)].zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        random_mtrigger(ch);
-    }
-  }
+  struct room_data *room;
+  room_rnum rnum;
 
-  for (obj = object_list; obj; obj = obj->next) {
-    if (SCRIPT(obj)) {
-      sc = SCRIPT(obj);
+  for (ch = next_scheduled_char(TRUE, WTRIG_RANDOM); ch;
+       ch = next_scheduled_char(FALSE, WTRIG_RANDOM))
+    if (IN_ROOM(ch) != NOWHERE &&
+        (!is_empty(world[IN_ROOM(ch)].zone) ||
+         IS_SET(SCRIPT_TYPES(SCRIPT(ch)), WTRIG_GLOBAL)))
+      random_mtrigger(ch);
 
-      if (IS_SET(SCRIPT_TYPES(sc), OTRIG_RANDOM))
-        random_otrigger(obj);
-    }
-  }
+  for (obj = next_scheduled_obj(TRUE, OTRIG_RANDOM); obj;
+       obj = next_scheduled_obj(FALSE, OTRIG_RANDOM))
+    if (IS_SET(SCRIPT_TYPES(SCRIPT(obj)), OTRIG_GLOBAL) ||
+        (rnum = obj_room(obj)) == NOWHERE || !ZONE_DORMANT(world[rnum].zone))
+      random_otrigger(obj);
 
-  for (nr = 0; nr <= top_of_world; nr++) {
-    if (SCRIPT(&world[nr])) {
-      room = &world[nr];
-      sc = SCRIPT(room);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-          (!is_empty(room->zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        random_wtrigger(room);
-    }
-  }
+  for (room = next_scheduled_room(TRUE, WTRIG_RANDOM); room;
+       room = next_scheduled_room(FALSE, WTRIG_RANDOM))
+    if (!is_empty(room->zone) ||
+        IS_SET(SCRIPT_TYPES(SCRIPT(room)), WTRIG_GLOBAL))
+      random_wtrigger(room);
 }
 
 void check_time_triggers(void)
 {
   char_data *ch;
   obj_data *obj;
-  struct room_data *room=NULL;
-  int nr;
-  struct script_data *sc;
-
-  for (ch = character_list; ch; ch = ch->next) {
-    if (SCRIPT(ch)) {
-      sc = SCRIPT(ch);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-          (!is_empty(world[IN_ROOM(ch)].zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        time_mtrigger(ch);
-    }
-  }
+  struct room_data *room;
 
-  for (obj = object_list; obj; obj = obj->next) {
-    if (SCRIPT(obj)) {
-      sc = SCRIPT(obj);
+  for (ch = next_scheduled_char(TRUE, WTRIG_TIME); ch;
+       ch = next_scheduled_char(FALSE, WTRIG_TIME))
+    if (IN_ROOM(ch) != NOWHERE &&
+        (!is_empty(world[IN_ROOM(ch)].zone) ||
+         IS_SET(SCRIPT_TYPES(SCRIPT(ch)), WTRIG_GLOBAL)))
+      time_mtrigger(ch);
 
-      if (IS_SET(SCRIPT_TYPES(sc), OTRIG_TIME))
-        time_otrigger(obj);
-    }
-  }
+  for (obj = next_scheduled_obj(TRUE, OTRIG_TIME); obj;
+       obj = next_scheduled_obj(FALSE, OTRIG_TIME))
+    time_otrigger(obj);
 
-  for (nr = 0; nr <= top_of_world; nr++) {
-    if (SCRIPT(&world[nr])) {
-      room = &world[nr];
-      sc = SCRIPT(room);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-          (!is_empty(room->zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        time_wtrigger(room);
-    }
-  }
+  for (room = next_scheduled_room(TRUE, WTRIG_TIME); room;
+       room = next_scheduled_room(FALSE, WTRIG_TIME))
+    if (!is_empty(room->zone) ||
+        IS_SET(SCRIPT_TYPES(SCRIPT(room)), WTRIG_GLOBAL))
+      time_wtrigger(room);
 }
 
 static EVENTFUNC(trig_wait_event)
@@ -834,7 +804,7 @@ static void script_stat (char_data *ch, struct script_data *sc)
   send_to_char(ch, "Global Variables: %s\r\n", sc->global_vars ? "" : "None");
   send_to_char(ch, "Global context: %ld\r\n", sc->context);
 
-  for (tv = sc->global_vars; tv; tv = tv->next) {
+  for (tv = sc->global_vars ? sc->global_vars->first : NULL; tv; tv = tv->next) {
     snprintf(namebuf, sizeof(namebuf), "%s:%ld", tv->name, tv->context);
     if (*(tv->value) == UID_CHAR) {
       find_uid_name(tv->value, name, sizeof(name));
@@ -871,7 +841,7 @@ static void script_stat (char_data *ch, struct script_data *sc)
               t->curr_state ? t->curr_state->cmd : "End of Script");
       send_to_char(ch, "  Variables: %s\r\n", GET_TRIG_VARS(t) ? "" : "None");
 
-      for (tv = GET_TRIG_VARS(t); tv; tv = tv->next) {
+      for (tv = GET_TRIG_VARS(t) ? GET_TRIG_VARS(t)->first : NULL; tv; tv = tv->next) {
         if (*(tv->value) == UID_CHAR) {
           find_uid_name(tv->value, name, sizeof(name));
           send_to_char(ch, "    %15s:  %s\r\n", tv->name, name);
@@ -993,6 +963,7 @@ ACMD(do_attach)
     if (!SCRIPT(victim))
       CREATE(SCRIPT(victim), struct script_data, 1);
     add_trigger(SCRIPT(victim), trig, loc);
+    triggers_attached(victim, MOB_TRIGGER);
 
     if (IS_NPC(victim))
     send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n",
@@ -1035,6 +1006,7 @@ ACMD(do_attach)
     if (!SCRIPT(object))
       CREATE(SCRIPT(object), struct script_data, 1);
     add_trigger(SCRIPT(object), trig, loc);
+    triggers_attached(object, OBJ_TRIGGER);
 
     send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n",
                  tn, GET_TRIG_NAME(trig),
@@ -1072,6 +1044,7 @@ ACMD(do_attach)
     if (!SCRIPT(room))
       CREATE(SCRIPT(room), struct script_data, 1);
     add_trigger(SCRIPT(room), trig, loc);
+    triggers_attached(room, WLD_TRIGGER);
 
     send_to_char(ch, "Trigger %d (%s) attached to room %d.\r\n",
                  tn, GET_TRIG_NAME(trig), world[rnum].number);
@@ -1330,6 +1303,13 @@ void script_vlog(const char *format, va_list args)
   /* parse the args, making the error message */ 
   vsnprintf(output, sizeof(output) - 2, format, args); 
 
+#ifdef DG_CORPUS
+  if (dg_corpus_mode) {
+    dg_corpus_note("log %s", output);
+    return;
+  }
+#endif
+
   /* Save to the syslog file */ 
   basic_mud_log("SCRIPT ERROR: %s", output); 
 
@@ -1357,269 +1337,41 @@ void script_log(const char *format, ...)
   va_end(args);
 }
 
-/* Returns 1 if string is all digits, else 0. Bugfixed - would have returned 
- * true on num="------". */
-static int is_num(char *arg)
-{
-   if (*arg == '\0')
-      return FALSE;
-
-   if (*arg == '+' || *arg == '-')
-      arg++;
-
-   for (; *arg != '\0'; arg++)
-   {
-      if (!isdigit(*arg))
-         return FALSE;
-   }
-
-   return TRUE;
-}
-
-/* evaluates 'lhs op rhs', and copies to result */
-static void eval_op(char *op, char *lhs, char *rhs, char *result, void *go,
-             struct script_data *sc, trig_data *trig)
-{
-  unsigned char *p;
-  int n;
-
-  /* strip off extra spaces at begin and end */
-  while (*lhs && isspace(*lhs))
-    lhs++;
-  while (*rhs && isspace(*rhs))
-    rhs++;
-
-  for (p = (unsigned char *) lhs; *p; p++);
-  for (--p; isspace(*p) && ((char *)p > lhs); *p-- = '\0');
-  for (p = (unsigned char *) rhs; *p; p++);
-  for (--p; isspace(*p) && ((char *)p > rhs); *p-- = '\0');
-
-
-  /* find the op, and figure out the value */
-  if (!strcmp("||", op)) {
-    if ((!*lhs || (*lhs == '0')) && (!*rhs || (*rhs == '0')))
-      strcpy(result, "0");
-    else
-      strcpy(result, "1");
-  }
-
-  else if (!strcmp("&&", op)) {
-    if (!*lhs || (*lhs == '0') || !*rhs || (*rhs == '0'))
-      strcpy (result, "0");
-    else
-      strcpy (result, "1");
-  }
-
-  else if (!strcmp("==", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) == atoi(rhs));
-    else
-      sprintf(result, "%d", !str_cmp(lhs, rhs));
-  }
-
-  else if (!strcmp("!=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) != atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs));
-  }
-
-  else if (!strcmp("<=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) <= atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
-  }
-
-  else if (!strcmp(">=", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) >= atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
-  }
-
-  else if (!strcmp("<", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) < atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) < 0);
-  }
-
-  else if (!strcmp(">", op)) {
-    if (is_num(lhs) && is_num(rhs))
-      sprintf(result, "%d", atoi(lhs) > atoi(rhs));
-    else
-      sprintf(result, "%d", str_cmp(lhs, rhs) > 0);
-  }
-
-  else if (!strcmp("/=", op))
-    sprintf(result, "%c", str_str(lhs, rhs) ? '1' : '0');
-
-  else if (!strcmp("*", op))
-    sprintf(result, "%d", atoi(lhs) * atoi(rhs));
-
-  else if (!strcmp("/", op))
-    sprintf(result, "%d", (n = atoi(rhs)) ? (atoi(lhs) / n) : 0);
-
-  else if (!strcmp("+", op))
-    sprintf(result, "%d", atoi(lhs) + atoi(rhs));
-
-  else if (!strcmp("-", op))
-    sprintf(result, "%d", atoi(lhs) - atoi(rhs));
-
-  else if (!strcmp("!", op)) {
-    if (is_num(rhs))
-      sprintf(result, "%d", !atoi(rhs));
-    else
-      sprintf(result, "%d", !*rhs);
-  }
-}
-
-/* p points to the first quote, returns the matching end quote, or the last 
- * non-null char in p.*/
-char *matching_quote(char *p)
-{
-  for (p++; *p && (*p != '"'); p++) {
-    if (*p == '\\')
-      p++;
-  }
-
-  if (!*p)
-    p--;
-
-  return p;
-}
-
-/* p points to the first paren.  returns a pointer to the matching closing 
- * paren, or the last non-null char in p. */
-static char *matching_paren(char *p)
-{
-  int i;
-
-  for (p++, i = 1; *p && i; p++) {
-    if (*p == '(')
-      i++;
-    else if (*p == ')')
-      i--;
-    else if (*p == '"')
-      p = matching_quote(p);
-  }
-
-  return --p;
-}
-
-/* evaluates line, and returns answer in result */
-static void eval_expr(char *line, char *result, void *go, struct script_data *sc,
-               trig_data *trig, int type)
+/* Logs a missing 'end' found by find_end() or find_else_end(), or, when
+ * compiling, appends the error number to errors to be logged at run time. */
+static void if_end_error(trig_data *trig, char *errors, int num)
 {
-  char expr[MAX_INPUT_LENGTH], *p;
-
-  while (*line && isspace(*line))
-    line++;
-
-  if (eval_lhs_op_rhs(line, result, go, sc, trig, type));
-
-  else if (*line == '(') {
-    strcpy(expr, line);
-    p = matching_paren(expr);
-    *p = '\0';
-    eval_expr(expr + 1, result, go, sc, trig, type);
-  }
-
-  else
-    var_subst(go, sc, trig, type, line, result);
-}
-
-/* Evaluates expr if it is in the form lhs op rhs, and copies answer in result.
- * Returns 1 if expr is evaluated, else 0. */
-static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
-                    trig_data *trig, int type)
-{
-  char *p, *tokens[MAX_INPUT_LENGTH];
-  char line[MAX_INPUT_LENGTH], lhr[MAX_INPUT_LENGTH], rhr[MAX_INPUT_LENGTH];
-  int i, j;
-
-  /*
-   * valid operands, in order of priority
-   * each must also be defined in eval_op()
-   */
-  static char *ops[] = {
-    "||",
-    "&&",
-    "==",
-    "!=",
-    "<=",
-    ">=",
-    "<",
-    ">",
-    "/=",
-    "-",
-    "+",
-    "/",
-    "*",
-    "!",
-    "\n"
-  };
+  size_t len;
 
-  p = strcpy(line, expr);
-
-  /* Initialize tokens, an array of pointers to locations in line where the 
-   * ops could possibly occur. */
-  for (j = 0; *p; j++) {
-    tokens[j] = p;
-    if (*p == '(')
-      p = matching_paren(p) + 1;
-    else if (*p == '"')
-      p = matching_quote(p) + 1;
-    else if (isalnum(*p))
-      for (p++; *p && (isalnum(*p) || isspace(*p)); p++);
-    else
-      p++;
+  if (!errors) {
+    script_log("Trigger VNum %d has 'if' without 'end'. (error %d)", GET_TRIG_VNUM(trig), num);
+    return;
   }
-  tokens[j] = NULL;
-
-  for (i = 0; *ops[i] != '\n'; i++)
-    for (j = 0; tokens[j]; j++)
-      if (!strn_cmp(ops[i], tokens[j], strlen(ops[i]))) {
-        *tokens[j] = '\0';
-        p = tokens[j] + strlen(ops[i]);
-
-        eval_expr(line, lhr, go, sc, trig, type);
-        eval_expr(p, rhr, go, sc, trig, type);
-        eval_op(ops[i], lhr, rhr, result, go, sc, trig);
-
-        return 1;
-      }
-
-  return 0;
+  len = strlen(errors);
+  errors[len] = '0' + num;
+  errors[len + 1] = '\0';
 }
 
-/* returns 1 if cond is true, else 0 */
-static int process_if(char *cond, void *go, struct script_data *sc,
-               trig_data *trig, int type)
+/* Logs the errors if_end_error() saved while compiling. */
+void log_if_errors(trig_data *trig, const char *errors)
 {
-  char result[MAX_INPUT_LENGTH], *p;
-
-  eval_expr(cond, result, go, sc, trig, type);
-
-  p = result;
-  skip_spaces(&p);
-
-  if (!*p || *p == '0')
-    return 0;
-  else
-    return 1;
+  if (!errors)
+    return;
+  for (; *errors; errors++)
+    script_log("Trigger VNum %d has 'if' without 'end'. (error %c)", GET_TRIG_VNUM(trig), *errors);
 }
 
 /* Scans for end of if-block.  returns the line containg 'end', or the last
- * line of the trigger if not found. */
-static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl)
+ * line of the trigger if not found.  Errors are logged, or saved in errors
+ * if it is not NULL (see if_end_error()). */
+struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl,
+                                 char *errors)
 {
   struct cmdlist_element *c;
   char *p;
 
   if (!(cl->next)) { /* rryan: if this is the last line, theres no end */
-    script_log("Trigger VNum %d has 'if' without 'end'. (error 1)", GET_TRIG_VNUM(trig));
+    if_end_error(trig, errors, 1);
     return cl;
   }
 
@@ -1627,19 +1379,19 @@ static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element
     for (p = c->cmd; *p && isspace(*p); p++);
 
     if (!strn_cmp("if ", p, 3))
-      c = find_end(trig, c);
+      c = find_end(trig, c, errors);
     else if (!strn_cmp("end", p, 3))
       return c;
 
     /* thanks to Russell Ryan for this fix */
     if(!c->next) { /* rryan: this is the last line, we didn't find an end. */
-      script_log("Trigger VNum %d has 'if' without 'end'. (error 2)", GET_TRIG_VNUM(trig));
+      if_end_error(trig, errors, 2);
       return c;
     }
   }
 
   /* rryan: we didn't find an end */
-  script_log("Trigger VNum %d has 'if' without 'end'. (error 3)", GET_TRIG_VNUM(trig));
+  if_end_error(trig, errors, 3);
   return c;
 }
 
@@ -1658,7 +1410,7 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
     for (p = c->cmd; *p && isspace(*p); p++); /* skip spaces */
 
     if (!strn_cmp("if ", p, 3))
-      c = find_end(trig, c);
+      c = find_end(trig, c, NULL);
 
     else if (!strn_cmp("elseif ", p, 7)) {
       if (process_if(p + 7, go, sc, trig, type)) {
@@ -1689,6 +1441,33 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
   return c;
 }
 
+/* find_else_end() for a compiled 'if': only the elseif conditions are left
+ * to evaluate. */
+static struct cmdlist_element *run_else_steps(trig_data *trig,
+    struct dg_line *code, void *go, struct script_data *sc, int type)
+{
+  struct dg_step *step;
+  int i;
+
+  for (i = 0; i < code->num_steps; i++) {
+    step = &code->steps[i];
+    log_if_errors(trig, step->errors);
+
+    if (step->kind == DG_STEP_ELSEIF) {
+      if (process_if(step->arg, go, sc, trig, type)) {
+        GET_TRIG_DEPTH(trig)++;
+        return step->line;
+      }
+    } else {
+      if (step->kind == DG_STEP_ELSE)
+        GET_TRIG_DEPTH(trig)++;
+      return step->line;
+    }
+  }
+  /* dg_compile_cmdlist() always ends the list with an else or a stop. */
+  return code->steps[code->num_steps - 1].line;
+}
+
 /* processes any 'wait' commands in a trigger */
 static void process_wait(void *go, trig_data *trig, int type, char *cmd,
                   struct cmdlist_element *cl)
@@ -1737,6 +1516,15 @@ static void process_wait(void *go, trig_data *trig, int type, char *cmd,
     }
   }
 
+#ifdef DG_CORPUS
+  if (dg_corpus_mode) {
+    dg_corpus_note("wait %ld", when);
+    trig->curr_state = cl->next;
+    dg_corpus_wait();
+    return;
+  }
+#endif
+
   CREATE(wait_event_obj, struct wait_event_data, 1);
   wait_event_obj->trigger = trig;
   wait_event_obj->go = go;
@@ -1851,6 +1639,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
     if (!SCRIPT(c))
       CREATE(SCRIPT(c), struct script_data, 1);
     add_trigger(SCRIPT(c), newtrig, -1);
+    triggers_attached(c, MOB_TRIGGER);
     return;
   }
 
@@ -1858,6 +1647,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
     if (!SCRIPT(o))
       CREATE(SCRIPT(o), struct script_data, 1);
     add_trigger(SCRIPT(o), newtrig, -1);
+    triggers_attached(o, OBJ_TRIGGER);
     return;
   }
 
@@ -1865,6 +1655,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
     if (!SCRIPT(r))
       CREATE(SCRIPT(r), struct script_data, 1);
     add_trigger(SCRIPT(r), newtrig, -1);
+    triggers_attached(r, WLD_TRIGGER);
     return;
   }
 }
@@ -2130,15 +1921,10 @@ static void process_remote(struct script_data *sc, trig_data *trig, char *cmd)
   }
 
   /* find the locally owned variable */
-  for (vd = GET_TRIG_VARS(trig); vd; vd = vd->next)
-    if (!str_cmp(vd->name, buf))
-      break;
+  vd = find_var(GET_TRIG_VARS(trig), buf);
 
   if (!vd)
-    for (vd = sc->global_vars; vd; vd = vd->next)
-      if (!str_cmp(vd->name, var) &&
-          (vd->context==0 || vd->context==sc->context))
-        break;
+    vd = find_var_context(sc->global_vars, var, sc->context);
 
   if (!vd) {
     script_log("Trigger: %s, VNum %d. local var '%s' not found in remote call",
@@ -2179,7 +1965,7 @@ static void process_remote(struct script_data *sc, trig_data *trig, char *cmd)
  * was to delete rooms. */
 ACMD(do_vdelete)
 {
-  struct trig_var_data *vd, *vd_prev=NULL;
+  struct trig_var_data *vd;
   struct script_data *sc_remote=NULL;
   char *var, *uid_p;
   char buf[MAX_INPUT_LENGTH], buf2[MAX_INPUT_LENGTH];
@@ -2229,22 +2015,14 @@ ACMD(do_vdelete)
   }
 
   if (*var == '*' || is_abbrev(var, "all")) {
-    struct trig_var_data *vd_next;
-    for (vd = sc_remote->global_vars; vd; vd = vd_next) {
-      vd_next = vd->next;
-      free(vd->value);
-      free(vd->name);
-      free(vd);
-    }
+    free_varlist(sc_remote->global_vars);
     sc_remote->global_vars = NULL;
     send_to_char(ch, "All variables deleted from that id.\r\n");
     return;
   }
 
   /* find the global */
-  for (vd = sc_remote->global_vars; vd; vd_prev = vd, vd = vd->next)
-    if (!str_cmp(vd->name, var))
-      break;
+  vd = find_var(sc_remote->global_vars, var);
 
   if (!vd) {
     send_to_char(ch, "That variable cannot be located.\r\n");
@@ -2252,13 +2030,7 @@ ACMD(do_vdelete)
   }
 
   /* ok, delete the variable */
-  if (vd_prev) vd_prev->next = vd->next;
-  else sc_remote->global_vars = vd->next;
-
-  /* and free up the space */
-  free(vd->value);
-  free(vd->name);
-  free(vd);
+  delete_var(&sc_remote->global_vars, vd);
 
   send_to_char(ch, "Deleted.\r\n");
 }
@@ -2286,7 +2058,7 @@ int perform_set_dg_var(struct char_data *ch, struct char_data *vict, char *val_a
  * 'rdelete <variable_name> <uid>' */
 static void process_rdelete(struct script_data *sc, trig_data *trig, char *cmd)
 {
-  struct trig_var_data *vd, *vd_prev=NULL;
+  struct trig_var_data *vd;
   struct script_data *sc_remote=NULL;
   char *line, *var, *uid_p;
   char arg[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH], buf2[MAX_STRING_LENGTH];
@@ -2332,21 +2104,12 @@ static void process_rdelete(struct script_data *sc, trig_data *trig, char *cmd)
   if (sc_remote->global_vars==NULL) return; /* no script globals */
 
   /* find the global */
-  for (vd = sc_remote->global_vars; vd; vd_prev = vd, vd = vd->next)
-    if (!str_cmp(vd->name, var) &&
-        (vd->context==0 || vd->context==sc->context))
-      break;
+  vd = find_var_context(sc_remote->global_vars, var, sc->context);
 
   if (!vd) return; /* the variable doesn't exist, or is the wrong context */
 
   /* ok, delete the variable */
-  if (vd_prev) vd_prev->next = vd->next;
-  else sc_remote->global_vars = vd->next;
-
-  /* and free up the space */
-  free(vd->value);
-  free(vd->name);
-  free(vd);
+  delete_var(&sc_remote->global_vars, vd);
 }
 
 /* Makes a local variable into a global variable. */
@@ -2365,9 +2128,7 @@ static void process_global(struct script_data *sc, trig_data *trig, char *cmd, l
     return;
   }
 
-  for (vd = GET_TRIG_VARS(trig); vd; vd = vd->next)
-    if (!str_cmp(vd->name, var))
-      break;
+  vd = find_var(GET_TRIG_VARS(trig), var);
 
   if (!vd) {
     script_log("Trigger: %s, VNum %d. local var '%s' not found in global call",
@@ -2490,6 +2251,8 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
   char cmd[MAX_INPUT_LENGTH], *p;
   struct script_data *sc = 0;
   struct cmdlist_element *temp;
+  struct dg_line *code;
+  int op, cmd_id;
   void *go = NULL;
 
   void obj_command_interpreter(obj_data *obj, char *argument);
@@ -2549,30 +2312,54 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
 
   for (cl = (mode == TRIG_NEW) ? trig->cmdlist : trig->curr_state;
       cl && GET_TRIG_DEPTH(trig); cl = cl->next) {
-    for (p = cl->cmd; *p && isspace(*p); p++);
+#ifdef DG_CORPUS
+    if (dg_corpus_mode)
+      dg_corpus_note("> %s", cl->cmd);
+#endif
+
+    /* The compiled form has the line classified and its block ends found;
+     * the text engine works them out from the line every time. */
+#ifdef DG_CORPUS
+    if (dg_text_engine) {
+      code = NULL;
+      op = dg_line_op(cl->cmd, &p);
+    } else
+#endif
+    {
+      if (!cl->code)
+        dg_compile_cmdlist(trig);
+      code = cl->code;
+      op = code->op;
+      p = code->text;
+    }
 
-    if (*p == '*') /* comment */
+    if (op == DG_OP_COMMENT)
       continue;
 
-    else if (!strn_cmp(p, "if ", 3)) {
+    else if (op == DG_OP_IF) {
       if (process_if(p + 3, go, sc, trig, type))
         GET_TRIG_DEPTH(trig)++;
+      else if (code)
+        cl = run_else_steps(trig, code, go, sc, type);
       else
         cl = find_else_end(trig, cl, go, sc, type);
     }
 
-    else if (!strn_cmp("elseif ", p, 7) ||
-       !strn_cmp("else", p, 4)) {
+    else if (op == DG_OP_ELSE) {
       /* If not in an if-block, ignore the extra 'else[if]' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1) {
         script_log("Trigger VNum %d has 'else' without 'if'.",
                    GET_TRIG_VNUM(trig));
         continue;
       }
-      cl = find_end(trig, cl);
+      if (code) {
+        log_if_errors(trig, code->end_errors);
+        cl = code->end;
+      } else
+        cl = find_end(trig, cl, NULL);
       GET_TRIG_DEPTH(trig)--;
-    } else if (!strn_cmp("while ", p, 6)) {
-      temp = find_done(cl);
+    } else if (op == DG_OP_WHILE) {
+      temp = code ? code->done : find_done(cl);
       if (!temp) {
         script_log("Trigger VNum %d has 'while' without 'done'.",
                    GET_TRIG_VNUM(trig));
@@ -2584,9 +2371,12 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
          cl->loops = 0;
          cl = temp;
       }
-    } else if (!strn_cmp("switch ", p, 7)) {
-      cl = find_case(trig, cl, go, sc, type, p + 7);
-    } else if (!strn_cmp("end", p, 3)) {
+    } else if (op == DG_OP_SWITCH) {
+      if (code)
+        cl = run_case_steps(trig, code, go, sc, type, p + 7);
+      else
+        cl = find_case(trig, cl, go, sc, type, p + 7);
+    } else if (op == DG_OP_END) {
       /* If not in an if-block, ignore the extra 'end' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1) {
         script_log("Trigger VNum %d has 'end' without 'if'.",
@@ -2594,11 +2384,14 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
         continue;
       }
       GET_TRIG_DEPTH(trig)--;
-    } else if (!strn_cmp("done", p, 4)) {
+    } else if (op == DG_OP_DONE) {
       /* if in a while loop, cl->original is non-NULL */
       if (cl->original) {
-      char *orig_cmd = cl->original->cmd;
-      while (*orig_cmd && isspace(*orig_cmd)) orig_cmd++;
+      char *orig_cmd;
+      if (code && cl->original->code)
+        orig_cmd = cl->original->code->text;
+      else
+        for (orig_cmd = cl->original->cmd; *orig_cmd && isspace(*orig_cmd); orig_cmd++);
       if (cl->original && process_if(orig_cmd + 6, go, sc, trig,
           type)) {
         cl = cl->original;
@@ -2619,69 +2412,87 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
          /* if we're falling through a switch statement, this ends it. */
         }
       }
-    } else if (!strn_cmp("break", p, 5)) {
-      cl = find_done(cl);
-    } else if (!strn_cmp("case", p, 4)) {
+    } else if (op == DG_OP_BREAK) {
+      cl = code ? code->done : find_done(cl);
+    } else if (op == DG_OP_CASE) {
        /* Do nothing, this allows multiple cases to a single instance */
     }
 
     else {
-      var_subst(go, sc, trig, type, p, cmd);
+      /* A line without a % comes out of var_subst() unchanged. */
+      if (code && code->literal)
+        snprintf(cmd, sizeof(cmd), "%s", p);
+      else
+        var_subst(go, sc, trig, type, p, cmd);
 
-      if (!strn_cmp(cmd, "eval ", 5))
+      /* Unless a variable supplies the first word, the command is known
+       * from the compiled line. */
+      if (code && code->cmd != DG_CMD_UNKNOWN)
+        cmd_id = code->cmd;
+      else
+        cmd_id = dg_command_id(cmd);
+
+      if (cmd_id == DG_CMD_EVAL)
         process_eval(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "nop ", 4)); /* nop: do nothing */
+      else if (cmd_id == DG_CMD_NOP); /* nop: do nothing */
 
-      else if (!strn_cmp(cmd, "extract ", 8))
+      else if (cmd_id == DG_CMD_EXTRACT)
         extract_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "dg_letter ", 10))
+      else if (cmd_id == DG_CMD_LETTER)
         dg_letter_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "makeuid ", 8))
+      else if (cmd_id == DG_CMD_MAKEUID)
         makeuid_var(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "halt", 4))
+      else if (cmd_id == DG_CMD_HALT)
         break;
 
-      else if (!strn_cmp(cmd, "dg_cast ", 8))
+#ifdef DG_CORPUS
+      else if (dg_corpus_mode && (cmd_id == DG_CMD_CAST || cmd_id == DG_CMD_AFFECT ||
+               cmd_id == DG_CMD_ATTACH || cmd_id == DG_CMD_DETACH ||
+               cmd_id == DG_CMD_OTHER))
+        dg_corpus_note("cmd %s", cmd);
+#endif
+
+      else if (cmd_id == DG_CMD_CAST)
         do_dg_cast(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "dg_affect ", 10))
+      else if (cmd_id == DG_CMD_AFFECT)
         do_dg_affect(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "global ", 7))
+      else if (cmd_id == DG_CMD_GLOBAL)
         process_global(sc, trig, cmd, sc->context);
 
-      else if (!strn_cmp(cmd, "context ", 8))
+      else if (cmd_id == DG_CMD_CONTEXT)
         process_context(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "remote ", 7))
+      else if (cmd_id == DG_CMD_REMOTE)
         process_remote(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "rdelete ", 8))
+      else if (cmd_id == DG_CMD_RDELETE)
         process_rdelete(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "return ", 7))
+      else if (cmd_id == DG_CMD_RETURN)
         ret_val = process_return(trig, cmd);
 
-      else if (!strn_cmp(cmd, "set ", 4))
+      else if (cmd_id == DG_CMD_SET)
         process_set(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "unset ", 6))
+      else if (cmd_id == DG_CMD_UNSET)
         process_unset(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "wait ", 5)) {
+      else if (cmd_id == DG_CMD_WAIT) {
         process_wait(go, trig, type, cmd, cl);
         depth--;
         return ret_val;
       }
 
-      else if (!strn_cmp(cmd, "attach ", 7))
+      else if (cmd_id == DG_CMD_ATTACH)
         process_attach(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "detach ", 7))
+      else if (cmd_id == DG_CMD_DETACH)
         process_detach(go, sc, trig, type, cmd);
 
       else {
@@ -2712,6 +2523,10 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
     case OBJ_TRIGGER:    sc = SCRIPT((obj_data *) go);            break;
     case WLD_TRIGGER:    sc = SCRIPT((room_data *) go);    break;
   }
+#ifdef DG_CORPUS
+  if (dg_corpus_mode)
+    dg_corpus_vars(GET_TRIG_VARS(trig));
+#endif
   if (sc)
   free_varlist(GET_TRIG_VARS(trig));
   GET_TRIG_VARS(trig) = NULL;
@@ -2726,6 +2541,9 @@ trig_rnum real_trigger(trig_vnum vnum)
 {
   trig_rnum bot, top, mid;
 
+  if (vnum_index_lookup(&trig_vnums, vnum, &mid))
+    return (mid);
+
   bot = 0;
   top = top_of_trigt - 1;
 
@@ -2772,7 +2590,7 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
 {
   char result[MAX_INPUT_LENGTH];
   struct cmdlist_element *c;
-  char *p, *buf;
+  char *p;
 
   eval_expr(cond, result, go, sc, trig, type);
 
@@ -2785,13 +2603,8 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
     if (!strn_cmp("while ", p, 6) || !strn_cmp("switch", p, 6))
       c = find_done(c);
     else if (!strn_cmp("case ", p, 5)) {
-      buf = (char*)malloc(MAX_STRING_LENGTH);
-      eval_op("==", result, p + 5, buf, go, sc, trig);
-      if (*buf && *buf!='0') {
-        free(buf);
+      if (eval_case(result, p + 5))
         return c;
-      }
-      free(buf);
     } else if (!strn_cmp("default", p, 7))
       return c;
     else if (!strn_cmp("done", p, 3))
@@ -2800,10 +2613,34 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
   return c;
 }
 
+/* find_case() for a compiled 'switch': only the case values are left to
+ * compare. */
+static struct cmdlist_element *run_case_steps(trig_data *trig,
+    struct dg_line *code, void *go, struct script_data *sc, int type,
+    char *cond)
+{
+  char result[MAX_INPUT_LENGTH];
+  struct dg_step *step;
+  int i;
+
+  eval_expr(cond, result, go, sc, trig, type);
+
+  for (i = 0; i < code->num_steps; i++) {
+    step = &code->steps[i];
+    if (step->kind != DG_STEP_CASE)
+      return step->line;
+
+    if (eval_case(result, step->arg))
+      return step->line;
+  }
+  /* dg_compile_cmdlist() always ends the list with a stop. */
+  return code->steps[code->num_steps - 1].line;
+}
+
 /* Scans for end of while/switch-blocks. Returns the line containg 'end', or 
  * the last line of the trigger if not found. Malformed scripts may cause NULL 
  * to be returned. */
-static struct cmdlist_element *find_done(struct cmdlist_element *cl)
+struct cmdlist_element *find_done(struct cmdlist_element *cl)
 {
   struct cmdlist_element *c;
   char *p;
@@ -2912,7 +2749,7 @@ void save_char_vars(struct char_data *ch)
 
   /* make sure this char has global variables to save */
   if (ch->script->global_vars == NULL) return;
-  vars = ch->script->global_vars;
+  vars = ch->script->global_vars->first;
 
   file = fopen(fn,"wt");
   if (!file) {
@@ -2989,14 +2826,14 @@ void save_char_vars_ascii(FILE *file, struct char_data *ch)
 
   /* Note that currently, context will always be zero. This may change in the 
    * future */
-  for (vars = ch->script->global_vars;vars;vars = vars->next)
+  for (vars = ch->script->global_vars->first;vars;vars = vars->next)
     if (*vars->name != '-')
       count++;
 
   if (count != 0) {
 	  fprintf(file, "Vars: %d\n", count);
 
-  for (vars = ch->script->global_vars;vars;vars = vars->next)
+  for (vars = ch->script->global_vars->first;vars;vars = vars->next)
     if (*vars->name != '-') /* don't save if it begins with - */
       fprintf(file, "%s %ld %s\n", vars->name, vars->context, vars->value);
   }
@@ -74,7 +74,7 @@
 #define MTRIG_DAMAGE           (1 << 20)     /* trigger whenever mob is damaged */
 
 /* obj trigger types */
-#define OTRIG_GLOBAL           (1 << 0)	     /* unused                     */
+#define OTRIG_GLOBAL           (1 << 0)	     /* check even if zone dormant */
 #define OTRIG_RANDOM           (1 << 1)	     /* checked randomly           */
 #define OTRIG_COMMAND          (1 << 2)      /* character types a command  */
 
@@ -109,6 +109,10 @@
 #define WTRIG_LOGIN            (1 << 18)     /* character logs into MUD    */
 #define WTRIG_TIME             (1 << 19)     /* trigger based on game hour */
 
+/* The types, the same bits for mobs, objects and rooms, whose owners are
+ * kept on the trigger registry; see triggers_attached(). */
+#define TRIG_SCHEDULED         (WTRIG_RANDOM | WTRIG_TIME)
+
 /* obj command trigger types */
 #define OCMD_EQUIP             (1 << 0)	     /* obj must be in char's equip */
 #define OCMD_INVEN             (1 << 1)	     /* obj must be in char's inven */
@@ -131,20 +135,101 @@
 
 #define SCRIPT_ERROR_CODE     -9999999   /* this shouldn't happen too often */
 
+/* What script_driver() does with a line (struct dg_line op). */
+#define DG_OP_CMD       0   /* anything else: var_subst() and run it */
+#define DG_OP_COMMENT   1   /* '*' */
+#define DG_OP_IF        2   /* "if " */
+#define DG_OP_ELSE      3   /* "else" or "elseif " reached from inside a block */
+#define DG_OP_WHILE     4   /* "while " */
+#define DG_OP_SWITCH    5   /* "switch " */
+#define DG_OP_END       6   /* "end" */
+#define DG_OP_DONE      7   /* "done" */
+#define DG_OP_BREAK     8   /* "break" */
+#define DG_OP_CASE      9   /* "case", reached by falling through */
+
+/* Script commands handled by the driver itself, in the order it tests for
+ * them.  DG_CMD_OTHER goes to the mob/obj/wld command interpreters. */
+#define DG_CMD_UNKNOWN  0   /* first word comes from a variable */
+#define DG_CMD_EVAL     1
+#define DG_CMD_NOP      2
+#define DG_CMD_EXTRACT  3
+#define DG_CMD_LETTER   4
+#define DG_CMD_MAKEUID  5
+#define DG_CMD_HALT     6
+#define DG_CMD_CAST     7
+#define DG_CMD_AFFECT   8
+#define DG_CMD_GLOBAL   9
+#define DG_CMD_CONTEXT  10
+#define DG_CMD_REMOTE   11
+#define DG_CMD_RDELETE  12
+#define DG_CMD_RETURN   13
+#define DG_CMD_SET      14
+#define DG_CMD_UNSET    15
+#define DG_CMD_WAIT     16
+#define DG_CMD_ATTACH   17
+#define DG_CMD_DETACH   18
+#define DG_CMD_OTHER    19
+
+/* Kinds of stop in a precomputed block scan (struct dg_step kind). */
+#define DG_STEP_ELSEIF  0   /* jump here if arg is true */
+#define DG_STEP_ELSE    1   /* jump here, entering the else block */
+#define DG_STEP_CASE    2   /* jump here if the switch value == arg */
+#define DG_STEP_STOP    3   /* end of the scan: jump here */
+
+/** One stop in the scan find_else_end() or find_case() would make. */
+struct dg_step {
+  byte kind;                         /**< DG_STEP_* */
+  struct cmdlist_element *line;      /**< Where execution continues. */
+  char *arg;                         /**< Condition or case value. */
+  char *errors;                      /**< find_end() errors logged first. */
+};
+
+/** A trigger line as compiled by dg_compile_cmdlist(). */
+struct dg_line {
+  byte op;                           /**< DG_OP_* */
+  byte cmd;                          /**< DG_CMD_* for DG_OP_CMD lines. */
+  bool literal;                      /**< No '%' in the line. */
+  char *text;                        /**< The line with leading spaces skipped. */
+  struct cmdlist_element *end;       /**< find_end() from an else line. */
+  char *end_errors;                  /**< Errors that find_end() logs. */
+  struct cmdlist_element *done;      /**< find_done() from a while/break line. */
+  struct dg_step *steps;             /**< if: else/end scan; switch: case scan. */
+  int num_steps;
+};
+
 /* one line of the trigger */
 struct cmdlist_element {
   char *cmd;				/* one line of a trigger */
   struct cmdlist_element *original;
   struct cmdlist_element *next;
   int loops;        /* for counting number of runs in a while loop */
+  struct dg_line *code;  /* compiled form, shared like the line itself */
 };
 
+/** Values up to this long, with the terminator, are kept in the variable. */
+#define DG_VAR_INLINE 16
+
 struct trig_var_data {
   char *name;				/* name of variable  */
   char *value;				/* value of variable */
   long context;				/* 0: global context */
 
-  struct trig_var_data *next;
+  struct trig_var_data *next;		/* next older variable */
+  struct trig_var_data *prev;		/* next newer variable */
+  struct trig_var_data *next_same;	/* next older one with this name */
+  unsigned long hash;			/* of the name, ignoring case */
+  size_t value_size;			/* room at value */
+  char value_buf[DG_VAR_INLINE];	/* value, when it fits */
+};
+
+/** A list of trigger variables, newest first, indexed by name once it gets
+ * long enough to be worth it. */
+struct trig_var_table {
+  struct trig_var_data *first;	/**< newest variable                 */
+  struct trig_var_data **slots;	/**< newest of each name, or NULL    */
+  int num_slots;		/**< size of slots, a power of 2     */
+  int num_names;		/**< slots in use                    */
+  int num_vars;			/**< variables in the list           */
 };
 
 /** structure for triggers */
@@ -162,7 +247,7 @@ struct trig_data {
     int loops;                          /**< loop iteration counter          */
     struct event *wait_event;           /**< event to pause the trigger  */
     ubyte purged;                       /**< trigger is set to be purged     */
-    struct trig_var_data *var_list;	    /**< list of local vars for trigger  */
+    struct trig_var_table *var_list;	    /**< list of local vars for trigger  */
 
     struct trig_data *next;
     struct trig_data *next_in_world;    /**< next in the global trigger list */
@@ -172,7 +257,7 @@ struct trig_data {
 struct script_data {
   long types;                        /**< bitvector of trigger types */
   struct trig_data *trig_list;       /**< list of triggers           */
-  struct trig_var_data *global_vars; /**< list of global variables   */
+  struct trig_var_table *global_vars; /**< list of global variables  */
   ubyte purged;                      /**< script is set to be purged */
   long context;                      /**< current context for statics */
 
@@ -298,7 +383,6 @@ void do_sstat_character(char_data *ch, char_data *k);
 void add_trigger(struct script_data *sc, trig_data *t, int loc);
 void script_vlog(const char *format, va_list args);
 void script_log(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
-char *matching_quote(char *p);
 struct room_data *dg_room_of_obj(struct obj_data *obj);
 bool check_flags_by_name_ar(int *array, int numflags, char *search, const char *namelist[]);
 void read_saved_vars_ascii(FILE *file, struct char_data *ch, int count);
@@ -309,6 +393,15 @@ int trig_is_attached(struct script_data *sc, int trig_num);
 /* To maintain strict-aliasing we'll have to do this trick with a union */
 /* Thanks to Chris Gilbert for reminding me that there are other options. */
 int script_driver(void *go_adress, trig_data *trig, int type, int mode);
+#ifdef DG_CORPUS
+extern bool dg_text_engine;
+#endif
+int dg_line_op(char *line, char **text);
+int dg_command_id(const char *cmd);
+struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl,
+                                 char *errors);
+struct cmdlist_element *find_done(struct cmdlist_element *cl);
+void log_if_errors(trig_data *trig, const char *errors);
 trig_rnum real_trigger(trig_vnum vnum);
 void process_eval(void *go, struct script_data *sc, trig_data *trig,
                  int type, char *cmd);
@@ -318,6 +411,28 @@ void init_lookup_table(void);
 void add_to_lookup_table(long uid, void *c);
 void remove_from_lookup_table(long uid);
 
+/* from dg_compile.c */
+void dg_compile_cmdlist(trig_data *trig);
+void dg_compile_all(void);
+void free_cmdlist(struct cmdlist_element *cl);
+
+/* from dg_eval.c */
+char *matching_quote(char *p);
+void eval_expr(char *line, char *result, void *go, struct script_data *sc,
+               trig_data *trig, int type);
+int process_if(char *cond, void *go, struct script_data *sc,
+               trig_data *trig, int type);
+int eval_case(char *value, char *arg);
+
+#ifdef DG_CORPUS
+/* from tests/dg_corpus.c, linked only into bin/check_dg_corpus */
+extern bool dg_corpus_mode;
+void dg_corpus_note(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
+void dg_corpus_wait(void);
+void dg_corpus_vars(struct trig_var_table *vars);
+int dg_corpus_run(const char *path);
+#endif
+
 /* from dg_db_scripts.c */
 void parse_trigger(FILE *trig_f, int nr);
 trig_data *read_trigger(int nr);
@@ -327,7 +442,10 @@ void dg_obj_trigger(char *line, struct obj_data *obj);
 void assign_triggers(void *i, int type);
 
 /* From dg_variables.c */
-void add_var(struct trig_var_data **var_list, const char *name, const char *value, long id);
+void add_var(struct trig_var_table **var_list, const char *name, const char *value, long id);
+struct trig_var_data *find_var(struct trig_var_table *vars, const char *name);
+struct trig_var_data *find_var_context(struct trig_var_table *vars, const char *name, long context);
+void delete_var(struct trig_var_table **vars, struct trig_var_data *vd);
 int item_in_list(char *item, obj_data *list);
 char *skill_percent(struct char_data *ch, char *skill);
 int char_has_item(char *item, struct char_data *ch);
@@ -340,8 +458,20 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
 /* From dg_handler.c */
 void free_var_el(struct trig_var_data *var);
-void free_varlist(struct trig_var_data *vd);
-int remove_var(struct trig_var_data **var_list, char *name);
+void free_varlist(struct trig_var_table *vars);
+int remove_var(struct trig_var_table **var_list, char *name);
+long room_mob_trig_types(struct room_data *room);
+long room_obj_trig_types(struct room_data *room);
+void room_trig_types_enter_char(room_rnum room, struct char_data *ch);
+void room_trig_types_leave_char(room_rnum room, struct char_data *ch);
+void room_trig_types_enter_obj(room_rnum room, struct obj_data *obj);
+void room_trig_types_leave_obj(room_rnum room, struct obj_data *obj);
+void unschedule_char(struct char_data *ch);
+void unschedule_obj(struct obj_data *obj);
+struct char_data *next_scheduled_char(bool first, long types);
+struct obj_data *next_scheduled_obj(bool first, long types);
+struct room_data *next_scheduled_room(bool first, long types);
+void triggers_attached(void *thing, int type);
 void free_trigger(trig_data *trig);
 void extract_trigger(struct trig_data *trig);
 void extract_script(void *thing, int type);
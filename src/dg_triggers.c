@@ -207,6 +207,9 @@ int greet_mtrigger(char_data *actor, int dir)
   if (!valid_dg_target(actor, DG_ALLOW_GODS))
     return TRUE;
 
+  if (!(room_mob_trig_types(&world[IN_ROOM(actor)]) & (MTRIG_GREET | MTRIG_GREET_ALL)))
+    return TRUE;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch->next_in_room) {
     if (!SCRIPT_CHECK(ch, MTRIG_GREET | MTRIG_GREET_ALL) ||
         !AWAKE(ch) || FIGHTING(ch) || (ch == actor) ||
@@ -301,6 +304,9 @@ int command_mtrigger(char_data *actor, char *cmd, char *argument)
   if (!valid_dg_target(actor, 0))
     return 0;
 
+  if (!(room_mob_trig_types(&world[IN_ROOM(actor)]) & MTRIG_COMMAND))
+    return 0;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next) {
     ch_next = ch->next_in_room;
 
@@ -340,6 +346,9 @@ void speech_mtrigger(char_data *actor, char *str)
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
 
+  if (!(room_mob_trig_types(&world[IN_ROOM(actor)]) & MTRIG_SPEECH))
+    return;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next)
   {
     ch_next = ch->next_in_room;
@@ -590,6 +599,9 @@ int leave_mtrigger(char_data *actor, int dir)
   if (!valid_dg_target(actor, DG_ALLOW_GODS))
     return 1;
 
+  if (!(room_mob_trig_types(&world[IN_ROOM(actor)]) & MTRIG_LEAVE))
+    return 1;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch->next_in_room) {
     if (!SCRIPT_CHECK(ch, MTRIG_LEAVE) ||
         !AWAKE(ch) || FIGHTING(ch) || (ch == actor) ||
@@ -617,6 +629,9 @@ int door_mtrigger(char_data *actor, int subcmd, int dir)
   char_data *ch;
   char buf[MAX_INPUT_LENGTH];
 
+  if (!(room_mob_trig_types(&world[IN_ROOM(actor)]) & MTRIG_DOOR))
+    return 1;
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch->next_in_room) {
     if (!SCRIPT_CHECK(ch, MTRIG_DOOR) ||
         !AWAKE(ch) || FIGHTING(ch) || (ch == actor) ||
@@ -762,6 +777,10 @@ int command_otrigger(char_data *actor, char *cmd, char *argument)
   if (!valid_dg_target(actor, 0))
     return 0;
 
+  /* The room's mask covers what the actor wears and carries, too. */
+  if (!(room_obj_trig_types(&world[IN_ROOM(actor)]) & OTRIG_COMMAND))
+    return 0;
+
   for (i = 0; i < NUM_WEARS; i++)
     if (GET_EQ(actor, i))
       if (cmd_otrig(GET_EQ(actor, i), actor, cmd, argument, OCMD_EQUIP))
@@ -938,6 +957,9 @@ int leave_otrigger(room_data *room, char_data *actor, int dir)
   if (!valid_dg_target(actor, DG_ALLOW_GODS))
     return 1;
 
+  if (!(room_obj_trig_types(room) & OTRIG_LEAVE))
+    return 1;
+
   for (obj = room->contents; obj; obj = obj_next) {
     obj_next = obj->next_content;
     if (!SCRIPT_CHECK(obj, OTRIG_LEAVE))
@@ -11,6 +11,7 @@
 #include "sysdep.h"
 #include "structs.h"
 #include "dg_scripts.h"
+#include "dg_fields.h"
 #include "utils.h"
 #include "comm.h"
 #include "interpreter.h"
@@ -29,39 +30,223 @@
 
 /* Utility functions */
 
+/* Lists shorter than this are searched in order rather than indexed. */
+#define VAR_INDEX_MIN 8
+
+/* FNV-1a over the name folded to lower case, since variable names are
+ * compared with str_cmp(). */
+static unsigned long var_hash(const char *name)
+{
+  unsigned long h = 2166136261UL;
+
+  for (; *name; name++)
+    h = (h ^ (unsigned char)LOWER(*name)) * 16777619UL;
+  return (h);
+}
+
+/* The slot holding name, or the empty slot it would go in. */
+static int var_slot(struct trig_var_table *vars, const char *name, unsigned long hash)
+{
+  int mask = vars->num_slots - 1, i;
+
+  for (i = hash & mask; vars->slots[i]; i = (i + 1) & mask)
+    if (vars->slots[i]->hash == hash && !str_cmp(vars->slots[i]->name, name))
+      break;
+  return (i);
+}
+
+/* (Re)builds the index with the given number of slots.  Each slot holds the
+ * newest variable of one name; older ones hang off it by next_same. */
+static void build_var_index(struct trig_var_table *vars, int num_slots)
+{
+  struct trig_var_data *vd, *last = NULL;
+  int i;
+
+  if (vars->slots)
+    free(vars->slots);
+  CREATE(vars->slots, struct trig_var_data *, num_slots);
+  vars->num_slots = num_slots;
+  vars->num_names = 0;
+
+  /* Oldest first, so each name's chain ends up newest first. */
+  for (vd = vars->first; vd; vd = vd->next)
+    last = vd;
+  for (vd = last; vd; vd = vd->prev) {
+    i = var_slot(vars, vd->name, vd->hash);
+    if (!vars->slots[i])
+      vars->num_names++;
+    vd->next_same = vars->slots[i];
+    vars->slots[i] = vd;
+  }
+}
+
+/* Empties slot i, moving up any later names that probed past it. */
+static void clear_var_slot(struct trig_var_table *vars, int i)
+{
+  int mask = vars->num_slots - 1, j = i, k;
+
+  for (;;) {
+    j = (j + 1) & mask;
+    if (!vars->slots[j])
+      break;
+    k = vars->slots[j]->hash & mask;
+    if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+      vars->slots[i] = vars->slots[j];
+      i = j;
+    }
+  }
+  vars->slots[i] = NULL;
+  vars->num_names--;
+}
+
+/* Stores value, reusing the space the old value had when it fits. */
+static void set_var_value(struct trig_var_data *vd, const char *value)
+{
+  size_t len = strlen(value) + 1;
+
+  if (len > vd->value_size) {
+    if (vd->value == vd->value_buf)
+      CREATE(vd->value, char, len);
+    else
+      RECREATE(vd->value, char, len);
+    vd->value_size = len;
+  }
+  memmove(vd->value, value, len);
+}
+
+/** Finds the newest variable called name.
+ * @param vars The list, which may be NULL.
+ * @param name The variable name, in any case.
+ * @retval trig_var_data * The variable, or NULL. */
+struct trig_var_data *find_var(struct trig_var_table *vars, const char *name)
+{
+  struct trig_var_data *vd;
+  unsigned long hash;
+
+  if (!vars)
+    return (NULL);
+  hash = var_hash(name);
+  if (vars->slots)
+    return (vars->slots[var_slot(vars, name, hash)]);
+
+  for (vd = vars->first; vd; vd = vd->next)
+    if (vd->hash == hash && !str_cmp(vd->name, name))
+      break;
+  return (vd);
+}
+
+/** Finds the newest variable called name that a script in the given
+ * context can see: one set in that context, or in the global context 0.
+ * @param vars The list, which may be NULL.
+ * @param name The variable name, in any case.
+ * @param context The script's context.
+ * @retval trig_var_data * The variable, or NULL. */
+struct trig_var_data *find_var_context(struct trig_var_table *vars, const char *name, long context)
+{
+  struct trig_var_data *vd;
+  unsigned long hash;
+
+  if (!vars)
+    return (NULL);
+  hash = var_hash(name);
+  if (vars->slots) {
+    for (vd = vars->slots[var_slot(vars, name, hash)]; vd; vd = vd->next_same)
+      if (vd->context == 0 || vd->context == context)
+        break;
+    return (vd);
+  }
+
+  for (vd = vars->first; vd; vd = vd->next)
+    if (vd->hash == hash && !str_cmp(vd->name, name) &&
+        (vd->context == 0 || vd->context == context))
+      break;
+  return (vd);
+}
+
+/** Unlinks a variable from its list and frees it.  The list itself is
+ * freed, and *vars set to NULL, when the last variable goes.
+ * @param vars The list holding vd.
+ * @param vd The variable. */
+void delete_var(struct trig_var_table **vars, struct trig_var_data *vd)
+{
+  struct trig_var_table *t = *vars;
+  struct trig_var_data **same;
+  int i;
+
+  if (t->slots) {
+    i = var_slot(t, vd->name, vd->hash);
+    for (same = &t->slots[i]; *same != vd; same = &(*same)->next_same);
+    *same = vd->next_same;
+    if (!t->slots[i])
+      clear_var_slot(t, i);
+  }
+
+  if (vd->prev)
+    vd->prev->next = vd->next;
+  else
+    t->first = vd->next;
+  if (vd->next)
+    vd->next->prev = vd->prev;
+  free_var_el(vd);
+
+  if (--t->num_vars == 0) {
+    free_varlist(t);
+    *vars = NULL;
+  }
+}
+
 /* Thanks to James Long for his assistance in plugging the memory leak that
  * used to be here. - Welcor */
 /* Adds a variable with given name and value to trigger. */
-void add_var(struct trig_var_data **var_list, const char *name, const char *value, long id)
+void add_var(struct trig_var_table **var_list, const char *name, const char *value, long id)
 {
+  struct trig_var_table *vars;
   struct trig_var_data *vd;
+  int i;
 
   if (strchr(name, '.')) {
     log("add_var() : Attempt to add illegal var: %s", name);
     return;
   }
 
-  for (vd = *var_list; vd && str_cmp(vd->name, name); vd = vd->next);
-
-  if (vd && (!vd->context || vd->context==id)) {
-    free(vd->value);
-    CREATE(vd->value, char, strlen(value) + 1);
-  }
-
-  else {
-    CREATE(vd, struct trig_var_data, 1);
+  if (!*var_list)
+    CREATE(*var_list, struct trig_var_table, 1);
+  vars = *var_list;
 
-    CREATE(vd->name, char, strlen(name) + 1);
-    strcpy(vd->name, name);                            /* strcpy: ok*/
+  vd = find_var(vars, name);
 
-    CREATE(vd->value, char, strlen(value) + 1);
-
-    vd->next = *var_list;
-    vd->context = id;
-    *var_list = vd;
+  if (vd && (!vd->context || vd->context==id)) {
+    set_var_value(vd, value);
+    return;
   }
 
-  strcpy(vd->value, value);                            /* strcpy: ok*/
+  CREATE(vd, struct trig_var_data, 1);
+  vd->name = strdup(name);
+  vd->hash = var_hash(name);
+  vd->value = vd->value_buf;
+  vd->value_size = sizeof(vd->value_buf);
+  set_var_value(vd, value);
+  vd->context = id;
+
+  vd->next = vars->first;
+  if (vars->first)
+    vars->first->prev = vd;
+  vars->first = vd;
+  vars->num_vars++;
+
+  if (vars->slots) {
+    i = var_slot(vars, name, vd->hash);
+    if (!vars->slots[i]) {
+      vars->num_names++;
+      if (vars->num_names * 4 > vars->num_slots * 3) {
+        build_var_index(vars, vars->num_slots * 2);
+        return;
+      }
+    }
+    vd->next_same = vars->slots[i];
+    vars->slots[i] = vd;
+  } else if (vars->num_vars >= VAR_INDEX_MIN)
+    build_var_index(vars, VAR_INDEX_MIN * 2);
 }
 
 /* perhaps not the best place for this, but I didn't want a new file */
@@ -175,16 +360,17 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
 {
   char *p, *p2;
   char tmpvar[MAX_STRING_LENGTH];
+  int fid = dg_field_id(DG_FIELDS_TEXT, field);
 
-  if (!str_cmp(field, "strlen")) {                     /* strlen    */
+  if (fid == DG_TEXT_STRLEN) {                     /* strlen    */
     snprintf(str, slen, "%d", (int)strlen(vd->value));
     return TRUE;
-  } else if (!str_cmp(field, "toupper")) {             /* toupper   */
+  } else if (fid == DG_TEXT_TOUPPER) {             /* toupper   */
     char *upper = vd->value;
     if (*upper)
       snprintf(str, slen, "%c%s", UPPER(*upper), upper + 1);
     return TRUE;
-  } else if (!str_cmp(field, "trim")) {                /* trim      */
+  } else if (fid == DG_TEXT_TRIM) {                /* trim      */
     /* trim whitespace from ends */
     snprintf(tmpvar, sizeof(tmpvar)-1 , "%s", vd->value); /* -1 to use later*/
     p = tmpvar;
@@ -198,34 +384,34 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
     *(++p2) = '\0';                                         /* +1 ok (see above) */
     snprintf(str, slen, "%s", p);
     return TRUE;
-  } else if (!str_cmp(field, "contains")) {            /* contains  */
+  } else if (fid == DG_TEXT_CONTAINS) {            /* contains  */
     if (str_str(vd->value, subfield))
       strcpy(str, "1");
     else
       strcpy(str, "0");
     return TRUE;
-  } else if (!str_cmp(field, "car")) {                 /* car       */
+  } else if (fid == DG_TEXT_CAR) {                 /* car       */
     char *car = vd->value;
     while (*car && !isspace(*car))
       *str++ = *car++;
     *str = '\0';
     return TRUE;
 
-  } else if (!str_cmp(field, "cdr")) {                 /* cdr       */
+  } else if (fid == DG_TEXT_CDR) {                 /* cdr       */
     char *cdr = vd->value;
     while (*cdr && !isspace(*cdr)) cdr++; /* skip 1st field */
     while (*cdr && isspace(*cdr)) cdr++;  /* skip to next */
 
     snprintf(str, slen, "%s", cdr);
     return TRUE;
-  } else if (!str_cmp(field, "charat")) {              /* CharAt    */
+  } else if (fid == DG_TEXT_CHARAT) {              /* CharAt    */
     size_t len = strlen(vd->value), cindex = atoi(subfield);
     if (cindex > len || cindex < 1)
       strcpy(str, "");
     else
       snprintf(str, slen, "%c", vd->value[cindex - 1]);
     return TRUE;
-  } else if (!str_cmp(field, "mudcommand")) {
+  } else if (fid == DG_TEXT_MUDCOMMAND) {
     /* find the mud command returned from this text */
 /* NOTE: you may need to replace "cmd_info" with "complete_cmd_info", */
 /* depending on what patches you've got applied.                      */
@@ -255,48 +441,45 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
   obj_data *obj, *o = NULL;
   struct room_data *room, *r = NULL;
   char *name;
-  int num, count, i, j, doors;
-
-  char *log_cmd[]        = {"mlog ",        "olog ",        "wlog "       };
-  char *send_cmd[]       = {"msend ",       "osend ",       "wsend "      };
-  char *echo_cmd[]       = {"mecho ",       "oecho ",       "wecho "      };
-  char *echoaround_cmd[] = {"mechoaround ", "oechoaround ", "wechoaround "};
-  char *door[]           = {"mdoor ",       "odoor ",       "wdoor "      };
-  char *force[]          = {"mforce ",      "oforce ",      "wforce "     };
-  char *load[]           = {"mload ",       "oload ",       "wload "      };
-  char *purge[]          = {"mpurge ",      "opurge ",      "wpurge "     };
-  char *teleport[]       = {"mteleport ",   "oteleport ",   "wteleport "  };
+  int num, count, i, j, doors, var_id, fid;
+
+  static const char * const log_cmd[]        = {"mlog ",        "olog ",        "wlog "       };
+  static const char * const send_cmd[]       = {"msend ",       "osend ",       "wsend "      };
+  static const char * const echo_cmd[]       = {"mecho ",       "oecho ",       "wecho "      };
+  static const char * const echoaround_cmd[] = {"mechoaround ", "oechoaround ", "wechoaround "};
+  static const char * const door[]           = {"mdoor ",       "odoor ",       "wdoor "      };
+  static const char * const force[]          = {"mforce ",      "oforce ",      "wforce "     };
+  static const char * const load[]           = {"mload ",       "oload ",       "wload "      };
+  static const char * const purge[]          = {"mpurge ",      "opurge ",      "wpurge "     };
+  static const char * const teleport[]       = {"mteleport ",   "oteleport ",   "wteleport "  };
   /* the x kills a 'shadow' warning in gcc. */
-  char *xdamage[]        = {"mdamage ",     "odamage ",     "wdamage "    };
-  char *zoneecho[]       = {"mzoneecho ",   "ozoneecho ",   "wzoneecho "  };
-  char *asound[]         = {"masound ",     "oasound ",     "wasound "    };
-  char *at[]             = {"mat ",         "oat ",         "wat "        };
+  static const char * const xdamage[]        = {"mdamage ",     "odamage ",     "wdamage "    };
+  static const char * const zoneecho[]       = {"mzoneecho ",   "ozoneecho ",   "wzoneecho "  };
+  static const char * const asound[]         = {"masound ",     "oasound ",     "wasound "    };
+  static const char * const at[]             = {"mat ",         "oat ",         "wat "        };
   /* there is no such thing as wtransform, thus the wecho below  */
-  char *transform[]      = {"mtransform ",  "otransform ",  "wecho "      };
-  char *recho[]          = {"mrecho ",      "orecho ",      "wrecho "     };
+  static const char * const transform[]      = {"mtransform ",  "otransform ",  "wecho "      };
+  static const char * const recho[]          = {"mrecho ",      "orecho ",      "wrecho "     };
   /* there is no such thing as mmove, thus the mecho below  */
-  char *omove[]          = {"mecho ",      "omove ",      "wmove "     };
+  static const char * const omove[]          = {"mecho ",      "omove ",      "wmove "     };
 
   *str = '\0';
 
   /* X.global() will have a NULL trig */
   if (trig)
-    for (vd = GET_TRIG_VARS(trig); vd; vd = vd->next)
-      if (!str_cmp(vd->name, var))
-        break;
+    vd = find_var(GET_TRIG_VARS(trig), var);
 
   /* some evil waitstates could crash the mud if sent here with sc==NULL*/
   if (!vd && sc)
-    for (vd = sc->global_vars; vd; vd = vd->next)
-      if (!str_cmp(vd->name, var) &&
-          (vd->context==0 || vd->context==sc->context))
-        break;
+    vd = find_var_context(sc->global_vars, var, sc->context);
+
+  var_id = vd ? DG_FIELD_NONE : dg_field_id(DG_FIELDS_VAR, var);
 
   if (!*field) {
     if (vd)
       snprintf(str, slen, "%s", vd->value);
     else {
-      if (!str_cmp(var, "self")) {
+      if (var_id == DG_VAR_SELF) {
         switch (type) {
         case MOB_TRIGGER:
           snprintf(str, slen, "%c%ld", UID_CHAR, char_script_id((char_data *) go));
@@ -309,42 +492,42 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           break;
         }
       }
-      else if (!str_cmp(var, "global")) {
+      else if (var_id == DG_VAR_GLOBAL) {
         /* so "remote varname %global%" will work */
         snprintf(str, slen, "%d", ROOM_ID_BASE);
         return;
       }
-      else if (!str_cmp(var, "door"))
+      else if (var_id == DG_VAR_DOOR)
         snprintf(str, slen, "%s", door[type]);
-      else if (!str_cmp(var, "force"))
+      else if (var_id == DG_VAR_FORCE)
         snprintf(str, slen, "%s", force[type]);
-      else if (!str_cmp(var, "load"))
+      else if (var_id == DG_VAR_LOAD)
         snprintf(str, slen, "%s", load[type]);
-      else if (!str_cmp(var, "purge"))
+      else if (var_id == DG_VAR_PURGE)
         snprintf(str, slen, "%s", purge[type]);
-      else if (!str_cmp(var, "teleport"))
+      else if (var_id == DG_VAR_TELEPORT)
         snprintf(str, slen, "%s", teleport[type]);
-      else if (!str_cmp(var, "damage"))
+      else if (var_id == DG_VAR_DAMAGE)
         snprintf(str, slen, "%s", xdamage[type]);
-      else if (!str_cmp(var, "send"))
+      else if (var_id == DG_VAR_SEND)
         snprintf(str, slen, "%s", send_cmd[type]);
-      else if (!str_cmp(var, "echo"))
+      else if (var_id == DG_VAR_ECHO)
         snprintf(str, slen, "%s", echo_cmd[type]);
-      else if (!str_cmp(var, "echoaround"))
+      else if (var_id == DG_VAR_ECHOAROUND)
         snprintf(str, slen, "%s", echoaround_cmd[type]);
-      else if (!str_cmp(var, "zoneecho"))
+      else if (var_id == DG_VAR_ZONEECHO)
         snprintf(str, slen, "%s", zoneecho[type]);
-      else if (!str_cmp(var, "asound"))
+      else if (var_id == DG_VAR_ASOUND)
         snprintf(str, slen, "%s", asound[type]);
-      else if (!str_cmp(var, "at"))
+      else if (var_id == DG_VAR_AT)
         snprintf(str, slen, "%s", at[type]);
-      else if (!str_cmp(var, "transform"))
+      else if (var_id == DG_VAR_TRANSFORM)
         snprintf(str, slen, "%s", transform[type]);
-      else if (!str_cmp(var, "recho"))
+      else if (var_id == DG_VAR_RECHO)
         snprintf(str, slen, "%s", recho[type]);
-      else if (!str_cmp(var, "move"))
+      else if (var_id == DG_VAR_MOVE)
         snprintf(str, slen, "%s", omove[type]);
-      else if (!str_cmp(var, "log"))
+      else if (var_id == DG_VAR_LOG)
         snprintf(str, slen, "%s", log_cmd[type]);
       else
         *str = '\0';
@@ -392,7 +575,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
     }
 
     else {
-      if (!str_cmp(var, "self")) {
+      if (var_id == DG_VAR_SELF) {
         switch (type) {
         case MOB_TRIGGER:
           c = (char_data *) go;
@@ -412,27 +595,25 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
       }
 
-      else if (!str_cmp(var, "global")) {
+      else if (var_id == DG_VAR_GLOBAL) {
         struct script_data *thescript = SCRIPT(&world[0]);
         *str = '\0';
         if (!thescript) {
           script_log("Attempt to find global var. Apparently the void has no script.");
           return;
         }
-        for (vd = thescript->global_vars; vd ; vd = vd->next)
-          if (!str_cmp(vd->name, field))
-            break;
+        vd = find_var(thescript->global_vars, field);
 
         if (vd)
           snprintf(str, slen, "%s", vd->value);
 
         return;
       }
-      else if (!str_cmp(var, "people")) {
+      else if (var_id == DG_VAR_PEOPLE) {
         snprintf(str, slen, "%d",((num = atoi(field)) > 0) ? trgvar_in_room(num) : 0);
         return;
       }
-      else if (!str_cmp(var, "time")) {
+      else if (var_id == DG_VAR_TIME) {
         if (!str_cmp(field, "hour"))
           snprintf(str, slen, "%d", time_info.hours);
         else if (!str_cmp(field, "day"))
@@ -454,7 +635,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
  * coins (vnum: 1234). In the vault (vnum: 453). Use: %findobj.453(1234)% and it
  * will return the number of bags of coins.
  * Addition inspired by Jamie Nelson */
-      else if (!str_cmp(var, "findmob")) {
+      else if (var_id == DG_VAR_FINDMOB) {
         if (!field || !*field || !subfield || !*subfield) {
           script_log("findmob.vnum(mvnum) - illegal syntax");
           strcpy(str, "0");
@@ -475,7 +656,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
       }
       /* Addition inspired by Jamie Nelson. */
-      else if (!str_cmp(var, "findobj")) {
+      else if (var_id == DG_VAR_FINDOBJ) {
         if (!field || !*field || !subfield || !*subfield) {
           script_log("findobj.vnum(ovnum) - illegal syntax");
           strcpy(str, "0");
@@ -491,7 +672,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
         }
       }
-      else if (!str_cmp(var, "random")) {
+      else if (var_id == DG_VAR_RANDOM) {
         if (!str_cmp(field, "char")) {
           rndm = NULL;
           count = 0;
@@ -577,7 +758,8 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
     }
 
     if (c) {
-      if (!str_cmp(field, "global")) { /* get global of something else */
+      fid = dg_field_id(DG_FIELDS_CHAR, field);
+      if (fid == DG_CHAR_GLOBAL) { /* get global of something else */
         if (IS_NPC(c) && c->script) {
           find_replacement(go, c->script, NULL, MOB_TRIGGER,
             subfield, NULL, NULL, str, slen);
@@ -588,7 +770,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
       switch (LOWER(*field)) {
         case 'a':
-          if (!str_cmp(field, "affect")) {
+          if (fid == DG_CHAR_AFFECT) {
             if (subfield && *subfield) {
               int spell = find_skill_num(subfield);
               if (affected_by_spell(c, spell))
@@ -598,27 +780,29 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             } else
               strcpy(str, "0");
           }
-          else if (!str_cmp(field, "alias"))
+          else if (fid == DG_CHAR_ALIAS)
             snprintf(str, slen, "%s", GET_PC_NAME(c));
 
-          else if (!str_cmp(field, "align")) {
+          else if (fid == DG_CHAR_ALIGN) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
              GET_ALIGNMENT(c) = MAX(-1000, MIN(addition, 1000));
+             MARK_CHAR_CHANGED(c);
+             msdp_changed(c, MSDP_DIRTY_ALIGN);
             }
 	    snprintf(str, slen, "%d", GET_ALIGNMENT(c));
           }
-          else if (!str_cmp(field, "armor"))
+          else if (fid == DG_CHAR_ARMOR)
             snprintf(str, slen, "%d", compute_armor_class(c));
           break;
         case 'c':
-          if (!str_cmp(field, "canbeseen")) {
+          if (fid == DG_CHAR_CANBESEEN) {
             if ((type == MOB_TRIGGER) && !CAN_SEE(((char_data *)go), c))
               strcpy(str, "0");
             else
               strcpy(str, "1");
           }
-          else if (!str_cmp(field, "cha")) {
+          else if (fid == DG_CHAR_CHA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -629,11 +813,12 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             }
             snprintf(str, slen, "%d", GET_CHA(c));
           }
-          else if (!str_cmp(field, "class")) {
+          else if (fid == DG_CHAR_CLASS) {
             if (subfield && *subfield) {
               int cl = get_class_by_name(subfield);
               if (cl != -1) {
                 GET_CLASS(c) = cl;
+                MARK_CHAR_CHANGED(c);
                 snprintf(str, slen, "1");
               } else {
                 snprintf(str, slen, "0");
@@ -641,7 +826,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             } else
               sprinttype(GET_CLASS(c), pc_class_types, str, slen);
           }
-          else if (!str_cmp(field, "con")) {
+          else if (fid == DG_CHAR_CON) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -654,7 +839,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'd':
-          if (!str_cmp(field, "dex")) {
+          if (fid == DG_CHAR_DEX) {
               if (subfield && *subfield) {
                 int addition = atoi(subfield);
                 int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -665,16 +850,17 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
               }
             snprintf(str, slen, "%d", GET_DEX(c));
           }
-          else if (!str_cmp(field, "drunk")) {
+          else if (fid == DG_CHAR_DRUNK) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_COND(c, DRUNK) = MAX(-1, MIN(addition, 24));
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_COND(c, DRUNK));
           }
           break;
         case 'e':
-          if (!str_cmp(field, "eq")) {
+          if (fid == DG_CHAR_EQ) {
             int pos;
             if (!subfield || !*subfield)
               *str = '\0';
@@ -693,7 +879,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             else
               snprintf(str, slen, "%c%ld",UID_CHAR, obj_script_id(GET_EQ(c, pos)));
           }
-          else if (!str_cmp(field, "exp")) {
+          else if (fid == DG_CHAR_EXP) {
             if (subfield && *subfield) {
               int addition = MIN(atoi(subfield), 1000);
 
@@ -703,13 +889,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'f':
-          if (!str_cmp(field, "fighting")) {
+          if (fid == DG_CHAR_FIGHTING) {
             if (FIGHTING(c))
               snprintf(str, slen, "%c%ld", UID_CHAR, char_script_id(FIGHTING(c)));
             else
               *str = '\0';
           }
-          else if (!str_cmp(field, "follower")) {
+          else if (fid == DG_CHAR_FOLLOWER) {
             if (!c->followers || !c->followers->follower)
               *str = '\0';
             else
@@ -717,7 +903,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'g':
-          if (!str_cmp(field, "coins")) {
+          if (fid == DG_CHAR_COINS) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               increase_coins(c, addition);
@@ -726,13 +912,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'h':
-          if (!str_cmp(field, "has_item")) {
+          if (fid == DG_CHAR_HAS_ITEM) {
             if (!(subfield && *subfield))
               *str = '\0';
             else
               snprintf(str, slen, "%d", char_has_item(subfield, c));
           }
-          else if (!str_cmp(field, "hasattached")) {
+          else if (fid == DG_CHAR_HASATTACHED) {
             if (!(subfield && *subfield) || !IS_NPC(c))
               *str = '\0';
             else {
@@ -740,39 +926,41 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
               snprintf(str, slen, "%d", trig_is_attached(SCRIPT(c), i));
             }
           }
-          else if (!str_cmp(field, "heshe"))
+          else if (fid == DG_CHAR_HESHE)
             snprintf(str, slen, "%s", HSSH(c));
-          else if (!str_cmp(field, "himher"))
+          else if (fid == DG_CHAR_HIMHER)
             snprintf(str, slen, "%s", HMHR(c));
-          else if (!str_cmp(field, "hisher"))
+          else if (fid == DG_CHAR_HISHER)
             snprintf(str, slen, "%s", HSHR(c));
-          else if (!str_cmp(field, "hitp")) {
+          else if (fid == DG_CHAR_HITP) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_HIT(c) += addition;
+              msdp_changed(c, MSDP_DIRTY_VITALS);
               update_pos(c);
             }
             snprintf(str, slen, "%d", GET_HIT(c));
           }
-          else if (!str_cmp(field, "hunger")) {
+          else if (fid == DG_CHAR_HUNGER) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_COND(c, HUNGER) = MAX(-1, MIN(addition, 24));
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_COND(c, HUNGER));
           }
           break;
         case 'i':
-          if (!str_cmp(field, "id"))
+          if (fid == DG_CHAR_ID)
             snprintf(str, slen, "%ld", char_script_id(c));
           /* new check for pc/npc status */
-          else if (!str_cmp(field, "is_pc")) {
+          else if (fid == DG_CHAR_IS_PC) {
             if (IS_NPC(c))
               strcpy(str, "0");
             else
               strcpy(str, "1");
           }
-          else if (!str_cmp(field, "int")) {
+          else if (fid == DG_CHAR_INT) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -783,7 +971,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             }
             snprintf(str, slen, "%d", GET_INT(c));
           }
-          else if (!str_cmp(field, "inventory")) {
+          else if (fid == DG_CHAR_INVENTORY) {
             if(subfield && *subfield) {
               for (obj = c->carrying;obj;obj=obj->next_content) {
                 if(GET_OBJ_VNUM(obj)==atoi(subfield)) {
@@ -803,7 +991,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'l':
-          if (!str_cmp(field, "level")) {
+          if (fid == DG_CHAR_LEVEL) {
             if (subfield && *subfield) {
               int lev = atoi(subfield);
               if (IS_NPC(c)) {
@@ -811,64 +999,76 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
                   GET_LEVEL(c) = 1;
               } else
                 GET_LEVEL(c) = MIN(MAX(lev, 1), LVL_IMPL);
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_LEVEL);
             } else
               snprintf(str, slen, "%d", GET_LEVEL(c));
           }
           break;
         case 'm':
-          if (!str_cmp(field, "mana")) {
+          if (fid == DG_CHAR_MANA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_MANA(c) += addition;
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_VITALS);
             }
             snprintf(str, slen, "%d", GET_MANA(c));
           }
-          else if (!str_cmp(field, "master")) {
+          else if (fid == DG_CHAR_MASTER) {
             if (!c->master)
               *str = '\0';
             else
               snprintf(str, slen, "%c%ld", UID_CHAR, char_script_id(c->master));
           }
-          else if (!str_cmp(field, "maxhitp")) {
+          else if (fid == DG_CHAR_MAXHITP) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_MAX_HIT(c) = MAX(GET_MAX_HIT(c) + addition, 1);
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_VITALS);
             }
             snprintf(str, slen, "%d", GET_MAX_HIT(c));
           }
-          else if (!str_cmp(field, "maxmana")) {
+          else if (fid == DG_CHAR_MAXMANA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_MAX_MANA(c) = MAX(GET_MAX_MANA(c) + addition, 1);
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_VITALS);
             }
             snprintf(str, slen, "%d", GET_MAX_MANA(c));
           }
-          else if (!str_cmp(field, "maxmove") || !str_cmp(field, "maxstamina")) {
+          else if (fid == DG_CHAR_MAXMOVE || fid == DG_CHAR_MAXSTAMINA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_MAX_STAMINA(c) = MAX(GET_MAX_STAMINA(c) + addition, 1);
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_VITALS);
             }
             snprintf(str, slen, "%d", GET_MAX_STAMINA(c));
           }
-          else if (!str_cmp(field, "move") || !str_cmp(field, "stamina")) {
+          else if (fid == DG_CHAR_MOVE || fid == DG_CHAR_STAMINA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_STAMINA(c) += addition;
+              MARK_CHAR_CHANGED(c);
+              msdp_changed(c, MSDP_DIRTY_VITALS);
             }
             snprintf(str, slen, "%d", GET_STAMINA(c));
           }
           break;
         case 'n':
-          if (!str_cmp(field, "name"))
+          if (fid == DG_CHAR_NAME)
             snprintf(str, slen, "%s", GET_NAME(c));
 
-          else if (!str_cmp(field, "next_in_room")) {
+          else if (fid == DG_CHAR_NEXT_IN_ROOM) {
             if (c->next_in_room)
               snprintf(str, slen,"%c%ld",UID_CHAR, char_script_id(c->next_in_room));
             else
               *str = '\0';
           }
-          else if (!str_cmp(field, "npcflag")) {
+          else if (fid == DG_CHAR_NPCFLAG) {
             if (subfield && *subfield) {
                char buf[MAX_STRING_LENGTH];
                sprintbitarray(MOB_FLAGS(c), action_bits, PM_ARRAY_MAX, buf);
@@ -885,7 +1085,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         case 'p':
           /* Thanks to Christian Ejlertsen for this idea
              And to Ken Ray for speeding the implementation up :)*/
-          if (!str_cmp(field, "pos")) {
+          if (fid == DG_CHAR_POS) {
             if (subfield && *subfield) {
               for (i = POS_SLEEPING; i <= POS_STANDING; i++) {
                 /* allows : Sleeping, Resting, Sitting, Fighting, Standing */
@@ -897,7 +1097,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             }
             snprintf(str, slen, "%s", position_types[GET_POS(c)]);
           }
-          else if (!str_cmp(field, "pref")) {
+          else if (fid == DG_CHAR_PREF) {
             if (subfield && *subfield) {
               int pref = get_flag_by_name(preference_bits, subfield);
               if (!IS_NPC(c) && pref != NOFLAG && PRF_FLAGGED(c, pref))
@@ -909,23 +1109,24 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'q':
-          if (!IS_NPC(c) && (!str_cmp(field, "questpoints") ||
-              !str_cmp(field, "qp") || !str_cmp(field, "qpnts")))
+          if (!IS_NPC(c) && (fid == DG_CHAR_QUESTPOINTS ||
+              fid == DG_CHAR_QP || fid == DG_CHAR_QPNTS))
           {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_QUESTPOINTS(c) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_QUESTPOINTS(c));
           }
-           else if (!str_cmp(field, "quest"))
+           else if (fid == DG_CHAR_QUEST)
            {
                if (!IS_NPC(c) && (GET_QUEST(c) != NOTHING) && (real_quest(GET_QUEST(c)) != NOTHING))
                  snprintf(str, slen, "%d", GET_QUEST(c));
                else
                  strcpy(str, "0");
              }
-           else if (!str_cmp(field, "questdone"))
+           else if (fid == DG_CHAR_QUESTDONE)
            {
                if (!IS_NPC(c) && subfield && *subfield) {
                  int q_num = atoi(subfield);
@@ -939,7 +1140,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
              }
           break;
         case 'r':
-          if (!str_cmp(field, "room")) {  /* in NOWHERE, return the void */
+          if (fid == DG_CHAR_ROOM) {  /* in NOWHERE, return the void */
 /* see note in dg_scripts.h */
 #ifdef ACTOR_ROOM_IS_UID
             snprintf(str, slen, "%c%ld",UID_CHAR,
@@ -950,58 +1151,64 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 's':
-          if (!str_cmp(field, "save_str")) {
+          if (fid == DG_CHAR_SAVE_STR) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_STR) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_STR));
           }
 
-          else if (!str_cmp(field, "save_dex")) {
+          else if (fid == DG_CHAR_SAVE_DEX) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_DEX) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_DEX));
           }
 
-          else if (!str_cmp(field, "save_con")) {
+          else if (fid == DG_CHAR_SAVE_CON) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_CON) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_CON));
           }
 
-          else if (!str_cmp(field, "save_int")) {
+          else if (fid == DG_CHAR_SAVE_INT) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_INT) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_INT));
           }
 
-          else if (!str_cmp(field, "save_wis")) {
+          else if (fid == DG_CHAR_SAVE_WIS) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_WIS) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_WIS));
           }
 
-          else if (!str_cmp(field, "save_cha")) {
+          else if (fid == DG_CHAR_SAVE_CHA) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_SAVE(c, ABIL_CHA) += addition;
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_SAVE(c, ABIL_CHA));
           }
-          else if (!str_cmp(field, "sex"))
+          else if (fid == DG_CHAR_SEX)
             snprintf(str, slen, "%s", genders[(int)GET_SEX(c)]);
-          else if (!str_cmp(field, "skill"))
+          else if (fid == DG_CHAR_SKILL)
             snprintf(str, slen, "%s", skill_percent(c, subfield));
-          else if (!str_cmp(field, "str")) {
+          else if (fid == DG_CHAR_STR) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -1014,26 +1221,25 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 't':
-          if (!str_cmp(field, "thirst")) {
+          if (fid == DG_CHAR_THIRST) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_COND(c, THIRST) = MAX(-1, MIN(addition, 24));
+              MARK_CHAR_CHANGED(c);
             }
             snprintf(str, slen, "%d", GET_COND(c, THIRST));
           }
           break;
 	case 'v':
-          if (!str_cmp(field, "varexists")) {
+          if (fid == DG_CHAR_VAREXISTS) {
             struct trig_var_data *remote_vd;
             strcpy(str, "0");
             if (SCRIPT(c)) {
-              for (remote_vd = SCRIPT(c)->global_vars; remote_vd; remote_vd = remote_vd->next) {
-                if (!str_cmp(remote_vd->name, subfield)) break;
-              }
+              remote_vd = find_var(SCRIPT(c)->global_vars, subfield);
               if (remote_vd) strcpy(str, "1");
             }
           }
-          else if (!str_cmp(field, "vnum")) {
+          else if (fid == DG_CHAR_VNUM) {
             if (subfield && *subfield) {
              /* When this had -1 at the end of the line it returned true for PC's if you did
               * something like if %actor.vnum(500)%. It should return false for PC's instead 
@@ -1054,9 +1260,9 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'w':
-          if (!str_cmp(field, "weight"))
+          if (fid == DG_CHAR_WEIGHT)
             snprintf(str, slen, "%d", GET_WEIGHT(c));
-          else if (!str_cmp(field, "wis")) {
+          else if (fid == DG_CHAR_WIS) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               int max = (IS_NPC(c) || GET_LEVEL(c) >= LVL_GRGOD) ? 25 : 18;
@@ -1068,7 +1274,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", GET_WIS(c));
           }
           
-          else if (!str_cmp(field, "wait")) 
+          else if (fid == DG_CHAR_WAIT) 
           {
             if (subfield && *subfield)
             {
@@ -1083,9 +1289,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
       if (*str == '\x1') { /* no match found in switch */
         if (SCRIPT(c)) {
-          for (vd = (SCRIPT(c))->global_vars; vd; vd = vd->next)
-            if (!str_cmp(vd->name, field))
-              break;
+          vd = find_var(SCRIPT(c)->global_vars, field);
           if (vd)
             snprintf(str, slen, "%s", vd->value);
           else {
@@ -1102,11 +1306,12 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
     } /* if (c) ...*/
 
     else if (o) {
+      fid = dg_field_id(DG_FIELDS_OBJ, field);
 
       *str = '\x1';
       switch (LOWER(*field)) {
         case 'a':
-          if (!str_cmp(field, "affects")) {
+          if (fid == DG_OBJ_AFFECTS) {
             if (subfield && *subfield) {
               if (check_flags_by_name_ar(GET_OBJ_AFFECT(o), NUM_AFF_FLAGS, subfield, affected_bits) == TRUE)
                 snprintf(str, slen, "1");
@@ -1116,7 +1321,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
               snprintf(str, slen, "0");
           }
 	case 'c':
-          if (!str_cmp(field, "cost")) {
+          if (fid == DG_OBJ_COST) {
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_OBJ_COST(o) = MAX(1, addition + GET_OBJ_COST(o));
@@ -1124,21 +1329,21 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", GET_OBJ_COST(o));
           }
 
-          else if (!str_cmp(field, "carried_by")) {
+          else if (fid == DG_OBJ_CARRIED_BY) {
             if (o->carried_by)
               snprintf(str, slen,"%c%ld",UID_CHAR, char_script_id(o->carried_by));
             else
               *str = '\0';
           }
 
-          else if (!str_cmp(field, "contents")) {
+          else if (fid == DG_OBJ_CONTENTS) {
             if (o->contains)
               snprintf(str, slen, "%c%ld", UID_CHAR, obj_script_id(o->contains));
             else
               *str = '\0';
           }
           /* thanks to Jamie Nelson (Mordecai of 4 Dimensions MUD) */
-          else if (!str_cmp(field, "count")) {
+          else if (fid == DG_OBJ_COUNT) {
             if (GET_OBJ_TYPE(o) == ITEM_CONTAINER)
               snprintf(str, slen, "%d", item_in_list(subfield, o->contains));
             else
@@ -1146,7 +1351,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'e':
-          if (!str_cmp(field, "extra")) {
+          if (fid == DG_OBJ_EXTRA) {
             if (subfield && *subfield) {
               if (check_flags_by_name_ar(GET_OBJ_EXTRA(o), NUM_ITEM_FLAGS, subfield, extra_bits) > 0)
                 snprintf(str, slen, "1");
@@ -1159,13 +1364,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           break;
 	case 'h':
           /* thanks to Jamie Nelson (Mordecai of 4 Dimensions MUD) */
-          if (!str_cmp(field, "has_in")) {
+          if (fid == DG_OBJ_HAS_IN) {
             if (GET_OBJ_TYPE(o) == ITEM_CONTAINER)
               snprintf(str, slen, "%s", (item_in_list(subfield, o->contains) ? "1" : "0"));
             else
               strcpy(str, "0");
           }
-          else if (!str_cmp(field, "hasattached")) {
+          else if (fid == DG_OBJ_HASATTACHED) {
             if (!(subfield && *subfield))
               *str = '\0';
             else {
@@ -1175,24 +1380,24 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'i':
-          if (!str_cmp(field, "id"))
+          if (fid == DG_OBJ_ID)
             snprintf(str, slen, "%ld", obj_script_id(o));
 
-          else if (!str_cmp(field, "is_inroom")) {
+          else if (fid == DG_OBJ_IS_INROOM) {
             if (IN_ROOM(o) != NOWHERE)
               snprintf(str, slen,"%c%ld",UID_CHAR, room_script_id(world + IN_ROOM(o)));
             else
               *str = '\0';
           }
-          else if (!str_cmp(field, "is_pc")) {
+          else if (fid == DG_OBJ_IS_PC) {
             strcpy(str, "-1");
           }
 	  break;
         case 'n':
-          if (!str_cmp(field, "name"))
+          if (fid == DG_OBJ_NAME)
             snprintf(str, slen, "%s",  o->name);
 
-          else if (!str_cmp(field, "next_in_list")) {
+          else if (fid == DG_OBJ_NEXT_IN_LIST) {
             if (o->next_content)
               snprintf(str, slen,"%c%ld",UID_CHAR, obj_script_id(o->next_content));
             else
@@ -1200,7 +1405,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'o':
-          if (!str_cmp(field, "oset")) {
+          if (fid == DG_OBJ_OSET) {
             if (subfield && *subfield) {
               if (handle_oset(o, subfield))
                 strcpy(str, "1");
@@ -1210,7 +1415,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 'r':
-          if (!str_cmp(field, "room")) {
+          if (fid == DG_OBJ_ROOM) {
             if (obj_room(o) != NOWHERE)
               snprintf(str, slen,"%c%ld",UID_CHAR, room_script_id(world + obj_room(o)));
             else
@@ -1218,37 +1423,37 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           break;
         case 's':
-          if (!str_cmp(field, "shortdesc"))
+          if (fid == DG_OBJ_SHORTDESC)
             snprintf(str, slen, "%s",  o->short_description);
           break;
         case 't':
-          if (!str_cmp(field, "type"))
+          if (fid == DG_OBJ_TYPE)
             sprinttype(GET_OBJ_TYPE(o), item_types, str, slen);
 
-          else if (!str_cmp(field, "timer"))
+          else if (fid == DG_OBJ_TIMER)
             snprintf(str, slen, "%d", GET_OBJ_TIMER(o));
           break;
         case 'v':
-          if (!str_cmp(field, "vnum"))
+          if (fid == DG_OBJ_VNUM)
             if (subfield && *subfield) {
               snprintf(str, slen, "%d", (int)(GET_OBJ_VNUM(o) == atoi(subfield)));
             } else {
               snprintf(str, slen, "%d", GET_OBJ_VNUM(o));
             }
-          else if (!str_cmp(field, "val0"))
+          else if (fid == DG_OBJ_VAL0)
             snprintf(str, slen, "%d", GET_OBJ_VAL(o, 0));
 
-          else if (!str_cmp(field, "val1"))
+          else if (fid == DG_OBJ_VAL1)
             snprintf(str, slen, "%d", GET_OBJ_VAL(o, 1));
 
-          else if (!str_cmp(field, "val2"))
+          else if (fid == DG_OBJ_VAL2)
             snprintf(str, slen, "%d", GET_OBJ_VAL(o, 2));
 
-          else if (!str_cmp(field, "val3"))
+          else if (fid == DG_OBJ_VAL3)
             snprintf(str, slen, "%d", GET_OBJ_VAL(o, 3));
           break;
         case 'w':
-          if (!str_cmp(field, "wearflag")) {
+          if (fid == DG_OBJ_WEARFLAG) {
 	    if (subfield && *subfield) {
 	      if (can_wear_on_pos(o, find_eq_pos_script(subfield)))
 	        snprintf(str, slen, "1");
@@ -1258,7 +1463,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
               snprintf(str, slen, "0");
 	  }
 
-	  else if (!str_cmp(field, "weight")){
+	  else if (fid == DG_OBJ_WEIGHT){
             if (subfield && *subfield) {
               int addition = atoi(subfield);
               GET_OBJ_WEIGHT(o) = MAX(1, addition + GET_OBJ_WEIGHT(o));
@@ -1266,7 +1471,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", GET_OBJ_WEIGHT(o));
           }
 
-          else if (!str_cmp(field, "worn_by")) {
+          else if (fid == DG_OBJ_WORN_BY) {
             if (o->worn_by)
               snprintf(str, slen,"%c%ld",UID_CHAR, char_script_id(o->worn_by));
             else
@@ -1278,9 +1483,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
       if (*str == '\x1') { /* no match in switch */
         if (SCRIPT(o)) { /* check for global var */
-          for (vd = (SCRIPT(o))->global_vars; vd; vd = vd->next)
-            if (!str_cmp(vd->name, field))
-              break;
+          vd = find_var(SCRIPT(o)->global_vars, field);
           if (vd)
             snprintf(str, slen, "%s", vd->value);
           else {
@@ -1297,6 +1500,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
     } /* if (o) ... */
 
     else if (r) {
+      fid = dg_field_id(DG_FIELDS_ROOM, field);
 
       /* special handling of the void, as it stores all 'full global' variables */
       if (r->number == 0) {
@@ -1305,9 +1509,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           script_log("Trigger: %s, Vnum %d, type %d. Trying to access Global var list of void. Apparently this has not been set up!",
                      GET_TRIG_NAME(trig), GET_TRIG_VNUM(trig), type);
         } else {
-          for (vd = (SCRIPT(r))->global_vars; vd; vd = vd->next)
-            if (!str_cmp(vd->name, field))
-              break;
+          vd = find_var(SCRIPT(r)->global_vars, field);
           if (vd)
             snprintf(str, slen, "%s", vd->value);
           else
@@ -1315,19 +1517,19 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
       }
 
-      else if (!str_cmp(field, "name"))
+      else if (fid == DG_ROOM_NAME)
         snprintf(str, slen, "%s",  r->name);
 
-      else if (!str_cmp(field, "sector"))
+      else if (fid == DG_ROOM_SECTOR)
         sprinttype(r->sector_type, sector_types, str, slen);
 
-      else if (!str_cmp(field, "vnum")) {
+      else if (fid == DG_ROOM_VNUM) {
         if (subfield && *subfield) {
           snprintf(str, slen, "%d", (int)(r->number == atoi(subfield)));
         } else {
           snprintf(str, slen,"%d",r->number);
         }
-      } else if (!str_cmp(field, "contents")) {
+      } else if (fid == DG_ROOM_CONTENTS) {
         if (subfield && *subfield) {
           for (obj = r->contents; obj; obj = obj->next_content) {
             if (GET_OBJ_VNUM(obj) == atoi(subfield)) {
@@ -1347,20 +1549,20 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
       }
 
-      else if (!str_cmp(field, "people")) {
+      else if (fid == DG_ROOM_PEOPLE) {
         if (r->people)
           snprintf(str, slen, "%c%ld", UID_CHAR, char_script_id(r->people));
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "id")) {
+      else if (fid == DG_ROOM_ID) {
         room_rnum rnum = real_room(r->number);
         if (rnum != NOWHERE)
           snprintf(str, slen, "%ld", room_script_id(world + rnum));
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "weather")) {
+      else if (fid == DG_ROOM_WEATHER) {
         const char *sky_look[] = {
           "sunny",
           "cloudy",
@@ -1373,7 +1575,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "hasattached")) {
+      else if (fid == DG_ROOM_HASATTACHED) {
         if (!(subfield && *subfield))
           *str = '\0';
         else {
@@ -1381,11 +1583,11 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           snprintf(str, slen, "%d", trig_is_attached(SCRIPT(r), i));
         }
       }
-      else if (!str_cmp(field, "zonenumber"))
+      else if (fid == DG_ROOM_ZONENUMBER)
         snprintf(str, slen, "%d",  zone_table[r->zone].number);
-      else if (!str_cmp(field, "zonename"))
+      else if (fid == DG_ROOM_ZONENAME)
         snprintf(str, slen, "%s",  zone_table[r->zone].name);
-      else if (!str_cmp(field, "roomflag")) {
+      else if (fid == DG_ROOM_ROOMFLAG) {
         if (subfield && *subfield) {
           room_rnum thisroom = real_room(r->number);
           if (check_flags_by_name_ar(ROOM_FLAGS(thisroom), NUM_ROOM_FLAGS, subfield, room_bits) == TRUE)
@@ -1395,7 +1597,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           snprintf(str, slen, "0");
       }
-      else if (!str_cmp(field, "north")) {
+      else if (fid == DG_ROOM_NORTH) {
         if (R_EXIT(r, NORTH)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1415,7 +1617,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           *str = '\0';
       }
-      else if (!str_cmp(field, "east")) {
+      else if (fid == DG_ROOM_EAST) {
         if (R_EXIT(r, EAST)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1435,7 +1637,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           *str = '\0';
       }
-      else if (!str_cmp(field, "south")) {
+      else if (fid == DG_ROOM_SOUTH) {
         if (R_EXIT(r, SOUTH)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1455,7 +1657,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           *str = '\0';
       }
-      else if (!str_cmp(field, "west")) {
+      else if (fid == DG_ROOM_WEST) {
         if (R_EXIT(r, WEST)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1475,7 +1677,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           *str = '\0';
       }
-      else if (!str_cmp(field, "up")) {
+      else if (fid == DG_ROOM_UP) {
         if (R_EXIT(r, UP)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1495,7 +1697,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         } else
           *str = '\0';
       }
-      else if (!str_cmp(field, "down")) {
+      else if (fid == DG_ROOM_DOWN) {
         if (R_EXIT(r, DOWN)) {
           if (subfield && *subfield) {
             if (!str_cmp(subfield, "vnum"))
@@ -1517,9 +1719,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       }
       else {
         if (SCRIPT(r)) { /* check for global var */
-          for (vd = (SCRIPT(r))->global_vars; vd; vd = vd->next)
-            if (!str_cmp(vd->name, field))
-              break;
+          vd = find_var(SCRIPT(r)->global_vars, field);
           if (vd)
             snprintf(str, slen, "%s", vd->value);
           else {
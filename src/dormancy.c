@@ -0,0 +1,193 @@
+/**
+* @file dormancy.c
+* Zone dormancy: zones no player has been near for a while stop running
+* their mobs' idle AI and their resets until someone comes back.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "comm.h"
+#include "dormancy.h"
+
+/* The zones each zone has an exit into, by zone rnum. */
+static zone_rnum **zone_links = NULL;
+static int *num_zone_links = NULL;
+static zone_rnum links_top_zone = NOWHERE;
+
+/* Zones woken since the last pulse, which may owe a reset. */
+static bool wakes_pending = FALSE;
+
+/** Throws the zone links away; they are rebuilt when next wanted. */
+void free_zone_links(void)
+{
+  zone_rnum zone;
+
+  if (zone_links) {
+    for (zone = 0; zone <= links_top_zone; zone++)
+      if (zone_links[zone])
+        free(zone_links[zone]);
+    free(zone_links);
+    free(num_zone_links);
+  }
+  zone_links = NULL;
+  num_zone_links = NULL;
+  links_top_zone = NOWHERE;
+}
+
+static void add_zone_link(zone_rnum from, zone_rnum to)
+{
+  int i;
+
+  for (i = 0; i < num_zone_links[from]; i++)
+    if (zone_links[from][i] == to)
+      return;
+
+  RECREATE(zone_links[from], zone_rnum, num_zone_links[from] + 1);
+  zone_links[from][num_zone_links[from]++] = to;
+}
+
+/* Links are kept both ways: a one way exit still puts the zones at either
+ * end within reach of each other's mobs and players. */
+static void build_zone_links(void)
+{
+  room_rnum room, to;
+  zone_rnum from;
+  int dir;
+
+  free_zone_links();
+  if (top_of_zone_table < 0)
+    return;
+
+  links_top_zone = top_of_zone_table;
+  CREATE(zone_links, zone_rnum *, links_top_zone + 1);
+  CREATE(num_zone_links, int, links_top_zone + 1);
+
+  for (room = 0; room <= top_of_world; room++) {
+    from = world[room].zone;
+    for (dir = 0; dir < DIR_COUNT; dir++) {
+      if (!world[room].dir_option[dir] ||
+          (to = world[room].dir_option[dir]->to_room) == NOWHERE ||
+          world[to].zone == from)
+        continue;
+      add_zone_link(from, world[to].zone);
+      add_zone_link(world[to].zone, from);
+    }
+  }
+}
+
+/** Wakes a dormant zone.  Only flags are changed here, so this is safe to
+ * call while a character is being moved; the catch-up reset, if one is
+ * owed, happens on the next pulse. */
+void wake_zone(zone_rnum zone)
+{
+  if (!zone_table[zone].dormant)
+    return;
+
+  zone_table[zone].dormant = FALSE;
+  zone_table[zone].last_near = time(0);
+  if (zone_table[zone].reset_missed)
+    wakes_pending = TRUE;
+}
+
+/* Gives the zones woken since the last pulse the reset they missed.  As in
+ * zone_update(), a zone that only resets when empty and has someone in it
+ * is looked at again PULSE_ZONE later instead. */
+static void catch_up_woken_zones(void)
+{
+  zone_rnum zone;
+
+  wakes_pending = FALSE;
+  for (zone = 0; zone <= top_of_zone_table; zone++)
+    if (zone_table[zone].reset_missed && !zone_table[zone].dormant) {
+      zone_table[zone].reset_missed = FALSE;
+      if (zone_table[zone].reset_mode == 2 || is_empty(zone))
+        reset_zone(zone);
+      else
+        schedule_zone_reset_at(zone, zone_pulse + PULSE_ZONE);
+    }
+}
+
+/* Finds every zone within dormancy_radius hops of a player, breadth first
+ * from the zones with players in them.  near[] gets TRUE for each. */
+static void find_near_zones(bool *near)
+{
+  zone_rnum zone, next, *queue;
+  int *hops, head, tail = 0, i, radius = MAX(0, CONFIG_DORMANCY_RADIUS);
+
+  CREATE(queue, zone_rnum, top_of_zone_table + 1);
+  CREATE(hops, int, top_of_zone_table + 1);
+
+  for (zone = 0; zone <= top_of_zone_table; zone++)
+    if (zone_table[zone].num_players || zone_table[zone].num_switched) {
+      near[zone] = TRUE;
+      hops[tail] = 0;
+      queue[tail++] = zone;
+    }
+
+  for (head = 0; head < tail; head++) {
+    if (hops[head] >= radius)
+      continue;
+    zone = queue[head];
+    for (i = 0; i < num_zone_links[zone]; i++) {
+      next = zone_links[zone][i];
+      if (near[next])
+        continue;
+      near[next] = TRUE;
+      hops[tail] = hops[head] + 1;
+      queue[tail++] = next;
+    }
+  }
+
+  free(queue);
+  free(hops);
+}
+
+/** Puts zones to sleep and wakes them.  Called every pulse; the zones are
+ * looked over every PULSE_ZONE, the links between them rebuilt every
+ * minute so exits dug in OLC are picked up.
+ * @param heart_pulse The pulse being run. */
+void dormancy_update(int heart_pulse)
+{
+  zone_rnum zone;
+  time_t now;
+  bool *near;
+
+  if (wakes_pending)
+    catch_up_woken_zones();
+
+  if (heart_pulse % PULSE_ZONE)
+    return;
+
+  if (CONFIG_DORMANCY_DELAY <= 0) {
+    for (zone = 0; zone <= top_of_zone_table; zone++)
+      wake_zone(zone);
+    return;
+  }
+
+  if (!zone_links || links_top_zone != top_of_zone_table ||
+      !(heart_pulse % (60 * PASSES_PER_SEC)))
+    build_zone_links();
+
+  now = time(0);
+  CREATE(near, bool, top_of_zone_table + 1);
+  find_near_zones(near);
+
+  for (zone = 0; zone <= top_of_zone_table; zone++) {
+    if (near[zone] || !zone_table[zone].last_near) {
+      wake_zone(zone);
+      zone_table[zone].last_near = now;
+    } else if (!zone_table[zone].dormant &&
+               now - zone_table[zone].last_near >= CONFIG_DORMANCY_DELAY * SECS_PER_REAL_MIN)
+      zone_table[zone].dormant = TRUE;
+  }
+
+  free(near);
+}
@@ -0,0 +1,29 @@
+/**
+* @file dormancy.h
+* Zone dormancy: zones no player has been near for a while stop running
+* their mobs' idle AI and their resets until someone comes back.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* A zone is near a player when it is within dormancy_radius zone hops of a
+* zone with a player in it, a hop being any exit from one zone into the
+* other.  A zone that has not been near a player for dormancy_delay minutes
+* goes dormant.  Its mobs skip their turn in mobile_activity() (spec procs
+* still run, and a mob hunting someone stays awake), its objects' random
+* triggers stop unless flagged global, and its resets are held back.  When
+* a player comes near again the zone wakes, and a zone that missed any
+* resets while it slept gets one reset to catch up.
+*/
+#ifndef _DORMANCY_H_
+#define _DORMANCY_H_
+
+/** Is the zone asleep? */
+#define ZONE_DORMANT(rnum)  (zone_table[(rnum)].dormant)
+
+void dormancy_update(int heart_pulse);
+void wake_zone(zone_rnum zone);
+void free_zone_links(void);
+
+#endif /* _DORMANCY_H_ */
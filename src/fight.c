@@ -161,6 +161,8 @@ int compute_armor_class(struct char_data *ch)
 
 void update_pos(struct char_data *victim)
 {
+  MARK_CHAR_CHANGED(victim);
+
   if ((GET_HIT(victim) > 0) && (GET_POS(victim) > POS_STUNNED))
     return;
   else if (GET_HIT(victim) > 0)
@@ -194,6 +196,7 @@ void set_fighting(struct char_data *ch, struct char_data *vict)
 
   FIGHTING(ch) = vict;
   GET_POS(ch) = POS_FIGHTING;
+  msdp_changed(ch, MSDP_DIRTY_COMBAT);
 
 }
 
@@ -210,6 +213,7 @@ void stop_fighting(struct char_data *ch)
   FIGHTING(ch) = NULL;
   GET_POS(ch) = POS_STANDING;
   update_pos(ch);
+  msdp_changed(ch, MSDP_DIRTY_COMBAT);
 }
 
 static void make_corpse(struct char_data *ch)
@@ -273,6 +277,8 @@ static void make_corpse(struct char_data *ch)
   /* transfer coins */
   if (GET_COINS(ch) > 0)
     GET_COINS(ch) = 0;
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_MONEY);
   ch->carrying = NULL;
   IS_CARRYING_N(ch) = 0;
   IS_CARRYING_W(ch) = 0;
@@ -668,6 +674,7 @@ int damage(struct char_data *ch, struct char_data *victim, int dam, int attackty
   dam = MAX(MIN(dam, 100), 0);
   prev_hit = GET_HIT(victim);
   GET_HIT(victim) -= dam;
+  msdp_changed(victim, MSDP_DIRTY_VITALS);
 
   update_pos(victim);
 
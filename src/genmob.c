@@ -69,6 +69,7 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
     mob_index[0].number = 0;
     mob_index[0].func = 0;
   }
+  vnum_index_rebuild(DB_BOOT_MOB);
 
   log("GenOLC: add_mobile: Added mobile %d at index #%d.", vnum, found);
 
@@ -176,6 +177,7 @@ int delete_mobile(mob_rnum refpt)
   top_of_mobt--;
   RECREATE(mob_index, struct index_data, top_of_mobt + 1);
   RECREATE(mob_proto, struct char_data, top_of_mobt + 1);
+  vnum_index_rebuild(DB_BOOT_MOB);
 
   /* Update live mobile rnums. */
   for (live_mob = character_list; live_mob; live_mob = live_mob->next)
@@ -74,6 +74,9 @@ static int update_all_objects(struct obj_data *refobj)
     obj->contains = swap.contains;
     obj->next_content = swap.next_content;
     obj->next = swap.next;
+    obj->next_scheduled = swap.next_scheduled;
+    obj->prev_scheduled = swap.prev_scheduled;
+    obj->scheduled = swap.scheduled;
     obj->sitting_here = swap.sitting_here;
   }
 
@@ -174,6 +177,7 @@ obj_rnum index_object(struct obj_data *obj, obj_vnum ovnum, obj_rnum ornum)
   copy_object_preserve(&obj_proto[ornum], obj);
   obj_proto[ornum].in_room = NOWHERE;
 
+  vnum_index_rebuild(DB_BOOT_OBJ);
   return ornum;
 }
 
@@ -421,6 +425,7 @@ int delete_object(obj_rnum rnum)
   top_of_objt--;
   RECREATE(obj_index, struct index_data, top_of_objt + 1);
   RECREATE(obj_proto, struct obj_data, top_of_objt + 1);
+  vnum_index_rebuild(DB_BOOT_OBJ);
 
   /* Renumber notice boards. */
   for (j = 0; j < NUM_OF_BOARDS; j++)
@@ -106,6 +106,7 @@ int add_quest(struct aq_data *nqst)
       aquest_table[rnum] = aquest_table[rnum - 1]; //shift quest up one
     }
     copy_quest(&aquest_table[rnum], nqst, FALSE);
+    vnum_index_rebuild(DB_BOOT_QST);
   }
   qmrnum = real_mobile(QST_MASTER(rnum));
   /* Make sure we assign spec procs to the questmaster */
@@ -155,6 +156,7 @@ int delete_quest(qst_rnum rnum)
     free(aquest_table);
     aquest_table = NULL; 
    }
+  vnum_index_rebuild(DB_BOOT_QST);
   if (rznum != NOWHERE)
      add_to_save_list(zone_table[rznum].number, SL_QST);
   else
@@ -73,6 +73,8 @@ room_rnum add_room(struct room_data *room)
     world[0] = *room;	/* Last place, in front. */
     copy_room_strings(&world[0], room);
   }
+  world[found].trig_types_stale = TRUE;
+  vnum_index_rebuild(DB_BOOT_WLD);
 
   log("GenOLC: add_room: Added room %d at index #%d.", room->number, found);
   /* found is equal to the array index where we added the room. */
@@ -258,6 +260,7 @@ int delete_room(room_rnum rnum)
 
   top_of_world--;
   RECREATE(world, struct room_data, top_of_world + 1);
+  vnum_index_rebuild(DB_BOOT_WLD);
 
   return TRUE;
 }
@@ -380,6 +383,7 @@ int copy_room(struct room_data *to, struct room_data *from)
   *to = *from;
   copy_room_strings(to, from);
   to->events = from->events;
+  to->trig_types_stale = TRUE;
 
   /* Don't put people and objects in two locations. Should this be done here? */
   from->people = NULL;
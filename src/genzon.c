@@ -195,6 +195,10 @@ rznum = i;
 
   /* Ok, insert the new zone here. */
   zone->name = strdup("New Zone");
+  zone->num_players = zone->num_linkless = zone->num_switched = 0;
+  zone->last_reset = zone->reset_due = 0;
+  zone->dormant = zone->reset_missed = FALSE;
+  zone->last_near = 0;
   zone->number = vzone_num;
   zone->builders = strdup("None");
   zone->bot = bottom;
@@ -212,6 +216,8 @@ rznum = i;
   zone->cmd[0].command = 'S';
 
   top_of_zone_table++;
+  vnum_index_rebuild(DB_BOOT_ZON);
+  reschedule_zone_resets();
 
   add_to_save_list(zone->number, SL_ZON);
   return rznum;
@@ -24,6 +24,8 @@
 #include "fight.h"
 #include "quest.h"
 #include "mud_event.h"
+#include "save_writer.h"
+#include "dormancy.h"
 
 /* local file scope variables */
 static int extractions_pending = 0;
@@ -242,6 +244,9 @@ void affect_total(struct char_data *ch)
   if (IS_NPC(ch) || GET_LEVEL(ch) >= LVL_GRGOD) {
     GET_STR(ch) = MIN(GET_STR(ch), i);
   } 
+
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_VITALS | MSDP_DIRTY_ARMOR);
 }
 
 /* Insert an affect_type in a char_data structure. Automatically sets
@@ -333,6 +338,38 @@ void affect_join(struct char_data *ch, struct affected_type *af,
     affect_to_char(ch, af);
 }
 
+/* Counts ch in (count 1) or out of (-1) the occupancy of the zone it is in,
+ * as is_empty() reads it. */
+static void count_zone_occupant(struct char_data *ch, int count)
+{
+  struct zone_data *zone;
+
+  if (IN_ROOM(ch) == NOWHERE)
+    return;
+  zone = &zone_table[world[IN_ROOM(ch)].zone];
+
+  if (!IS_NPC(ch)) {
+    zone->num_players += count;
+    if (!ch->desc)
+      zone->num_linkless += count;
+  } else if (ch->desc)
+    zone->num_switched += count;
+  else
+    return;
+
+  if (count > 0 && zone->dormant)
+    wake_zone(world[IN_ROOM(ch)].zone);
+}
+
+/** Gives ch a new descriptor, or none, keeping the zone counts right.  Use
+ * this, not ch->desc, for a character that may be in a room. */
+void set_char_desc(struct char_data *ch, struct descriptor_data *d)
+{
+  count_zone_occupant(ch, -1);
+  ch->desc = d;
+  count_zone_occupant(ch, 1);
+}
+
 /* move a player out of a room */
 void char_from_room(struct char_data *ch)
 {
@@ -353,7 +390,12 @@ void char_from_room(struct char_data *ch)
       if (GET_OBJ_VAL(GET_EQ(ch, WEAR_LIGHT), 2))	/* Light is ON */
 	world[IN_ROOM(ch)].light--;
 
+  room_trig_types_leave_char(IN_ROOM(ch), ch);
+  count_zone_occupant(ch, -1);
   REMOVE_FROM_LIST(ch, world[IN_ROOM(ch)].people, next_in_room);
+  /* RoomSave: saved rooms keep their NPCs */
+  if (IS_NPC(ch))
+    RoomSave_mark_dirty_room(IN_ROOM(ch));
   IN_ROOM(ch) = NOWHERE;
   ch->next_in_room = NULL;
 }
@@ -368,6 +410,12 @@ void char_to_room(struct char_data *ch, room_rnum room)
     ch->next_in_room = world[room].people;
     world[room].people = ch;
     IN_ROOM(ch) = room;
+    room_trig_types_enter_char(room, ch);
+    count_zone_occupant(ch, 1);
+    if (IS_NPC(ch))
+      RoomSave_mark_dirty_room(room);
+    else
+      MARK_CHAR_CHANGED(ch);
 
     autoquest_trigger_check(ch, 0, 0, AQ_ROOM_FIND);
     autoquest_trigger_check(ch, 0, 0, AQ_MOB_FIND);
@@ -426,6 +474,8 @@ static void adjust_char_coins(struct char_data *ch, int amount)
     GET_COINS(ch) = MIN(MAX_COINS, GET_COINS(ch) + amount);
   else
     GET_COINS(ch) = MAX(0, GET_COINS(ch) + amount);
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_MONEY);
 }
 
 /* Give an object to a char. */
@@ -441,8 +491,13 @@ void obj_to_char(struct obj_data *object, struct char_data *ch)
     ch->carrying = object;
     object->carried_by = ch;
     IN_ROOM(object) = NOWHERE;
+    if (IN_ROOM(ch) != NOWHERE)
+      room_trig_types_enter_obj(IN_ROOM(ch), object);
     if (__rs_room != NOWHERE)
       RoomSave_mark_dirty_room(__rs_room);
+    /* RoomSave: an NPC's inventory is saved with its room */
+    if (IS_NPC(ch) && IN_ROOM(ch) != __rs_room)
+      RoomSave_mark_dirty_room(IN_ROOM(ch));
     IS_CARRYING_W(ch) += GET_OBJ_WEIGHT(object);
     IS_CARRYING_N(ch)++;
     if (AFF_FLAGGED(ch, AFF_MOUNTED) && MOUNT(ch) && RIDDEN_BY(MOUNT(ch)) == ch)
@@ -451,8 +506,10 @@ void obj_to_char(struct obj_data *object, struct char_data *ch)
     autoquest_trigger_check(ch, NULL, object, AQ_OBJ_FIND);
 
     /* set flag for crash-save system, but not on mobs! */
-    if (!IS_NPC(ch))
+    if (!IS_NPC(ch)) {
       SET_BIT_AR(PLR_FLAGS(ch), PLR_CRASH);
+      MARK_CHAR_CHANGED(ch);
+    }
 
     if (coin_count > 0 && old_owner != ch) {
       adjust_char_coins(old_owner, -coin_count);
@@ -481,10 +538,14 @@ void obj_from_char(struct obj_data *object)
     }
   }
   REMOVE_FROM_LIST(object, object->carried_by->carrying, next_content);
+  if (__rs_room != NOWHERE)
+    room_trig_types_leave_obj(__rs_room, object);
 
   /* set flag for crash-save system, but not on mobs! */
-  if (!IS_NPC(object->carried_by))
+  if (!IS_NPC(object->carried_by)) {
     SET_BIT_AR(PLR_FLAGS(object->carried_by), PLR_CRASH);
+    MARK_CHAR_CHANGED(object->carried_by);
+  }
 
   IS_CARRYING_W(object->carried_by) -= GET_OBJ_WEIGHT(object);
   IS_CARRYING_N(object->carried_by)--;
@@ -575,6 +636,9 @@ void equip_char(struct char_data *ch, struct obj_data *obj, int pos)
     if (pos == WEAR_LIGHT && GET_OBJ_TYPE(obj) == ITEM_LIGHT)
       if (GET_OBJ_VAL(obj, 2))	/* if light is ON */
 	world[IN_ROOM(ch)].light++;
+    if (IS_NPC(ch))
+      RoomSave_mark_dirty_room(IN_ROOM(ch));
+    room_trig_types_enter_obj(IN_ROOM(ch), obj);
   } else
     log("SYSERR: IN_ROOM(ch) = NOWHERE when equipping char %s.", GET_NAME(ch));
 
@@ -611,6 +675,9 @@ struct obj_data *unequip_char(struct char_data *ch, int pos)
     if (pos == WEAR_LIGHT && GET_OBJ_TYPE(obj) == ITEM_LIGHT)
       if (GET_OBJ_VAL(obj, 2))	/* if light is ON */
 	world[IN_ROOM(ch)].light--;
+    if (IS_NPC(ch))
+      RoomSave_mark_dirty_room(IN_ROOM(ch));
+    room_trig_types_leave_obj(IN_ROOM(ch), obj);
   } else
     log("SYSERR: IN_ROOM(ch) = NOWHERE when unequipping char %s.", GET_NAME(ch));
 
@@ -725,6 +792,7 @@ void obj_to_room(struct obj_data *object, room_rnum room)
     object->next_content = NULL; // mostly for sanity. should do nothing.
     IN_ROOM(object) = room;
     object->carried_by = NULL;
+    room_trig_types_enter_obj(room, object);
     if (ROOM_FLAGGED(room, ROOM_HOUSE))
       SET_BIT_AR(ROOM_FLAGS(room), ROOM_HOUSE_CRASH);
     /* RoomSave: this room’s contents changed */
@@ -755,6 +823,7 @@ void obj_from_room(struct obj_data *object)
   }
 
   REMOVE_FROM_LIST(object, world[IN_ROOM(object)].contents, next_content);
+  room_trig_types_leave_obj(IN_ROOM(object), object);
 
   if (ROOM_FLAGGED(IN_ROOM(object), ROOM_HOUSE))
     SET_BIT_AR(ROOM_FLAGS(IN_ROOM(object)), ROOM_HOUSE_CRASH);
@@ -1006,7 +1075,7 @@ void extract_char_final(struct char_data *ch)
         STATE(ch->desc) = CON_ACCOUNT_MENU;
         send_account_menu(ch->desc);
         ch->desc->character = NULL;
-        ch->desc = NULL;
+        set_char_desc(ch, NULL);
       } else {
         STATE(ch->desc) = CON_ACCOUNT_MENU;
         send_account_menu(ch->desc);
@@ -1107,8 +1176,10 @@ void extract_char_final(struct char_data *ch)
         log("SYSERR: Could not locate player index entry for %s on death cleanup.",
             GET_NAME(ch));
         for (i = 0; i < MAX_FILES; i++) {
-          if (get_filename(filename, sizeof(filename), i, GET_NAME(ch)))
+          if (get_filename(filename, sizeof(filename), i, GET_NAME(ch))) {
+            save_writer_wait(filename);
             unlink(filename);
+          }
         }
       }
     } else {
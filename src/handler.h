@@ -57,6 +57,7 @@ struct char_data *get_char_num(mob_rnum nr);
 
 void	char_from_room(struct char_data *ch);
 void	char_to_room(struct char_data *ch, room_rnum room);
+void	set_char_desc(struct char_data *ch, struct descriptor_data *d);
 void	extract_char(struct char_data *ch);
 void	extract_char_final(struct char_data *ch);
 void	extract_pending_chars(void);
@@ -102,7 +103,12 @@ int	generic_find(char *arg, bitvector_t bitvector, struct char_data *ch,
 /* prototypes from mobact.c */
 void forget(struct char_data *ch, struct char_data *victim);
 void remember(struct char_data *ch, struct char_data *victim);
-void mobile_activity(void);
+void mobile_activity(int heart_pulse);
+extern long mob_ai_slices;
+extern long mob_ai_usec;
+extern long mob_ai_worst_usec;
+extern long mob_ai_turns;
+extern long mob_ai_dormant;
 void clearMemory(struct char_data *ch);
 
 
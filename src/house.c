@@ -19,6 +19,7 @@
 #include "house.h"
 #include "constants.h"
 #include "modify.h"
+#include "save_writer.h"
 
 /* local (file scope only) globals */
 static struct house_control_rec house_control[MAX_HOUSES];
@@ -64,6 +65,7 @@ static int House_load(room_vnum vnum)
     return (0);
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return (0);
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "r")))	/* no file found */
     return (0);
 
@@ -122,21 +124,21 @@ void House_crashsave(room_vnum vnum)
 {
   int rnum;
   char buf[MAX_STRING_LENGTH];
-  FILE *fp;
+  struct save_file *sf;
 
   if ((rnum = real_room(vnum)) == NOWHERE)
     return;
   if (!House_get_filename(vnum, buf, sizeof(buf)))
     return;
-  if (!(fp = fopen(buf, "wb"))) {
+  if (!(sf = save_begin(buf))) {
     perror("SYSERR: Error saving house file");
     return;
   }
-  if (!House_save(world[rnum].contents, fp)) {
-    fclose(fp);
+  if (!House_save(world[rnum].contents, sf->fp)) {
+    save_abort(sf);
     return;
   }
-  fclose(fp);
+  save_commit(sf);
   House_restore_weight(world[rnum].contents);
   REMOVE_BIT_AR(ROOM_FLAGS(rnum), ROOM_HOUSE_CRASH);
 }
@@ -149,6 +151,7 @@ static void House_delete_file(room_vnum vnum)
 
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return;
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "rb"))) {
     if (errno != ENOENT)
       log("SYSERR: Error deleting house file #%d. (1): %s", vnum, strerror(errno));
@@ -170,6 +173,7 @@ static void House_listrent(struct char_data *ch, room_vnum vnum)
 
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return;
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "rb"))) {
     send_to_char(ch, "No objects on file for house #%d.\r\n", vnum);
     return;
@@ -0,0 +1,159 @@
+/**
+* @file input_scan.c
+* Finding the bytes in player input that need a closer look.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "input_scan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i scan_vec;
+#define SCAN_WIDTH    32
+#define VLOAD(p)      _mm256_loadu_si256((const __m256i *)(p))
+#define VSET(c)       _mm256_set1_epi8((char)(c))
+#define VEQ(a, b)     _mm256_cmpeq_epi8((a), (b))
+#define VLT(a, b)     _mm256_cmpgt_epi8((b), (a))   /* signed bytes */
+#define VOR(a, b)     _mm256_or_si256((a), (b))
+#define VMASK(v)      ((unsigned int)_mm256_movemask_epi8(v))
+#define SCAN_METHOD   "AVX2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128i scan_vec;
+#define SCAN_WIDTH    16
+#define VLOAD(p)      _mm_loadu_si128((const __m128i *)(p))
+#define VSET(c)       _mm_set1_epi8((char)(c))
+#define VEQ(a, b)     _mm_cmpeq_epi8((a), (b))
+#define VLT(a, b)     _mm_cmplt_epi8((a), (b))      /* signed bytes */
+#define VOR(a, b)     _mm_or_si128((a), (b))
+#define VMASK(v)      ((unsigned int)_mm_movemask_epi8(v))
+#define SCAN_METHOD   "SSE2"
+#else
+#define SCAN_METHOD   "bytewise"
+#endif
+
+/* What stops each scan, a byte at a time. */
+#define TELNET_STOP(c)  ((unsigned char)(c) == 255 || (c) == 27 || (c) == '\0')
+#define CLEAN_TEXT(c)   ((unsigned char)(c) >= ' ' && (unsigned char)(c) < 127 && (c) != '$')
+
+/** How many bytes from the start of buf ProtocolInput() can pass through
+ * as they are: up to the first IAC (255), ESC (which may start an MXP
+ * reply) or NUL. */
+size_t scan_telnet_plain(const char *buf, size_t len)
+{
+  size_t i = 0;
+#ifdef SCAN_WIDTH
+  const scan_vec iac = VSET(255), esc = VSET(27), nul = VSET(0);
+  scan_vec v;
+  unsigned int mask;
+
+  for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+    v = VLOAD(buf + i);
+    if ((mask = VMASK(VOR(VOR(VEQ(v, iac), VEQ(v, esc)), VEQ(v, nul)))) != 0)
+      return (i + __builtin_ctz(mask));
+  }
+#endif
+  while (i < len && !TELNET_STOP(buf[i]))
+    i++;
+  return (i);
+}
+
+/** The offset of the first CR or LF in buf, or len if there is none. */
+size_t scan_newline(const char *buf, size_t len)
+{
+  size_t i = 0;
+#ifdef SCAN_WIDTH
+  const scan_vec cr = VSET('\r'), lf = VSET('\n');
+  scan_vec v;
+  unsigned int mask;
+
+  for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+    v = VLOAD(buf + i);
+    if ((mask = VMASK(VOR(VEQ(v, cr), VEQ(v, lf)))) != 0)
+      return (i + __builtin_ctz(mask));
+  }
+#endif
+  while (i < len && !ISNEWL(buf[i]))
+    i++;
+  return (i);
+}
+
+/** How many bytes from the start of buf are printable ASCII other than
+ * '$', and so can be copied into a command line as they are. */
+size_t scan_clean_text(const char *buf, size_t len)
+{
+  size_t i = 0;
+#ifdef SCAN_WIDTH
+  /* Below ' ' as a signed byte catches control characters and 128-255. */
+  const scan_vec space = VSET(' '), del = VSET(127), dollar = VSET('$');
+  scan_vec v;
+  unsigned int mask;
+
+  for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+    v = VLOAD(buf + i);
+    if ((mask = VMASK(VOR(VOR(VLT(v, space), VEQ(v, del)), VEQ(v, dollar)))) != 0)
+      return (i + __builtin_ctz(mask));
+  }
+#endif
+  while (i < len && CLEAN_TEXT(buf[i]))
+    i++;
+  return (i);
+}
+
+/** Copy the line from src up to end into dst, as process_input() always
+ * has: backspace and DEL rub out the character before, '$' is doubled, and
+ * anything else that isn't printable ASCII is dropped.  Copying stops with
+ * one byte of *space_left to spare, which reserves room for a '$$'.  dst is
+ * terminated and *space_left updated.
+ * @retval const char * Where in src copying stopped; end unless the line
+ * was too long. */
+const char *input_copy_line(const char *src, const char *end, char *dst, size_t *space_left)
+{
+  char *write_point = dst;
+  size_t left = *space_left, run;
+
+  while (left > 1 && src < end) {
+    if ((run = scan_clean_text(src, end - src)) > 0) {
+      if (run > left - 1)
+        run = left - 1;
+      memcpy(write_point, src, run);
+      write_point += run;
+      src += run;
+      left -= run;
+      continue;
+    }
+
+    if (*src == '\b' || *src == 127) { /* handle backspacing or delete key */
+      if (write_point > dst) {
+        if (*(--write_point) == '$') {
+          write_point--;
+          left += 2;
+        } else
+          left++;
+      }
+    } else if (*src == '$') {	/* if it's a $, double it */
+      *(write_point++) = '$';
+      *(write_point++) = '$';
+      left -= 2;
+    }
+    src++;
+  }
+
+  *write_point = '\0';
+  *space_left = left;
+  return (src);
+}
+
+/** Which scanner this build uses, for the benchmark. */
+const char *input_scan_method(void)
+{
+  return (SCAN_METHOD);
+}
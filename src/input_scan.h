@@ -0,0 +1,26 @@
+/**
+* @file input_scan.h
+* Finding the bytes in player input that need a closer look.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* Almost everything a player types is plain printable ASCII, so the input
+* path asks these functions how far the plain run goes and copies it in
+* one piece, and only looks byte by byte at what stopped the scan: IAC and
+* escapes in ProtocolInput(), CR and LF, and backspace, '$' and anything
+* unprintable when a line is copied out.  The scans look at 32 bytes at a
+* time with AVX2 when the compiler targets it, 16 with SSE2 (any x86-64),
+* and one at a time elsewhere; the answers are the same either way.
+*/
+#ifndef _INPUT_SCAN_H_
+#define _INPUT_SCAN_H_
+
+size_t scan_telnet_plain(const char *buf, size_t len);
+size_t scan_newline(const char *buf, size_t len);
+size_t scan_clean_text(const char *buf, size_t len);
+const char *input_copy_line(const char *src, const char *end, char *dst, size_t *space_left);
+const char *input_scan_method(void);
+
+#endif /* _INPUT_SCAN_H_ */
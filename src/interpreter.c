@@ -504,6 +504,10 @@ void command_interpreter(struct char_data *ch, char *argument)
   if (!*argument)
     return;
 
+  /* Commands can change nearly anything that is saved (aliases, prefs,
+   * titles...), so a player who typed one is due an autosave. */
+  MARK_CHAR_CHANGED(ch);
+
   /* special case to handle one-character, non-alphanumeric commands; requested
    * by many people so "'hi" or ";godnet test" is possible. Patch sent by Eric
    * Green and Stefan Wasilewski. */
@@ -1158,7 +1162,7 @@ static int perform_dupe_check(struct descriptor_data *d)
 	mode = UNSWITCH;
       }
       if (k->character)
-	k->character->desc = NULL;
+	set_char_desc(k->character, NULL);
       k->character = NULL;
       k->original = NULL;
     } else if (k->character && GET_IDNUM(k->character) == id && k->original) {
@@ -1174,7 +1178,7 @@ static int perform_dupe_check(struct descriptor_data *d)
 	target = k->character;
 	mode = USURP;
       }
-      k->character->desc = NULL;
+      set_char_desc(k->character, NULL);
       k->character = NULL;
       k->original = NULL;
       write_to_output(k, "\r\nMultiple login detected -- disconnecting.\r\n");
@@ -1237,7 +1241,7 @@ static int perform_dupe_check(struct descriptor_data *d)
   /* Okay, we've found a target.  Connect d to target. */
   free_char(d->character); /* get rid of the old char */
   d->character = target;
-  d->character->desc = d;
+  set_char_desc(d->character, d);
   d->original = NULL;
   d->character->char_specials.timer = 0;
   REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_MAILING);
@@ -1293,7 +1297,7 @@ static bool perform_new_char_dupe_check(struct descriptor_data *d)
       /* Check the other character is still in creation? */
       if (is_creation_state(STATE(k))) {
         /* Boot the older one */
-        k->character->desc = NULL;
+        set_char_desc(k->character, NULL);
         k->character = NULL;
         k->original = NULL;
         write_to_output(k, "\r\nMultiple login detected -- disconnecting.\r\n");
@@ -1304,13 +1308,13 @@ static bool perform_new_char_dupe_check(struct descriptor_data *d)
         found = TRUE;
       } else {
         /* Something went VERY wrong, boot both chars */
-        k->character->desc = NULL;
+        set_char_desc(k->character, NULL);
         k->character = NULL;
         k->original = NULL;
         write_to_output(k, "\r\nMultiple login detected -- disconnecting.\r\n");
         STATE(k) = CON_CLOSE;
 
-        d->character->desc = NULL;
+        set_char_desc(d->character, NULL);
         d->character = NULL;
         d->original = NULL;
         write_to_output(d, "\r\nSorry, due to multiple connections, all your connections are being closed.\r\n");
@@ -2247,6 +2251,7 @@ case CON_QSTAT_PREF: {
     add_llog_entry(d->character, LAST_CONNECT);
 
     load_result = enter_player_game(d);
+    msdp_changed(d->character, MSDP_DIRTY_ALL);
     send_to_char(d->character, "%s", CONFIG_WELC_MESSG);
 
     save_char(d->character);
@@ -283,6 +283,8 @@ void gain_exp(struct char_data *ch, int gain)
     return;
   }
 
+  MARK_CHAR_CHANGED(ch);
+  msdp_changed(ch, MSDP_DIRTY_LEVEL);
   if (gain > 0) {
     gain = MIN(CONFIG_MAX_EXP_GAIN, gain);	/* cap max gain per kill */
     GET_EXP(ch) += gain;
@@ -307,6 +309,8 @@ void gain_exp_regardless(struct char_data *ch, int gain)
     GET_EXP(ch) = 0;
 
   if (!IS_NPC(ch)) {
+    MARK_CHAR_CHANGED(ch);
+    msdp_changed(ch, MSDP_DIRTY_LEVEL);
     while (GET_LEVEL(ch) < LVL_IMPL &&
 	GET_EXP(ch) >= level_exp(GET_CLASS(ch), GET_LEVEL(ch) + 1)) {
       GET_LEVEL(ch) += 1;
@@ -331,17 +335,22 @@ void gain_exp_regardless(struct char_data *ch, int gain)
 void gain_condition(struct char_data *ch, int condition, int value)
 {
   bool intoxicated;
+  int old;
 
   if (IS_NPC(ch) || GET_COND(ch, condition) == -1)	/* No change */
     return;
 
   intoxicated = (GET_COND(ch, DRUNK) > 0);
+  old = GET_COND(ch, condition);
 
   GET_COND(ch, condition) += value;
 
   GET_COND(ch, condition) = MAX(0, GET_COND(ch, condition));
   GET_COND(ch, condition) = MIN(24, GET_COND(ch, condition));
 
+  if (GET_COND(ch, condition) != old)
+    MARK_CHAR_CHANGED(ch);
+
   if (GET_COND(ch, condition) || PLR_FLAGGED(ch, PLR_WRITING))
     return;
 
@@ -388,7 +397,7 @@ static void check_idling(struct char_data *ch)
 	 * -gg 3/1/98 (Happy anniversary.)
 	 */
 	ch->desc->character = NULL;
-	ch->desc = NULL;
+	set_char_desc(ch, NULL);
       }
       Crash_idlesave(ch);
       mudlog(CMP, MAX(LVL_GOD, GET_INVIS_LEV(ch)), TRUE, "%s idle-saved and extracted (idle).", GET_NAME(ch));
@@ -415,9 +424,13 @@ void point_update(void)
     gain_condition(i, THIRST, -1);
 
     if (GET_POS(i) >= POS_STUNNED) {
+      if (GET_HIT(i) < GET_MAX_HIT(i) || GET_MANA(i) < GET_MAX_MANA(i) ||
+          GET_STAMINA(i) < GET_MAX_STAMINA(i))
+        MARK_CHAR_CHANGED(i);
       GET_HIT(i) = MIN(GET_HIT(i) + hit_gain(i), GET_MAX_HIT(i));
       GET_MANA(i) = MIN(GET_MANA(i) + mana_gain(i), GET_MAX_MANA(i));
       GET_STAMINA(i) = MIN(GET_STAMINA(i) + move_gain(i), GET_MAX_STAMINA(i));
+      msdp_changed(i, MSDP_DIRTY_VITALS);
       if (AFF_FLAGGED(i, AFF_POISON))
         if (damage(i, i, 2, SPELL_POISON) == -1)
           continue; /* Oops, they died. -gg 6/24/98 */
@@ -537,6 +550,7 @@ int increase_bank_coins(struct char_data *ch, int amt)
   if (IS_NPC(ch)) return 0;
 
   curr_bank = GET_BANK_COINS(ch);
+  MARK_CHAR_CHANGED(ch);
 
   if (amt < 0) {
     GET_BANK_COINS(ch) = MAX(0, curr_bank+amt);
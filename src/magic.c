@@ -56,9 +56,10 @@ void affect_update(void)
   for (i = character_list; i; i = i->next)
     for (af = i->affected; af; af = next) {
       next = af->next;
-      if (af->duration >= 1)
+      if (af->duration >= 1) {
 	af->duration--;
-      else if (af->duration == -1)	/* No action */
+	MARK_CHAR_CHANGED(i);
+      } else if (af->duration == -1)	/* No action */
 	;
       else {
 	if ((af->spell > 0) && (af->spell <= MAX_SPELLS))
@@ -784,6 +785,7 @@ void mag_points(int level, struct char_data *ch, struct char_data *victim,
   }
   GET_HIT(victim) = MIN(GET_MAX_HIT(victim), GET_HIT(victim) + healing);
   GET_STAMINA(victim) = MIN(GET_MAX_STAMINA(victim), GET_STAMINA(victim) + move);
+  msdp_changed(victim, MSDP_DIRTY_VITALS);
   update_pos(victim);
 }
 
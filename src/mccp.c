@@ -0,0 +1,185 @@
+/**
+* @file mccp.c
+* MCCP version 2: deflate compression of what is sent to a client.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "mccp.h"
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+
+/** Room the buffer grows by when deflate runs out of it. */
+#define MCCP_CHUNK 4096
+
+struct mccp_stream {
+  z_stream zs;
+  bool started;          /**< Start marker sent, zs initialised. */
+  bool finished;         /**< Z_FINISH done; nothing more goes in. */
+  char *buf;             /**< Bytes for the socket, raw marker included. */
+  size_t start, end, size;
+};
+
+/** Make sure there is room for at least want more bytes at the end of the
+ * buffer, dropping what has been sent from the front first. */
+static void make_room(struct mccp_stream *z, size_t want)
+{
+  if (z->start == z->end)
+    z->start = z->end = 0;
+  else if (z->start && z->size - z->end < want) {
+    memmove(z->buf, z->buf + z->start, z->end - z->start);
+    z->end -= z->start;
+    z->start = 0;
+  }
+  if (z->size - z->end < want) {
+    z->size = z->end + MAX(want, MCCP_CHUNK);
+    RECREATE(z->buf, char, z->size);
+  }
+}
+
+/** Run deflate over whatever zs holds with the given flush mode, appending
+ * the output to the buffer.  @retval bool FALSE on a zlib error. */
+static bool run_deflate(struct mccp_stream *z, int flush)
+{
+  int ret;
+
+  do {
+    make_room(z, MCCP_CHUNK);
+    z->zs.next_out = (Bytef *) (z->buf + z->end);
+    z->zs.avail_out = z->size - z->end;
+    ret = deflate(&z->zs, flush);
+    z->end = z->size - z->zs.avail_out;
+    if (ret == Z_STREAM_END)
+      return (TRUE);
+    if (ret != Z_OK && ret != Z_BUF_ERROR)
+      return (FALSE);
+    /* Filling the room we gave it is the only reason to go around again. */
+  } while (z->zs.avail_in > 0 || z->zs.avail_out == 0);
+
+  return (TRUE);
+}
+
+struct mccp_stream *mccp_create(void)
+{
+  struct mccp_stream *z;
+
+  CREATE(z, struct mccp_stream, 1);
+  return (z);
+}
+
+void mccp_free(struct mccp_stream *z)
+{
+  if (z->started)
+    deflateEnd(&z->zs);
+  if (z->buf)
+    free(z->buf);
+  free(z);
+}
+
+/** Queue IAC SB COMPRESS2 IAC SE and start compressing everything after it.
+ * Call only once nothing meant to go out uncompressed is still queued.
+ * @retval bool FALSE if zlib couldn't be set up. */
+bool mccp_begin(struct mccp_stream *z)
+{
+  /* IAC SB COMPRESS2 IAC SE */
+  static const char marker[] = { (char) 255, (char) 250, 86, (char) 255, (char) 240 };
+
+  if (z->started)
+    return (TRUE);
+  if (deflateInit(&z->zs, Z_DEFAULT_COMPRESSION) != Z_OK)
+    return (FALSE);
+
+  make_room(z, sizeof(marker));
+  memcpy(z->buf + z->end, marker, sizeof(marker));
+  z->end += sizeof(marker);
+  z->started = TRUE;
+  return (TRUE);
+}
+
+bool mccp_started(const struct mccp_stream *z)
+{
+  return (z->started);
+}
+
+/** Compress len bytes of txt into the buffer.  They may not come out
+ * until mccp_flush(). */
+bool mccp_compress(struct mccp_stream *z, const char *txt, size_t len)
+{
+  if (!z->started || z->finished)
+    return (FALSE);
+  if (!len)
+    return (TRUE);
+  z->zs.next_in = (Bytef *) txt;
+  z->zs.avail_in = len;
+  return (run_deflate(z, Z_NO_FLUSH));
+}
+
+/** Push everything compressed so far into the buffer, so the client can
+ * decompress it without waiting for more.  Done at the end of each write. */
+bool mccp_flush(struct mccp_stream *z)
+{
+  if (!z->started || z->finished)
+    return (FALSE);
+  z->zs.avail_in = 0;
+  return (run_deflate(z, Z_SYNC_FLUSH));
+}
+
+/** End the stream; once the buffer is sent the client is back to reading
+ * plain text. */
+bool mccp_finish(struct mccp_stream *z)
+{
+  if (!z->started || z->finished)
+    return (FALSE);
+  z->zs.avail_in = 0;
+  z->finished = TRUE;
+  return (run_deflate(z, Z_FINISH));
+}
+
+/** How many bytes are waiting for the socket.
+ * @param data If not NULL, set to the first of them. */
+size_t mccp_pending(const struct mccp_stream *z, const char **data)
+{
+  if (data)
+    *data = z->buf + z->start;
+  return (z->end - z->start);
+}
+
+/** Drop len bytes from the front of the buffer, the socket having taken
+ * them. */
+void mccp_consume(struct mccp_stream *z, size_t len)
+{
+  z->start += MIN(len, z->end - z->start);
+}
+
+/** Bytes of text compressed, and the bytes they came to. */
+void mccp_totals(const struct mccp_stream *z, unsigned long *in, unsigned long *out)
+{
+  *in = z->started ? z->zs.total_in : 0;
+  *out = z->started ? z->zs.total_out : 0;
+}
+
+#else /* !HAVE_ZLIB_H */
+
+struct mccp_stream *mccp_create(void) { return (NULL); }
+void mccp_free(struct mccp_stream *z) { }
+bool mccp_begin(struct mccp_stream *z) { return (FALSE); }
+bool mccp_started(const struct mccp_stream *z) { return (FALSE); }
+bool mccp_compress(struct mccp_stream *z, const char *txt, size_t len) { return (FALSE); }
+bool mccp_flush(struct mccp_stream *z) { return (FALSE); }
+bool mccp_finish(struct mccp_stream *z) { return (FALSE); }
+size_t mccp_pending(const struct mccp_stream *z, const char **data) { return (0); }
+void mccp_consume(struct mccp_stream *z, size_t len) { }
+void mccp_totals(const struct mccp_stream *z, unsigned long *in, unsigned long *out)
+{
+  *in = *out = 0;
+}
+
+#endif /* HAVE_ZLIB_H */
@@ -0,0 +1,32 @@
+/**
+* @file mccp.h
+* MCCP version 2: deflate compression of what is sent to a client.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* Once a client answers our IAC WILL COMPRESS2 with IAC DO, everything we
+* send it after IAC SB COMPRESS2 IAC SE is one zlib stream, flushed at the
+* end of each write so the client can show it straight away.  A stream only
+* compresses into its own buffer; comm.c takes the bytes from there to the
+* socket, and keeps whatever the socket won't take there for the next pulse.
+* Without zlib mccp_create() returns NULL and nothing is compressed.
+*/
+#ifndef _MCCP_H_
+#define _MCCP_H_
+
+struct mccp_stream;
+
+struct mccp_stream *mccp_create(void);
+void mccp_free(struct mccp_stream *z);
+bool mccp_begin(struct mccp_stream *z);
+bool mccp_started(const struct mccp_stream *z);
+bool mccp_compress(struct mccp_stream *z, const char *txt, size_t len);
+bool mccp_flush(struct mccp_stream *z);
+bool mccp_finish(struct mccp_stream *z);
+size_t mccp_pending(const struct mccp_stream *z, const char **data);
+void mccp_consume(struct mccp_stream *z, size_t len);
+void mccp_totals(const struct mccp_stream *z, unsigned long *in, unsigned long *out);
+
+#endif /* _MCCP_H_ */
@@ -21,17 +21,50 @@
 #include "act.h"
 #include "graph.h"
 #include "fight.h"
+#include "dormancy.h"
 
 
+/* Mob AI timing, for 'show stats'. */
+long mob_ai_slices = 0;         /* shards run since boot */
+long mob_ai_usec = 0;           /* time spent in them */
+long mob_ai_worst_usec = 0;     /* the slowest one */
+long mob_ai_turns = 0;          /* mob turns taken in them */
+long mob_ai_dormant = 0;        /* turns skipped in dormant zones */
+
 /* local file scope only function prototypes */
 static bool aggressive_mob_on_a_leash(struct char_data *slave, struct char_data *master, struct char_data *attack);
 
-void mobile_activity(void)
+/* Which of the shards a mob belongs to.  Script ids are handed out lazily,
+ * so the mob's address is hashed instead; it holds still for its life. */
+static int mob_ai_shard(struct char_data *ch, int shards)
+{
+  unsigned long h = (unsigned long)((size_t)ch >> 4) * 2654435761UL;
+
+  return ((int)((h >> 16) % shards));
+}
+
+/** Runs the mobs' AI.  Called every pulse.  The mobs are split into
+ * CONFIG_MOB_AI_SHARDS shards, and the shards take turns over each
+ * PULSE_MOBILE, so every mob still acts once per PULSE_MOBILE but the work
+ * is not all done in one pulse.
+ * @param heart_pulse The pulse being run. */
+void mobile_activity(int heart_pulse)
 {
   struct char_data *ch, *next_ch, *vict;
   struct obj_data *obj, *best_obj;
-  int door, found, max;
+  int door, found, max, shards, phase, shard;
+  bool dormant;
   memory_rec *names;
+  struct timeval start, end;
+  long usec;
+
+  shards = MIN(PULSE_MOBILE, MAX(1, CONFIG_MOB_AI_SHARDS));
+  phase = heart_pulse % PULSE_MOBILE;
+  shard = phase * shards / PULSE_MOBILE;
+  if (phase && shard == (phase - 1) * shards / PULSE_MOBILE)
+    return;             /* this shard has had its turn */
+
+  gettimeofday(&start, NULL);
 
   for (ch = character_list; ch; ch = next_ch) {
     next_ch = ch->next;
@@ -39,6 +72,18 @@ void mobile_activity(void)
     if (!IS_MOB(ch))
       continue;
 
+    if (shards > 1 && mob_ai_shard(ch, shards) != shard)
+      continue;
+
+    /* In a dormant zone only spec procs run, and mobs on a hunt. */
+    dormant = IN_ROOM(ch) != NOWHERE &&
+              ZONE_DORMANT(world[IN_ROOM(ch)].zone) && !HUNTING(ch);
+    if (dormant && !MOB_FLAGGED(ch, MOB_SPEC)) {
+      mob_ai_dormant++;
+      continue;
+    }
+    mob_ai_turns++;
+
     /* Examine call for special procedure */
     if (MOB_FLAGGED(ch, MOB_SPEC) && !no_specials) {
       if (mob_index[GET_MOB_RNUM(ch)].func == NULL) {
@@ -53,7 +98,7 @@ void mobile_activity(void)
     }
 
     /* If the mob has no specproc, do the default actions */
-    if (FIGHTING(ch) || !AWAKE(ch))
+    if (FIGHTING(ch) || !AWAKE(ch) || dormant)
       continue;
 
     /* hunt a victim, if applicable */
@@ -168,6 +213,13 @@ void mobile_activity(void)
     /* Add new mobile actions here */
 
   }				/* end for() */
+
+  gettimeofday(&end, NULL);
+  usec = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+  mob_ai_slices++;
+  mob_ai_usec += usec;
+  if (usec > mob_ai_worst_usec)
+    mob_ai_worst_usec = usec;
 }
 
 /* Mob Memory Routines */
@@ -0,0 +1,559 @@
+/**
+* @file netio.c
+* The network thread: socket reads and writes off the game thread.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "poller.h"
+#include "netio.h"
+
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_SYS_EPOLL_H)
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#define NETIO_EVENTS 256
+
+/** Tries, 100 msec apart, at sending what is left when the thread stops. */
+#define NETIO_FLUSH_TRIES 20
+
+/* Everything both threads touch goes through these. */
+#define LOAD(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/** One direction of a connection.  Only the thread filling the ring moves
+ * head and only the one emptying it moves tail.  Both count bytes from the
+ * start, so head - tail is what the ring holds. */
+struct netio_ring {
+  char *buf;
+  size_t size;
+  size_t head;
+  size_t tail;
+};
+
+struct netio_conn {
+  socket_t fd;
+  struct netio_ring in;     /**< Filled by the network thread. */
+  struct netio_ring out;    /**< Filled by the game thread. */
+  int closed;               /**< Set by the network thread on EOF or error. */
+  int stalled;              /**< Set by the network thread when the input
+                                 ring filled before the socket ran dry. */
+  /* The network thread's own. */
+  bool blocked;             /**< Socket took no more; wait for EPOLLOUT. */
+  bool listed;              /**< In conns and the epoll set. */
+  struct netio_conn *prev, *next;
+  /* Protected by netio_lock while queued.  Attaches and detaches have
+   * lists of their own, so a connection detached before the thread got to
+   * its attach is on both at once rather than relinked into one. */
+  struct netio_conn *next_attach;
+  struct netio_conn *next_detach;
+};
+
+/* The game thread's. */
+static pthread_t netio_tid;
+static bool running = FALSE;
+static bool kick_wanted = FALSE;
+
+/* Set up by netio_start() before the thread runs, then left alone. */
+static int epoll_fd = -1, wake_fd[2] = { -1, -1 };
+
+/* Protected by netio_lock. */
+static pthread_mutex_t netio_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct netio_conn *attach_head = NULL, *attach_tail = NULL;
+static struct netio_conn *detach_head = NULL, *detach_tail = NULL;
+static bool stop_wanted = FALSE;
+
+/* The network thread's. */
+static struct netio_conn *conns = NULL;
+
+/* Written by the network thread, read by show stats. */
+static unsigned long bytes_in = 0, bytes_out = 0;
+
+static size_t ring_used(struct netio_ring *r)
+{
+  return (LOAD(&r->head) - LOAD(&r->tail));
+}
+
+/** Describe len bytes of r from offset off as one or two iovecs. */
+static int ring_span(struct netio_ring *r, size_t off, size_t len, struct iovec *iov)
+{
+  if (!len)
+    return (0);
+  iov[0].iov_base = r->buf + off;
+  if (off + len <= r->size) {
+    iov[0].iov_len = len;
+    return (1);
+  }
+  iov[0].iov_len = r->size - off;
+  iov[1].iov_base = r->buf;
+  iov[1].iov_len = len - iov[0].iov_len;
+  return (2);
+}
+
+/** The free space in r, for the thread that fills it. */
+static int ring_space(struct netio_ring *r, struct iovec *iov)
+{
+  size_t head = LOAD(&r->head);
+
+  return (ring_span(r, head & (r->size - 1), r->size - (head - LOAD(&r->tail)), iov));
+}
+
+/** What r holds, for the thread that empties it. */
+static int ring_data(struct netio_ring *r, struct iovec *iov)
+{
+  size_t tail = LOAD(&r->tail);
+
+  return (ring_span(r, tail & (r->size - 1), LOAD(&r->head) - tail, iov));
+}
+
+/** Copy as much of len bytes of src into r as fits. */
+static size_t ring_put(struct netio_ring *r, const char *src, size_t len)
+{
+  struct iovec iov[2];
+  size_t done = 0, n;
+  int i, cnt = ring_space(r, iov);
+
+  for (i = 0; i < cnt && done < len; i++) {
+    n = iov[i].iov_len < len - done ? iov[i].iov_len : len - done;
+    memcpy(iov[i].iov_base, src + done, n);
+    done += n;
+  }
+  if (done)
+    STORE(&r->head, LOAD(&r->head) + done);
+  return (done);
+}
+
+/** Copy up to len bytes out of r into dst. */
+static size_t ring_get(struct netio_ring *r, char *dst, size_t len)
+{
+  struct iovec iov[2];
+  size_t done = 0, n;
+  int i, cnt = ring_data(r, iov);
+
+  for (i = 0; i < cnt && done < len; i++) {
+    n = iov[i].iov_len < len - done ? iov[i].iov_len : len - done;
+    memcpy(dst + done, iov[i].iov_base, n);
+    done += n;
+  }
+  if (done)
+    STORE(&r->tail, LOAD(&r->tail) + done);
+  return (done);
+}
+
+static void ring_init(struct netio_ring *r, size_t size)
+{
+  CREATE(r->buf, char, size);
+  r->size = size;
+  r->head = r->tail = 0;
+}
+
+static void free_conn(struct netio_conn *c)
+{
+  free(c->in.buf);
+  free(c->out.buf);
+  free(c);
+}
+
+static void wake_thread(void)
+{
+  char c = 0;
+
+  /* A full pipe means the thread has a wakeup coming already. */
+  if (write(wake_fd[1], &c, 1) < 0 && errno != EAGAIN)
+    perror("SYSERR: netio wake");
+}
+
+/* --- The network thread --- */
+
+/** Read what the socket has into the input ring, until it would block. */
+static void conn_read(struct netio_conn *c)
+{
+  struct iovec iov[2];
+  ssize_t n;
+  int cnt;
+
+  while (!LOAD(&c->closed)) {
+    if (!(cnt = ring_space(&c->in, iov))) {
+      STORE(&c->stalled, TRUE);
+      return;
+    }
+    n = readv(c->fd, iov, cnt);
+    if (n > 0) {
+      STORE(&c->in.head, LOAD(&c->in.head) + n);
+      __atomic_fetch_add(&bytes_in, n, __ATOMIC_RELAXED);
+    } else if (n < 0 && errno == EINTR)
+      continue;
+    else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      STORE(&c->stalled, FALSE);
+      return;
+    } else      /* EOF, or an error that won't go away */
+      STORE(&c->closed, TRUE);
+  }
+}
+
+/** Send what the output ring holds, until the socket would block. */
+static void conn_write(struct netio_conn *c)
+{
+  struct iovec iov[2];
+  ssize_t n;
+  int cnt;
+
+  while (!LOAD(&c->closed) && (cnt = ring_data(&c->out, iov)) > 0) {
+    n = writev(c->fd, iov, cnt);
+    if (n > 0) {
+      STORE(&c->out.tail, LOAD(&c->out.tail) + n);
+      __atomic_fetch_add(&bytes_out, n, __ATOMIC_RELAXED);
+    } else if (n < 0 && errno == EINTR)
+      continue;
+    else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      c->blocked = TRUE;
+      return;
+    } else
+      STORE(&c->closed, TRUE);
+  }
+}
+
+/** Carry out the attaches and detaches the game thread has queued, the
+ * attaches first, since a connection's detach may be in the same batch.
+ * @retval bool TRUE if the game thread wants the thread to stop. */
+static bool run_commands(void)
+{
+  struct netio_conn *attaches, *detaches, *c;
+  struct epoll_event ev;
+  bool stop;
+
+  pthread_mutex_lock(&netio_lock);
+  attaches = attach_head;
+  detaches = detach_head;
+  attach_head = attach_tail = detach_head = detach_tail = NULL;
+  stop = stop_wanted;
+  pthread_mutex_unlock(&netio_lock);
+
+  while ((c = attaches) != NULL) {
+    attaches = c->next_attach;
+
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = c;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c->fd, &ev) < 0) {
+      STORE(&c->closed, TRUE);
+      continue;
+    }
+    c->listed = TRUE;
+    c->prev = NULL;
+    if ((c->next = conns) != NULL)
+      conns->prev = c;
+    conns = c;
+  }
+
+  while ((c = detaches) != NULL) {
+    detaches = c->next_detach;
+
+    /* Send what the socket will take at once, then close it. */
+    if (c->listed) {
+      conn_write(c);
+      if (c->prev)
+        c->prev->next = c->next;
+      else
+        conns = c->next;
+      if (c->next)
+        c->next->prev = c->prev;
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, &ev);
+    }
+    CLOSE_SOCKET(c->fd);
+    free_conn(c);
+  }
+  return (stop);
+}
+
+/** On the way out, give every socket a couple of seconds to take what is
+ * left in its output ring; the game thread sends from there on itself. */
+static void flush_all(void)
+{
+  struct epoll_event ev[NETIO_EVENTS];
+  struct netio_conn *c;
+  bool left;
+  int i;
+
+  for (i = 0; i < NETIO_FLUSH_TRIES; i++) {
+    left = FALSE;
+    for (c = conns; c; c = c->next) {
+      conn_write(c);
+      if (!LOAD(&c->closed) && ring_used(&c->out))
+        left = TRUE;
+    }
+    if (!left)
+      break;
+    epoll_wait(epoll_fd, ev, NETIO_EVENTS, 100);
+  }
+}
+
+static void *netio_main(void *arg)
+{
+  struct epoll_event ev[NETIO_EVENTS];
+  struct netio_conn *c;
+  char drain[64];
+  bool woken, stop = FALSE;
+  int i, n;
+
+  while (!stop) {
+    if ((n = epoll_wait(epoll_fd, ev, NETIO_EVENTS, -1)) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    woken = FALSE;
+    for (i = 0; i < n; i++) {
+      if (!(c = ev[i].data.ptr))
+        woken = TRUE;
+      else {
+        if (ev[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+          conn_read(c);
+        if (ev[i].events & EPOLLOUT) {
+          c->blocked = FALSE;
+          conn_write(c);
+        }
+      }
+    }
+    if (!woken)
+      continue;
+
+    /* The game thread has queued output, made room for input, or has
+     * commands for us.  Empty the pipe first so a kick from here on
+     * wakes us again. */
+    while (read(wake_fd[0], drain, sizeof(drain)) > 0)
+      ;
+    stop = run_commands();
+    for (c = conns; c; c = c->next) {
+      if (LOAD(&c->stalled))
+        conn_read(c);
+      if (!c->blocked)
+        conn_write(c);
+    }
+  }
+
+  flush_all();
+  while ((c = conns) != NULL) {
+    conns = c->next;
+    free_conn(c);
+  }
+  return (NULL);
+}
+
+/* --- The game thread --- */
+
+static void queue_attach(struct netio_conn *c)
+{
+  pthread_mutex_lock(&netio_lock);
+  c->next_attach = NULL;
+  if (attach_tail)
+    attach_tail->next_attach = c;
+  else
+    attach_head = c;
+  attach_tail = c;
+  pthread_mutex_unlock(&netio_lock);
+  kick_wanted = TRUE;
+}
+
+static void queue_detach(struct netio_conn *c)
+{
+  pthread_mutex_lock(&netio_lock);
+  c->next_detach = NULL;
+  if (detach_tail)
+    detach_tail->next_detach = c;
+  else
+    detach_head = c;
+  detach_tail = c;
+  pthread_mutex_unlock(&netio_lock);
+  kick_wanted = TRUE;
+}
+
+static void close_fds(void)
+{
+  if (epoll_fd >= 0)
+    close(epoll_fd);
+  if (wake_fd[0] >= 0) {
+    close(wake_fd[0]);
+    close(wake_fd[1]);
+  }
+  epoll_fd = wake_fd[0] = wake_fd[1] = -1;
+}
+
+/** Start the network thread.
+ * @retval bool FALSE if it couldn't be started; the caller keeps doing its
+ * own socket I/O. */
+bool netio_start(void)
+{
+  struct epoll_event ev;
+  sigset_t all, old;
+  int i, err;
+
+  if (running)
+    return (TRUE);
+
+  if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0 || pipe(wake_fd) < 0) {
+    close_fds();
+    return (FALSE);
+  }
+  for (i = 0; i < 2; i++) {
+    fcntl(wake_fd[i], F_SETFL, fcntl(wake_fd[i], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(wake_fd[i], F_SETFD, FD_CLOEXEC);
+  }
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd[0], &ev) < 0) {
+    close_fds();
+    return (FALSE);
+  }
+
+  stop_wanted = FALSE;
+  /* Signals are the game thread's business; the new thread inherits this
+   * mask and never sees them. */
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  err = pthread_create(&netio_tid, NULL, netio_main, NULL);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+  if (err) {
+    close_fds();
+    return (FALSE);
+  }
+  running = TRUE;
+  return (TRUE);
+}
+
+/** Stop the network thread once it has sent what it was given, as far as
+ * the sockets will take it in a couple of seconds.  Every connection still
+ * attached is freed, but its socket is left open for the caller. */
+void netio_stop(void)
+{
+  if (!running)
+    return;
+
+  pthread_mutex_lock(&netio_lock);
+  stop_wanted = TRUE;
+  pthread_mutex_unlock(&netio_lock);
+  wake_thread();
+  pthread_join(netio_tid, NULL);
+
+  close_fds();
+  running = kick_wanted = FALSE;
+}
+
+bool netio_running(void)
+{
+  return (running);
+}
+
+/** Hand socket s to the network thread.  The caller must no longer read
+ * or write s itself, only the connection returned. */
+struct netio_conn *netio_attach(socket_t s)
+{
+  struct netio_conn *c;
+
+  CREATE(c, struct netio_conn, 1);
+  c->fd = s;
+  ring_init(&c->in, NETIO_IN_RING);
+  ring_init(&c->out, NETIO_OUT_RING);
+  queue_attach(c);
+  return (c);
+}
+
+/** Done with c: the network thread sends what it can of the output still
+ * in its ring, then closes the socket and frees c. */
+void netio_detach(struct netio_conn *c)
+{
+  queue_detach(c);
+}
+
+/** As perform_socket_read(), from c's input ring.
+ * @retval ssize_t The bytes read, 0 if none are waiting, or -1 once the
+ * connection has closed and everything before that has been read. */
+ssize_t netio_read(struct netio_conn *c, char *buf, size_t len)
+{
+  int closed = LOAD(&c->closed);   /* before the ring, so nothing is lost */
+  size_t n;
+
+  if ((n = ring_get(&c->in, buf, len)) > 0) {
+    if (LOAD(&c->stalled))
+      kick_wanted = TRUE;
+    return (n);
+  }
+  return (closed ? -1 : 0);
+}
+
+/** As perform_socket_writev(), into c's output ring.  The bytes are sent
+ * once netio_kick() wakes the network thread.
+ * @retval ssize_t The bytes queued, 0 if the ring is full, or -1 if the
+ * connection has closed. */
+ssize_t netio_writev(struct netio_conn *c, const struct iovec *iov, int iovcnt)
+{
+  size_t n, total = 0;
+  int i;
+
+  if (LOAD(&c->closed))
+    return (-1);
+  for (i = 0; i < iovcnt; i++) {
+    n = ring_put(&c->out, iov[i].iov_base, iov[i].iov_len);
+    total += n;
+    if (n < iov[i].iov_len)
+      break;
+  }
+  if (total)
+    kick_wanted = TRUE;
+  return (total);
+}
+
+/** POLL_READ if there is input or the connection has closed, POLL_WRITE
+ * if there is room for output. */
+int netio_ready(struct netio_conn *c)
+{
+  int ready = 0;
+
+  if (LOAD(&c->closed) || ring_used(&c->in))
+    ready |= POLL_READ;
+  if (ring_used(&c->out) < c->out.size)
+    ready |= POLL_WRITE;
+  return (ready);
+}
+
+/** Wake the network thread if anything was queued or read since the last
+ * kick.  Called once a pulse, after the output has been handed over. */
+void netio_kick(void)
+{
+  if (!running || !kick_wanted)
+    return;
+  kick_wanted = FALSE;
+  wake_thread();
+}
+
+/** Bytes the network thread has read and sent. */
+void netio_totals(unsigned long *in, unsigned long *out)
+{
+  *in = __atomic_load_n(&bytes_in, __ATOMIC_RELAXED);
+  *out = __atomic_load_n(&bytes_out, __ATOMIC_RELAXED);
+}
+
+#else /* no pthreads or epoll */
+
+bool netio_start(void) { return (FALSE); }
+void netio_stop(void) { }
+bool netio_running(void) { return (FALSE); }
+struct netio_conn *netio_attach(socket_t s) { return (NULL); }
+void netio_detach(struct netio_conn *c) { }
+ssize_t netio_read(struct netio_conn *c, char *buf, size_t len) { return (-1); }
+ssize_t netio_writev(struct netio_conn *c, const struct iovec *iov, int iovcnt) { return (-1); }
+int netio_ready(struct netio_conn *c) { return (0); }
+void netio_kick(void) { }
+void netio_totals(unsigned long *in, unsigned long *out)
+{
+  *in = *out = 0;
+}
+
+#endif
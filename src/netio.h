@@ -0,0 +1,42 @@
+/**
+* @file netio.h
+* The network thread: socket reads and writes off the game thread.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* With network_thread on, each client socket is handed to a thread of its
+* own, which reads whatever arrives into the connection's input ring and
+* sends whatever the game puts in its output ring.  Each ring has one
+* writer and one reader, so neither side ever takes a lock or waits for the
+* other; the game thread just copies bytes in and out once a pulse and
+* kicks the network thread when it has queued some.  Everything else,
+* telnet negotiation included, still happens on the game thread.  Needs
+* pthreads and epoll(); without them netio_start() fails and the game does
+* its own socket I/O as before.
+*/
+#ifndef _NETIO_H_
+#define _NETIO_H_
+
+/* Ring sizes, powers of two.  A full input ring just leaves the rest in the
+ * kernel until the game catches up; a full output ring leaves it queued in
+ * the descriptor's output, as a full socket buffer would. */
+#define NETIO_IN_RING   8192
+#define NETIO_OUT_RING  32768
+
+struct netio_conn;
+struct iovec;
+
+bool netio_start(void);
+void netio_stop(void);
+bool netio_running(void);
+struct netio_conn *netio_attach(socket_t s);
+void netio_detach(struct netio_conn *c);
+ssize_t netio_read(struct netio_conn *c, char *buf, size_t len);
+ssize_t netio_writev(struct netio_conn *c, const struct iovec *iov, int iovcnt);
+int netio_ready(struct netio_conn *c);
+void netio_kick(void);
+void netio_totals(unsigned long *in, unsigned long *out);
+
+#endif /* _NETIO_H_ */
@@ -393,6 +393,10 @@ extern const char *nrm, *grn, *cyn, *yel;
 #define CEDIT_MAP_SIZE                 51
 #define CEDIT_MINIMAP_SIZE             52
 #define CEDIT_DEBUG_MODE               53
+#define CEDIT_BOOT_THREADS             54
+#define CEDIT_MOB_AI_SHARDS            55
+#define CEDIT_DORMANCY_DELAY           56
+#define CEDIT_DORMANCY_RADIUS          57
 
 /* Hedit Submodes of connectedness. */
 #define HEDIT_CONFIRM_SAVESTRING        0
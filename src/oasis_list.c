@@ -881,7 +881,7 @@ void print_zone(struct char_data *ch, zone_vnum vnum)
     QGRN, QCYN, zone_table[rnum].name,
     QGRN, QCYN, zone_table[rnum].builders,
     QGRN, QCYN, zone_table[rnum].lifespan,
-    QGRN, QCYN, zone_table[rnum].age,
+    QGRN, QCYN, zone_age(rnum),
     QGRN, QCYN, zone_table[rnum].bot,
     QGRN, QCYN, zone_table[rnum].top,
     QGRN, QCYN, zone_table[rnum].reset_mode ? ((zone_table[rnum].reset_mode == 1) ?
@@ -24,6 +24,7 @@
 #include "genolc.h" /* for strip_cr and sprintascii */
 #include "toml.h"
 #include "toml_utils.h"
+#include "save_writer.h"
 
 /* these factors should be unique integers */
 #define CRYO_FACTOR    4
@@ -229,6 +230,7 @@ int Crash_delete_file(char *name)
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return FALSE;
 
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "r"))) {
     if (errno != ENOENT)  /* if it fails but NOT because of no file */
       log("SYSERR: deleting crash file %s (1): %s", filename, strerror(errno));
@@ -255,6 +257,7 @@ int Crash_delete_crashfile(struct char_data *ch)
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
     return FALSE;
 
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "r"))) {
     if (errno != ENOENT)  /* if it fails, NOT because of no file */
       log("SYSERR: checking for crash file %s (3): %s", filename, strerror(errno));
@@ -293,6 +296,7 @@ int Crash_clean_file(char *name)
     return FALSE;
 
   /* Open so that permission problems will be flagged now, at boot time. */
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "r"))) {
     if (errno != ENOENT)  /* if it fails, NOT because of no file */
       log("SYSERR: OPENING OBJECT FILE %s (4): %s", filename, strerror(errno));
@@ -412,6 +416,7 @@ void Crash_crashsave(struct char_data *ch)
 {
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct save_file *sf;
   FILE *fp;
 
   if (IS_NPC(ch))
@@ -420,28 +425,31 @@ void Crash_crashsave(struct char_data *ch)
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(sf = save_begin(buf)))
     return;
+  fp = sf->fp;
 
   Crash_write_header(ch, fp, SAVE_CRASH);
 
   for (j = 0; j < NUM_WEARS; j++)
     if (GET_EQ(ch, j)) {
       if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-        fclose(fp);
+        save_abort(sf);
         return;
       }
       Crash_restore_weight(GET_EQ(ch, j));
     }
 
   if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
+    save_abort(sf);
     return;
   }
   Crash_restore_weight(ch->carrying);
 
-  fclose(fp);
+  save_commit(sf);
   REMOVE_BIT_AR(PLR_FLAGS(ch), PLR_CRASH);
+  ch->player_specials->crash_gen = MAX(1, ch->player_specials->save_gen);
+  ch->player_specials->save_gen = ch->player_specials->crash_gen;
 }
 
 /* Shortened because we don't use storage fees in this game */
@@ -452,33 +460,37 @@ void Crash_idlesave(struct char_data *ch)
 
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct save_file *sf;
   FILE *fp;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(sf = save_begin(buf)))
     return;
+  fp = sf->fp;
 
   Crash_write_header(ch, fp, SAVE_FORCED);
 
   for (j = 0; j < NUM_WEARS; j++)
     if (GET_EQ(ch, j)) {
       if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-        fclose(fp);
+        save_abort(sf);
         return;
       }
       Crash_restore_weight(GET_EQ(ch, j));
     }
 
   if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
+    save_abort(sf);
     return;
   }
   Crash_restore_weight(ch->carrying);
 
-  fclose(fp);
+  save_commit(sf);
   REMOVE_BIT_AR(PLR_FLAGS(ch), PLR_CRASH);
+  ch->player_specials->crash_gen = MAX(1, ch->player_specials->save_gen);
+  ch->player_specials->save_gen = ch->player_specials->crash_gen;
 }
 
 /* Shortened because we don't use storage fees in this game */
@@ -489,35 +501,44 @@ void Crash_rentsave(struct char_data *ch, int cost)
 
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct save_file *sf;
   FILE *fp;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(sf = save_begin(buf)))
     return;
+  fp = sf->fp;
 
   Crash_write_header(ch, fp, SAVE_LOGOUT);
 
   for (j = 0; j < NUM_WEARS; j++)
     if (GET_EQ(ch, j)) {
       if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-        fclose(fp);
+        save_abort(sf);
         return;
       }
       Crash_restore_weight(GET_EQ(ch, j));
     }
 
   if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
+    save_abort(sf);
     return;
   }
   Crash_restore_weight(ch->carrying);
 
-  fclose(fp);
+  save_commit(sf);
   REMOVE_BIT_AR(PLR_FLAGS(ch), PLR_CRASH);
+  ch->player_specials->crash_gen = MAX(1, ch->player_specials->save_gen);
+  ch->player_specials->save_gen = ch->player_specials->crash_gen;
 }
 
+/** Files written and skipped as unchanged by Crash_save_all(), shown by
+ * 'show stats'. */
+long autosave_files_written = 0;
+long autosave_files_skipped = 0;
+
 void Crash_save_all(void)
 {
   struct descriptor_data *d;
@@ -543,9 +564,20 @@ void Crash_save_all(void)
     /* IMPORTANT: Do NOT modify GET_LOADROOM here.
        Autosave should not change the player's spawn point. */
 
-    /* Persist character and object file. */
-    save_char(d->character);
-    Crash_crashsave(d->character);
+    /* Persist character and object file, unless nothing saved in them has
+     * changed since they were last written. */
+    if (PFILE_CURRENT(d->character))
+      autosave_files_skipped++;
+    else {
+      save_char(d->character);
+      autosave_files_written++;
+    }
+    if (CRASHFILE_CURRENT(d->character))
+      autosave_files_skipped++;
+    else {
+      Crash_crashsave(d->character);
+      autosave_files_written++;
+    }
 
     if (PLR_FLAGGED(d->character, PLR_CRASH))
       REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_CRASH);
@@ -713,6 +745,7 @@ static int Crash_load_objs(struct char_data *ch) {
   for (i = 0; i < MAX_BAG_ROWS; i++)
     cont_row[i] = NULL;
 
+  save_writer_wait(filename);
   if (!(fl = fopen(filename, "r"))) {
     if (errno != ENOENT) { /* if it fails, NOT because of no file */
       snprintf(buf, MAX_STRING_LENGTH, "SYSERR: READING OBJECT FILE %s (5)", filename);
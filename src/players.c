@@ -24,6 +24,7 @@
 #include "quest.h"
 #include "toml.h"
 #include "toml_utils.h"
+#include "save_writer.h"
 
 #define LOAD_HIT	0
 #define LOAD_MANA	1
@@ -387,6 +388,7 @@ int load_char(const char *name, struct char_data *ch)
   else {
     if (!get_filename(filename, sizeof(filename), PLR_FILE, player_table[id].name))
       return (-1);
+    save_writer_wait(filename);
     if (!(fl = fopen(filename, "r"))) {
       mudlog(NRM, LVL_GOD, TRUE, "SYSERR: Couldn't open player file %s", filename);
       return (-1);
@@ -649,6 +651,7 @@ int load_char(const char *name, struct char_data *ch)
           CREATE(SCRIPT(ch), struct script_data, 1);
         add_trigger(SCRIPT(ch), t, -1);
       }
+      triggers_attached(ch, MOB_TRIGGER);
     }
 
     arr = toml_array_in(tab, "skill_gain_next");
@@ -791,9 +794,11 @@ int load_char(const char *name, struct char_data *ch)
 /* This is the TOML Player Files save routine. */
 void save_char(struct char_data * ch)
 {
+  struct save_file *sf;
   FILE *fl;
   char filename[40], buf[MAX_STRING_LENGTH];
   int i, j, id, save_index = FALSE;
+  unsigned long gen, own = 0, before;
   int save_throws[NUM_OF_SAVING_THROWS];
   long gain_times[MAX_SKILLS];
   struct affected_type *aff, tmp_aff[MAX_AFFECT];
@@ -826,15 +831,25 @@ void save_char(struct char_data * ch)
 
   if (!get_filename(filename, sizeof(filename), PLR_FILE, GET_NAME(ch)))
     return;
-  if (!(fl = fopen(filename, "w"))) {
+
+  /* Taking the affects and eq off and putting them back below looks like a
+   * change; count the bumps it makes so they can be undone afterwards. */
+  if (!ch->player_specials->save_gen)
+    ch->player_specials->save_gen = 1;
+  gen = ch->player_specials->save_gen;
+
+  if (!(sf = save_begin(filename))) {
     mudlog(NRM, LVL_GOD, TRUE, "SYSERR: Couldn't open player file %s for write", filename);
     return;
   }
+  fl = sf->fp;
 
   /* Unaffect everything a character can be affected by. */
   for (i = 0; i < NUM_WEARS; i++) {
     if (GET_EQ(ch, i)) {
+      before = ch->player_specials->save_gen;
       char_eq[i] = unequip_char(ch, i);
+      own += ch->player_specials->save_gen - before;
 #ifndef NO_EXTRANEOUS_TRIGGERS
       remove_otrigger(char_eq[i], ch);
 #endif
@@ -859,8 +874,10 @@ void save_char(struct char_data * ch)
   /* Remove the affections so that the raw values are stored; otherwise the
    * effects are doubled when the char logs back in. */
 
+  before = ch->player_specials->save_gen;
   while (ch->affected)
     affect_remove(ch, ch->affected);
+  own += ch->player_specials->save_gen - before;
 
   if ((i >= MAX_AFFECT) && aff && aff->next)
     log("SYSERR: WARNING: OUT OF STORE ROOM FOR AFFECTED TYPES!!!");
@@ -1010,7 +1027,7 @@ void save_char(struct char_data * ch)
   if (SCRIPT(ch) && ch->script->global_vars) {
     struct trig_var_data *vars;
 
-    for (vars = ch->script->global_vars; vars; vars = vars->next) {
+    for (vars = ch->script->global_vars->first; vars; vars = vars->next) {
       if (*vars->name == '-')
         continue;
       fprintf(fl, "\n[[var]]\n");
@@ -1020,27 +1037,37 @@ void save_char(struct char_data * ch)
     }
   }
 
-  fclose(fl);
+  save_commit(sf);
 
   /* More char_to_store code to add spell and eq affections back in. */
+  before = ch->player_specials->save_gen;
   for (i = 0; i < MAX_AFFECT; i++) {
     if (tmp_aff[i].spell)
       affect_to_char(ch, &tmp_aff[i]);
   }
+  own += ch->player_specials->save_gen - before;
 
   for (i = 0; i < NUM_WEARS; i++) {
-    if (char_eq[i])
+    if (!char_eq[i])
+      continue;
 #ifndef NO_EXTRANEOUS_TRIGGERS
-        if (wear_otrigger(char_eq[i], ch, i))
+    if (!wear_otrigger(char_eq[i], ch, i)) {
+      obj_to_char(char_eq[i], ch);
+      continue;
+    }
 #endif
+    before = ch->player_specials->save_gen;
     equip_char(ch, char_eq[i], i);
-#ifndef NO_EXTRANEOUS_TRIGGERS
-          else
-          obj_to_char(char_eq[i], ch);
-#endif
+    own += ch->player_specials->save_gen - before;
   }
   /* end char_to_store code */
 
+  /* The file now matches generation gen.  Take back only the bumps from
+   * stripping and restoring ch; whatever the remove and wear triggers did
+   * meanwhile, or eq a wear trigger left in the inventory, still counts. */
+  ch->player_specials->save_gen -= own;
+  ch->player_specials->pfile_gen = gen;
+
   if ((id = get_ptable_by_name(GET_NAME(ch))) < 0)
     return;
 
@@ -1104,8 +1131,10 @@ void remove_player(int pfilepos)
 
   /* Unlink all player-owned files */
   for (i = 0; i < MAX_FILES; i++) {
-    if (get_filename(filename, sizeof(filename), i, player_table[pfilepos].name))
+    if (get_filename(filename, sizeof(filename), i, player_table[pfilepos].name)) {
+      save_writer_wait(filename);
       unlink(filename);
+    }
   }
 
   strftime(timestr, sizeof(timestr), "%c", localtime(&(player_table[pfilepos].last)));
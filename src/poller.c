@@ -0,0 +1,267 @@
+/**
+* @file poller.c
+* Socket readiness polling used by the main game loop.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* It only depends on the system headers so it can be linked into the
+* network benchmark without the rest of the game.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#include "poller.h"
+
+#ifndef INVALID_SOCKET
+#define INVALID_SOCKET (-1)
+#endif
+
+/* One socket registered with the select() backend. */
+struct poll_slot {
+  socket_t fd;
+  void *data;
+};
+
+static int backend = POLLER_SELECT;
+static struct poll_slot *slots = NULL;  /* select(): registered sockets */
+static int num_slots = 0, max_slots = 0;
+static socket_t listener = INVALID_SOCKET;
+#ifdef HAVE_SYS_EPOLL_H
+static int epoll_fd = -1;
+static struct epoll_event *epoll_buf = NULL;
+static int epoll_buf_size = 0;
+#endif
+
+/** Start the poller.  Falls back to select() if the requested backend is
+ * not compiled in or cannot be created.
+ * @param want POLLER_SELECT or POLLER_EPOLL.
+ * @retval int The backend actually in use. */
+int poller_open(int want)
+{
+  poller_close();
+  backend = POLLER_SELECT;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (want == POLLER_EPOLL) {
+    /* Close-on-exec, or the descriptor would leak through copyover. */
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) >= 0)
+      backend = POLLER_EPOLL;
+  }
+#endif
+
+  return (backend);
+}
+
+void poller_close(void)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (epoll_fd >= 0)
+    close(epoll_fd);
+  epoll_fd = -1;
+  if (epoll_buf)
+    free(epoll_buf);
+  epoll_buf = NULL;
+  epoll_buf_size = 0;
+#endif
+  if (slots)
+    free(slots);
+  slots = NULL;
+  num_slots = max_slots = 0;
+  listener = INVALID_SOCKET;
+}
+
+int poller_backend(void)
+{
+  return (backend);
+}
+
+const char *poller_name(void)
+{
+  return (backend == POLLER_EPOLL ? "epoll" : "select");
+}
+
+static int slot_add(socket_t s, void *data)
+{
+#ifndef CIRCLE_WINDOWS
+  /* FD_SET() past FD_SETSIZE writes outside the fd_set. */
+  if (s >= FD_SETSIZE) {
+    errno = EMFILE;
+    return (-1);
+  }
+#endif
+
+  if (num_slots == max_slots) {
+    struct poll_slot *grown;
+    int want = max_slots ? max_slots * 2 : 64;
+
+    if (!(grown = realloc(slots, want * sizeof(struct poll_slot))))
+      return (-1);
+    slots = grown;
+    max_slots = want;
+  }
+  slots[num_slots].fd = s;
+  slots[num_slots].data = data;
+  num_slots++;
+  return (0);
+}
+
+/** Register the listening socket.  It is polled level-triggered so that a
+ * backlog of pending connections keeps being reported, one accept() per
+ * pulse as before. */
+int poller_add_listener(socket_t s)
+{
+  listener = s;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (backend == POLLER_EPOLL) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    return (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s, &ev));
+  }
+#endif
+
+  return (slot_add(s, NULL));
+}
+
+/** Register a player socket.
+ * @param s The (non-blocking) socket.
+ * @param data Handed back in poll_event.data; must not be NULL.
+ * @retval int 0 on success, -1 (with errno set) if the socket can't be
+ * polled, in which case the caller should refuse the connection. */
+int poller_add(socket_t s, void *data)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (backend == POLLER_EPOLL) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = data;
+    return (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s, &ev));
+  }
+#endif
+
+  return (slot_add(s, data));
+}
+
+void poller_remove(socket_t s)
+{
+  int i;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (backend == POLLER_EPOLL) {
+    struct epoll_event ev;  /* Pre-2.6.9 kernels want a non-NULL event. */
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s, &ev);
+    return;
+  }
+#endif
+
+  for (i = 0; i < num_slots; i++)
+    if (slots[i].fd == s) {
+      slots[i] = slots[--num_slots];
+      return;
+    }
+}
+
+static int select_wait(struct poll_event *events, int max_events, struct timeval *timeout)
+{
+  fd_set input_set, output_set, exc_set;
+  socket_t maxdesc = 0;
+  int i, n = 0, ready;
+
+  FD_ZERO(&input_set);
+  FD_ZERO(&output_set);
+  FD_ZERO(&exc_set);
+
+  for (i = 0; i < num_slots; i++) {
+    if (slots[i].fd > maxdesc)
+      maxdesc = slots[i].fd;
+    FD_SET(slots[i].fd, &input_set);
+    if (slots[i].fd == listener)
+      continue;
+    FD_SET(slots[i].fd, &output_set);
+    FD_SET(slots[i].fd, &exc_set);
+  }
+
+  if (select(maxdesc + 1, &input_set, &output_set, &exc_set, timeout) < 0)
+    return (-1);
+
+  for (i = 0; i < num_slots && n < max_events; i++) {
+    ready = 0;
+    if (FD_ISSET(slots[i].fd, &input_set))
+      ready |= POLL_READ;
+    if (FD_ISSET(slots[i].fd, &output_set))
+      ready |= POLL_WRITE;
+    if (FD_ISSET(slots[i].fd, &exc_set))
+      ready |= POLL_EXCEPT;
+    if (ready) {
+      events[n].data = slots[i].data;
+      events[n].ready = ready;
+      n++;
+    }
+  }
+  return (n);
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+static int epoll_wait_events(struct poll_event *events, int max_events, struct timeval *timeout)
+{
+  int i, n, ms = -1;
+
+  if (max_events > epoll_buf_size) {
+    struct epoll_event *grown;
+
+    if (!(grown = realloc(epoll_buf, max_events * sizeof(struct epoll_event))))
+      return (-1);
+    epoll_buf = grown;
+    epoll_buf_size = max_events;
+  }
+
+  if (timeout)
+    ms = timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000;
+
+  if ((n = epoll_wait(epoll_fd, epoll_buf, max_events, ms)) < 0)
+    return (-1);
+
+  for (i = 0; i < n; i++) {
+    events[i].data = epoll_buf[i].data.ptr;
+    events[i].ready = 0;
+    /* A hangup is reported as input so the read sees the EOF and closes. */
+    if (epoll_buf[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+      events[i].ready |= POLL_READ;
+    if (epoll_buf[i].events & EPOLLOUT)
+      events[i].ready |= POLL_WRITE;
+    if (epoll_buf[i].events & EPOLLERR)
+      events[i].ready |= POLL_EXCEPT;
+  }
+  return (n);
+}
+#endif
+
+/** Wait for socket readiness.
+ * @param events Filled with up to max_events ready sockets.
+ * @param max_events Size of the events array.
+ * @param timeout How long to block; NULL blocks until something is ready,
+ * a zeroed timeval only polls.
+ * @retval int Number of events stored, or -1 with errno set. Sockets that
+ * did not fit are reported on the next call. */
+int poller_wait(struct poll_event *events, int max_events, struct timeval *timeout)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (backend == POLLER_EPOLL)
+    return (epoll_wait_events(events, max_events, timeout));
+#endif
+
+  return (select_wait(events, max_events, timeout));
+}
@@ -0,0 +1,47 @@
+/**
+* @file poller.h
+* Socket readiness polling used by the main game loop.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* It hides the difference between select() and Linux epoll() so that
+* game_loop() only sees a list of sockets that actually have something to
+* do.  The epoll backend is edge-triggered: a readiness bit is reported
+* once, and the caller must keep it until the socket returns EAGAIN.
+*/
+#ifndef _POLLER_H_
+#define _POLLER_H_
+
+/* Readiness bits reported in poll_event.ready */
+#define POLL_READ     (1 << 0)  /**< Input (or EOF) is waiting. */
+#define POLL_WRITE    (1 << 1)  /**< Socket buffer has room for output. */
+#define POLL_EXCEPT   (1 << 2)  /**< Exceptional condition; drop the socket. */
+
+/* Available backends */
+#define POLLER_SELECT 0  /**< Portable select(); capped at FD_SETSIZE. */
+#define POLLER_EPOLL  1  /**< Linux epoll(7), edge-triggered. */
+
+#ifdef HAVE_SYS_EPOLL_H
+#define POLLER_DEFAULT POLLER_EPOLL
+#else
+#define POLLER_DEFAULT POLLER_SELECT
+#endif
+
+/** One ready socket, as returned by poller_wait(). */
+struct poll_event {
+  void *data;  /**< Pointer given to poller_add(); NULL for the listener. */
+  int ready;   /**< POLL_xxx bits. */
+};
+
+int  poller_open(int backend);
+void poller_close(void);
+int  poller_backend(void);
+const char *poller_name(void);
+int  poller_add_listener(socket_t s);
+int  poller_add(socket_t s, void *data);
+void poller_remove(socket_t s);
+int  poller_wait(struct poll_event *events, int max_events, struct timeval *timeout);
+
+#endif /* _POLLER_H_ */
@@ -71,6 +71,7 @@ static void prefedit_save_to_char(struct descriptor_data *d)
       PRF_FLAGS(vict)[i]  = OLC_PREFS(d)->pref_flags[i];
 
     GET_WIMP_LEV(vict)     = OLC_PREFS(d)->wimp_level;
+    msdp_changed(vict, MSDP_DIRTY_WIMPY);
     GET_PAGE_LENGTH(vict)  = OLC_PREFS(d)->page_length;
     GET_SCREEN_WIDTH(vict) = OLC_PREFS(d)->screen_width;
 
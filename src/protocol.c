@@ -35,6 +35,7 @@
 #include "dg_scripts.h"
 #include "act.h"
 #include "modify.h"
+#include "input_scan.h"
 
 /* Globals */
 const char * RGBone = "F022";
@@ -45,7 +46,7 @@ static void Write( descriptor_t *apDescriptor, const char *apData )
 {
    if ( apDescriptor != NULL)
    {
-      if ( apDescriptor->pProtocol->WriteOOB > 0 || *(apDescriptor->output) == '\0' )
+      if ( apDescriptor->pProtocol->WriteOOB > 0 || apDescriptor->output == NULL )
       {
          apDescriptor->pProtocol->WriteOOB = 2;
       }
@@ -66,24 +67,12 @@ static void InfoMessage( descriptor_t *apDescriptor, const char *apData )
 
 static void CompressStart( descriptor_t *apDescriptor )
 {
-   /* If your mud uses MCCP (Mud Client Compression Protocol), you need to 
-    * call whatever function normally starts compression from here - the 
-    * ReportBug() call should then be deleted.
-    * 
-    * Otherwise you can just ignore this function.
-    */
-   ReportBug( "CompressStart() in protocol.c is being called, but it doesn't do anything!\n" );
+   start_compression( apDescriptor );
 }
 
 static void CompressEnd( descriptor_t *apDescriptor )
 {
-   /* If your mud uses MCCP (Mud Client Compression Protocol), you need to 
-    * call whatever function normally starts compression from here - the 
-    * ReportBug() call should then be deleted.
-    * 
-    * Otherwise you can just ignore this function.
-    */
-   ReportBug( "CompressEnd() in protocol.c is being called, but it doesn't do anything!\n" );
+   end_compression( apDescriptor );
 }
 
 /******************************************************************************
@@ -205,6 +194,14 @@ static variable_name_t VariableNameTable[eMSDP_MAX+1] =
 static int    s_Players = 0;
 static time_t s_Uptime  = 0;
 
+/******************************************************************************
+ MSDP dirty bits.
+ ******************************************************************************/
+
+#define MSDP_IS_DIRTY(p, v)    ((p)->DirtyMSDP[(v) / 32] & (1u << ((v) % 32)))
+#define MSDP_SET_DIRTY(p, v)   ((p)->DirtyMSDP[(v) / 32] |= (1u << ((v) % 32)))
+#define MSDP_CLEAR_DIRTY(p, v) ((p)->DirtyMSDP[(v) / 32] &= ~(1u << ((v) % 32)))
+
 /******************************************************************************
  Local function prototypes.
  ******************************************************************************/
@@ -310,12 +307,12 @@ protocol_t *ProtocolCreate( void )
    pProtocol->pMXPVersion = AllocString("Unknown");
    pProtocol->pLastTTYPE = NULL;
    pProtocol->pVariables = (MSDP_t **) malloc(sizeof(MSDP_t*)*eMSDP_MAX);
+   memset(pProtocol->DirtyMSDP, 0, sizeof(pProtocol->DirtyMSDP));
 
    for ( i = eMSDP_NONE+1; i < eMSDP_MAX; ++i )
    {
       pProtocol->pVariables[i] = (MSDP_t *) malloc(sizeof(MSDP_t));
       pProtocol->pVariables[i]->bReport = false;
-      pProtocol->pVariables[i]->bDirty = false;
       pProtocol->pVariables[i]->ValueInt = 0;
       pProtocol->pVariables[i]->pValueString = NULL;
 
@@ -362,6 +359,7 @@ ssize_t ProtocolInput( descriptor_t *apDescriptor, char *apData, int aSize, char
    ssize_t CmdIndex = 0;
    ssize_t IacIndex = 0;
    ssize_t Index;
+   ssize_t Run;
 
    protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
 
@@ -374,6 +372,18 @@ ssize_t ProtocolInput( descriptor_t *apDescriptor, char *apData, int aSize, char
          return (-1);
       }
 
+      /* Plain text, which is nearly all of it, is copied a run at a time. */
+      if ( !pProtocol->bIACMode && 
+         ( Run = scan_telnet_plain( &apData[Index], aSize - Index ) ) > 0 )
+      {
+         if ( Run > MAX_PROTOCOL_BUFFER - CmdIndex )
+            Run = MAX_PROTOCOL_BUFFER - CmdIndex;
+         memcpy( &CmdBuf[CmdIndex], &apData[Index], Run );
+         CmdIndex += Run;
+         Index += Run - 1;
+         continue;
+      }
+
       /* IAC IAC is treated as a single value of 255 */
       if ( apData[Index] == (char)IAC && apData[Index+1] == (char)IAC )
       {
@@ -508,7 +518,7 @@ ssize_t ProtocolInput( descriptor_t *apDescriptor, char *apData, int aSize, char
                   break;
             }
          }
-         else
+         else if ( apData[Index] != '\0' ) /* NUL is a telnet no-op. */
             CmdBuf[CmdIndex++] = apData[Index];
       }
    }
@@ -518,7 +528,7 @@ ssize_t ProtocolInput( descriptor_t *apDescriptor, char *apData, int aSize, char
    CmdBuf[CmdIndex] = '\0';
 
    /* Copy the input buffer back to the player. */
-   strcat( apOut, CmdBuf );
+   memcpy( apOut, CmdBuf, CmdIndex + 1 );
    return (CmdIndex);
 }
 
@@ -1020,19 +1030,23 @@ void CopyoverSet( descriptor_t *apDescriptor, const char *apData )
 
 void MSDPUpdate( descriptor_t *apDescriptor )
 {
-   int i; /* Loop counter */
+   int i, Bit;            /* Loop counters */
+   unsigned int Pending;  /* The dirty bits of one word */
 
    protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
 
-   for ( i = eMSDP_NONE+1; i < eMSDP_MAX; ++i )
+   for ( i = 0; i < MSDP_DIRTY_WORDS; ++i )
    {
-      if ( pProtocol->pVariables[i]->bReport )
+      /* A dirty variable nobody is reporting is just cleared, as REPORT 
+       * marks it dirty again.
+       */
+      Pending = pProtocol->DirtyMSDP[i];
+      pProtocol->DirtyMSDP[i] = 0;
+
+      for ( Bit = 0; Pending != 0; ++Bit, Pending >>= 1 )
       {
-         if ( pProtocol->pVariables[i]->bDirty )
-         {
-            MSDPSend( apDescriptor, (variable_t)i );
-            pProtocol->pVariables[i]->bDirty = false;
-         }
+         if ( (Pending & 1) && pProtocol->pVariables[i * 32 + Bit]->bReport )
+            MSDPSend( apDescriptor, (variable_t)(i * 32 + Bit) );
       }
    }
 }
@@ -1045,10 +1059,10 @@ void MSDPFlush( descriptor_t *apDescriptor, variable_t aMSDP )
 
       if ( pProtocol->pVariables[aMSDP]->bReport )
       {
-         if ( pProtocol->pVariables[aMSDP]->bDirty )
+         if ( MSDP_IS_DIRTY(pProtocol, aMSDP) )
          {
             MSDPSend( apDescriptor, aMSDP );
-            pProtocol->pVariables[aMSDP]->bDirty = false;
+            MSDP_CLEAR_DIRTY(pProtocol, aMSDP);
          }
       }
    }
@@ -1229,7 +1243,7 @@ void MSDPSetNumber( descriptor_t *apDescriptor, variable_t aMSDP, int aValue )
          if ( pProtocol->pVariables[aMSDP]->ValueInt != aValue )
          {
             pProtocol->pVariables[aMSDP]->ValueInt = aValue;
-            pProtocol->pVariables[aMSDP]->bDirty = true;
+            MSDP_SET_DIRTY(pProtocol, aMSDP);
          }
       }
    }
@@ -1247,7 +1261,7 @@ void MSDPSetString( descriptor_t *apDescriptor, variable_t aMSDP, const char *ap
          {
             free(pProtocol->pVariables[aMSDP]->pValueString);
             pProtocol->pVariables[aMSDP]->pValueString = AllocString(apValue);
-            pProtocol->pVariables[aMSDP]->bDirty = true;
+            MSDP_SET_DIRTY(pProtocol, aMSDP);
          }
       }
    }
@@ -1279,7 +1293,7 @@ void MSDPSetTable( descriptor_t *apDescriptor, variable_t aMSDP, const char *apV
          {
             free(pProtocol->pVariables[aMSDP]->pValueString);
             pProtocol->pVariables[aMSDP]->pValueString = pTable;
-            pProtocol->pVariables[aMSDP]->bDirty = true;
+            MSDP_SET_DIRTY(pProtocol, aMSDP);
          }
          else /* Just discard the table, we've already got one */
          {
@@ -1315,7 +1329,7 @@ void MSDPSetArray( descriptor_t *apDescriptor, variable_t aMSDP, const char *apV
          {
             free(pProtocol->pVariables[aMSDP]->pValueString);
             pProtocol->pVariables[aMSDP]->pValueString = pArray;
-            pProtocol->pVariables[aMSDP]->bDirty = true;
+            MSDP_SET_DIRTY(pProtocol, aMSDP);
          }
          else /* Just discard the array, we've already got one */
          {
@@ -1947,7 +1961,7 @@ static void ExecuteMSDPPair( descriptor_t *apDescriptor, const char *apVariable,
             if ( MatchString(apValue, VariableNameTable[i].pName) )
             {
                apDescriptor->pProtocol->pVariables[i]->bReport = true;
-               apDescriptor->pProtocol->pVariables[i]->bDirty = true;
+               MSDP_SET_DIRTY(apDescriptor->pProtocol, i);
                bDone = true;
             }
          }
@@ -1963,7 +1977,7 @@ static void ExecuteMSDPPair( descriptor_t *apDescriptor, const char *apVariable,
                if ( apDescriptor->pProtocol->pVariables[i]->bReport )
                {
                   apDescriptor->pProtocol->pVariables[i]->bReport = false;
-                  apDescriptor->pProtocol->pVariables[i]->bDirty = false;
+                  MSDP_CLEAR_DIRTY(apDescriptor->pProtocol, i);
                }
             }
          }
@@ -1977,7 +1991,7 @@ static void ExecuteMSDPPair( descriptor_t *apDescriptor, const char *apVariable,
             if ( MatchString(apValue, VariableNameTable[i].pName) )
             {
                apDescriptor->pProtocol->pVariables[i]->bReport = false;
-               apDescriptor->pProtocol->pVariables[i]->bDirty = false;
+               MSDP_CLEAR_DIRTY(apDescriptor->pProtocol, i);
                bDone = true;
             }
          }
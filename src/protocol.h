@@ -14,12 +14,13 @@
 typedef struct descriptor_data descriptor_t;
 
 /******************************************************************************
- If your mud supports MCCP (compression), uncomment the next line.
+ If your mud supports MCCP (compression), define USING_MCCP.  We do, using
+ zlib (see mccp.c), whenever zlib is available.
  ******************************************************************************/
 
-/*
+#ifdef HAVE_ZLIB_H
 #define USING_MCCP
-*/
+#endif
 
 /******************************************************************************
  If your offer a Mudlet GUI for autoinstallation, put the path/filename here.
@@ -162,6 +163,9 @@ typedef enum
    eMSDP_MAX                   /* This must always be last */
 } variable_t;
 
+/* One bit per MSDP variable, set when it needs to be sent again. */
+#define MSDP_DIRTY_WORDS               ((eMSDP_MAX + 31) / 32)
+
 typedef struct
 {
    variable_t   Variable;      /* The enum type of this variable */
@@ -179,7 +183,6 @@ typedef struct
 typedef struct
 {
    bool_t       bReport;       /* Is this variable being reported? */
-   bool_t       bDirty;        /* Does this variable need to be sent again? */
    int          ValueInt;      /* The numeric value of the variable */
    char        *pValueString;  /* The string value of the variable */
 } MSDP_t;
@@ -211,6 +214,7 @@ typedef struct
    char     *pMXPVersion;      /* The version of MXP supported */
    char     *pLastTTYPE;       /* Used for the cyclic TTYPE check */
    MSDP_t  **pVariables;       /* The MSDP variables */
+   unsigned int DirtyMSDP[MSDP_DIRTY_WORDS]; /* Variables to send again */
 } protocol_t;
 
 /******************************************************************************
@@ -246,6 +250,8 @@ void ProtocolNegotiate( descriptor_t *apDescriptor );
  * Extracts any negotiation sequences from the input buffer, and passes back 
  * whatever is left for the mud to parse normally.  Call this after data has 
  * been read into the input buffer, before it is used for anything else.
+ * What is left is written, terminated, to apOut (the end of the text 
+ * already waiting), and its length returned.  NUL bytes are dropped.
  */
  
 /* MUD Primary Colours */
@@ -353,6 +359,8 @@ void CopyoverSet( descriptor_t *apDescriptor, const char *apData );
  * Call this regularly (I'd suggest at least once per second) to flush every 
  * dirty MSDP variable that has been requested by the client via REPORT.  This 
  * will automatically use ATCP instead if MSDP is not supported by the client.
+ * Only the variables marked dirty since the last call are looked at, so it 
+ * costs next to nothing when nothing has changed.
  */
 void MSDPUpdate( descriptor_t *apDescriptor );
 
@@ -20,6 +20,7 @@
 #include "screen.h"
 #include "quest.h"
 #include "act.h" /* for do_tell */
+#include "vnum_index.h"
 
 
 /*--------------------------------------------------------------------------
@@ -62,6 +63,10 @@ static const char *quest_imm_usage =
 qst_rnum real_quest(qst_vnum vnum)
 {
   int rnum;
+  qst_rnum found;
+
+  if (vnum_index_lookup(&quest_vnums, vnum, &found))
+    return (found);
 
   for (rnum = 0; rnum < total_quests; rnum++)
     if (QST_NUM(rnum) == vnum)
@@ -240,6 +245,7 @@ void set_quest(struct char_data *ch, qst_rnum rnum)
   GET_QUEST_TIME(ch) = QST_TIME(rnum);
   GET_QUEST_COUNTER(ch) = QST_QUANTITY(rnum);
   SET_BIT_AR(PRF_FLAGS(ch), PRF_QUEST);
+  MARK_CHAR_CHANGED(ch);
   return;
 }
 
@@ -249,6 +255,7 @@ void clear_quest(struct char_data *ch)
   GET_QUEST_TIME(ch) = -1;
   GET_QUEST_COUNTER(ch) = 0;
   REMOVE_BIT_AR(PRF_FLAGS(ch), PRF_QUEST);
+  MARK_CHAR_CHANGED(ch);
   return;
 }
 
@@ -292,6 +299,7 @@ void generic_complete_quest(struct char_data *ch)
   qst_vnum vnum = GET_QUEST(ch);
   struct obj_data *new_obj;
 
+  MARK_CHAR_CHANGED(ch);
   if (--GET_QUEST_COUNTER(ch) <= 0) {
     rnum = real_quest(vnum);
     GET_QUESTPOINTS(ch) += QST_POINTS(rnum);
@@ -409,9 +417,11 @@ void check_timed_quests(void)
   struct char_data *ch;
 
   for (ch = character_list; ch; ch = ch->next)
-    if (!IS_NPC(ch) && (GET_QUEST(ch) != NOTHING) && (GET_QUEST_TIME(ch) != -1))
+    if (!IS_NPC(ch) && (GET_QUEST(ch) != NOTHING) && (GET_QUEST_TIME(ch) != -1)) {
+      MARK_CHAR_CHANGED(ch);
       if (--GET_QUEST_TIME(ch) == 0)
         quest_timeout(ch);
+    }
 }
 
 /*--------------------------------------------------------------------------*/
@@ -0,0 +1,399 @@
+/**
+* @file resolver.c
+* Background reverse lookups of connecting sites, with a cache.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "resolver.h"
+
+#define RESOLVER_BUCKETS 257
+
+/** A cached answer.  The cache belongs to the game thread. */
+struct resolve_entry {
+  struct in_addr addr;
+  char name[HOST_LENGTH + 1];
+  bool found;                       /**< FALSE if the address has no name. */
+  time_t expires;
+  struct resolve_entry *hnext;      /**< Next in the hash bucket. */
+  struct resolve_entry *prev, *next; /**< Most recently used first. */
+};
+
+/** A lookup, from resolver_request() until resolver_poll() passes it back. */
+struct resolve_job {
+  struct in_addr addr;
+  long *keys;                       /**< Requests waiting on this lookup. */
+  int num_keys, max_keys;
+  char name[HOST_LENGTH + 1];       /**< Filled in by the lookup. */
+  bool found;
+  long msec;                        /**< How long the lookup took. */
+  struct resolve_job *next;         /**< In the queue or the done list. */
+  struct resolve_job *next_pending; /**< Game thread only. */
+};
+
+static struct resolve_entry *cache_hash[RESOLVER_BUCKETS];
+static struct resolve_entry *lru_head = NULL, *lru_tail = NULL;
+static int cache_ttl = RESOLVER_TTL;
+
+/* Game thread only: every job not yet passed back, and the counters. */
+static struct resolve_job *pending = NULL;
+static struct resolver_stats stats;
+
+static bool default_lookup(struct in_addr addr, char *name, size_t len);
+static resolver_lookup_fn lookup_fn = default_lookup;
+
+/** The lookup used unless resolver_set_lookup() says otherwise.
+ * getnameinfo() may be used on any thread, unlike gethostbyaddr(). */
+static bool default_lookup(struct in_addr addr, char *name, size_t len)
+{
+  struct sockaddr_in sa;
+  char host[NI_MAXHOST];
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr = addr;
+  if (getnameinfo((struct sockaddr *) &sa, sizeof(sa), host, sizeof(host),
+                  NULL, 0, NI_NAMEREQD) != 0)
+    return (FALSE);
+  snprintf(name, len, "%s", host);
+  return (TRUE);
+}
+
+/** Do the lookup for job.  Safe to call on any thread. */
+static void run_lookup(struct resolve_job *job)
+{
+  struct timeval start, end;
+
+  gettimeofday(&start, NULL);
+  job->found = lookup_fn(job->addr, job->name, sizeof(job->name));
+  if (!job->found)
+    *job->name = '\0';
+  gettimeofday(&end, NULL);
+  job->msec = (end.tv_sec - start.tv_sec) * 1000 +
+              (end.tv_usec - start.tv_usec) / 1000;
+}
+
+static void free_job(struct resolve_job *job)
+{
+  free(job->keys);
+  free(job);
+}
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t resolver_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t resolver_work = PTHREAD_COND_INITIALIZER;
+static pthread_t resolver_tids[RESOLVER_THREADS];
+static int resolver_threads = 0;
+static bool resolver_stop = FALSE;
+
+/* Protected by resolver_lock. */
+static struct resolve_job *queue_head = NULL, *queue_tail = NULL;
+static struct resolve_job *done_head = NULL, *done_tail = NULL;
+
+static void *resolver_main(void *arg)
+{
+  struct resolve_job *job;
+
+  pthread_mutex_lock(&resolver_lock);
+  for (;;) {
+    while (!queue_head && !resolver_stop)
+      pthread_cond_wait(&resolver_work, &resolver_lock);
+    if (resolver_stop)
+      break;
+
+    job = queue_head;
+    if (!(queue_head = job->next))
+      queue_tail = NULL;
+    pthread_mutex_unlock(&resolver_lock);
+
+    run_lookup(job);
+
+    pthread_mutex_lock(&resolver_lock);
+    job->next = NULL;
+    if (done_tail)
+      done_tail->next = job;
+    else
+      done_head = job;
+    done_tail = job;
+  }
+  pthread_mutex_unlock(&resolver_lock);
+  return (NULL);
+}
+#endif
+
+/* Without the threads, finished jobs wait here for resolver_poll(). */
+static struct resolve_job *sync_head = NULL, *sync_tail = NULL;
+
+static int hash_addr(struct in_addr addr)
+{
+  return ((int)(ntohl(addr.s_addr) % RESOLVER_BUCKETS));
+}
+
+static void lru_unlink(struct resolve_entry *e)
+{
+  if (e->prev)
+    e->prev->next = e->next;
+  else
+    lru_head = e->next;
+  if (e->next)
+    e->next->prev = e->prev;
+  else
+    lru_tail = e->prev;
+  e->prev = e->next = NULL;
+}
+
+static void lru_push(struct resolve_entry *e)
+{
+  e->prev = NULL;
+  e->next = lru_head;
+  if (lru_head)
+    lru_head->prev = e;
+  else
+    lru_tail = e;
+  lru_head = e;
+}
+
+static void cache_remove(struct resolve_entry *e)
+{
+  struct resolve_entry **pp;
+
+  for (pp = &cache_hash[hash_addr(e->addr)]; *pp; pp = &(*pp)->hnext)
+    if (*pp == e) {
+      *pp = e->hnext;
+      break;
+    }
+  lru_unlink(e);
+  free(e);
+  stats.cached--;
+}
+
+/** Find addr in the cache, dropping it instead if it has expired. */
+static struct resolve_entry *cache_find(struct in_addr addr)
+{
+  struct resolve_entry *e;
+
+  for (e = cache_hash[hash_addr(addr)]; e; e = e->hnext)
+    if (e->addr.s_addr == addr.s_addr)
+      break;
+  if (e && e->expires <= time(0)) {
+    cache_remove(e);
+    e = NULL;
+  }
+  return (e);
+}
+
+static void cache_store(struct resolve_job *job)
+{
+  struct resolve_entry *e;
+
+  if ((e = cache_find(job->addr)) != NULL)
+    lru_unlink(e);
+  else {
+    if (stats.cached >= RESOLVER_CACHE_SIZE)
+      cache_remove(lru_tail);
+    CREATE(e, struct resolve_entry, 1);
+    e->addr = job->addr;
+    e->hnext = cache_hash[hash_addr(e->addr)];
+    cache_hash[hash_addr(e->addr)] = e;
+    stats.cached++;
+  }
+  e->found = job->found;
+  strcpy(e->name, job->name);	/* strcpy: OK (same size) */
+  e->expires = time(0) + cache_ttl;
+  if (!job->found && cache_ttl > RESOLVER_NEGATIVE_TTL)
+    e->expires = time(0) + RESOLVER_NEGATIVE_TTL;
+  lru_push(e);
+}
+
+/** Start the lookup threads.
+ * @param threads How many, at most RESOLVER_THREADS.
+ * @param ttl Seconds a name stays in the cache.
+ * @retval bool FALSE if no thread could be started, in which case
+ * resolver_request() looks names up itself. */
+bool resolver_init(int threads, int ttl)
+{
+  cache_ttl = ttl > 0 ? ttl : 1;
+#ifdef HAVE_PTHREAD_H
+  if (resolver_threads)
+    return (TRUE);
+  resolver_stop = FALSE;
+  if (threads < 1)
+    threads = 1;
+  else if (threads > RESOLVER_THREADS)
+    threads = RESOLVER_THREADS;
+  while (resolver_threads < threads &&
+         pthread_create(&resolver_tids[resolver_threads], NULL, resolver_main, NULL) == 0)
+    resolver_threads++;
+  return (resolver_threads > 0);
+#else
+  return (FALSE);
+#endif
+}
+
+/** Stop the lookup threads, once each has finished the lookup it is on, and
+ * forget every lookup and cached name. */
+void resolver_shutdown(void)
+{
+  struct resolve_job *job;
+  struct resolve_entry *e;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&resolver_lock);
+  resolver_stop = TRUE;
+  pthread_cond_broadcast(&resolver_work);
+  pthread_mutex_unlock(&resolver_lock);
+  while (resolver_threads > 0)
+    pthread_join(resolver_tids[--resolver_threads], NULL);
+  queue_head = queue_tail = done_head = done_tail = NULL;
+#endif
+  sync_head = sync_tail = NULL;
+
+  while ((job = pending) != NULL) {
+    pending = job->next_pending;
+    free_job(job);
+  }
+  while ((e = lru_head) != NULL)
+    cache_remove(e);
+  memset(&stats, 0, sizeof(stats));
+}
+
+/** Use fn for lookups from now on; NULL goes back to the name servers.
+ * Call it before resolver_init(). */
+void resolver_set_lookup(resolver_lookup_fn fn)
+{
+  lookup_fn = fn ? fn : default_lookup;
+}
+
+/** See if the cache already knows addr.
+ * @param name Where the name goes if it does.
+ * @retval int RESOLVE_FOUND, RESOLVE_NO_NAME or RESOLVE_MISS. */
+int resolver_cached(struct in_addr addr, char *name, size_t len)
+{
+  struct resolve_entry *e;
+
+  if (!(e = cache_find(addr)))
+    return (RESOLVE_MISS);
+
+  stats.hits++;
+  lru_unlink(e);
+  lru_push(e);
+  if (!e->found)
+    return (RESOLVE_NO_NAME);
+  snprintf(name, len, "%s", e->name);
+  return (RESOLVE_FOUND);
+}
+
+/** Look addr up in the background.  resolver_poll() passes the answer back
+ * with key, which the caller should check is still wanted. */
+void resolver_request(struct in_addr addr, long key)
+{
+  struct resolve_job *job;
+
+  for (job = pending; job; job = job->next_pending)
+    if (job->addr.s_addr == addr.s_addr)
+      break;
+
+  if (job)
+    stats.shared++;
+  else {
+    CREATE(job, struct resolve_job, 1);
+    job->addr = addr;
+    job->next_pending = pending;
+    pending = job;
+    stats.pending++;
+  }
+
+  if (job->num_keys == job->max_keys) {
+    job->max_keys = job->max_keys ? job->max_keys * 2 : 2;
+    RECREATE(job->keys, long, job->max_keys);
+  }
+  job->keys[job->num_keys++] = key;
+
+  if (job->num_keys > 1)
+    return;
+
+#ifdef HAVE_PTHREAD_H
+  if (resolver_threads) {
+    pthread_mutex_lock(&resolver_lock);
+    if (queue_tail)
+      queue_tail->next = job;
+    else
+      queue_head = job;
+    queue_tail = job;
+    pthread_cond_signal(&resolver_work);
+    pthread_mutex_unlock(&resolver_lock);
+    return;
+  }
+#endif
+
+  run_lookup(job);
+  if (sync_tail)
+    sync_tail->next = job;
+  else
+    sync_head = job;
+  sync_tail = job;
+}
+
+/** Pass back every finished lookup, caching each answer first.  Called from
+ * the game loop every pulse.
+ * @retval int How many lookups were passed back. */
+int resolver_poll(resolver_done_fn done)
+{
+  struct resolve_job *list, *job, **pp;
+  int i, count = 0;
+
+  if (!pending)
+    return (0);
+
+  list = sync_head;
+  sync_head = sync_tail = NULL;
+#ifdef HAVE_PTHREAD_H
+  if (!list && resolver_threads) {
+    pthread_mutex_lock(&resolver_lock);
+    list = done_head;
+    done_head = done_tail = NULL;
+    pthread_mutex_unlock(&resolver_lock);
+  }
+#endif
+
+  while ((job = list) != NULL) {
+    list = job->next;
+
+    for (pp = &pending; *pp; pp = &(*pp)->next_pending)
+      if (*pp == job) {
+        *pp = job->next_pending;
+        break;
+      }
+    stats.pending--;
+    stats.lookups++;
+    if (!job->found)
+      stats.failures++;
+    if (job->msec > stats.worst_ms)
+      stats.worst_ms = job->msec;
+
+    cache_store(job);
+    for (i = 0; i < job->num_keys; i++)
+      done(job->keys[i], job->addr, job->found ? job->name : NULL);
+    free_job(job);
+    count++;
+  }
+  return (count);
+}
+
+/** Copy out the counters for show stats. */
+void resolver_get_stats(struct resolver_stats *st)
+{
+  *st = stats;
+}
@@ -0,0 +1,62 @@
+/**
+* @file resolver.h
+* Background reverse lookups of connecting sites, with a cache.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* A reverse lookup can take many seconds when a site's name server is slow,
+* and the whole game used to wait on it.  Now a new connection starts out
+* known by its numeric address.  resolver_cached() answers from the cache if
+* it can; otherwise resolver_request() hands the address to a pool of
+* lookup threads, and resolver_poll() later passes each answer back on the
+* game thread, along with the key it was requested under.
+*
+* Answers, failed lookups included, are kept for a while in a cache of
+* RESOLVER_CACHE_SIZE addresses that drops the least recently used one when
+* full.  Several requests for an address already being looked up share the
+* one lookup.  Without pthreads the lookup is done by resolver_request()
+* itself, and answered by the next resolver_poll().
+*/
+#ifndef _RESOLVER_H_
+#define _RESOLVER_H_
+
+#define RESOLVER_THREADS     4            /**< Lookups that can be in flight. */
+#define RESOLVER_CACHE_SIZE  512          /**< Addresses kept in the cache. */
+#define RESOLVER_TTL         (60 * 60)    /**< Seconds a name is trusted. */
+#define RESOLVER_NEGATIVE_TTL (5 * 60)    /**< Most seconds a failure is. */
+
+/** resolver_cached() results. */
+#define RESOLVE_MISS     0   /**< Not cached; resolver_request() it. */
+#define RESOLVE_FOUND    1   /**< Cached name copied out. */
+#define RESOLVE_NO_NAME  2   /**< Cached as having no name. */
+
+/** Looks up the name of addr into name.  Must be safe to call on several
+ * threads at once.  @retval bool FALSE if addr has no name. */
+typedef bool (*resolver_lookup_fn)(struct in_addr addr, char *name, size_t len);
+
+/** Called by resolver_poll() for each finished request.  name is NULL if
+ * the address has no name. */
+typedef void (*resolver_done_fn)(long key, struct in_addr addr, const char *name);
+
+/** Counters for show stats. */
+struct resolver_stats {
+  long hits;       /**< resolver_cached() answers. */
+  long lookups;    /**< Lookups done. */
+  long failures;   /**< Of those, how many found no name. */
+  long shared;     /**< Requests that joined a lookup in flight. */
+  long worst_ms;   /**< Slowest lookup. */
+  int pending;     /**< Lookups not yet passed back. */
+  int cached;      /**< Addresses in the cache. */
+};
+
+bool resolver_init(int threads, int ttl);
+void resolver_shutdown(void);
+void resolver_set_lookup(resolver_lookup_fn fn);
+int resolver_cached(struct in_addr addr, char *name, size_t len);
+void resolver_request(struct in_addr addr, long key);
+int resolver_poll(resolver_done_fn done);
+void resolver_get_stats(struct resolver_stats *st);
+
+#endif /* _RESOLVER_H_ */
@@ -0,0 +1,358 @@
+/**
+* @file save_writer.c
+* Background writer for player, object and house save files.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "save_writer.h"
+
+/** Close a finished "<path>.tmp", make sure it is on disk and move it over
+ * path.  Safe to call on any thread.
+ * @retval int 0, or the errno of whatever failed. */
+static int close_and_rename(FILE *fp, const char *tmp, const char *path)
+{
+  int err = 0;
+
+  if (fflush(fp) != 0)
+    err = errno ? errno : EIO;
+#ifndef CIRCLE_WINDOWS
+  else if (fsync(fileno(fp)) != 0)
+    err = errno ? errno : EIO;
+#endif
+  if (fclose(fp) != 0 && !err)
+    err = errno ? errno : EIO;
+  if (!err && rename(tmp, path) != 0)
+    err = errno ? errno : EIO;
+  if (err)
+    remove(tmp);
+  return (err);
+}
+
+/** Write a whole buffer out to path.  Safe to call on any thread.
+ * @retval int 0, or the errno of whatever failed. */
+static int write_out(const char *path, const char *data, size_t len)
+{
+  char tmp[PATH_MAX];
+  FILE *fp;
+
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  if (!(fp = fopen(tmp, "w")))
+    return (errno ? errno : EIO);
+  if (len && fwrite(data, 1, len, fp) != len) {
+    int err = errno ? errno : EIO;
+
+    fclose(fp);
+    remove(tmp);
+    return (err);
+  }
+  return (close_and_rename(fp, tmp, path));
+}
+
+static void report_failure(const char *path, int err)
+{
+  mudlog(BRF, LVL_GOD, TRUE, "SYSERR: Couldn't write save file %s: %s", path, strerror(err));
+}
+
+static void free_save_file(struct save_file *sf)
+{
+  if (sf->data)
+    free(sf->data);
+  free(sf->path);
+  free(sf);
+}
+
+#ifdef HAVE_PTHREAD_H
+/** A buffer waiting for the writer thread. */
+struct save_job {
+  char *path;
+  char *data;
+  size_t len;
+  struct save_job *next;
+};
+
+/** A write that failed on the writer thread, logged later by
+ * save_writer_poll() since log() may only be used on the game thread. */
+struct save_failure {
+  char *path;
+  int err;
+  struct save_failure *next;
+};
+
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_work = PTHREAD_COND_INITIALIZER;  /* job queued */
+static pthread_cond_t writer_done = PTHREAD_COND_INITIALIZER;  /* job written */
+static pthread_t writer_tid;
+static bool writer_running = FALSE;
+static bool writer_stop = FALSE;
+
+/* Everything below is protected by writer_lock. */
+static struct save_job *queue_head = NULL, *queue_tail = NULL;
+static const char *writing = NULL;     /* path being written right now */
+static struct save_failure *failures = NULL;
+static long num_written = 0, num_coalesced = 0;
+
+static void *writer_main(void *arg)
+{
+  struct save_job *job;
+  struct save_failure *fail;
+  int err;
+
+  pthread_mutex_lock(&writer_lock);
+  for (;;) {
+    while (!queue_head && !writer_stop)
+      pthread_cond_wait(&writer_work, &writer_lock);
+    if (!queue_head)
+      break;
+
+    job = queue_head;
+    if (!(queue_head = job->next))
+      queue_tail = NULL;
+    writing = job->path;
+    pthread_mutex_unlock(&writer_lock);
+
+    err = write_out(job->path, job->data, job->len);
+
+    pthread_mutex_lock(&writer_lock);
+    writing = NULL;
+    if (err) {
+      CREATE(fail, struct save_failure, 1);
+      fail->path = job->path;
+      fail->err = err;
+      fail->next = failures;
+      failures = fail;
+    } else {
+      num_written++;
+      free(job->path);
+    }
+    free(job->data);
+    free(job);
+    pthread_cond_broadcast(&writer_done);
+  }
+  pthread_mutex_unlock(&writer_lock);
+  return (NULL);
+}
+
+/** Is path queued or being written?  Call with writer_lock held. */
+static bool path_pending(const char *path)
+{
+  struct save_job *job;
+
+  if (writing && !strcmp(writing, path))
+    return (TRUE);
+  for (job = queue_head; job; job = job->next)
+    if (!strcmp(job->path, path))
+      return (TRUE);
+  return (FALSE);
+}
+
+/** Hand a closed in-memory save to the writer thread, replacing any older
+ * snapshot of the same file that it has not started on yet. */
+static void queue_save(struct save_file *sf)
+{
+  struct save_job *job;
+
+  pthread_mutex_lock(&writer_lock);
+  for (job = queue_head; job; job = job->next)
+    if (!strcmp(job->path, sf->path))
+      break;
+
+  if (job) {
+    free(job->data);
+    job->data = sf->data;
+    job->len = sf->len;
+    free(sf->path);
+    num_coalesced++;
+  } else {
+    CREATE(job, struct save_job, 1);
+    job->path = sf->path;
+    job->data = sf->data;
+    job->len = sf->len;
+    if (queue_tail)
+      queue_tail->next = job;
+    else
+      queue_head = job;
+    queue_tail = job;
+    pthread_cond_signal(&writer_work);
+  }
+  pthread_mutex_unlock(&writer_lock);
+  free(sf);
+}
+#endif
+
+/** Start the writer thread.  Until this is called, and on systems without
+ * pthreads, save_commit() writes files itself. */
+void save_writer_init(void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (writer_running)
+    return;
+  writer_stop = FALSE;
+  if (pthread_create(&writer_tid, NULL, writer_main, NULL) != 0) {
+    log("SYSERR: Couldn't start the save writer thread; saving synchronously.");
+    return;
+  }
+  writer_running = TRUE;
+#endif
+}
+
+/** Write out everything queued and stop the writer thread. */
+void save_writer_shutdown(void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!writer_running)
+    return;
+
+  save_writer_flush();
+
+  pthread_mutex_lock(&writer_lock);
+  writer_stop = TRUE;
+  pthread_cond_signal(&writer_work);
+  pthread_mutex_unlock(&writer_lock);
+  pthread_join(writer_tid, NULL);
+  writer_running = FALSE;
+
+  log("Save writer: %ld file(s) written, %ld older snapshot(s) coalesced.",
+      num_written, num_coalesced);
+#endif
+}
+
+/** Block until every queued save is on disk.  Call before anything that
+ * ends or replaces the process (shutdown, reboot, copyover). */
+void save_writer_flush(void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!writer_running)
+    return;
+
+  pthread_mutex_lock(&writer_lock);
+  while (queue_head || writing)
+    pthread_cond_wait(&writer_done, &writer_lock);
+  pthread_mutex_unlock(&writer_lock);
+
+  save_writer_poll();
+#endif
+}
+
+/** Block until path has no save queued or in progress, so it can be read or
+ * removed without racing the writer thread.
+ * @param path The file about to be opened or removed. */
+void save_writer_wait(const char *path)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!writer_running)
+    return;
+
+  pthread_mutex_lock(&writer_lock);
+  while (path_pending(path))
+    pthread_cond_wait(&writer_done, &writer_lock);
+  pthread_mutex_unlock(&writer_lock);
+#endif
+}
+
+/** Log any writes that failed on the writer thread.  Called from the game
+ * loop once a second. */
+void save_writer_poll(void)
+{
+#ifdef HAVE_PTHREAD_H
+  struct save_failure *list, *next;
+
+  pthread_mutex_lock(&writer_lock);
+  list = failures;
+  failures = NULL;
+  pthread_mutex_unlock(&writer_lock);
+
+  for (; list; list = next) {
+    next = list->next;
+    report_failure(list->path, list->err);
+    free(list->path);
+    free(list);
+  }
+#endif
+}
+
+/** Start a save file.  Write its contents to the returned fp, then pass it
+ * to save_commit(), or to save_abort() to leave the old file untouched.
+ * @param path Final name of the file.
+ * @retval struct save_file * The save, or NULL if it couldn't be started. */
+struct save_file *save_begin(const char *path)
+{
+  struct save_file *sf;
+
+  CREATE(sf, struct save_file, 1);
+  sf->path = strdup(path);
+
+#ifdef HAVE_PTHREAD_H
+  if ((sf->fp = open_memstream(&sf->data, &sf->len)) != NULL) {
+    sf->in_memory = TRUE;
+    return (sf);
+  }
+#endif
+
+  /* No memory streams: write "<path>.tmp" directly and rename on commit. */
+  {
+    char tmp[PATH_MAX];
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if ((sf->fp = fopen(tmp, "w")) != NULL)
+      return (sf);
+  }
+
+  free_save_file(sf);
+  return (NULL);
+}
+
+/** Finish a save started with save_begin(); sf is freed.
+ * @retval bool FALSE if the save is already known to have failed.  Errors
+ * on the writer thread are logged later by save_writer_poll(). */
+bool save_commit(struct save_file *sf)
+{
+  char tmp[PATH_MAX];
+  int err;
+
+  if (!sf->in_memory) {
+    /* Direct to disk. */
+    snprintf(tmp, sizeof(tmp), "%s.tmp", sf->path);
+    err = close_and_rename(sf->fp, tmp, sf->path);
+  } else if (fclose(sf->fp) != 0) {
+    err = errno ? errno : ENOMEM;
+  } else {
+#ifdef HAVE_PTHREAD_H
+    if (writer_running) {
+      queue_save(sf);
+      return (TRUE);
+    }
+#endif
+    err = write_out(sf->path, sf->data, sf->len);
+  }
+
+  if (err)
+    report_failure(sf->path, err);
+  free_save_file(sf);
+  return (err == 0);
+}
+
+/** Throw away a save started with save_begin(); sf is freed. */
+void save_abort(struct save_file *sf)
+{
+  char tmp[PATH_MAX];
+
+  fclose(sf->fp);
+  if (!sf->in_memory) {
+    snprintf(tmp, sizeof(tmp), "%s.tmp", sf->path);
+    remove(tmp);
+  }
+  free_save_file(sf);
+}
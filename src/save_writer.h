@@ -0,0 +1,44 @@
+/**
+* @file save_writer.h
+* Background writer for player, object and house save files.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* A save is done in two steps.  The game thread serializes into memory
+* through the FILE * that save_begin() hands out, which is cheap and sees a
+* consistent snapshot of the character.  save_commit() then queues the
+* buffer for a writer thread, which writes it to "<path>.tmp", fsyncs it
+* and renames it over the real file, so a crash mid-write never leaves a
+* truncated pfile behind.  If a file is queued again before the writer gets
+* to it, the newer snapshot simply replaces the older one.
+*
+* Anything that reads or removes one of these files must call
+* save_writer_wait() on the path first, and save_writer_flush() must be
+* called before the process exits or execs.  Without pthreads the commit
+* writes the file on the spot.
+*/
+#ifndef _SAVE_WRITER_H_
+#define _SAVE_WRITER_H_
+
+/** A save file being built on the game thread. */
+struct save_file {
+  FILE *fp;          /**< Write the file's contents here. */
+  char *path;        /**< Where the file goes once committed. */
+  char *data;        /**< In-memory contents, once fp is closed. */
+  size_t len;        /**< Bytes in data. */
+  bool in_memory;    /**< FALSE if fp is "<path>.tmp" on disk instead. */
+};
+
+void save_writer_init(void);
+void save_writer_shutdown(void);
+void save_writer_flush(void);
+void save_writer_wait(const char *path);
+void save_writer_poll(void);
+
+struct save_file *save_begin(const char *path);
+bool save_commit(struct save_file *sf);
+void save_abort(struct save_file *sf);
+
+#endif /* _SAVE_WRITER_H_ */
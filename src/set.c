@@ -468,6 +468,8 @@ static void rset_mark_room_modified(room_rnum rnum)
     return;
 
   add_to_save_list(zone_table[world[rnum].zone].number, SL_WLD);
+  /* In case the room just became a SAVE room. */
+  RoomSave_mark_dirty_room(rnum);
 }
 
 static void rset_show_room(struct char_data *ch, struct room_data *room)
@@ -6648,17 +6650,39 @@ ACMD(do_rsave)
 #define ROOMSAVE_EXT     ".toml"
 #endif
 
+/* Dirty set: SAVE rooms whose contents changed since they were last
+ * written.  roomsave_dirty[] stops a room going on the list twice; the list
+ * lets the autosave skip straight to them.  Both are indexed by rnum, so if
+ * OLC adds or removes rooms (top_of_world moves) they are rebuilt and every
+ * SAVE room is treated as dirty once. */
 static unsigned char *roomsave_dirty = NULL;
+static room_rnum *roomsave_dirty_list = NULL;
+static int roomsave_num_dirty = 0;
+static room_rnum roomsave_dirty_top = NOWHERE;
+static bool roomsave_all_dirty = FALSE;
 
 void RoomSave_init_dirty(void) {
-  free(roomsave_dirty);
-  roomsave_dirty = calloc((size_t)top_of_world + 1, 1);
+  if (roomsave_dirty) free(roomsave_dirty);
+  if (roomsave_dirty_list) free(roomsave_dirty_list);
+  CREATE(roomsave_dirty, unsigned char, top_of_world + 1);
+  CREATE(roomsave_dirty_list, room_rnum, top_of_world + 1);
+  roomsave_num_dirty = 0;
+  roomsave_dirty_top = top_of_world;
 }
 
 void RoomSave_mark_dirty_room(room_rnum rnum) {
   if (!roomsave_dirty) return;
-  if (rnum != NOWHERE && rnum >= 0 && rnum <= top_of_world)
+  if (rnum == NOWHERE || rnum < 0 || rnum > top_of_world) return;
+  if (!ROOM_FLAGGED(rnum, ROOM_SAVE)) return;
+
+  if (roomsave_dirty_top != top_of_world) {
+    RoomSave_init_dirty();
+    roomsave_all_dirty = TRUE;
+  }
+  if (!roomsave_dirty[rnum]) {
     roomsave_dirty[rnum] = 1;
+    roomsave_dirty_list[roomsave_num_dirty++] = rnum;
+  }
 }
 
 /* Where does an object “live” (topmost location -> room)? */
@@ -6741,6 +6765,17 @@ struct roomsave_room {
   struct roomsave_room *next;
 };
 
+/* In-memory copy of one lib/world/rsv/<zone>.toml.  It always matches what
+ * is on disk, except for rooms updated since the zone was last written. */
+struct roomsave_zone {
+  int vnum;
+  struct roomsave_room *rooms;
+  bool dirty;                   /* rooms changed, file not yet rewritten */
+  struct roomsave_zone *next;
+};
+
+static struct roomsave_zone *roomsave_zones = NULL;
+
 static void roomsave_free_obj_list(struct roomsave_obj *obj)
 {
   while (obj) {
@@ -7495,42 +7530,58 @@ static void roomsave_zone_filename(int zone_vnum, char *out, size_t outsz) {
   snprintf(out, outsz, "%s%d%s", ROOMSAVE_PREFIX, zone_vnum, ROOMSAVE_EXT);
 }
 
-/* Public: write the entire room’s contents */
-int RoomSave_now(room_rnum rnum) {
-  char path[PATH_MAX], tmp[PATH_MAX];
-  FILE *out = NULL;
-  struct roomsave_room *rooms = NULL, *it = NULL, *prev = NULL;
-  struct roomsave_room *new_room = NULL;
-  room_vnum rvnum;
+static void roomsave_free_zones(void)
+{
+  struct roomsave_zone *z, *next;
+
+  for (z = roomsave_zones; z; z = next) {
+    next = z->next;
+    roomsave_free_rooms(z->rooms);
+    free(z);
+  }
+  roomsave_zones = NULL;
+}
+
+/* The model for a zone, reading its file the first time it is needed. */
+static struct roomsave_zone *roomsave_get_zone(int zone_vnum)
+{
+  struct roomsave_zone *z;
+  char path[PATH_MAX];
+
+  for (z = roomsave_zones; z; z = z->next)
+    if (z->vnum == zone_vnum)
+      return z;
+
+  CREATE(z, struct roomsave_zone, 1);
+  z->vnum = zone_vnum;
+  roomsave_zone_filename(zone_vnum, path, sizeof(path));
+  z->rooms = roomsave_load_file_toml(path);
+  z->next = roomsave_zones;
+  roomsave_zones = z;
+  return z;
+}
+
+/* Replace (or append) a room's entry in its zone's model.  Returns the
+ * zone, now marked dirty, or NULL if the room could not be saved. */
+static struct roomsave_zone *roomsave_update_room(room_rnum rnum)
+{
+  struct roomsave_zone *z;
+  struct roomsave_room *it, *prev = NULL, *new_room;
   int zvnum;
 
   if (rnum == NOWHERE)
-    return 0;
+    return NULL;
 
-  rvnum = world[rnum].number;
   zvnum = roomsave_zone_for_rnum(rnum);
   if (zvnum < 0)
-    return 0;
-
-  ensure_dir_exists(ROOMSAVE_PREFIX);
-  roomsave_zone_filename(zvnum, path, sizeof(path));
-
-  {
-    int n = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
-    if (n < 0 || n >= (int)sizeof(tmp)) {
-      mudlog(NRM, LVL_IMMORT, TRUE,
-             "SYSERR: RoomSave: temp path too long for %s", path);
-      return 0;
-    }
-  }
+    return NULL;
 
-  rooms = roomsave_load_file_toml(path);
-  new_room = roomsave_build_room(rnum);
-  if (!new_room)
-    return 0;
+  if (!(new_room = roomsave_build_room(rnum)))
+    return NULL;
+  z = roomsave_get_zone(zvnum);
 
-  for (it = rooms; it; it = it->next) {
-    if (it->vnum == (int)rvnum)
+  for (it = z->rooms; it; it = it->next) {
+    if (it->vnum == new_room->vnum)
       break;
     prev = it;
   }
@@ -7542,11 +7593,32 @@ int RoomSave_now(room_rnum rnum) {
     it->objects = new_room->objects;
     it->mobs = new_room->mobs;
     free(new_room);
-  } else {
-    if (!rooms) {
-      rooms = new_room;
-    } else if (prev) {
-      prev->next = new_room;
+  } else if (prev)
+    prev->next = new_room;
+  else
+    z->rooms = new_room;
+
+  z->dirty = TRUE;
+  if (roomsave_dirty && rnum <= roomsave_dirty_top)
+    roomsave_dirty[rnum] = 0;
+  return z;
+}
+
+/* Write a zone's model out with an atomic rename. */
+static int roomsave_write_zone(struct roomsave_zone *z)
+{
+  char path[PATH_MAX], tmp[PATH_MAX];
+  FILE *out;
+
+  ensure_dir_exists(ROOMSAVE_PREFIX);
+  roomsave_zone_filename(z->vnum, path, sizeof(path));
+
+  {
+    int n = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if (n < 0 || n >= (int)sizeof(tmp)) {
+      mudlog(NRM, LVL_IMMORT, TRUE,
+             "SYSERR: RoomSave: temp path too long for %s", path);
+      return 0;
     }
   }
 
@@ -7554,31 +7626,37 @@ int RoomSave_now(room_rnum rnum) {
     mudlog(NRM, LVL_IMMORT, TRUE,
            "SYSERR: RoomSave: fopen(%s) failed: %s",
            tmp, strerror(errno));
-    roomsave_free_rooms(rooms);
     return 0;
   }
 
-  roomsave_write_rooms(out, rooms);
+  roomsave_write_rooms(out, z->rooms);
 
   if (fclose(out) != 0) {
     mudlog(NRM, LVL_IMMORT, TRUE,
            "SYSERR: RoomSave: fclose(%s) failed: %s",
            tmp, strerror(errno));
-    roomsave_free_rooms(rooms);
     return 0;
   }
   if (rename(tmp, path) != 0) {
     mudlog(NRM, LVL_IMMORT, TRUE,
            "SYSERR: RoomSave: rename(%s -> %s) failed: %s",
            tmp, path, strerror(errno));
-    roomsave_free_rooms(rooms);
     return 0;
   }
 
-  roomsave_free_rooms(rooms);
+  z->dirty = FALSE;
   return 1;
 }
 
+/* Public: write the entire room’s contents */
+int RoomSave_now(room_rnum rnum) {
+  struct roomsave_zone *z;
+
+  if (!(z = roomsave_update_room(rnum)))
+    return 0;
+  return roomsave_write_zone(z);
+}
+
 static struct obj_data *RS_create_obj_by_vnum(obj_vnum ov) {
   obj_rnum ornum;
   if (ov <= 0) return NULL;
@@ -7648,13 +7726,42 @@ static void RS_apply_inventory_loadout(struct char_data *mob) {
   }
 }
 
-/* Optional autosave hook (invoked by limits.c:point_update). */
+/* Optional autosave hook (invoked by limits.c:point_update).  Refreshes
+ * the model for every dirty room, then writes each changed zone once. */
 void RoomSave_autosave_tick(void) {
-  /* Iterate all rooms; only save flagged ones. */
-  for (room_rnum rnum = 0; rnum <= top_of_world; ++rnum) {
-    if (ROOM_FLAGGED(rnum, ROOM_SAVE))
-      RoomSave_now(rnum);
+  struct roomsave_zone *z;
+  room_rnum rnum;
+  int i, rooms = 0, zones = 0;
+
+  if (roomsave_dirty && roomsave_dirty_top != top_of_world) {
+    RoomSave_init_dirty();
+    roomsave_all_dirty = TRUE;
+  }
+
+  if (roomsave_all_dirty) {
+    for (rnum = 0; rnum <= top_of_world; rnum++)
+      if (ROOM_FLAGGED(rnum, ROOM_SAVE) && roomsave_update_room(rnum))
+        rooms++;
+    roomsave_all_dirty = FALSE;
+  } else {
+    for (i = 0; i < roomsave_num_dirty; i++) {
+      rnum = roomsave_dirty_list[i];
+      /* RoomSave_now() may already have saved it */
+      if (roomsave_dirty[rnum] && ROOM_FLAGGED(rnum, ROOM_SAVE) &&
+          roomsave_update_room(rnum))
+        rooms++;
+      roomsave_dirty[rnum] = 0;
+    }
   }
+  roomsave_num_dirty = 0;
+
+  for (z = roomsave_zones; z; z = z->next)
+    if (z->dirty)
+      zones += roomsave_write_zone(z);
+
+  if (zones)
+    log("RoomSave: autosaved %d room%s in %d zone file%s.",
+        rooms, rooms == 1 ? "" : "s", zones, zones == 1 ? "" : "s");
 }
 
 void RoomSave_boot(void)
@@ -7673,6 +7780,10 @@ void RoomSave_boot(void)
 
   log("RoomSave: scanning %s for *.toml", ROOMSAVE_PREFIX);
 
+  /* The files are the truth here; anything not yet written is lost, just as
+   * the room contents it described are about to be. */
+  roomsave_free_zones();
+
   while ((dp = readdir(dirp))) {
     size_t n = strlen(dp->d_name);
     size_t extlen = strlen(ROOMSAVE_EXT);
@@ -7697,6 +7808,16 @@ void RoomSave_boot(void)
       if (!rooms)
         continue;
 
+      {
+        struct roomsave_zone *z;
+
+        CREATE(z, struct roomsave_zone, 1);
+        z->vnum = atoi(dp->d_name);
+        z->rooms = rooms;
+        z->next = roomsave_zones;
+        roomsave_zones = z;
+      }
+
       int blocks = 0;
       int restored_objs_total = 0;
       int restored_mobs_total = 0;
@@ -7724,6 +7845,10 @@ void RoomSave_boot(void)
         restored_objs_total += count_objs;
         restored_mobs_total += count_mobs;
 
+        /* Restoring matches the file, so it is not a change to save. */
+        if (roomsave_dirty && rnum <= roomsave_dirty_top)
+          roomsave_dirty[rnum] = 0;
+
         if (count_mobs > 0)
           log("RoomSave: room %d <- %d object(s) and %d mob(s)",
               room->vnum, count_objs, count_mobs);
@@ -7733,7 +7858,6 @@ void RoomSave_boot(void)
 
       log("RoomSave: finished %s (blocks=%d, objects=%d, mobs=%d)",
           path, blocks, restored_objs_total, restored_mobs_total);
-      roomsave_free_rooms(rooms);
     }
   }
 
@@ -30,10 +30,10 @@ void RoomSave_boot(void);
 /* saves ground objs AND NPCs (+their E/G/P trees) in rsv. */
 int  RoomSave_now(room_rnum rnum);
 
-/* Autosave pass for all rooms flagged ROOM_SAVE. */
+/* Autosave pass: writes each zone file whose SAVE rooms changed, once. */
 void RoomSave_autosave_tick(void);
 
-/* Only save rooms when modified */
+/* Only save rooms when modified (handler.c marks them) */
 void RoomSave_init_dirty(void);
 void RoomSave_mark_dirty_room(room_rnum rnum);
 /* For container edits: find the room an object ultimately lives in */
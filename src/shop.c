@@ -1328,32 +1328,13 @@ static char *dup_shop_message(int mnum, room_vnum shr, const char *msg)
   return (tbuf);
 }
 
-void boot_the_shops(FILE *shop_f, char *filename, int rec_count)
+void boot_the_shops(toml_table_t *tab, char *filename, int rec_count)
 {
-  FILE *fp;
-  toml_table_t *tab;
   toml_array_t *shops;
-  char errbuf[200];
   int i;
 
-  (void)shop_f;
-
-  fp = fopen(filename, "r");
-  if (!fp) {
-    log("SYSERR: %s: %s", filename, strerror(errno));
-    exit(1);
-  }
-
-  tab = toml_parse_file(fp, errbuf, sizeof(errbuf));
-  fclose(fp);
-  if (!tab) {
-    log("SYSERR: parsing file '%s': %s", filename, errbuf);
-    exit(1);
-  }
-
   shops = toml_array_in(tab, "shop");
   if (!shops) {
-    toml_free(tab);
     log("SYSERR: TOML file '%s' missing 'shop' array.", filename);
     exit(1);
   }
@@ -1451,8 +1432,6 @@ void boot_the_shops(FILE *shop_f, char *filename, int rec_count)
     SHOP_SORT(top_shop) = toml_get_int_default(shop_tab, "sort", 0);
     SHOP_FUNC(top_shop) = NULL;
   }
-
-  toml_free(tab);
 }
 
 void assign_the_shopkeepers(void)
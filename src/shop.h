@@ -14,7 +14,8 @@
 
 /* Public function prototypes */
 SPECIAL(shop_keeper);
-void boot_the_shops(FILE *shop_f, char *filename, int rec_count);
+struct toml_table_t;
+void boot_the_shops(struct toml_table_t *tab, char *filename, int rec_count);
 void assign_the_shopkeepers(void);
 void show_shops(struct char_data *ch, char *arg);
 int ok_damage_shopkeeper(struct char_data *ch, struct char_data *victim);
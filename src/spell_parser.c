@@ -630,16 +630,20 @@ ACMD(do_cast) {
     gain_skill(ch, s, FALSE);
     if (!tch || !skill_message(0, ch, tch, spellnum))
       send_to_char(ch, "You lost your concentration!\r\n");
-    if (mana > 0)
+    if (mana > 0) {
       GET_MANA(ch) = MAX(0, MIN(GET_MAX_MANA(ch), GET_MANA(ch) - (mana / 2)));
+      msdp_changed(ch, MSDP_DIRTY_VITALS);
+    }
     if (SINFO.violent && tch && IS_NPC(tch))
     hit(tch, ch, TYPE_UNDEFINED);
   } else { /* cast spell returns 1 on success; subtract mana & set waitstate */
     if (cast_spell(ch, tch, tobj, spellnum)) {
       WAIT_STATE(ch, PULSE_VIOLENCE);
       gain_skill(ch, s, TRUE);
-      if (mana > 0)
+      if (mana > 0) {
         GET_MANA(ch) = MAX(0, MIN(GET_MAX_MANA(ch), GET_MANA(ch) - mana));
+        msdp_changed(ch, MSDP_DIRTY_VITALS);
+      }
     }
   }
 }
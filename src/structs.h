@@ -651,6 +651,7 @@
 #define MAX_PROMPT_LENGTH  96          /**< Max length of prompt        */
 #define GARBAGE_SPACE      32          /**< Space for **OVERFLOW** etc  */
 #define SMALL_BUFSIZE      1024        /**< Static output buffer size   */
+#define OUT_BLOCK_SIZE     2048        /**< Size of one output block    */
 /** Max amount of output that can be buffered */
 #define LARGE_BUFSIZE      (MAX_SOCK_BUF - GARBAGE_SPACE - MAX_PROMPT_LENGTH)
 
@@ -784,6 +785,9 @@ struct obj_data
 
   struct obj_data *next_content;  /**< For 'contains' lists   */
   struct obj_data *next;          /**< For the object list */
+  struct obj_data *next_scheduled; /**< For the random/time trigger registry */
+  struct obj_data *prev_scheduled; /**< For the random/time trigger registry */
+  bool scheduled;                 /**< On the random/time trigger registry */
   struct char_data *sitting_here; /**< For furniture, who is sitting in it */
   
   struct list_data *events;      /**< Used for object events */
@@ -871,6 +875,10 @@ struct room_data
   
   struct forage_entry *forage; /**< Forage table entries for this room */
   struct list_data * events;  
+
+  long mob_trig_types;       /**< Trigger types of the people here; see room_mob_trig_types() */
+  long obj_trig_types;       /**< Trigger types of the objects here and on people here */
+  bool trig_types_stale;     /**< Something scripted left; rebuild the two above */
 };
 
 /* char-related structures */
@@ -1068,6 +1076,9 @@ struct player_special_data
   char *account_name;    /**< Account name owning this PC. */
   int buildwalk_sector;  /**< Default sector type for buildwalk */
   struct scan_result_data *scan_results; /**< Hidden figures this player has spotted */
+  unsigned long save_gen;  /**< Bumped when anything saved for this PC changes */
+  unsigned long pfile_gen; /**< save_gen when the pfile was last written, 0 if never */
+  unsigned long crash_gen; /**< save_gen when the rent file was last written, 0 if never */
 };
 
 /** Account data stored separately from character data. */
@@ -1157,6 +1168,9 @@ struct char_data
   struct char_data *next_in_room;  /**< Next PC in the room */
   struct char_data *next;          /**< Next char_data in the room */
   struct char_data *next_fighting; /**< Next in line to fight */
+  struct char_data *next_scheduled; /**< For the random/time trigger registry */
+  struct char_data *prev_scheduled; /**< For the random/time trigger registry */
+  bool scheduled;                  /**< On the random/time trigger registry */
 
   struct follow_type *followers; /**< List of characters following */
   struct char_data *master;      /**< List of character being followed */
@@ -1187,6 +1201,17 @@ struct txt_q
   struct txt_block *tail; /**< ? */
 };
 
+/** One block of a descriptor's output.  Output is appended to the last block
+ * of a chain of these and sent straight from them; the text between start and
+ * end has not been sent yet.  Spare blocks are pooled in comm.c. */
+struct out_block
+{
+  struct out_block *next;    /**< Next block in the chain, or the pool */
+  int start;                 /**< First byte not yet sent */
+  int end;                   /**< End of the text; not NUL terminated */
+  char text[OUT_BLOCK_SIZE]; /**< The text */
+};
+
 /** Master structure players. Holds the real players connection to the mud.
  * An analogy is the char_data is the body of the character, the descriptor_data
  * is the soul. */
@@ -1209,14 +1234,16 @@ struct descriptor_data
   long mail_to;             /**< name for mail system			*/
   int has_prompt;           /**< is the user at a prompt?             */
   char inbuf[MAX_RAW_INPUT_LENGTH];  /**< buffer for raw input		*/
+  int inbuf_len;            /**< bytes of raw input in inbuf	*/
   char last_input[MAX_INPUT_LENGTH]; /**< the last input			*/
-  char small_outbuf[SMALL_BUFSIZE];  /**< standard output buffer		*/
-  char *output;             /**< ptr to the current output buffer	*/
+  struct out_block *output; /**< queued output, oldest block first, or NULL */
+  struct out_block *output_tail; /**< the block being appended to	*/
+  int output_len;           /**< bytes of output queued			*/
+  bool output_overflow;     /**< output has been dropped since the last send */
+  struct mccp_stream *mccp;  /**< MCCP compression, once the client asks */
+  struct netio_conn *netio;  /**< Rings to the network thread, if it has the socket */
   char **history;           /**< History of commands, for ! mostly.	*/
   int history_pos;          /**< Circular array position.		*/
-  int bufptr;               /**< ptr to end of current output		*/
-  int bufspace;             /**< space left in the output buffer	*/
-  struct txt_block *large_outbuf; /**< ptr to large buffer, if we need it */
   struct txt_q input;       /**< q of unprocessed input		*/
   struct account_data *account; /**< Active account session data */
   struct char_data *character; /**< linked to char			*/
@@ -1226,6 +1253,9 @@ struct descriptor_data
   struct descriptor_data *next;     /**< link to next descriptor		*/
   struct oasis_olc_data *olc;       /**< OLC info */
   protocol_t *pProtocol;    /**< Kavir plugin */
+  int msdp_dirty;           /**< MSDP_DIRTY_xxx: what to send MSDP for	*/
+  struct char_data *msdp_char; /**< the player MSDP is being sent for	*/
+  int poll_ready;           /**< POLL_xxx readiness not yet used up	*/
   
   struct list_data * events;
 };
@@ -1496,6 +1526,11 @@ struct game_operation
   int protocol_negotiation; /**< Enable the protocol negotiation system ? */
   int special_in_comm; /**< Enable use of a special character in communication channels ? */
   int debug_mode; /**< Current Debug Mode */
+  int boot_threads; /**< World file parser threads at boot, 0 = one per CPU */
+  int mob_ai_shards; /**< Pulses each PULSE_MOBILE's mob AI is spread over */
+  int dormancy_delay; /**< Minutes with no player near before a zone sleeps, 0 = never */
+  int dormancy_radius; /**< Zone hops from a player that count as near */
+  int network_thread; /**< Do socket I/O on a thread of its own ? */
 };
 
 /** The Autowizard options. */
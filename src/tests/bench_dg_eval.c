@@ -0,0 +1,576 @@
+/* tests/bench_dg_eval.c — DG expressions: text values vs typed values
+ *
+ * Runs a few scripts shaped like the loops in random and time triggers -
+ * a counting while loop, damage arithmetic, string tests and a clock check -
+ * through the expression evaluator.  The old evaluator from dg_scripts.c,
+ * which passed every value around as text, is reproduced here verbatim as
+ * the baseline; the new one is linked from dg_eval.o.  Variables are
+ * substituted by a small stand-in for var_subst() that both share.  Every
+ * answer from the two must be the same text.
+ *
+ * Usage: bench_dg_eval [runs of each script]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "dg_scripts.h"
+#include "interpreter.h"
+
+/* --- Globals and functions dg_eval.o expects from the rest of the game --- */
+void basic_mud_log(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+#ifndef str_cmp
+int str_cmp(const char *arg1, const char *arg2)
+{
+  int chk, i;
+
+  if (arg1 == NULL || arg2 == NULL) {
+    log("SYSERR: str_cmp() passed a NULL pointer, %p or %p.", (void *)arg1, (void *)arg2);
+    return (0);
+  }
+
+  for (i = 0; arg1[i] || arg2[i]; i++)
+    if ((chk = LOWER(arg1[i]) - LOWER(arg2[i])) != 0)
+      return (chk);	/* not equal */
+
+  return (0);
+}
+#endif
+
+#ifndef strn_cmp
+int strn_cmp(const char *arg1, const char *arg2, int n)
+{
+  int chk, i;
+
+  if (arg1 == NULL || arg2 == NULL) {
+    log("SYSERR: strn_cmp() passed a NULL pointer, %p or %p.", (void *)arg1, (void *)arg2);
+    return (0);
+  }
+
+  for (i = 0; (arg1[i] || arg2[i]) && (n > 0); i++, n--)
+    if ((chk = LOWER(arg1[i]) - LOWER(arg2[i])) != 0)
+      return (chk);	/* not equal */
+
+  return (0);
+}
+#endif
+
+void skip_spaces(char **string)
+{
+  for (; **string && **string != '\t' && isspace(**string); (*string)++);
+}
+
+char *str_str(char *cs, char *ct)
+{
+  char *s, *t;
+
+  if (!cs || !ct || !*ct)
+    return NULL;
+
+  while (*cs) {
+    t = ct;
+
+    while (*cs && (LOWER(*cs) != LOWER(*t)))
+      cs++;
+
+    s = cs;
+
+    while (*t && *cs && (LOWER(*cs) == LOWER(*t))) {
+      t++;
+      cs++;
+    }
+
+    /* If there we haven reached the end of ct via t,
+     * then the whole string was found. */
+    if (!*t)
+      return s;
+  }
+
+  return NULL;
+}
+
+/* Variables, and just enough of var_subst() for the scripts below: each
+ * %name% is replaced by the variable's value, or nothing. */
+#define BENCH_VARS 16
+
+static struct {
+  char name[32];
+  char value[MAX_INPUT_LENGTH];
+} vars[BENCH_VARS];
+static int num_vars;
+
+static void set_var(const char *name, const char *value)
+{
+  int i;
+
+  for (i = 0; i < num_vars; i++)
+    if (!strcmp(vars[i].name, name))
+      break;
+  if (i == num_vars) {
+    if (num_vars == BENCH_VARS) {
+      fprintf(stderr, "bench_dg_eval: too many variables\n");
+      exit(1);
+    }
+    snprintf(vars[num_vars++].name, sizeof(vars[0].name), "%s", name);
+  }
+  snprintf(vars[i].value, sizeof(vars[i].value), "%s", value);
+}
+
+void var_subst(void *go, struct script_data *sc, trig_data *trig,
+               int type, char *line, char *buf)
+{
+  char *out = buf, *end;
+  size_t len;
+  int i;
+
+  while (*line) {
+    if (*line != '%' || !(end = strchr(line + 1, '%'))) {
+      *out++ = *line++;
+      continue;
+    }
+    len = end - line - 1;
+    for (i = 0; i < num_vars; i++)
+      if (strlen(vars[i].name) == len && !strncmp(vars[i].name, line + 1, len)) {
+        strcpy(out, vars[i].value);
+        out += strlen(out);
+        break;
+      }
+    line = end + 1;
+  }
+  *out = '\0';
+}
+
+/* --- The previous evaluator, from dg_scripts.c --- */
+static void old_eval_expr(char *line, char *result, void *go, struct script_data *sc,
+          trig_data *trig, int type);
+static int old_eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
+          trig_data *trig, int type);
+
+/* Returns 1 if string is all digits, else 0. Bugfixed - would have returned 
+ * true on num="------". */
+static int old_is_num(char *arg)
+{
+   if (*arg == '\0')
+      return FALSE;
+
+   if (*arg == '+' || *arg == '-')
+      arg++;
+
+   for (; *arg != '\0'; arg++)
+   {
+      if (!isdigit(*arg))
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+/* evaluates 'lhs op rhs', and copies to result */
+static void old_eval_op(char *op, char *lhs, char *rhs, char *result, void *go,
+             struct script_data *sc, trig_data *trig)
+{
+  unsigned char *p;
+  int n;
+
+  /* strip off extra spaces at begin and end */
+  while (*lhs && isspace(*lhs))
+    lhs++;
+  while (*rhs && isspace(*rhs))
+    rhs++;
+
+  for (p = (unsigned char *) lhs; *p; p++);
+  for (--p; isspace(*p) && ((char *)p > lhs); *p-- = '\0');
+  for (p = (unsigned char *) rhs; *p; p++);
+  for (--p; isspace(*p) && ((char *)p > rhs); *p-- = '\0');
+
+
+  /* find the op, and figure out the value */
+  if (!strcmp("||", op)) {
+    if ((!*lhs || (*lhs == '0')) && (!*rhs || (*rhs == '0')))
+      strcpy(result, "0");
+    else
+      strcpy(result, "1");
+  }
+
+  else if (!strcmp("&&", op)) {
+    if (!*lhs || (*lhs == '0') || !*rhs || (*rhs == '0'))
+      strcpy (result, "0");
+    else
+      strcpy (result, "1");
+  }
+
+  else if (!strcmp("==", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) == atoi(rhs));
+    else
+      sprintf(result, "%d", !str_cmp(lhs, rhs));
+  }
+
+  else if (!strcmp("!=", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) != atoi(rhs));
+    else
+      sprintf(result, "%d", str_cmp(lhs, rhs));
+  }
+
+  else if (!strcmp("<=", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) <= atoi(rhs));
+    else
+      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
+  }
+
+  else if (!strcmp(">=", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) >= atoi(rhs));
+    else
+      sprintf(result, "%d", str_cmp(lhs, rhs) <= 0);
+  }
+
+  else if (!strcmp("<", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) < atoi(rhs));
+    else
+      sprintf(result, "%d", str_cmp(lhs, rhs) < 0);
+  }
+
+  else if (!strcmp(">", op)) {
+    if (old_is_num(lhs) && old_is_num(rhs))
+      sprintf(result, "%d", atoi(lhs) > atoi(rhs));
+    else
+      sprintf(result, "%d", str_cmp(lhs, rhs) > 0);
+  }
+
+  else if (!strcmp("/=", op))
+    sprintf(result, "%c", str_str(lhs, rhs) ? '1' : '0');
+
+  else if (!strcmp("*", op))
+    sprintf(result, "%d", atoi(lhs) * atoi(rhs));
+
+  else if (!strcmp("/", op))
+    sprintf(result, "%d", (n = atoi(rhs)) ? (atoi(lhs) / n) : 0);
+
+  else if (!strcmp("+", op))
+    sprintf(result, "%d", atoi(lhs) + atoi(rhs));
+
+  else if (!strcmp("-", op))
+    sprintf(result, "%d", atoi(lhs) - atoi(rhs));
+
+  else if (!strcmp("!", op)) {
+    if (old_is_num(rhs))
+      sprintf(result, "%d", !atoi(rhs));
+    else
+      sprintf(result, "%d", !*rhs);
+  }
+}
+
+/* p points to the first paren.  returns a pointer to the matching closing 
+ * paren, or the last non-null char in p. */
+static char *old_matching_paren(char *p)
+{
+  int i;
+
+  for (p++, i = 1; *p && i; p++) {
+    if (*p == '(')
+      i++;
+    else if (*p == ')')
+      i--;
+    else if (*p == '"')
+      p = matching_quote(p);
+  }
+
+  return --p;
+}
+
+/* evaluates line, and returns answer in result */
+static void old_eval_expr(char *line, char *result, void *go, struct script_data *sc,
+               trig_data *trig, int type)
+{
+  char expr[MAX_INPUT_LENGTH], *p;
+
+  while (*line && isspace(*line))
+    line++;
+
+  if (old_eval_lhs_op_rhs(line, result, go, sc, trig, type));
+
+  else if (*line == '(') {
+    strcpy(expr, line);
+    p = old_matching_paren(expr);
+    *p = '\0';
+    old_eval_expr(expr + 1, result, go, sc, trig, type);
+  }
+
+  else
+    var_subst(go, sc, trig, type, line, result);
+}
+
+/* Evaluates expr if it is in the form lhs op rhs, and copies answer in result.
+ * Returns 1 if expr is evaluated, else 0. */
+static int old_eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
+                    trig_data *trig, int type)
+{
+  char *p, *tokens[MAX_INPUT_LENGTH];
+  char line[MAX_INPUT_LENGTH], lhr[MAX_INPUT_LENGTH], rhr[MAX_INPUT_LENGTH];
+  int i, j;
+
+  /*
+   * valid operands, in order of priority
+   * each must also be defined in old_eval_op()
+   */
+  static char *ops[] = {
+    "||",
+    "&&",
+    "==",
+    "!=",
+    "<=",
+    ">=",
+    "<",
+    ">",
+    "/=",
+    "-",
+    "+",
+    "/",
+    "*",
+    "!",
+    "\n"
+  };
+
+  p = strcpy(line, expr);
+
+  /* Initialize tokens, an array of pointers to locations in line where the 
+   * ops could possibly occur. */
+  for (j = 0; *p; j++) {
+    tokens[j] = p;
+    if (*p == '(')
+      p = old_matching_paren(p) + 1;
+    else if (*p == '"')
+      p = matching_quote(p) + 1;
+    else if (isalnum(*p))
+      for (p++; *p && (isalnum(*p) || isspace(*p)); p++);
+    else
+      p++;
+  }
+  tokens[j] = NULL;
+
+  for (i = 0; *ops[i] != '\n'; i++)
+    for (j = 0; tokens[j]; j++)
+      if (!strn_cmp(ops[i], tokens[j], strlen(ops[i]))) {
+        *tokens[j] = '\0';
+        p = tokens[j] + strlen(ops[i]);
+
+        old_eval_expr(line, lhr, go, sc, trig, type);
+        old_eval_expr(p, rhr, go, sc, trig, type);
+        old_eval_op(ops[i], lhr, rhr, result, go, sc, trig);
+
+        return 1;
+      }
+
+  return 0;
+}
+
+/* returns 1 if cond is true, else 0 */
+static int old_process_if(char *cond, void *go, struct script_data *sc,
+               trig_data *trig, int type)
+{
+  char result[MAX_INPUT_LENGTH], *p;
+
+  old_eval_expr(cond, result, go, sc, trig, type);
+
+  p = result;
+  skip_spaces(&p);
+
+  if (!*p || *p == '0')
+    return 0;
+  else
+    return 1;
+}
+
+/* --- The two evaluators, as the script driver calls them --- */
+struct bench_eval {
+  const char *name;
+  void (*eval)(char *line, char *result);
+  int (*cond)(char *cond);
+};
+
+static void w_old_eval(char *line, char *result) { old_eval_expr(line, result, NULL, NULL, NULL, 0); }
+static int w_old_cond(char *cond) { return old_process_if(cond, NULL, NULL, NULL, 0); }
+static void w_new_eval(char *line, char *result) { eval_expr(line, result, NULL, NULL, NULL, 0); }
+static int w_new_cond(char *cond) { return process_if(cond, NULL, NULL, NULL, 0); }
+
+static const struct bench_eval evals[] = {
+  { "text values",  w_old_eval, w_old_cond },
+  { "typed values", w_new_eval, w_new_cond },
+};
+
+/* What each run saw, to compare the two evaluators by. */
+static unsigned long digest;
+static long exprs;
+
+static void note(const char *s)
+{
+  for (; *s; s++)
+    digest = digest * 31 + (unsigned char)*s;
+  digest = digest * 31 + '\n';
+}
+
+/* eval <var> <expr> */
+static void do_eval(const struct bench_eval *e, const char *var, const char *expr)
+{
+  char line[MAX_INPUT_LENGTH], result[MAX_INPUT_LENGTH];
+
+  snprintf(line, sizeof(line), "%s", expr);
+  e->eval(line, result);
+  set_var(var, result);
+  note(result);
+  exprs++;
+}
+
+/* if <expr> / while <expr> */
+static int do_cond(const struct bench_eval *e, const char *expr)
+{
+  char line[MAX_INPUT_LENGTH];
+  int ret;
+
+  snprintf(line, sizeof(line), "%s", expr);
+  ret = e->cond(line);
+  note(ret ? "1" : "0");
+  exprs++;
+  return (ret);
+}
+
+/* set i 0
+ * while %i% < 100
+ *   eval i %i% + 1
+ *   if %i% / 7 * 7 == %i%
+ *     eval sevens %sevens% + 1
+ *   end
+ * done */
+static void eval_loop(const struct bench_eval *e)
+{
+  set_var("i", "0");
+  set_var("sevens", "0");
+  while (do_cond(e, "%i% < 100")) {
+    do_eval(e, "i", "%i% + 1");
+    if (do_cond(e, "%i% / 7 * 7 == %i%"))
+      do_eval(e, "sevens", "%sevens% + 1");
+  }
+}
+
+/* A fight round worked out by a trigger, twenty times over. */
+static void eval_damage(const struct bench_eval *e)
+{
+  int round;
+
+  set_var("level", "23");
+  set_var("bonus", "7");
+  set_var("armor", "12");
+  set_var("hp", "800");
+  for (round = 0; round < 20; round++) {
+    do_eval(e, "dam", "(%level% * 3 + %bonus%) / 2 - %armor%");
+    if (do_cond(e, "%dam% > 20 && %dam% <= 100"))
+      do_eval(e, "hp", "%hp% - %dam% * 2");
+    else
+      do_eval(e, "hp", "%hp% - 1");
+    do_eval(e, "bonus", "(%bonus% + %level%) - (%bonus% / 3) * 3");
+    if (do_cond(e, "%hp% < 100 || !%level%"))
+      break;
+  }
+}
+
+/* Who is here, and what are they?  Mostly text comparisons. */
+static void eval_strings(const struct bench_eval *e)
+{
+  static const char *names[] = { "fido", "cityguard", "mayor", "beggar" };
+  int n;
+
+  set_var("class", "warrior");
+  set_var("flag", "0");
+  for (n = 0; n < 20; n++) {
+    set_var("name", names[n % 4]);
+    if (do_cond(e, "%name% == fido || %name% /= guard"))
+      do_eval(e, "hits", "%name% != mayor");
+    if (do_cond(e, "%class% != thief && !%flag%"))
+      do_eval(e, "flag", "%name% == beggar");
+  }
+}
+
+/* A time trigger checking the clock each hour of the day. */
+static void eval_clock(const struct bench_eval *e)
+{
+  char hour[16];
+  int h;
+
+  for (h = 0; h < 24; h++) {
+    snprintf(hour, sizeof(hour), "%d", h);
+    set_var("hour", hour);
+    if (do_cond(e, "%hour% >= 6 && %hour% < 20"))
+      do_eval(e, "light", "(%hour% - 6) * 100 / 14");
+    else
+      do_eval(e, "light", "0");
+    do_cond(e, "(%hour% == 0) || (%hour% == 12)");
+  }
+}
+
+static const struct {
+  const char *name;
+  void (*run)(const struct bench_eval *e);
+} scripts[] = {
+  { "while loop", eval_loop },
+  { "damage",     eval_damage },
+  { "strings",    eval_strings },
+  { "clock",      eval_clock },
+};
+
+#define NUM_SCRIPTS (int)(sizeof(scripts) / sizeof(scripts[0]))
+
+static double run(const struct bench_eval *e, int script, int runs)
+{
+  struct timeval start, end;
+  int i;
+
+  num_vars = 0;
+  digest = 0;
+  exprs = 0;
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < runs; i++)
+    scripts[script].run(e);
+  gettimeofday(&end, NULL);
+
+  return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_usec - start.tv_usec) / 1000.0;
+}
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? atoi(argv[1]) : 20000;
+  unsigned long digests[2];
+  double ms[2], total[2] = { 0, 0 };
+  int i, s, fail = 0;
+
+  printf("%d runs of each script\n", runs);
+  for (s = 0; s < NUM_SCRIPTS; s++) {
+    printf("  %s:\n", scripts[s].name);
+    for (i = 0; i < 2; i++) {
+      ms[i] = run(&evals[i], s, runs);
+      digests[i] = digest;
+      total[i] += ms[i];
+      printf("    %-13s %9.1f ms  (%ld expressions, %.0f ns each)\n",
+             evals[i].name, ms[i], exprs, ms[i] * 1e6 / exprs);
+    }
+    if (digests[0] != digests[1]) {
+      printf("    FAIL: the evaluators' answers differ\n");
+      fail = 1;
+    } else
+      printf("    answers identical, speedup %.2fx\n", ms[0] / ms[1]);
+  }
+  printf("  all scripts: %.1f ms vs %.1f ms, speedup %.2fx\n", total[0], total[1], total[0] / total[1]);
+  return (fail);
+}
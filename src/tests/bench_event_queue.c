@@ -0,0 +1,237 @@
+/* tests/bench_event_queue.c — DG event queue: bucketed sorted lists vs timing wheel
+ *
+ * Keeps a fixed number of events outstanding (100k by default) and runs the
+ * game's pulse loop over them: every expired event is re-armed with a new
+ * random delay, and a few events are cancelled and recreated each pulse the
+ * way wait triggers and mud events are.  The old queue from dg_event.c is
+ * reproduced here verbatim as the baseline; the new one is linked from
+ * dg_event.o.  Both runs use the same random stream and must fire the same
+ * events in the same order.
+ *
+ * Usage: bench_event_queue [outstanding events] [pulses]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "dg_event.h"
+#include "mud_event.h"
+
+/* --- Globals and functions dg_event.o expects from the rest of the game --- */
+unsigned long pulse = 0;
+
+void basic_mud_log(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void free_mud_event(struct mud_event_data *pMudEvent) {
+  (void)pMudEvent;
+}
+
+/* --- The previous queue: NUM_EVENT_QUEUES buckets of sorted lists --- */
+#define OLD_EVENT_QUEUES 10
+
+struct old_queue {
+  struct q_element *head[OLD_EVENT_QUEUES];
+  struct q_element *tail[OLD_EVENT_QUEUES];
+};
+
+static struct q_element *old_enq(struct old_queue *q, void *data, long key) {
+  struct q_element *qe, *i;
+  int bucket;
+
+  CREATE(qe, struct q_element, 1);
+  qe->data = data;
+  qe->key = key;
+
+  bucket = key % OLD_EVENT_QUEUES;
+
+  if (!q->head[bucket]) {
+    q->head[bucket] = qe;
+    q->tail[bucket] = qe;
+  } else {
+    for (i = q->tail[bucket]; i; i = i->prev) {
+      if (i->key < key) {
+        if (i == q->tail[bucket])
+          q->tail[bucket] = qe;
+        else {
+          qe->next = i->next;
+          i->next->prev = qe;
+        }
+        qe->prev = i;
+        i->next = qe;
+        break;
+      }
+    }
+    if (i == NULL) {
+      qe->next = q->head[bucket];
+      q->head[bucket] = qe;
+      qe->next->prev = qe;
+    }
+  }
+  return qe;
+}
+
+static void old_deq(struct old_queue *q, struct q_element *qe) {
+  int i = qe->key % OLD_EVENT_QUEUES;
+
+  if (qe->prev == NULL)
+    q->head[i] = qe->next;
+  else
+    qe->prev->next = qe->next;
+
+  if (qe->next == NULL)
+    q->tail[i] = qe->prev;
+  else
+    qe->next->prev = qe->prev;
+
+  free(qe);
+}
+
+static void *old_head(struct old_queue *q) {
+  int i = pulse % OLD_EVENT_QUEUES;
+  void *data;
+
+  if (!q->head[i])
+    return NULL;
+  data = q->head[i]->data;
+  old_deq(q, q->head[i]);
+  return data;
+}
+
+static long old_key(struct old_queue *q) {
+  int i = pulse % OLD_EVENT_QUEUES;
+
+  return q->head[i] ? q->head[i]->key : LONG_MAX;
+}
+
+/* --- Workload --- */
+struct bench_ops {
+  const char *name;
+  void *(*init)(void);
+  struct q_element *(*enq)(void *q, void *data, long key);
+  void (*deq)(void *q, struct q_element *qe);
+  void *(*head)(void *q);
+  long (*key)(void *q);
+  void (*done)(void *q);
+};
+
+static void *w_old_init(void) { struct old_queue *q; CREATE(q, struct old_queue, 1); return q; }
+static struct q_element *w_old_enq(void *q, void *d, long k) { return old_enq(q, d, k); }
+static void w_old_deq(void *q, struct q_element *qe) { old_deq(q, qe); }
+static void *w_old_head(void *q) { return old_head(q); }
+static long w_old_key(void *q) { return old_key(q); }
+static void w_old_done(void *q) { free(q); }
+
+static void *w_new_init(void) { return queue_init(); }
+static struct q_element *w_new_enq(void *q, void *d, long k) { return queue_enq(q, d, k); }
+static void w_new_deq(void *q, struct q_element *qe) { queue_deq(q, qe); }
+static void *w_new_head(void *q) { return queue_head(q); }
+static long w_new_key(void *q) { return queue_key(q); }
+static void w_new_done(void *q) { queue_free(q); }
+
+static const struct bench_ops ops[] = {
+  { "sorted buckets", w_old_init, w_old_enq, w_old_deq, w_old_head, w_old_key, w_old_done },
+  { "timing wheel",   w_new_init, w_new_enq, w_new_deq, w_new_head, w_new_key, w_new_done },
+};
+
+static unsigned long rng_state;
+
+static unsigned long rng(void) {
+  rng_state = rng_state * 6364136223846793005UL + 1442695040888963407UL;
+  return rng_state >> 33;
+}
+
+/* Mostly short waits (a few seconds), some up to ten minutes, a few of a
+ * day or more, like wait triggers and mud events in a live game. */
+static long delay(void) {
+  unsigned long r = rng() % 100;
+
+  if (r < 70)
+    return 1 + rng() % 100;
+  if (r < 98)
+    return 1 + rng() % 6000;
+  return 1 + rng() % 1000000;
+}
+
+static double run(const struct bench_ops *o, int n, int pulses, unsigned long *fired, unsigned long *order) {
+  struct q_element **handle;
+  struct timeval start, end;
+  long *ids;
+  void *q;
+  int i, p, victim;
+
+  CREATE(handle, struct q_element *, n);
+  CREATE(ids, long, n);
+
+  rng_state = 42;
+  pulse = 0;
+  *fired = 0;
+  *order = 0;
+
+  gettimeofday(&start, NULL);
+
+  q = o->init();
+  for (i = 0; i < n; i++) {
+    ids[i] = i;
+    handle[i] = o->enq(q, &ids[i], pulse + delay());
+  }
+
+  for (p = 0; p < pulses; p++) {
+    pulse++;
+
+    while ((long) pulse >= o->key(q)) {
+      long *id = o->head(q);
+
+      (*fired)++;
+      *order = *order * 31 + *id;
+      handle[*id] = o->enq(q, id, pulse + delay());
+    }
+
+    /* cancel and recreate a few, like extracting a scripted mob */
+    for (i = 0; i < 20; i++) {
+      victim = rng() % n;
+      o->deq(q, handle[victim]);
+      handle[victim] = o->enq(q, &ids[victim], pulse + delay());
+    }
+  }
+
+  gettimeofday(&end, NULL);
+
+  /* Not timed: empty the queue. */
+  for (i = 0; i < n; i++)
+    o->deq(q, handle[i]);
+  o->done(q);
+  free(handle);
+  free(ids);
+
+  return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_usec - start.tv_usec) / 1000.0;
+}
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  int pulses = argc > 2 ? atoi(argv[2]) : 200;
+  unsigned long fired[2], order[2];
+  double ms[2];
+  int i;
+
+  printf("%d outstanding events, %d pulses\n", n, pulses);
+  for (i = 0; i < 2; i++) {
+    ms[i] = run(&ops[i], n, pulses, &fired[i], &order[i]);
+    printf("  %-15s %10.1f ms  (%lu fired, %.3f us per pulse)\n",
+           ops[i].name, ms[i], fired[i], ms[i] * 1000.0 / pulses);
+  }
+
+  if (fired[0] != fired[1] || order[0] != order[1]) {
+    printf("FAIL: firing order differs between queues\n");
+    return 1;
+  }
+  printf("  firing order identical, speedup %.1fx\n", ms[0] / ms[1]);
+  return 0;
+}
@@ -0,0 +1,155 @@
+/* tests/bench_input_scan.c — input scanning speed, vector scans against
+ * the byte-at-a-time loops
+ *
+ * Builds a buffer of typical player input: short commands and the odd long
+ * line of chat, each ended with CR LF, with no telnet sequences.  Times
+ * ProtocolInput()'s hunt for IAC in each line, and the newline search and
+ * line copy process_input() does over it, each as before and with the
+ * scanners, and reports MB/s.
+ *
+ * Usage: bench_input_scan [passes]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "input_scan.h"
+
+#define BUF_SIZE  (256 * 1024)
+
+static char buf[BUF_SIZE];
+static size_t line_start[BUF_SIZE / 3 + 2], num_lines;
+static volatile size_t sink;
+
+static const char *lines[] = {
+  "look", "n", "kill guard", "get all corpse", "say hello there",
+  "gossip anyone want to group up for the dragon? we need a healer and a tank",
+  "cast 'magic missile' orc", "score", "tell bob meet me at the fountain",
+};
+
+static double now_usec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+/* --- The loops the scanners replaced --- */
+static size_t byte_telnet_plain(const char *p, size_t len) {
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if ((unsigned char)p[i] == 255 || p[i] == 27 || p[i] == '\0')
+      break;
+  return i;
+}
+
+static size_t byte_newline(const char *p, size_t len) {
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if (ISNEWL(p[i]))
+      break;
+  return i;
+}
+
+static const char *byte_copy_line(const char *src, const char *end, char *dst, size_t *left) {
+  char *w = dst;
+
+  for (; *left > 1 && src < end; src++) {
+    if (*src == '\b' || *src == 127) {
+      if (w > dst) {
+        if (*(--w) == '$') {
+          w--;
+          *left += 2;
+        } else
+          (*left)++;
+      }
+    } else if (isascii(*src) && isprint(*src)) {
+      if ((*(w++) = *src) == '$') {
+        *(w++) = '$';
+        *left -= 2;
+      } else
+        (*left)--;
+    }
+  }
+  *w = '\0';
+  return src;
+}
+
+/* Each line through ProtocolInput()'s scan, as if it came in a read of its
+ * own, which is how players' commands usually arrive. */
+static size_t pass_telnet(size_t (*scan)(const char *, size_t)) {
+  size_t k, n = 0;
+
+  for (k = 0; k < num_lines; k++)
+    n += scan(buf + line_start[k], line_start[k + 1] - line_start[k]);
+  return n;
+}
+
+/* Line by line, as process_input() splits and copies them. */
+static size_t pass_lines(size_t (*scan)(const char *, size_t),
+                         const char *(*copy)(const char *, const char *, char *, size_t *)) {
+  char tmp[MAX_INPUT_LENGTH];
+  const char *p = buf, *end = buf + BUF_SIZE, *nl;
+  size_t n = 0, left;
+
+  while (p < end) {
+    nl = p + scan(p, end - p);
+    left = MAX_INPUT_LENGTH - 1;
+    copy(p, nl, tmp, &left);
+    n += left;
+    while (nl < end && ISNEWL(*nl))
+      nl++;
+    p = nl;
+  }
+  return n;
+}
+
+static double mb_per_sec(double usec, int passes) {
+  return (double) BUF_SIZE * passes / usec;
+}
+
+int main(int argc, char **argv) {
+  int passes = argc > 1 ? atoi(argv[1]) : 500, p;
+  size_t i = 0, len;
+  double start, bytewise, vector;
+
+  while (i < BUF_SIZE) {
+    const char *line = lines[rand() % (sizeof(lines) / sizeof(lines[0]))];
+    line_start[num_lines++] = i;
+    for (len = 0; line[len] && i < BUF_SIZE; len++)
+      buf[i++] = line[len];
+    if (i < BUF_SIZE)
+      buf[i++] = '\r';
+    if (i < BUF_SIZE)
+      buf[i++] = '\n';
+  }
+  line_start[num_lines] = BUF_SIZE;
+
+  printf("Input scanning over %d KB of commands, %d passes (scanners: %s)\n",
+         BUF_SIZE / 1024, passes, input_scan_method());
+  printf("%-20s %14s %14s\n", "", "bytewise MB/s", "scan MB/s");
+
+  start = now_usec();
+  for (p = 0; p < passes; p++)
+    sink += pass_telnet(byte_telnet_plain);
+  bytewise = now_usec() - start;
+  start = now_usec();
+  for (p = 0; p < passes; p++)
+    sink += pass_telnet(scan_telnet_plain);
+  vector = now_usec() - start;
+  printf("%-20s %14.0f %14.0f\n", "telnet pass-through", mb_per_sec(bytewise, passes), mb_per_sec(vector, passes));
+
+  start = now_usec();
+  for (p = 0; p < passes; p++)
+    sink += pass_lines(byte_newline, byte_copy_line);
+  bytewise = now_usec() - start;
+  start = now_usec();
+  for (p = 0; p < passes; p++)
+    sink += pass_lines(scan_newline, input_copy_line);
+  vector = now_usec() - start;
+  printf("%-20s %14.0f %14.0f\n", "split and copy lines", mb_per_sec(bytewise, passes), mb_per_sec(vector, passes));
+
+  return 0;
+}
@@ -0,0 +1,281 @@
+/* tests/bench_netio.c — game thread time spent on socket I/O per pulse,
+ * with and without the network thread
+ *
+ * Opens N loopback connections.  Each pulse every client sends a command
+ * line, the pulse's wait goes by, and then the "game thread" does what
+ * game_loop() does with the sockets: reads what came in and answers each
+ * line with REPLY_BYTES of output.  Done once straight on the sockets, via
+ * the poller, and once through the network thread's rings.  Only that part
+ * of the pulse is timed; a separate thread reads and throws away the output
+ * on the client side.
+ *
+ * Usage: bench_netio [pulses] [max connections]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "structs.h"
+#include "utils.h"
+#include "poller.h"
+#include "netio.h"
+
+#define REPLY_BYTES  1024
+#define PULSE_USEC   10000
+
+static const int sizes[] = { 50, 100, 250, 500, 1000, 2000 };
+
+static char reply[REPLY_BYTES];
+static volatile int client_stop;
+
+/* --- What netio.o expects from the rest of the game --- */
+void basic_mud_log(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+static double now_usec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static socket_t open_listener(struct sockaddr_in *sa) {
+  socklen_t len = sizeof(*sa);
+  socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+  int opt = 1;
+
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char *) &opt, sizeof(opt));
+  memset(sa, 0, sizeof(*sa));
+  sa->sin_family = AF_INET;
+  sa->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sa->sin_port = 0;
+  if (bind(s, (struct sockaddr *) sa, sizeof(*sa)) < 0 || listen(s, 1024) < 0) {
+    perror("bench_netio: listen");
+    exit(1);
+  }
+  getsockname(s, (struct sockaddr *) sa, &len);
+  return s;
+}
+
+static void nonblock(socket_t s) {
+  fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+}
+
+/* Connect n clients; server ends go to srv[], client ends to cli[]. */
+static int open_pairs(socket_t lsn, struct sockaddr_in *sa, socket_t *srv, socket_t *cli, int n) {
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if ((cli[i] = socket(AF_INET, SOCK_STREAM, 0)) < 0 ||
+        connect(cli[i], (struct sockaddr *) sa, sizeof(*sa)) < 0 ||
+        (srv[i] = accept(lsn, NULL, NULL)) < 0) {
+      perror("bench_netio: connect");
+      return i;
+    }
+    nonblock(srv[i]);
+    nonblock(cli[i]);
+  }
+  return n;
+}
+
+/* The players: read and discard whatever the game sends. */
+struct clients { socket_t *cli; int n; };
+
+static void *client_main(void *arg) {
+  struct clients *c = arg;
+  struct epoll_event ev, events[256];
+  char buf[16384];
+  int ep = epoll_create1(0), i, n;
+
+  for (i = 0; i < c->n; i++) {
+    ev.events = EPOLLIN;
+    ev.data.fd = c->cli[i];
+    epoll_ctl(ep, EPOLL_CTL_ADD, c->cli[i], &ev);
+  }
+  while (!client_stop) {
+    n = epoll_wait(ep, events, 256, 10);
+    for (i = 0; i < n; i++)
+      while (read(events[i].data.fd, buf, sizeof(buf)) > 0)
+        ;
+  }
+  close(ep);
+  return NULL;
+}
+
+static void send_commands(socket_t *cli, int n) {
+  int i;
+
+  for (i = 0; i < n; i++)
+    if (write(cli[i], "look\r\n", 6) < 0 && errno != EAGAIN)
+      perror("bench_netio: client write");
+}
+
+static int count_lines(const char *buf, ssize_t len) {
+  int lines = 0;
+
+  while (len-- > 0)
+    lines += (*buf++ == '\n');
+  return lines;
+}
+
+/* game_loop()'s socket work, straight on the sockets.  Returns average
+ * microseconds per pulse. */
+static double run_direct(socket_t lsn, socket_t *srv, socket_t *cli, int n, int pulses) {
+  struct poll_event *events = calloc(n + 1, sizeof(struct poll_event));
+  struct timeval zero = { 0, 0 };
+  int *ready = calloc(n, sizeof(int));
+  char buf[4096];
+  double start, elapsed = 0;
+  ssize_t got;
+  int i, p, k, num, lines;
+
+  poller_open(POLLER_DEFAULT);
+  poller_add_listener(lsn);
+  for (i = 0; i < n; i++)
+    poller_add(srv[i], &ready[i]);
+
+  for (p = 0; p < pulses; p++) {
+    send_commands(cli, n);
+    usleep(PULSE_USEC);
+
+    start = now_usec();
+    num = poller_wait(events, n + 1, &zero);
+    for (k = 0; k < num; k++)
+      if (events[k].data)
+        *(int *) events[k].data |= events[k].ready;
+    for (i = 0; i < n; i++) {
+      lines = 0;
+      if (ready[i] & POLL_READ) {
+        while ((got = read(srv[i], buf, sizeof(buf))) > 0)
+          lines += count_lines(buf, got);
+        ready[i] &= ~POLL_READ;
+      }
+      while (lines-- > 0 && (ready[i] & POLL_WRITE))
+        if (write(srv[i], reply, REPLY_BYTES) < REPLY_BYTES)
+          ready[i] &= ~POLL_WRITE;
+    }
+    elapsed += now_usec() - start;
+  }
+
+  poller_close();
+  free(events);
+  free(ready);
+  return elapsed / pulses;
+}
+
+/* The same through the network thread, or -1 if there isn't one here.
+ * Stopping the thread closes srv[], as the connections were detached. */
+static double run_netio(socket_t *srv, socket_t *cli, int n, int pulses) {
+  struct netio_conn **conns;
+  struct iovec iov;
+  char buf[4096];
+  double start, elapsed = 0;
+  ssize_t got;
+  int i, p, lines, ready;
+
+  if (!netio_start())
+    return -1;
+  conns = calloc(n, sizeof(struct netio_conn *));
+  for (i = 0; i < n; i++)
+    conns[i] = netio_attach(srv[i]);
+  netio_kick();
+  iov.iov_base = reply;
+  iov.iov_len = REPLY_BYTES;
+
+  for (p = 0; p < pulses; p++) {
+    send_commands(cli, n);
+    usleep(PULSE_USEC);
+
+    start = now_usec();
+    for (i = 0; i < n; i++) {
+      lines = 0;
+      ready = netio_ready(conns[i]);
+      if (ready & POLL_READ)
+        while ((got = netio_read(conns[i], buf, sizeof(buf))) > 0)
+          lines += count_lines(buf, got);
+      while (lines-- > 0 && (ready & POLL_WRITE))
+        if (netio_writev(conns[i], &iov, 1) < REPLY_BYTES)
+          ready &= ~POLL_WRITE;
+    }
+    netio_kick();
+    elapsed += now_usec() - start;
+  }
+
+  for (i = 0; i < n; i++)
+    netio_detach(conns[i]);
+  netio_stop();
+  free(conns);
+  return elapsed / pulses;
+}
+
+int main(int argc, char **argv) {
+  int pulses = argc > 1 ? atoi(argv[1]) : 200;
+  int max_conn = argc > 2 ? atoi(argv[2]) : 2000;
+  struct sockaddr_in sa;
+  struct rlimit rl;
+  struct clients clients;
+  pthread_t tid;
+  socket_t lsn, *srv, *cli;
+  double direct, threaded;
+  size_t k;
+  int i, n;
+
+  getrlimit(RLIMIT_NOFILE, &rl);
+  rl.rlim_cur = rl.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &rl);
+  signal(SIGPIPE, SIG_IGN);
+  memset(reply, 'x', sizeof(reply));
+
+  lsn = open_listener(&sa);
+  srv = calloc(max_conn, sizeof(socket_t));
+  cli = calloc(max_conn, sizeof(socket_t));
+
+  printf("Game thread socket I/O per %d msec pulse over %d pulses\n", PULSE_USEC / 1000, pulses);
+  printf("(one command in and %d bytes out per connection per pulse)\n", REPLY_BYTES);
+  printf("%8s %16s %16s\n", "conns", "game loop us", "net thread us");
+
+  for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]) && sizes[k] <= max_conn; k++) {
+    if ((n = open_pairs(lsn, &sa, srv, cli, sizes[k])) < sizes[k]) {
+      printf("%8d  (could only open %d connections, stopping)\n", sizes[k], n);
+      for (i = 0; i < n; i++) {
+        close(srv[i]);
+        close(cli[i]);
+      }
+      break;
+    }
+
+    client_stop = 0;
+    clients.cli = cli;
+    clients.n = n;
+    pthread_create(&tid, NULL, client_main, &clients);
+
+    direct = run_direct(lsn, srv, cli, n, pulses);
+    threaded = run_netio(srv, cli, n, pulses);
+    if (threaded < 0)
+      printf("%8d %16.1f %16s\n", n, direct, "n/a");
+    else
+      printf("%8d %16.1f %16.1f\n", n, direct, threaded);
+
+    client_stop = 1;
+    pthread_join(tid, NULL);
+    for (i = 0; i < n; i++) {
+      close(cli[i]);
+      if (threaded < 0)
+        close(srv[i]);
+    }
+  }
+
+  close(lsn);
+  free(srv);
+  free(cli);
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* tests/bench_poller.c — per-pulse socket polling cost, select() vs epoll()
+ *
+ * Opens N idle loopback connections, registers the server side of each with
+ * the poller exactly as game_loop() does, then times the zero-timeout poll
+ * that runs once per pulse.  select() is skipped once the descriptors no
+ * longer fit in an fd_set.
+ *
+ * Usage: bench_poller [pulses] [max connections]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "poller.h"
+
+static const int sizes[] = { 100, 250, 500, 1000, 2000, 4000, 8000 };
+
+static double now_usec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static socket_t open_listener(struct sockaddr_in *sa) {
+  socklen_t len = sizeof(*sa);
+  socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+  int opt = 1;
+
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char *) &opt, sizeof(opt));
+  memset(sa, 0, sizeof(*sa));
+  sa->sin_family = AF_INET;
+  sa->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sa->sin_port = 0;
+  if (bind(s, (struct sockaddr *) sa, sizeof(*sa)) < 0 || listen(s, 1024) < 0) {
+    perror("bench_poller: listen");
+    exit(1);
+  }
+  getsockname(s, (struct sockaddr *) sa, &len);
+  return s;
+}
+
+/* Connect n clients; server ends go to srv[], client ends to cli[]. */
+static int open_pairs(socket_t lsn, struct sockaddr_in *sa, socket_t *srv, socket_t *cli, int n) {
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if ((cli[i] = socket(AF_INET, SOCK_STREAM, 0)) < 0 ||
+        connect(cli[i], (struct sockaddr *) sa, sizeof(*sa)) < 0 ||
+        (srv[i] = accept(lsn, NULL, NULL)) < 0) {
+      perror("bench_poller: connect");
+      return i;
+    }
+    fcntl(srv[i], F_SETFL, fcntl(srv[i], F_GETFL, 0) | O_NONBLOCK);
+  }
+  return n;
+}
+
+/* Returns average microseconds per pulse, or -1 if the backend can't run. */
+static double run(int backend, socket_t lsn, socket_t *srv, int n, int pulses) {
+  struct poll_event *events = calloc(n + 1, sizeof(struct poll_event));
+  struct timeval zero = { 0, 0 };
+  double start, elapsed;
+  int i;
+
+  if (poller_open(backend) != backend || poller_add_listener(lsn) < 0) {
+    free(events);
+    return -1;
+  }
+  for (i = 0; i < n; i++)
+    if (poller_add(srv[i], &srv[i]) < 0) {
+      poller_close();
+      free(events);
+      return -1;
+    }
+
+  /* First poll reports every socket as writable; the game does this once. */
+  poller_wait(events, n + 1, &zero);
+
+  start = now_usec();
+  for (i = 0; i < pulses; i++)
+    poller_wait(events, n + 1, &zero);
+  elapsed = now_usec() - start;
+
+  poller_close();
+  free(events);
+  return elapsed / pulses;
+}
+
+int main(int argc, char **argv) {
+  int pulses = argc > 1 ? atoi(argv[1]) : 1000;
+  int max_conn = argc > 2 ? atoi(argv[2]) : 4000;
+  struct sockaddr_in sa;
+  struct rlimit rl;
+  socket_t lsn, *srv, *cli;
+  size_t k;
+  int i, n;
+
+  /* two descriptors per connection */
+  getrlimit(RLIMIT_NOFILE, &rl);
+  rl.rlim_cur = rl.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &rl);
+
+  lsn = open_listener(&sa);
+  srv = calloc(max_conn, sizeof(socket_t));
+  cli = calloc(max_conn, sizeof(socket_t));
+
+  printf("Per-pulse poll cost over %d pulses (idle loopback connections)\n", pulses);
+  printf("%8s %14s %14s\n", "conns", "select us", "epoll us");
+
+  for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]) && sizes[k] <= max_conn; k++) {
+    double sel, ep;
+
+    if ((n = open_pairs(lsn, &sa, srv, cli, sizes[k])) < sizes[k]) {
+      printf("%8d  (could only open %d connections, stopping)\n", sizes[k], n);
+      for (i = 0; i < n; i++) {
+        close(srv[i]);
+        close(cli[i]);
+      }
+      break;
+    }
+
+    sel = run(POLLER_SELECT, lsn, srv, n, pulses);
+    ep = run(POLLER_EPOLL, lsn, srv, n, pulses);
+
+    printf("%8d", n);
+    if (sel < 0)
+      printf(" %14s", "n/a");
+    else
+      printf(" %14.2f", sel);
+    if (ep < 0)
+      printf(" %14s\n", "n/a");
+    else
+      printf(" %14.2f\n", ep);
+
+    for (i = 0; i < n; i++) {
+      close(srv[i]);
+      close(cli[i]);
+    }
+  }
+
+  close(lsn);
+  free(srv);
+  free(cli);
+  return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+# tests/check_dg_corpus.sh — compiled DG scripts must behave like the text engine
+#
+# Boots the world in syntax-check mode with -t, which runs every trigger in
+# lib/world/trg and in tests/dg_corpus.toml twice, once from the trigger text
+# and once from its compiled form, and compares everything the two runs did.
+# Run from src/ after building ../bin/check_dg_corpus (make check_dg), the
+# game built with the corpus hooks in the script driver.
+#
+# Usage: tests/check_dg_corpus.sh [corpus.toml] [extra circle args...]
+
+CORPUS=${1:-tests/dg_corpus.toml}
+[ $# -gt 0 ] && shift
+
+# circle changes into lib/ before reading the corpus.
+case "$CORPUS" in
+  /*) ;;
+  *) CORPUS="`pwd`/$CORPUS" ;;
+esac
+
+cd .. || exit 1
+
+out=`bin/check_dg_corpus -t "$CORPUS" "$@" 2>&1`
+status=$?
+echo "$out" | grep 'DG corpus:'
+
+if [ $status -ne 0 ]; then
+  echo "FAIL: the script engines disagree (or the corpus did not run)"
+  exit 1
+fi
+echo "OK: identical runs"
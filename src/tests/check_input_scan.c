@@ -0,0 +1,133 @@
+/* tests/check_input_scan.c — the input scanners against byte-at-a-time loops
+ *
+ * Fills buffers with random bytes, weighted towards the ones the scanners
+ * stop at, and checks each scan from random offsets and lengths (so loads
+ * straddle every alignment and the scalar tail is exercised) against the
+ * loops process_input() and ProtocolInput() used before.  input_copy_line()
+ * is checked the same way against the old line-cleaning loop, for lines
+ * longer and shorter than a command line.
+ *
+ * Usage: check_input_scan [rounds]
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "input_scan.h"
+
+#define BUF_SIZE  600
+
+static int failed = 0;
+
+#define CHECK(cond, ...) do { \
+  if (!(cond) && failed++ < 20) { printf("FAIL: " __VA_ARGS__); putchar('\n'); } \
+} while (0)
+
+/* --- The loops the scanners replaced --- */
+static size_t ref_telnet_plain(const char *buf, size_t len) {
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if ((unsigned char)buf[i] == 255 || buf[i] == 27 || buf[i] == '\0')
+      break;
+  return i;
+}
+
+static size_t ref_newline(const char *buf, size_t len) {
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if (ISNEWL(buf[i]))
+      break;
+  return i;
+}
+
+static size_t ref_clean_text(const char *buf, size_t len) {
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if (!isascii(buf[i]) || !isprint(buf[i]) || buf[i] == '$')
+      break;
+  return i;
+}
+
+static const char *ref_copy_line(const char *read_point, const char *nl_pos, char *tmp, size_t *left) {
+  char *write_point = tmp;
+  size_t space_left = *left;
+  const char *ptr;
+
+  for (ptr = read_point; (space_left > 1) && (ptr < nl_pos); ptr++) {
+    if (*ptr == '\b' || *ptr == 127) {
+      if (write_point > tmp) {
+        if (*(--write_point) == '$') {
+          write_point--;
+          space_left += 2;
+        } else
+          space_left++;
+      }
+    } else if (isascii(*ptr) && isprint(*ptr)) {
+      if ((*(write_point++) = *ptr) == '$') {
+        *(write_point++) = '$';
+        space_left -= 2;
+      } else
+        space_left--;
+    }
+  }
+  *write_point = '\0';
+  *left = space_left;
+  return ptr;
+}
+
+/* Mostly plain text, with a sprinkling of everything else. */
+static void fill(char *buf, size_t len) {
+  static const char special[] = { '\r', '\n', '\b', 127, '$', 27, 0, (char)255, (char)200, 7 };
+  size_t i;
+  int odds = 2 + rand() % 60;
+
+  for (i = 0; i < len; i++) {
+    if (rand() % odds == 0)
+      buf[i] = special[rand() % sizeof(special)];
+    else if (rand() % 200 == 0)
+      buf[i] = (char)(rand() % 256);
+    else
+      buf[i] = ' ' + rand() % 95;
+  }
+}
+
+int main(int argc, char **argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 200000, r;
+  char buf[BUF_SIZE], got[MAX_INPUT_LENGTH * 2], want[MAX_INPUT_LENGTH * 2];
+  size_t off, len, got_left, want_left;
+  const char *got_end, *want_end;
+
+  srand(1234);
+  printf("Scanning with %s\n", input_scan_method());
+
+  for (r = 0; r < rounds; r++) {
+    fill(buf, sizeof(buf));
+    off = rand() % 64;
+    len = rand() % (sizeof(buf) - off);
+
+    CHECK(scan_telnet_plain(buf + off, len) == ref_telnet_plain(buf + off, len),
+          "scan_telnet_plain round %d off %zu len %zu", r, off, len);
+    CHECK(scan_newline(buf + off, len) == ref_newline(buf + off, len),
+          "scan_newline round %d off %zu len %zu", r, off, len);
+    CHECK(scan_clean_text(buf + off, len) == ref_clean_text(buf + off, len),
+          "scan_clean_text round %d off %zu len %zu", r, off, len);
+
+    got_left = want_left = (r & 1) ? MAX_INPUT_LENGTH - 1 : 1 + rand() % 40;
+    got_end = input_copy_line(buf + off, buf + off + len, got, &got_left);
+    want_end = ref_copy_line(buf + off, buf + off + len, want, &want_left);
+    CHECK(got_end == want_end && got_left == want_left && !strcmp(got, want),
+          "input_copy_line round %d off %zu len %zu: stopped at %td/%td, %zu/%zu left",
+          r, off, len, got_end - buf, want_end - buf, got_left, want_left);
+  }
+
+  if (failed) {
+    printf("%d failures\n", failed);
+    return 1;
+  }
+  printf("OK: input scan (%d rounds)\n", rounds);
+  return 0;
+}
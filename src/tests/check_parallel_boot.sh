@@ -0,0 +1,43 @@
+#!/bin/sh
+# tests/check_parallel_boot.sh — parallel parsing and the world image must not change the world
+#
+# Boots the world in syntax-check mode (-c) three times: from the world files
+# parsed serially, from the world files parsed on several threads (both with
+# -w, so the world image is ignored and then rewritten), and finally from the
+# world image the second boot wrote.  Compares the world digest that
+# boot_world() logs.  Run from src/ after building ../bin/circle.
+#
+# Usage: tests/check_parallel_boot.sh [threads] [extra circle args...]
+
+THREADS=${1:-8}
+[ $# -gt 0 ] && shift
+
+cd .. || exit 1
+
+digest() {
+  j=$1; shift
+  bin/circle -c -j"$j" "$@" 2>&1 | sed -n 's/.*World loaded in .*, digest \([0-9a-f]*\)\..*/\1/p'
+}
+
+serial=`digest 1 -w "$@"`
+parallel=`digest "$THREADS" -w "$@"`
+image=`digest 1 "$@"`
+
+if [ -z "$serial" ] || [ -z "$parallel" ] || [ -z "$image" ]; then
+  echo "FAIL: world did not boot (no digest logged)"
+  exit 1
+fi
+
+echo "serial (-j1):       $serial"
+echo "parallel (-j$THREADS): $parallel"
+echo "world image:        $image"
+
+if [ "$serial" != "$parallel" ]; then
+  echo "FAIL: parallel boot loaded a different world"
+  exit 1
+fi
+if [ "$serial" != "$image" ]; then
+  echo "FAIL: world image loaded a different world"
+  exit 1
+fi
+echo "OK: identical worlds"
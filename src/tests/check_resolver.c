@@ -0,0 +1,190 @@
+/* tests/check_resolver.c — background reverse lookups against a stub resolver
+ *
+ * Replaces the name servers with a stub whose answers take as long as the
+ * address says: 10.0.0.N resolves to "hostN.test" after N * 10 msec, and
+ * 10.0.1.N has no name after N * 10 msec; 10.0.2.0 and up resolve at once.
+ * Checks that a request never waits for its lookup, that slow lookups run
+ * side by side, that requests for an address already in flight share its
+ * lookup, that answers and failures are cached, that the least recently
+ * used address is the one dropped when the cache is full, and that cached
+ * names expire.
+ *
+ * Usage: check_resolver
+ */
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "resolver.h"
+
+/* --- What resolver.o expects from the rest of the game --- */
+void basic_mud_log(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+static int failed = 0;
+
+#define CHECK(cond, ...) do { \
+  if (!(cond)) { printf("FAIL: " __VA_ARGS__); putchar('\n'); failed++; } \
+} while (0)
+
+static double now_msec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+static struct in_addr make_addr(int net, int host) {
+  struct in_addr a;
+  a.s_addr = htonl((10u << 24) | ((unsigned) net << 8) | (unsigned) host);
+  return a;
+}
+
+static bool stub_lookup(struct in_addr addr, char *name, size_t len) {
+  unsigned ip = ntohl(addr.s_addr);
+  int net = (ip >> 8) & 0xffff, host = ip & 0xff;
+
+  if (net > 1) {
+    snprintf(name, len, "filler%u.test", ip & 0xffffff);
+    return TRUE;
+  }
+  usleep(host * 10000);
+  if (net == 1)
+    return FALSE;
+  snprintf(name, len, "host%d.test", host);
+  return TRUE;
+}
+
+/* --- Answers handed back by resolver_poll() --- */
+#define MAX_ANSWERS 64
+static struct { long key; char name[HOST_LENGTH + 1]; bool found; } answers[MAX_ANSWERS];
+static int num_answers = 0;
+
+static void collect(long key, struct in_addr addr, const char *name) {
+  (void) addr;
+  if (num_answers >= MAX_ANSWERS)
+    return;
+  answers[num_answers].key = key;
+  answers[num_answers].found = (name != NULL);
+  snprintf(answers[num_answers].name, sizeof(answers[0].name), "%s", name ? name : "");
+  num_answers++;
+}
+
+static void ignore(long key, struct in_addr addr, const char *name) {
+  (void) key; (void) addr; (void) name;
+}
+
+/* Poll every 10 msec, the way the game loop does, until want answers are in. */
+static void wait_for(int want, double limit_msec) {
+  double start = now_msec();
+
+  while (num_answers < want && now_msec() - start < limit_msec) {
+    resolver_poll(collect);
+    usleep(10000);
+  }
+}
+
+static const char *answer_for(long key) {
+  int i;
+
+  for (i = 0; i < num_answers; i++)
+    if (answers[i].key == key)
+      return answers[i].found ? answers[i].name : "";
+  return NULL;
+}
+
+int main(void) {
+  struct resolver_stats st;
+  char name[HOST_LENGTH + 1];
+  const char *got;
+  double start, took;
+  int i;
+
+  resolver_set_lookup(stub_lookup);
+  if (!resolver_init(RESOLVER_THREADS, RESOLVER_TTL)) {
+    printf("FAIL: no resolver threads\n");
+    return 1;
+  }
+
+  /* Slow lookups: asking must not wait, and they must overlap. */
+  start = now_msec();
+  resolver_request(make_addr(0, 20), 1);
+  resolver_request(make_addr(0, 21), 2);
+  resolver_request(make_addr(0, 22), 3);
+  resolver_request(make_addr(1, 23), 4);
+  resolver_request(make_addr(0, 20), 5);   /* shares key 1's lookup */
+  took = now_msec() - start;
+  CHECK(took < 50, "requests took %.0f msec", took);
+
+  wait_for(5, 2000);
+  took = now_msec() - start;
+  CHECK(num_answers == 5, "%d of 5 answers", num_answers);
+  CHECK(took < 2 * 230, "4 lookups of ~210 msec took %.0f msec", took);
+  got = answer_for(1);
+  CHECK(got && !strcmp(got, "host20.test"), "key 1 got %s", got ? got : "nothing");
+  got = answer_for(5);
+  CHECK(got && !strcmp(got, "host20.test"), "key 5 got %s", got ? got : "nothing");
+  got = answer_for(3);
+  CHECK(got && !strcmp(got, "host22.test"), "key 3 got %s", got ? got : "nothing");
+  got = answer_for(4);
+  CHECK(got && !*got, "key 4 got %s", got ? got : "nothing");
+
+  resolver_get_stats(&st);
+  CHECK(st.lookups == 4 && st.shared == 1 && st.failures == 1 && st.pending == 0,
+        "stats: %ld lookups, %ld shared, %ld failed, %d pending",
+        st.lookups, st.shared, st.failures, st.pending);
+
+  /* Answers and failures are both cached. */
+  CHECK(resolver_cached(make_addr(0, 21), name, sizeof(name)) == RESOLVE_FOUND &&
+        !strcmp(name, "host21.test"), "10.0.0.21 not cached");
+  CHECK(resolver_cached(make_addr(1, 23), name, sizeof(name)) == RESOLVE_NO_NAME,
+        "10.0.1.23 not cached as nameless");
+  CHECK(resolver_cached(make_addr(0, 99), name, sizeof(name)) == RESOLVE_MISS,
+        "10.0.0.99 cached without a lookup");
+
+  /* Overfill the cache by two with quick lookups, keeping 10.0.0.20 in use.
+   * 10.0.0.22 was never used and 10.0.0.21 was used before 10.0.1.23, so
+   * those two must be the ones to go. */
+  for (i = 0; i < RESOLVER_CACHE_SIZE - 2; i++) {
+    resolver_cached(make_addr(0, 20), name, sizeof(name));
+    resolver_request(make_addr(2 + i / 256, i % 256), 100 + i);
+    while (!resolver_poll(ignore))
+      usleep(100);
+  }
+  resolver_get_stats(&st);
+  CHECK(st.cached == RESOLVER_CACHE_SIZE, "%d cached, not %d", st.cached, RESOLVER_CACHE_SIZE);
+  CHECK(resolver_cached(make_addr(0, 20), name, sizeof(name)) == RESOLVE_FOUND,
+        "recently used 10.0.0.20 was dropped");
+  CHECK(resolver_cached(make_addr(1, 23), name, sizeof(name)) == RESOLVE_NO_NAME,
+        "10.0.1.23 was dropped before 10.0.0.21");
+  CHECK(resolver_cached(make_addr(0, 21), name, sizeof(name)) == RESOLVE_MISS,
+        "least recently used 10.0.0.21 was kept");
+  CHECK(resolver_cached(make_addr(0, 22), name, sizeof(name)) == RESOLVE_MISS,
+        "unused 10.0.0.22 was kept");
+
+  resolver_shutdown();
+
+  /* Names expire.  The cache keeps whole seconds, so a ttl of 1 could run
+   * out before the first check if the lookup ended just before a tick. */
+  resolver_init(RESOLVER_THREADS, 2);
+  num_answers = 0;
+  resolver_request(make_addr(0, 1), 1);
+  wait_for(1, 1000);
+  CHECK(resolver_cached(make_addr(0, 1), name, sizeof(name)) == RESOLVE_FOUND,
+        "10.0.0.1 not cached");
+  sleep(3);
+  CHECK(resolver_cached(make_addr(0, 1), name, sizeof(name)) == RESOLVE_MISS,
+        "10.0.0.1 still cached after its ttl");
+  resolver_shutdown();
+
+  if (failed)
+    return 1;
+  printf("OK: resolver\n");
+  return 0;
+}
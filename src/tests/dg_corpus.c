@@ -0,0 +1,261 @@
+/**
+* @file tests/dg_corpus.c
+* Runs every trigger under both script engines and compares what they do.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* Linked only into bin/check_dg_corpus, a build of the game with the
+* DG_CORPUS hooks compiled into the script driver, and started with
+* "check_dg_corpus -t <file>" (see src/tests/check_dg_corpus.sh).  After
+* a syntax-check boot the triggers in <file> are added to those from
+* lib/world/trg, and each one is run on a scratch mob, object or room
+* twice: once from its text (dg_text_engine) and once from the form
+* dg_compile.c built.  While dg_corpus_mode is set the driver records every
+* line it reaches, each script error, wait, game command and the variables
+* left at the end, instead of sending commands to the game or scheduling
+* waits, which are resumed at once.  Both runs start from the same random
+* seed, so any difference in the two records is a bug in the compiler.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "dg_scripts.h"
+#include "db.h"
+#include "handler.h"
+#include "toml.h"
+
+/** Waits resumed per run before giving up on a trigger that never ends. */
+#define DG_CORPUS_MAX_RESUMES 50
+
+bool dg_corpus_mode = FALSE;
+
+/* What the current run has done so far. */
+static char *trace = NULL;
+static size_t trace_len = 0, trace_size = 0;
+static bool waiting = FALSE;
+
+/** Records one thing the script driver did. */
+void dg_corpus_note(const char *format, ...)
+{
+  char line[MAX_STRING_LENGTH];
+  va_list args;
+  size_t len;
+
+  va_start(args, format);
+  vsnprintf(line, sizeof(line) - 1, format, args);
+  va_end(args);
+  len = strlen(line);
+
+  if (trace_len + len + 2 > trace_size) {
+    trace_size = MAX(trace_size * 2, trace_len + len + 2 + MAX_STRING_LENGTH);
+    RECREATE(trace, char, trace_size);
+  }
+  memcpy(trace + trace_len, line, len);
+  trace_len += len;
+  trace[trace_len++] = '\n';
+  trace[trace_len] = '\0';
+}
+
+/** Called by process_wait() in place of scheduling the wait event. */
+void dg_corpus_wait(void)
+{
+  waiting = TRUE;
+}
+
+/** Records a list of variables. */
+void dg_corpus_vars(struct trig_var_table *vars)
+{
+  struct trig_var_data *vd;
+
+  for (vd = vars ? vars->first : NULL; vd; vd = vd->next)
+    dg_corpus_note("var %s=%s (%ld)", vd->name, vd->value, vd->context);
+}
+
+/* Runs one trigger to the end on a fresh host, resuming waits at once, and
+ * returns what it did.  The caller frees the result. */
+static char *run_trigger(trig_rnum nr, int type, bool text)
+{
+  struct script_data *sc, *room_script = NULL;
+  struct cmdlist_element *cl;
+  long mob_id = max_mob_id, obj_id = max_obj_id;
+  char_data *mob = NULL;
+  obj_data *obj = NULL;
+  trig_data *trig;
+  void *go = NULL;
+  int ret, resumes;
+
+  dg_text_engine = text;
+  trace_len = 0;
+  trace_size = 0;
+  trace = NULL;
+  dg_corpus_note("trigger %d", trig_index[nr]->vnum);
+
+  /* Scripts can change their host, so each run gets a new one, with the
+   * same script id and rolled from the same seed as the last. */
+  circle_srandom(trig_index[nr]->vnum + 1);
+  CREATE(sc, struct script_data, 1);
+  switch (type) {
+    case MOB_TRIGGER:
+      go = mob = read_mobile(0, REAL);
+      char_to_room(mob, 0);
+      if (SCRIPT(mob))
+        extract_script(mob, MOB_TRIGGER);
+      SCRIPT(mob) = sc;
+      break;
+    case OBJ_TRIGGER:
+      go = obj = read_object(0, REAL);
+      obj_to_room(obj, 0);
+      if (SCRIPT(obj))
+        extract_script(obj, OBJ_TRIGGER);
+      SCRIPT(obj) = sc;
+      break;
+    case WLD_TRIGGER:
+      go = &world[0];
+      room_script = SCRIPT(&world[0]);
+      SCRIPT(&world[0]) = sc;
+      break;
+  }
+  trig = read_trigger(nr);
+  add_trigger(sc, trig, -1);
+
+  /* While loop state lives on the shared lines; start each run clean. */
+  for (cl = trig->cmdlist; cl; cl = cl->next) {
+    cl->loops = 0;
+    cl->original = NULL;
+  }
+
+  waiting = FALSE;
+  ret = script_driver(&go, trig, type, TRIG_NEW);
+  for (resumes = 0; waiting && resumes < DG_CORPUS_MAX_RESUMES; resumes++) {
+    waiting = FALSE;
+    ret = script_driver(&go, trig, type, TRIG_RESTART);
+  }
+  dg_corpus_note("return %d%s", ret, waiting ? " (still waiting)" : "");
+  dg_corpus_vars(sc->global_vars);
+
+  extract_script(go, type);
+  if (mob) {
+    extract_char(mob);
+    extract_pending_chars();
+  } else if (obj)
+    extract_obj(obj);
+  else
+    SCRIPT(&world[0]) = room_script;
+  max_mob_id = mob_id;
+  max_obj_id = obj_id;
+
+  dg_text_engine = FALSE;
+  return (trace);
+}
+
+/* Logs the first line where two runs went different ways. */
+static void report_mismatch(int vnum, const char *a, const char *b)
+{
+  size_t len_a, len_b;
+  int line = 1;
+
+  for (;; line++) {
+    len_a = strcspn(a, "\n");
+    len_b = strcspn(b, "\n");
+    if (len_a != len_b || strncmp(a, b, len_a) || !a[len_a])
+      break;
+    a += len_a + 1;
+    b += len_b + 1;
+  }
+
+  log("DG corpus: trigger %d differs at step %d:", vnum, line);
+  log("  text:     %.*s", (int)len_a, a);
+  log("  compiled: %.*s", (int)len_b, b);
+}
+
+/* Adds the triggers in path after those already loaded. */
+static bool load_corpus(const char *path)
+{
+  char errbuf[256];
+  toml_table_t *tab;
+  toml_array_t *arr;
+  FILE *fp;
+  int i, n, first = top_of_trigt;
+
+  if (!(fp = fopen(path, "r"))) {
+    log("SYSERR: DG corpus: can't open %s: %s", path, strerror(errno));
+    return (FALSE);
+  }
+  tab = toml_parse_file(fp, errbuf, sizeof(errbuf));
+  fclose(fp);
+  if (!tab) {
+    log("SYSERR: DG corpus: parsing %s: %s", path, errbuf);
+    return (FALSE);
+  }
+  if (!(arr = toml_array_in(tab, "trigger"))) {
+    log("SYSERR: DG corpus: %s has no 'trigger' array.", path);
+    toml_free(tab);
+    return (FALSE);
+  }
+
+  n = toml_array_nelem(arr);
+  RECREATE(trig_index, struct index_data *, top_of_trigt + n);
+  for (i = 0; i < n; i++)
+    parse_trigger_toml(toml_table_at(arr, i));
+  toml_free(tab);
+
+  for (i = first; i < top_of_trigt; i++)
+    dg_compile_cmdlist(trig_index[i]->proto);
+  log("DG corpus: %d trigger(s) added from %s.", top_of_trigt - first, path);
+  return (TRUE);
+}
+
+/** Runs the corpus.  The world must already be booted.
+ * @param path TOML file of extra triggers.
+ * @retval int Number of triggers the two engines disagree on, or -1 if
+ * the corpus couldn't be run. */
+int dg_corpus_run(const char *path)
+{
+  char_data *ch;
+  obj_data *obj;
+  char *text, *compiled;
+  int i, type, run = 0, mismatches = 0;
+
+  if (top_of_mobt < 0 || top_of_objt < 0 || top_of_world < 0) {
+    log("SYSERR: DG corpus: the world needs a mob, an object and a room.");
+    return (-1);
+  }
+  if (!load_corpus(path))
+    return (-1);
+
+  init_lookup_table();
+
+  /* Give everything already in the world its id now, so the order a
+   * script looks at things in can't change which ids the hosts get. */
+  for (ch = character_list; ch; ch = ch->next)
+    char_script_id(ch);
+  for (obj = object_list; obj; obj = obj->next)
+    obj_script_id(obj);
+
+  dg_corpus_mode = TRUE;
+  for (i = 0; i < top_of_trigt; i++) {
+    type = trig_index[i]->proto->attach_type;
+    if (type != MOB_TRIGGER && type != OBJ_TRIGGER && type != WLD_TRIGGER) {
+      log("DG corpus: trigger %d has unknown attach type %d; skipped.", trig_index[i]->vnum, type);
+      continue;
+    }
+
+    text = run_trigger(i, type, TRUE);
+    compiled = run_trigger(i, type, FALSE);
+    if (strcmp(text, compiled)) {
+      report_mismatch(trig_index[i]->vnum, text, compiled);
+      mismatches++;
+    }
+    free(text);
+    free(compiled);
+    run++;
+  }
+  dg_corpus_mode = FALSE;
+
+  log("DG corpus: %d trigger(s) run under both engines, %d mismatch(es).", run, mismatches);
+  return (mismatches);
+}
@@ -702,6 +702,19 @@ do                                                              \
 #define GET_QUEST_COUNTER(ch)   CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->saved.quest_counter))
 /** Time remaining to complete the quest ch is currently on. */
 #define GET_QUEST_TIME(ch)      CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->saved.quest_time))
+/** Note that something written to ch's pfile or rent file has changed, so
+ * the next autosave must write them again.  See Crash_save_all(). */
+#define MARK_CHAR_CHANGED(ch) do { \
+  if (!IS_NPC(ch) && (ch)->player_specials) \
+    (ch)->player_specials->save_gen++; \
+} while (0)
+/** TRUE if ch's pfile is known to be up to date. */
+#define PFILE_CURRENT(ch) ((ch)->player_specials->pfile_gen && \
+  (ch)->player_specials->pfile_gen == (ch)->player_specials->save_gen)
+/** TRUE if ch's rent file is known to be up to date. */
+#define CRASHFILE_CURRENT(ch) ((ch)->player_specials->crash_gen && \
+  (ch)->player_specials->crash_gen == (ch)->player_specials->save_gen)
+
 /** The number of quests completed by ch. */
 #define GET_NUM_QUESTS(ch)      CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->saved.num_completed_quests))
 /** The type of quest ch is currently participating in. */
@@ -716,6 +729,7 @@ do                                                              \
     (ch)->mob_specials.skills[(i)] = (pct); \
   else { \
     CHECK_PLAYER_SPECIAL((ch), (ch)->player_specials->saved.skills[(i)]) = (pct); \
+    MARK_CHAR_CHANGED(ch); \
   } \
 } while (0)
 /** Per-skill next gain time (epoch seconds). Index with a valid skill number. **/
@@ -1143,6 +1157,16 @@ do                                                              \
 #define CONFIG_SPECIAL_IN_COMM config_info.operation.special_in_comm
 /** Activate debug mode? */
 #define CONFIG_DEBUG_MODE config_info.operation.debug_mode
+/** Threads used to parse the world files at boot. */
+#define CONFIG_BOOT_THREADS config_info.operation.boot_threads
+/** Shards the mob AI is split into, one run per turn. */
+#define CONFIG_MOB_AI_SHARDS config_info.operation.mob_ai_shards
+/** Minutes a zone waits with no player near before going dormant. */
+#define CONFIG_DORMANCY_DELAY config_info.operation.dormancy_delay
+/** How many zones away a player keeps a zone awake. */
+#define CONFIG_DORMANCY_RADIUS config_info.operation.dormancy_radius
+/** Do socket reads and writes on the network thread? */
+#define CONFIG_NETWORK_THREAD config_info.operation.network_thread
 
 /* Autowiz */
 /** Use autowiz or not? */
@@ -0,0 +1,114 @@
+/**
+* @file vnum_index.c
+* Direct vnum to rnum lookup tables for the world prototype arrays.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "vnum_index.h"
+
+void vnum_index_clear(struct vnum_index *idx)
+{
+  int i;
+
+  if (idx->pages) {
+    for (i = 0; i < idx->num_pages; i++)
+      if (idx->pages[i])
+        free(idx->pages[i]);
+    free(idx->pages);
+  }
+  idx->pages = NULL;
+  idx->num_pages = idx->used_pages = idx->entries = 0;
+  idx->built = FALSE;
+  idx->complete = TRUE;
+}
+
+/** (Re)build an index over a whole table.
+ * @param idx The index to fill; any previous contents are freed.
+ * @param count Number of rnums in the table (0 .. count - 1).
+ * @param get Returns the vnum stored at an rnum.
+ * If a vnum appears twice the lowest rnum wins, as with a linear search. */
+void vnum_index_build(struct vnum_index *idx, IDXTYPE count, vnum_index_getter get)
+{
+  IDXTYPE rnum, vnum, max_vnum = 0;
+  IDXTYPE *page;
+  int p, i;
+
+  vnum_index_clear(idx);
+
+  for (rnum = 0; rnum < count; rnum++)
+    if ((vnum = get(rnum)) > max_vnum)
+      max_vnum = vnum;
+
+  idx->num_pages = MIN((int)(max_vnum >> VNUM_PAGE_BITS) + 1, VNUM_MAX_PAGES);
+  CREATE(idx->pages, IDXTYPE *, idx->num_pages);
+
+  for (rnum = 0; rnum < count; rnum++) {
+    vnum = get(rnum);
+#if !CIRCLE_UNSIGNED_INDEX
+    if (vnum < 0)
+      continue;
+#endif
+    if ((p = vnum >> VNUM_PAGE_BITS) >= idx->num_pages) {
+      idx->complete = FALSE;
+      continue;
+    }
+    if (!(page = idx->pages[p])) {
+      CREATE(page, IDXTYPE, VNUM_PAGE_SIZE);
+      for (i = 0; i < VNUM_PAGE_SIZE; i++)
+        page[i] = NOTHING;
+      idx->pages[p] = page;
+      idx->used_pages++;
+    }
+    if (page[vnum & VNUM_PAGE_MASK] == NOTHING) {
+      page[vnum & VNUM_PAGE_MASK] = rnum;
+      idx->entries++;
+    }
+  }
+  idx->built = TRUE;
+}
+
+/** Look up a vnum.
+ * @param idx The index.
+ * @param vnum The vnum to find.
+ * @param rnum Set to the rnum, or NOTHING if the vnum does not exist.
+ * @retval bool TRUE if the index answered; FALSE if it is not built or the
+ * vnum is beyond what it covers, and the caller has to search the table. */
+bool vnum_index_lookup(const struct vnum_index *idx, IDXTYPE vnum, IDXTYPE *rnum)
+{
+  int p;
+
+  if (!idx->built)
+    return FALSE;
+
+#if !CIRCLE_UNSIGNED_INDEX
+  if (vnum < 0) {
+    *rnum = NOTHING;
+    return TRUE;
+  }
+#endif
+
+  if ((p = vnum >> VNUM_PAGE_BITS) >= idx->num_pages) {
+    if (!idx->complete)
+      return FALSE;
+    *rnum = NOTHING;
+    return TRUE;
+  }
+
+  *rnum = idx->pages[p] ? idx->pages[p][vnum & VNUM_PAGE_MASK] : NOTHING;
+  return TRUE;
+}
+
+/** Memory held by an index, for the boot report. */
+size_t vnum_index_bytes(const struct vnum_index *idx)
+{
+  return (sizeof(IDXTYPE *) * idx->num_pages +
+          sizeof(IDXTYPE) * VNUM_PAGE_SIZE * idx->used_pages);
+}
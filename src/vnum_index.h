@@ -0,0 +1,42 @@
+/**
+* @file vnum_index.h
+* Direct vnum to rnum lookup tables for the world prototype arrays.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* Each table is a two level page table: the vnum's high bits pick a page,
+* the low bits a slot in it.  Pages are only allocated where vnums exist,
+* so a world whose zones sit far apart in vnum space stays small.  The
+* tables are rebuilt whenever the underlying array is renumbered (at boot
+* and by the OLC add/delete functions); real_room() and friends fall back
+* to searching the array while a table is not built.
+*/
+#ifndef _VNUM_INDEX_H_
+#define _VNUM_INDEX_H_
+
+#define VNUM_PAGE_BITS   7
+#define VNUM_PAGE_SIZE   (1 << VNUM_PAGE_BITS)
+#define VNUM_PAGE_MASK   (VNUM_PAGE_SIZE - 1)
+/** Vnums at or above VNUM_MAX_PAGES * VNUM_PAGE_SIZE are not indexed. */
+#define VNUM_MAX_PAGES   (1 << 17)
+
+struct vnum_index {
+  IDXTYPE **pages;   /**< pages[vnum >> VNUM_PAGE_BITS]; NULL if none used. */
+  int num_pages;     /**< Length of pages[]. */
+  int used_pages;    /**< Pages actually allocated. */
+  int entries;       /**< Vnums stored. */
+  bool built;        /**< FALSE until the first build, and after clear. */
+  bool complete;     /**< FALSE if some vnum was too large to index. */
+};
+
+/** Reads one vnum out of the table being indexed. */
+typedef IDXTYPE (*vnum_index_getter)(IDXTYPE rnum);
+
+void vnum_index_build(struct vnum_index *idx, IDXTYPE count, vnum_index_getter get);
+void vnum_index_clear(struct vnum_index *idx);
+bool vnum_index_lookup(const struct vnum_index *idx, IDXTYPE vnum, IDXTYPE *rnum);
+size_t vnum_index_bytes(const struct vnum_index *idx);
+
+#endif /* _VNUM_INDEX_H_ */
@@ -0,0 +1,907 @@
+/**
+* @file world_image.c
+* Compiled binary image of the world prototypes, used to skip the TOML
+* parse at boot when the world files have not changed.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+*/
+
+#include "conf.h"
+#include "sysdep.h"
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "db.h"
+#include "dg_scripts.h"
+#include "world_image.h"
+
+#define IMAGE_HASH_INIT   0xcbf29ce484222325ULL
+#define IMAGE_HASH_PRIME  0x100000001b3ULL
+
+/** Fixed part at the front of the file; the payload follows it. */
+struct image_header {
+  char magic[8];
+  int version;
+  int header_size;
+  unsigned long long layout;       /**< image_layout() of the writer. */
+  unsigned long long sources;      /**< image_sources() at the writer's boot. */
+  unsigned long long payload_len;
+  unsigned long long payload_hash;
+  int zones, trigs, rooms, mobs, objs;
+};
+
+struct image_writer {
+  char *buf;
+  size_t len, size;
+};
+
+struct image_reader {
+  const char *pos, *end;
+};
+
+/** Source key taken before the TOML boot, so a file edited while the boot
+ * is running leaves an image that will not match next time. */
+static unsigned long long boot_sources;
+
+static unsigned long long image_hash(unsigned long long h, const void *p, size_t n)
+{
+  const unsigned char *c = p;
+
+  while (n--) {
+    h ^= *c++;
+    h *= IMAGE_HASH_PRIME;
+  }
+  return (h);
+}
+
+static unsigned long long image_hash_int(unsigned long long h, long long v)
+{
+  return (image_hash(h, &v, sizeof(v)));
+}
+
+/** Everything about this binary that decides how the fields in an image
+ * are encoded, or what the loaders would have put in them.  The struct sizes
+ * stand in for the header changes that add or retype a field. */
+static unsigned long long image_layout(void)
+{
+  unsigned long long h = IMAGE_HASH_INIT;
+
+  h = image_hash_int(h, WORLD_IMAGE_VERSION);
+  h = image_hash_int(h, sizeof(int));
+  h = image_hash_int(h, sizeof(long));
+  h = image_hash_int(h, sizeof(struct zone_data));
+  h = image_hash_int(h, sizeof(struct reset_com));
+  h = image_hash_int(h, sizeof(struct trig_data));
+  h = image_hash_int(h, sizeof(struct room_data));
+  h = image_hash_int(h, sizeof(struct room_direction_data));
+  h = image_hash_int(h, sizeof(struct char_data));
+  h = image_hash_int(h, sizeof(struct obj_data));
+  /* Rebuilding this file (as a header change would) retires old images. */
+  h = image_hash(h, __DATE__ __TIME__, sizeof(__DATE__ __TIME__));
+  /* parse_room_toml() drops diagonal exits when they are turned off. */
+  h = image_hash_int(h, CONFIG_DIAGONAL_DIRS);
+  return (h);
+}
+
+static unsigned long long image_hash_file(unsigned long long h, const char *path)
+{
+  struct stat st;
+
+  h = image_hash(h, path, strlen(path) + 1);
+  if (stat(path, &st) < 0)
+    return (image_hash_int(h, -1));
+  h = image_hash_int(h, st.st_size);
+  return (image_hash_int(h, st.st_mtime));
+}
+
+/** Hash the name, size and mtime of every index file and every world file
+ * they list, for the tables the image holds. */
+static unsigned long long image_sources(void)
+{
+  const char *prefixes[] = { ZON_PREFIX, TRG_PREFIX, WLD_PREFIX, MOB_PREFIX, OBJ_PREFIX };
+  unsigned long long h = IMAGE_HASH_INIT;
+  char path[PATH_MAX];
+  char **files;
+  int i, j, count;
+
+  for (i = 0; i < (int)(sizeof(prefixes) / sizeof(prefixes[0])); i++) {
+    snprintf(path, sizeof(path), "%s%s", prefixes[i], mini_mud ? MINDEX_FILE : INDEX_FILE);
+    h = image_hash_file(h, path);
+
+    files = toml_load_index_files(path, &count);
+    for (j = 0; j < count; j++) {
+      snprintf(path, sizeof(path), "%s%s", prefixes[i], files[j]);
+      h = image_hash_file(h, path);
+      free(files[j]);
+    }
+    if (files)
+      free(files);
+  }
+  return (h);
+}
+
+static double image_elapsed_ms(const struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return ((now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_usec - start->tv_usec) / 1000.0);
+}
+
+/* --- Writing --- */
+
+static void put(struct image_writer *w, const void *p, size_t n)
+{
+  if (w->len + n > w->size) {
+    while (w->len + n > w->size)
+      w->size = w->size ? w->size * 2 : 1 << 20;
+    RECREATE(w->buf, char, w->size);
+  }
+  memcpy(w->buf + w->len, p, n);
+  w->len += n;
+}
+
+static void put_int(struct image_writer *w, int v)
+{
+  put(w, &v, sizeof(v));
+}
+
+static void put_long(struct image_writer *w, long v)
+{
+  put(w, &v, sizeof(v));
+}
+
+static void put_ints(struct image_writer *w, const int *v, int n)
+{
+  put(w, v, n * sizeof(int));
+}
+
+/** Strings are stored with their length (-1 for NULL) and terminator. */
+static void put_str(struct image_writer *w, const char *s)
+{
+  int n = s ? (int)strlen(s) : -1;
+
+  put_int(w, n);
+  if (s)
+    put(w, s, n + 1);
+}
+
+static void put_extra(struct image_writer *w, const struct extra_descr_data *ex)
+{
+  const struct extra_descr_data *e;
+  int n = 0;
+
+  for (e = ex; e; e = e->next)
+    n++;
+  put_int(w, n);
+  for (e = ex; e; e = e->next) {
+    put_str(w, e->keyword);
+    put_str(w, e->description);
+  }
+}
+
+static void put_protos(struct image_writer *w, const struct trig_proto_list *tp)
+{
+  const struct trig_proto_list *t;
+  int n = 0;
+
+  for (t = tp; t; t = t->next)
+    n++;
+  put_int(w, n);
+  for (t = tp; t; t = t->next)
+    put_int(w, t->vnum);
+}
+
+/* Only what the TOML loaders fill in is written, field by field; the
+ * reader starts each record from a cleared struct, so the runtime state
+ * (counts, links, timers, scheduling) is never carried over from the boot
+ * that wrote the image. */
+static void put_zones(struct image_writer *w)
+{
+  struct reset_com *c;
+  struct zone_data *z;
+  zone_rnum i;
+  int j;
+
+  for (i = 0; i <= top_of_zone_table; i++) {
+    z = &zone_table[i];
+    put_int(w, z->number);
+    put_str(w, z->name);
+    put_str(w, z->builders);
+    put_int(w, z->lifespan);
+    put_int(w, z->bot);
+    put_int(w, z->top);
+    put_ints(w, z->zone_flags, ZN_ARRAY_MAX);
+    put_int(w, z->min_level);
+    put_int(w, z->max_level);
+    put_int(w, z->reset_mode);
+
+    for (j = 0; z->cmd[j].command != 'S'; j++)
+      ;
+    put_int(w, j);  /* not counting the closing 'S' */
+    for (j = 0; z->cmd[j].command != 'S'; j++) {
+      c = &z->cmd[j];
+      put_int(w, c->command);
+      put_int(w, c->if_flag);
+      put_int(w, c->arg1);
+      put_int(w, c->arg2);
+      put_int(w, c->arg3);
+      put_int(w, c->line);
+      put_str(w, c->sarg1);
+      put_str(w, c->sarg2);
+    }
+  }
+}
+
+static void put_triggers(struct image_writer *w)
+{
+  struct cmdlist_element *cl;
+  struct trig_data *t;
+  int i, n;
+
+  for (i = 0; i < top_of_trigt; i++) {
+    t = trig_index[i]->proto;
+    put_int(w, trig_index[i]->vnum);
+    put_str(w, t->name);
+    put_int(w, t->attach_type);
+    put_long(w, t->trigger_type);
+    put_int(w, t->narg);
+    put_str(w, t->arglist);
+
+    for (n = 0, cl = t->cmdlist; cl; cl = cl->next)
+      n++;
+    put_int(w, n);
+    for (cl = t->cmdlist; cl; cl = cl->next)
+      put_str(w, cl->cmd);
+  }
+}
+
+static void put_rooms(struct image_writer *w)
+{
+  struct room_direction_data *d;
+  struct room_data *r;
+  struct forage_entry *f;
+  room_rnum i;
+  int j, n;
+
+  for (i = 0; i <= top_of_world; i++) {
+    r = &world[i];
+    put_int(w, r->number);
+    put_int(w, r->zone);
+    put_int(w, r->sector_type);
+    put_ints(w, r->room_flags, RF_ARRAY_MAX);
+    put_str(w, r->name);
+    put_str(w, r->description);
+    put_extra(w, r->ex_description);
+    put_protos(w, r->proto_script);
+
+    for (j = 0; j < NUM_OF_DIRS; j++) {
+      put_int(w, (d = r->dir_option[j]) != NULL);
+      if (!d)
+        continue;
+      put_str(w, d->general_description);
+      put_str(w, d->keyword);
+      put_int(w, d->exit_info);
+      put_int(w, d->key);
+      put_int(w, d->to_room);
+    }
+
+    for (n = 0, f = r->forage; f; f = f->next)
+      n++;
+    put_int(w, n);
+    for (f = r->forage; f; f = f->next) {
+      put_int(w, f->obj_vnum);
+      put_int(w, f->dc);
+    }
+  }
+}
+
+static void put_abils(struct image_writer *w, const struct char_ability_data *a)
+{
+  put_int(w, a->str);
+  put_int(w, a->intel);
+  put_int(w, a->wis);
+  put_int(w, a->dex);
+  put_int(w, a->con);
+  put_int(w, a->cha);
+}
+
+static void put_mobs(struct image_writer *w)
+{
+  struct char_data *m;
+  struct mob_loadout *lo;
+  struct skin_yield_entry *y;
+  mob_rnum i;
+  int j, n;
+
+  for (i = 0; i <= top_of_mobt; i++) {
+    m = &mob_proto[i];
+    put_int(w, mob_index[i].vnum);
+    for (n = 0, y = mob_index[i].skin_yields; y; y = y->next)
+      n++;
+    put_int(w, n);
+    for (y = mob_index[i].skin_yields; y; y = y->next) {
+      put_int(w, y->mob_vnum);
+      put_int(w, y->obj_vnum);
+      put_int(w, y->dc);
+    }
+
+    put_str(w, m->player.name);
+    put_str(w, m->player.keywords);
+    put_str(w, m->player.short_descr);
+    put_str(w, m->player.long_descr);
+    put_str(w, m->player.description);
+    put_str(w, m->player.background);
+    put_int(w, m->player.sex);
+    put_int(w, m->player.chclass);
+    put_int(w, m->player.species);
+    put_int(w, m->player.level);
+    put_int(w, m->player.roleplay_age);
+    put_int(w, m->player.weight);
+    put_int(w, m->player.height);
+    put_abils(w, &m->real_abils);
+
+    put_int(w, m->points.mana);
+    put_int(w, m->points.max_mana);
+    put_int(w, m->points.hit);
+    put_int(w, m->points.max_hit);
+    put_int(w, m->points.stamina);
+    put_int(w, m->points.max_stamina);
+    put_int(w, m->points.armor);
+    put_int(w, m->points.coins);
+    put_int(w, m->points.exp);
+
+    put_int(w, m->char_specials.position);
+    put_int(w, m->char_specials.saved.alignment);
+    put_ints(w, m->char_specials.saved.act, PM_ARRAY_MAX);
+    put_ints(w, m->char_specials.saved.affected_by, AF_ARRAY_MAX);
+    for (j = 0; j < NUM_ABILITIES; j++)
+      put_int(w, m->char_specials.saved.saving_throws[j]);
+
+    put_int(w, m->mob_specials.attack_type);
+    put_int(w, m->mob_specials.default_pos);
+    put(w, m->mob_specials.skills, sizeof(m->mob_specials.skills));
+    put_extra(w, m->mob_specials.ex_description);
+    put_protos(w, m->proto_script);
+
+    for (n = 0, lo = m->proto_loadout; lo; lo = lo->next)
+      n++;
+    put_int(w, n);
+    for (lo = m->proto_loadout; lo; lo = lo->next) {
+      put_int(w, lo->vnum);
+      put_int(w, lo->wear_pos);
+      put_int(w, lo->quantity);
+    }
+  }
+}
+
+static void put_objs(struct image_writer *w)
+{
+  struct obj_data *o;
+  obj_rnum i;
+  int j;
+
+  for (i = 0; i <= top_of_objt; i++) {
+    o = &obj_proto[i];
+    put_int(w, obj_index[i].vnum);
+    put_str(w, o->name);
+    put_str(w, o->description);
+    put_str(w, o->short_description);
+    put_str(w, o->main_description);
+    put_extra(w, o->ex_description);
+    put_protos(w, o->proto_script);
+
+    put_ints(w, o->obj_flags.value, NUM_OBJ_VAL_POSITIONS);
+    put_int(w, o->obj_flags.type_flag);
+    put_int(w, o->obj_flags.level);
+    put_ints(w, o->obj_flags.wear_flags, TW_ARRAY_MAX);
+    put_ints(w, o->obj_flags.extra_flags, EF_ARRAY_MAX);
+    put_int(w, o->obj_flags.weight);
+    put_int(w, o->obj_flags.cost);
+    put_int(w, o->obj_flags.cost_per_day);
+    put_int(w, o->obj_flags.timer);
+    put_ints(w, o->obj_flags.bitvector, AF_ARRAY_MAX);
+    for (j = 0; j < MAX_OBJ_AFFECT; j++) {
+      put_int(w, o->affected[j].location);
+      put_int(w, o->affected[j].modifier);
+    }
+  }
+}
+
+/** Write the image for the world just loaded from the TOML files.  Must be
+ * called at the end of the world boot, before anything is instantiated from
+ * the prototypes.  The file is replaced atomically. */
+void world_image_save(void)
+{
+  struct image_writer w = { NULL, 0, 0 };
+  struct image_header hdr;
+  struct timeval start;
+  char tmp[PATH_MAX];
+  FILE *fl;
+  bool ok;
+
+  gettimeofday(&start, NULL);
+
+  put_zones(&w);
+  put_triggers(&w);
+  put_rooms(&w);
+  put_mobs(&w);
+  put_objs(&w);
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, WORLD_IMAGE_MAGIC, sizeof(hdr.magic));
+  hdr.version = WORLD_IMAGE_VERSION;
+  hdr.header_size = sizeof(hdr);
+  hdr.layout = image_layout();
+  hdr.sources = boot_sources;
+  hdr.payload_len = w.len;
+  hdr.payload_hash = image_hash(IMAGE_HASH_INIT, w.buf, w.len);
+  hdr.zones = top_of_zone_table + 1;
+  hdr.trigs = top_of_trigt;
+  hdr.rooms = top_of_world + 1;
+  hdr.mobs = top_of_mobt + 1;
+  hdr.objs = top_of_objt + 1;
+
+  snprintf(tmp, sizeof(tmp), "%s.tmp", WORLD_IMAGE_FILE);
+  if (!(fl = fopen(tmp, "wb"))) {
+    log("SYSERR: Cannot write world image '%s': %s", tmp, strerror(errno));
+    free(w.buf);
+    return;
+  }
+  ok = fwrite(&hdr, sizeof(hdr), 1, fl) == 1 && fwrite(w.buf, 1, w.len, fl) == w.len;
+  if (fclose(fl) != 0)
+    ok = FALSE;
+
+  if (!ok || rename(tmp, WORLD_IMAGE_FILE) < 0) {
+    log("SYSERR: Cannot write world image '%s': %s", WORLD_IMAGE_FILE, strerror(errno));
+    remove(tmp);
+  } else
+    log("Wrote world image %s (%lu KB) in %.1f ms.", WORLD_IMAGE_FILE,
+        (unsigned long)((w.len + sizeof(hdr)) / 1024), image_elapsed_ms(&start));
+  free(w.buf);
+}
+
+/* --- Reading --- */
+
+/** The header and payload hash matched, so running off the end means the
+ * image was written by code that disagrees with this reader.  Part of the
+ * world is already built from it; get rid of the file and stop, and the
+ * next boot reads the TOML files. */
+static void image_corrupt(void)
+{
+  log("SYSERR: World image '%s' is inconsistent; removing it.", WORLD_IMAGE_FILE);
+  remove(WORLD_IMAGE_FILE);
+  exit(1);
+}
+
+static void get(struct image_reader *r, void *p, size_t n)
+{
+  if ((size_t)(r->end - r->pos) < n)
+    image_corrupt();
+  memcpy(p, r->pos, n);
+  r->pos += n;
+}
+
+static int get_int(struct image_reader *r)
+{
+  int v;
+
+  get(r, &v, sizeof(v));
+  return (v);
+}
+
+static long get_long(struct image_reader *r)
+{
+  long v;
+
+  get(r, &v, sizeof(v));
+  return (v);
+}
+
+static void get_ints(struct image_reader *r, int *v, int n)
+{
+  get(r, v, n * sizeof(int));
+}
+
+/** Strings are copied out of the image rather than pointed into it: OLC
+ * and the free_*() functions free prototype strings one by one. */
+static char *get_str(struct image_reader *r)
+{
+  char *s;
+  int n = get_int(r);
+
+  if (n < 0)
+    return (NULL);
+  if (r->end - r->pos < n + 1 || r->pos[n] != '\0')
+    image_corrupt();
+  CREATE(s, char, n + 1);
+  memcpy(s, r->pos, n + 1);
+  r->pos += n + 1;
+  return (s);
+}
+
+static struct extra_descr_data *get_extra(struct image_reader *r)
+{
+  struct extra_descr_data *head = NULL, **tail = &head;
+  int n = get_int(r);
+
+  while (n-- > 0) {
+    CREATE(*tail, struct extra_descr_data, 1);
+    (*tail)->keyword = get_str(r);
+    (*tail)->description = get_str(r);
+    tail = &(*tail)->next;
+  }
+  return (head);
+}
+
+static struct trig_proto_list *get_protos(struct image_reader *r)
+{
+  struct trig_proto_list *head = NULL, **tail = &head;
+  int n = get_int(r);
+
+  while (n-- > 0) {
+    CREATE(*tail, struct trig_proto_list, 1);
+    (*tail)->vnum = get_int(r);
+    tail = &(*tail)->next;
+  }
+  return (head);
+}
+
+static void get_zones(struct image_reader *r, int count)
+{
+  struct reset_com *c;
+  struct zone_data *z;
+  int i, j, n;
+
+  CREATE(zone_table, struct zone_data, count);
+  for (i = 0; i < count; i++) {
+    z = &zone_table[i];
+    z->number = get_int(r);
+    z->name = get_str(r);
+    z->builders = get_str(r);
+    z->lifespan = get_int(r);
+    z->bot = get_int(r);
+    z->top = get_int(r);
+    get_ints(r, z->zone_flags, ZN_ARRAY_MAX);
+    z->min_level = get_int(r);
+    z->max_level = get_int(r);
+    z->reset_mode = get_int(r);
+
+    if ((n = get_int(r)) < 0)
+      image_corrupt();
+    CREATE(z->cmd, struct reset_com, n + 1);
+    for (j = 0; j < n; j++) {
+      c = &z->cmd[j];
+      c->command = get_int(r);
+      c->if_flag = get_int(r);
+      c->arg1 = get_int(r);
+      c->arg2 = get_int(r);
+      c->arg3 = get_int(r);
+      c->line = get_int(r);
+      c->sarg1 = get_str(r);
+      c->sarg2 = get_str(r);
+      if (c->command == 'S')
+        image_corrupt();
+    }
+    z->cmd[n].command = 'S';
+  }
+  top_of_zone_table = count - 1;
+}
+
+static void get_triggers(struct image_reader *r, int count)
+{
+  struct cmdlist_element **cle;
+  struct index_data *t_index;
+  struct trig_data *trig;
+  int i, n;
+
+  CREATE(trig_index, struct index_data *, MAX(count, 1));
+  for (i = 0; i < count; i++) {
+    CREATE(t_index, struct index_data, 1);
+    CREATE(trig, struct trig_data, 1);
+    t_index->vnum = get_int(r);
+    t_index->proto = trig;
+
+    trig->nr = i;
+    trig->name = get_str(r);
+    trig->attach_type = get_int(r);
+    trig->trigger_type = get_long(r);
+    trig->narg = get_int(r);
+    trig->arglist = get_str(r);
+
+    cle = &trig->cmdlist;
+    for (n = get_int(r); n > 0; n--) {
+      CREATE(*cle, struct cmdlist_element, 1);
+      (*cle)->cmd = get_str(r);
+      cle = &(*cle)->next;
+    }
+    trig_index[i] = t_index;
+  }
+  top_of_trigt = count;
+}
+
+static void get_rooms(struct image_reader *r, int count)
+{
+  struct room_direction_data *d;
+  struct forage_entry **f;
+  struct room_data *room;
+  int i, j, n;
+
+  CREATE(world, struct room_data, count);
+  for (i = 0; i < count; i++) {
+    room = &world[i];
+    room->number = get_int(r);
+    room->zone = get_int(r);
+    room->sector_type = get_int(r);
+    get_ints(r, room->room_flags, RF_ARRAY_MAX);
+    room->name = get_str(r);
+    room->description = get_str(r);
+    room->ex_description = get_extra(r);
+    room->proto_script = get_protos(r);
+
+    for (j = 0; j < NUM_OF_DIRS; j++) {
+      if (!get_int(r))
+        continue;
+      CREATE(d, struct room_direction_data, 1);
+      d->general_description = get_str(r);
+      d->keyword = get_str(r);
+      d->exit_info = get_int(r);
+      d->key = get_int(r);
+      d->to_room = get_int(r);
+      room->dir_option[j] = d;
+    }
+
+    f = &room->forage;
+    for (n = get_int(r); n > 0; n--) {
+      CREATE(*f, struct forage_entry, 1);
+      (*f)->obj_vnum = get_int(r);
+      (*f)->dc = get_int(r);
+      f = &(*f)->next;
+    }
+  }
+  top_of_world = count - 1;
+}
+
+static void get_abils(struct image_reader *r, struct char_ability_data *a)
+{
+  a->str = get_int(r);
+  a->intel = get_int(r);
+  a->wis = get_int(r);
+  a->dex = get_int(r);
+  a->con = get_int(r);
+  a->cha = get_int(r);
+}
+
+static void get_mobs(struct image_reader *r, int count)
+{
+  struct skin_yield_entry **y;
+  struct mob_loadout **lo;
+  struct char_data *m;
+  int i, j, n;
+
+  CREATE(mob_index, struct index_data, count);
+  CREATE(mob_proto, struct char_data, count);
+  for (i = 0; i < count; i++) {
+    mob_index[i].vnum = get_int(r);
+    y = &mob_index[i].skin_yields;
+    for (n = get_int(r); n > 0; n--) {
+      CREATE(*y, struct skin_yield_entry, 1);
+      (*y)->mob_vnum = get_int(r);
+      (*y)->obj_vnum = get_int(r);
+      (*y)->dc = get_int(r);
+      y = &(*y)->next;
+    }
+
+    /* Everything else parse_mobile_toml() leaves as clear_char() set it. */
+    m = &mob_proto[i];
+    clear_char(m);
+    m->nr = i;
+    m->player_specials = &dummy_mob;
+    m->player.name = get_str(r);
+    m->player.keywords = get_str(r);
+    m->player.short_descr = get_str(r);
+    m->player.long_descr = get_str(r);
+    m->player.description = get_str(r);
+    m->player.background = get_str(r);
+    m->player.sex = get_int(r);
+    m->player.chclass = get_int(r);
+    m->player.species = get_int(r);
+    m->player.level = get_int(r);
+    m->player.roleplay_age = get_int(r);
+    m->player.weight = get_int(r);
+    m->player.height = get_int(r);
+    m->player.time.birth = time(0);
+    m->player.roleplay_age_year = time_info.year;
+    get_abils(r, &m->real_abils);
+    m->aff_abils = m->real_abils;
+
+    m->points.mana = get_int(r);
+    m->points.max_mana = get_int(r);
+    m->points.hit = get_int(r);
+    m->points.max_hit = get_int(r);
+    m->points.stamina = get_int(r);
+    m->points.max_stamina = get_int(r);
+    m->points.armor = get_int(r);
+    m->points.coins = get_int(r);
+    m->points.exp = get_int(r);
+
+    m->char_specials.position = get_int(r);
+    m->char_specials.saved.alignment = get_int(r);
+    get_ints(r, m->char_specials.saved.act, PM_ARRAY_MAX);
+    get_ints(r, m->char_specials.saved.affected_by, AF_ARRAY_MAX);
+    for (j = 0; j < NUM_ABILITIES; j++)
+      m->char_specials.saved.saving_throws[j] = get_int(r);
+
+    m->mob_specials.attack_type = get_int(r);
+    m->mob_specials.default_pos = get_int(r);
+    get(r, m->mob_specials.skills, sizeof(m->mob_specials.skills));
+    m->mob_specials.ex_description = get_extra(r);
+    m->proto_script = get_protos(r);
+
+    lo = &m->proto_loadout;
+    for (n = get_int(r); n > 0; n--) {
+      CREATE(*lo, struct mob_loadout, 1);
+      (*lo)->vnum = get_int(r);
+      (*lo)->wear_pos = get_int(r);
+      (*lo)->quantity = get_int(r);
+      lo = &(*lo)->next;
+    }
+  }
+  top_of_mobt = count - 1;
+}
+
+static void get_objs(struct image_reader *r, int count)
+{
+  struct obj_data *o;
+  int i, j;
+
+  CREATE(obj_index, struct index_data, count);
+  CREATE(obj_proto, struct obj_data, count);
+  for (i = 0; i < count; i++) {
+    obj_index[i].vnum = get_int(r);
+
+    o = &obj_proto[i];
+    clear_object(o);
+    o->item_number = i;
+    o->name = get_str(r);
+    o->description = get_str(r);
+    o->short_description = get_str(r);
+    o->main_description = get_str(r);
+    o->ex_description = get_extra(r);
+    o->proto_script = get_protos(r);
+
+    get_ints(r, o->obj_flags.value, NUM_OBJ_VAL_POSITIONS);
+    o->obj_flags.type_flag = get_int(r);
+    o->obj_flags.level = get_int(r);
+    get_ints(r, o->obj_flags.wear_flags, TW_ARRAY_MAX);
+    get_ints(r, o->obj_flags.extra_flags, EF_ARRAY_MAX);
+    o->obj_flags.weight = get_int(r);
+    o->obj_flags.cost = get_int(r);
+    o->obj_flags.cost_per_day = get_int(r);
+    o->obj_flags.timer = get_int(r);
+    get_ints(r, o->obj_flags.bitvector, AF_ARRAY_MAX);
+    for (j = 0; j < MAX_OBJ_AFFECT; j++) {
+      o->affected[j].location = get_int(r);
+      o->affected[j].modifier = get_int(r);
+    }
+  }
+  top_of_objt = count - 1;
+}
+
+/** Map (or, without mmap, read) the whole image file.
+ * @retval char * The contents, or NULL if there is no usable file. */
+static char *image_map(size_t *len)
+{
+  struct stat st;
+  char *data;
+  int fd;
+
+  if ((fd = open(WORLD_IMAGE_FILE, O_RDONLY)) < 0)
+    return (NULL);
+  if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct image_header)) {
+    close(fd);
+    return (NULL);
+  }
+  *len = st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+  data = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  return (data == MAP_FAILED ? NULL : data);
+#else
+  CREATE(data, char, *len);
+  if (read(fd, data, *len) != (ssize_t)*len) {
+    free(data);
+    data = NULL;
+  }
+  close(fd);
+  return (data);
+#endif
+}
+
+static void image_unmap(char *data, size_t len)
+{
+#ifdef HAVE_SYS_MMAN_H
+  munmap(data, len);
+#else
+  free(data);
+#endif
+}
+
+/** Try to build the zone table, triggers, rooms, mobs and objects from the
+ * world image instead of the TOML files.
+ * @retval bool TRUE if the world was loaded (vnum tables included); FALSE
+ * if there is no image or it is out of date, and nothing was touched. */
+bool world_image_load(void)
+{
+  struct image_header hdr;
+  struct image_reader r;
+  struct timeval start;
+  const char *why = NULL;
+  char *data;
+  size_t len = 0;
+
+  gettimeofday(&start, NULL);
+  boot_sources = image_sources();
+
+  if (no_world_image) {
+    log("World image ignored (-w); loading world files.");
+    return (FALSE);
+  }
+
+  if (!(data = image_map(&len))) {
+    log("No world image; loading world files.");
+    return (FALSE);
+  }
+
+  memcpy(&hdr, data, sizeof(hdr));
+  if (memcmp(hdr.magic, WORLD_IMAGE_MAGIC, sizeof(hdr.magic)) ||
+      hdr.version != WORLD_IMAGE_VERSION || hdr.header_size != (int)sizeof(hdr))
+    why = "unknown format";
+  else if (hdr.layout != image_layout())
+    why = "written by a different build";
+  else if (hdr.sources != boot_sources)
+    why = "world files changed";
+  else if (hdr.payload_len != len - sizeof(hdr) ||
+           hdr.payload_hash != image_hash(IMAGE_HASH_INIT, data + sizeof(hdr), hdr.payload_len))
+    why = "damaged";
+  else if (hdr.zones < 1 || hdr.rooms < 1 || hdr.mobs < 1 || hdr.objs < 1 || hdr.trigs < 0)
+    why = "empty";
+
+  if (why) {
+    log("World image out of date (%s); loading world files.", why);
+    image_unmap(data, len);
+    return (FALSE);
+  }
+
+  r.pos = data + sizeof(hdr);
+  r.end = data + len;
+
+  get_zones(&r, hdr.zones);
+  get_triggers(&r, hdr.trigs);
+  get_rooms(&r, hdr.rooms);
+  get_mobs(&r, hdr.mobs);
+  get_objs(&r, hdr.objs);
+  if (r.pos != r.end)
+    image_corrupt();
+  image_unmap(data, len);
+
+  vnum_index_rebuild(DB_BOOT_ZON);
+  vnum_index_rebuild(DB_BOOT_TRG);
+  vnum_index_rebuild(DB_BOOT_WLD);
+  vnum_index_rebuild(DB_BOOT_MOB);
+  vnum_index_rebuild(DB_BOOT_OBJ);
+
+  log("Loaded world image: %d zones, %d triggers, %d rooms, %d mobs, %d objs (%lu KB) in %.1f ms.",
+      hdr.zones, hdr.trigs, hdr.rooms, hdr.mobs, hdr.objs, (unsigned long)(len / 1024),
+      image_elapsed_ms(&start));
+  return (TRUE);
+}
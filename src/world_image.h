@@ -0,0 +1,28 @@
+/**
+* @file world_image.h
+* Compiled binary image of the world prototypes, used to skip the TOML
+* parse at boot when the world files have not changed.
+*
+* Part of the core tbaMUD source code distribution, which is a derivative
+* of, and continuation of, CircleMUD.
+*
+* This set of code was not originally part of the circlemud distribution.
+* After a boot from the TOML files the zone table, triggers, rooms, mobs and
+* objects are written to WORLD_IMAGE_FILE, field by field.  The image is
+* keyed by the paths, sizes and mtimes of every index and world file (plus
+* the struct layout of the binary that wrote it), so touching any world
+* file, or rebuilding with different structs, makes the next boot go back to
+* the TOML path and write a fresh image.  Shops, quests and help are still read from their own
+* files; they are small and their loaders have side effects on other tables.
+*/
+#ifndef _WORLD_IMAGE_H_
+#define _WORLD_IMAGE_H_
+
+#define WORLD_IMAGE_MAGIC   "TBAWORLD"
+/** Bump whenever what is written for a table changes. */
+#define WORLD_IMAGE_VERSION 2
+
+bool world_image_load(void);
+void world_image_save(void);
+
+#endif /* _WORLD_IMAGE_H_ */
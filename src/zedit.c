@@ -350,6 +350,7 @@ static void zedit_save_internally(struct descriptor_data *d)
     zone_table[OLC_ZNUM(d)].max_level = OLC_ZONE(d)->max_level;
     for (i=0; i<ZN_ARRAY_MAX; i++)
       zone_table[OLC_ZNUM(d)].zone_flags[(i)] = OLC_ZONE(d)->zone_flags[(i)];
+    schedule_zone_reset(OLC_ZNUM(d));
   }
   add_to_save_list(zone_table[OLC_ZNUM(d)].number, SL_ZON);
 }